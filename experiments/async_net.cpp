@@ -0,0 +1,360 @@
+// Coroutines on one lab::EventLoop against a thread per connection, over
+// AF_UNIX socketpairs with 64-byte messages:
+//
+//   echo/<model>/conns:N               N clients, each echoed by its own
+//                                      server coroutine or thread
+//   rpc/<model>/clients:C/fanout:F     each client sends a request to F
+//                                      echo servers at once and waits
+//                                      for every reply
+//
+// One op is one round trip (echo) or one fanned-out request (rpc); ops are
+// spread evenly over the clients, and clients left without any stay idle
+// but connected. Connections and threads are set up outside the timed
+// region. Besides ns_per_op each point reports rtt_p50_us, rtt_p99_us and
+// rtt_p999_us, and ctx_switches_per_op from getrusage. Threads get 64 KiB
+// stacks; every connection costs two descriptors, so large grids need a
+// high RLIMIT_NOFILE, whose soft limit is raised to the hard one here.
+#include <pthread.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "lab/bench.hpp"
+#include "lab/event_loop.hpp"
+#include "lab/io.hpp"
+#include "lab/params.hpp"
+#include "lab/task.hpp"
+
+namespace async_net_bench {
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+constexpr std::size_t kMessage = 64;
+
+[[noreturn]] void fail(const std::string& error) {
+  std::fprintf(stderr, "async_net: %s\n", error.c_str());
+  std::exit(2);
+}
+
+// Client and server ends of `n` connections.
+struct Connections {
+  std::vector<int> client;
+  std::vector<int> server;
+};
+
+Connections connect_pairs(std::size_t n) {
+  rlimit limit{};
+  getrlimit(RLIMIT_NOFILE, &limit);
+  if (limit.rlim_cur < limit.rlim_max) {
+    limit.rlim_cur = limit.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &limit);
+  }
+  if (2 * n + 64 > limit.rlim_cur) {
+    fail(std::to_string(n) + " connections need " + std::to_string(2 * n) +
+         " descriptors; RLIMIT_NOFILE is " + std::to_string(limit.rlim_cur));
+  }
+  Connections c;
+  for (std::size_t i = 0; i < n; ++i) {
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) != 0) {
+      fail("socketpair failed");
+    }
+    c.client.push_back(fds[0]);
+    c.server.push_back(fds[1]);
+  }
+  return c;
+}
+
+// Ops of client `i` when `total` are spread over `clients`.
+std::uint64_t share(std::uint64_t total, std::size_t clients, std::size_t i) {
+  return total / clients + (i < total % clients ? 1 : 0);
+}
+
+double context_switches() {
+  rusage usage{};
+  getrusage(RUSAGE_SELF, &usage);
+  return static_cast<double>(usage.ru_nvcsw + usage.ru_nivcsw);
+}
+
+double microseconds(clock_type::duration d) {
+  return std::chrono::duration<double, std::micro>(d).count();
+}
+
+double percentile(std::vector<double>& v, double q) {
+  if (v.empty()) return 0;
+  auto k = static_cast<std::size_t>(q * static_cast<double>(v.size() - 1));
+  std::nth_element(v.begin(), v.begin() + static_cast<std::ptrdiff_t>(k),
+                   v.end());
+  return v[k];
+}
+
+// Times the body, which runs every op, and reports the common counters.
+template <class Body>
+void measure(lab::State& state, Body&& body) {
+  std::vector<double> rtt_us;
+  rtt_us.reserve(state.iterations());
+  double switches = context_switches();
+  auto start = clock_type::now();
+  body(rtt_us);
+  state.add_elapsed(clock_type::now() - start);
+  switches = context_switches() - switches;
+  auto ops =
+      static_cast<double>(std::max<std::uint64_t>(1, state.iterations()));
+  state.set_counter("rtt_p50_us", percentile(rtt_us, 0.50));
+  state.set_counter("rtt_p99_us", percentile(rtt_us, 0.99));
+  state.set_counter("rtt_p999_us", percentile(rtt_us, 0.999));
+  state.set_counter("ctx_switches_per_op", switches / ops);
+  for (double us : rtt_us) {
+    state.latency().record(static_cast<std::uint64_t>(us * 1e3));
+  }
+}
+
+// ---- coroutines ----------------------------------------------------------
+
+lab::task<> serve(lab::EventLoop& loop, int fd) {
+  char buf[kMessage];
+  for (int n; (n = co_await loop.read(fd, buf, sizeof buf)) > 0;) {
+    for (int done = 0; done < n;) {
+      int w = co_await loop.write(fd, buf + done,
+                                  static_cast<std::size_t>(n - done));
+      if (w <= 0) break;
+      done += w;
+    }
+  }
+  ::close(fd);
+}
+
+// One request and its full reply.
+lab::task<> call(lab::EventLoop& loop, int fd) {
+  char msg[kMessage] = {};
+  if (co_await loop.write(fd, msg, sizeof msg) != int{kMessage}) {
+    fail("short write");
+  }
+  for (std::size_t got = 0; got < kMessage;) {
+    int n = co_await loop.read(fd, msg + got, kMessage - got);
+    if (n <= 0) fail("connection closed");
+    got += static_cast<std::size_t>(n);
+  }
+}
+
+lab::task<> echo_client(lab::EventLoop& loop, int fd, std::uint64_t rounds,
+                        std::vector<double>& rtt_us) {
+  for (std::uint64_t r = 0; r < rounds; ++r) {
+    auto start = clock_type::now();
+    co_await call(loop, fd);
+    rtt_us.push_back(microseconds(clock_type::now() - start));
+  }
+  ::close(fd);
+}
+
+lab::task<> rpc_client(lab::EventLoop& loop, std::vector<int> fds,
+                       std::uint64_t rounds, std::vector<double>& rtt_us) {
+  for (std::uint64_t r = 0; r < rounds; ++r) {
+    auto start = clock_type::now();
+    std::vector<lab::task<>> calls;
+    calls.reserve(fds.size());
+    for (int fd : fds) calls.push_back(call(loop, fd));
+    co_await lab::when_all(std::move(calls));
+    rtt_us.push_back(microseconds(clock_type::now() - start));
+  }
+  for (int fd : fds) ::close(fd);
+}
+
+void make_loop(lab::EventLoop& loop) {
+  std::string error;
+  if (!loop.init(&error)) fail(error);
+}
+
+// Runs the clients with work to completion inside the timed region, then
+// closes the idle ones so that every server sees EOF and finishes.
+void run_coroutine_clients(lab::State& state, const Connections& c,
+                           std::size_t clients, std::size_t fanout) {
+  lab::EventLoop loop;
+  make_loop(loop);
+  for (int fd : c.server) loop.spawn(serve(loop, fd));
+  measure(state, [&](std::vector<double>& rtt_us) {
+    std::vector<lab::task<>> active;
+    for (std::size_t i = 0; i < clients; ++i) {
+      std::uint64_t rounds = share(state.iterations(), clients, i);
+      if (rounds == 0) break;
+      const int* first = &c.client[i * fanout];
+      if (fanout == 1) {
+        active.push_back(echo_client(loop, *first, rounds, rtt_us));
+      } else {
+        std::vector<int> fds(first, first + fanout);
+        active.push_back(rpc_client(loop, std::move(fds), rounds, rtt_us));
+      }
+    }
+    loop.run(lab::when_all(std::move(active)));
+  });
+  for (std::size_t i = 0; i < clients; ++i) {
+    if (share(state.iterations(), clients, i) > 0) continue;
+    for (std::size_t f = 0; f < fanout; ++f) ::close(c.client[i * fanout + f]);
+  }
+  loop.run();
+}
+
+void echo_coroutines(lab::State& state) {
+  auto conns = static_cast<std::size_t>(state.param("conns"));
+  run_coroutine_clients(state, connect_pairs(conns), conns, 1);
+}
+
+void rpc_coroutines(lab::State& state) {
+  auto clients = static_cast<std::size_t>(state.param("clients"));
+  auto fanout = static_cast<std::size_t>(state.param("fanout"));
+  run_coroutine_clients(state, connect_pairs(clients * fanout), clients,
+                        fanout);
+}
+
+// ---- threads -------------------------------------------------------------
+
+// Threads with small stacks, so thousands of them fit.
+class Threads {
+ public:
+  ~Threads() { join(); }
+
+  void start(std::function<void()> fn) {
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize(&attr, 64 * 1024);
+    auto* heap = new std::function<void()>(std::move(fn));
+    pthread_t thread;
+    int rc = pthread_create(
+        &thread, &attr,
+        [](void* p) -> void* {
+          auto* f = static_cast<std::function<void()>*>(p);
+          (*f)();
+          delete f;
+          return nullptr;
+        },
+        heap);
+    pthread_attr_destroy(&attr);
+    if (rc != 0) {
+      delete heap;
+      fail("pthread_create failed after " + std::to_string(threads_.size()) +
+           " threads");
+    }
+    threads_.push_back(thread);
+  }
+
+  void join() {
+    for (pthread_t t : threads_) pthread_join(t, nullptr);
+    threads_.clear();
+  }
+
+ private:
+  std::vector<pthread_t> threads_;
+};
+
+void blocking_serve(int fd) {
+  char buf[kMessage];
+  for (ssize_t n; (n = ::read(fd, buf, sizeof buf)) > 0;) {
+    for (ssize_t done = 0; done < n;) {
+      ssize_t w = ::write(fd, buf + done, static_cast<std::size_t>(n - done));
+      if (w <= 0) break;
+      done += w;
+    }
+  }
+  ::close(fd);
+}
+
+void blocking_send(int fd) {
+  char msg[kMessage] = {};
+  if (::write(fd, msg, sizeof msg) != static_cast<ssize_t>(kMessage)) {
+    fail("short write");
+  }
+}
+
+void blocking_receive(int fd) {
+  char msg[kMessage];
+  for (std::size_t got = 0; got < kMessage;) {
+    ssize_t n = ::read(fd, msg + got, kMessage - got);
+    if (n <= 0) fail("connection closed");
+    got += static_cast<std::size_t>(n);
+  }
+}
+
+// One server thread per connection and one thread per client with work,
+// owning `fanout` consecutive connections; these start together on a
+// signal given inside the timed region. Idle clients stay connected, their
+// servers blocked, until the measurement is over.
+void run_thread_clients(lab::State& state, const Connections& c,
+                        std::size_t clients, std::size_t fanout) {
+  Threads servers;
+  for (int fd : c.server) servers.start([fd] { blocking_serve(fd); });
+  std::vector<std::vector<double>> per_client(clients);
+  std::atomic<bool> go{false};
+  Threads workers;
+  for (std::size_t i = 0; i < clients; ++i) {
+    std::uint64_t rounds = share(state.iterations(), clients, i);
+    if (rounds == 0) break;
+    per_client[i].reserve(rounds);
+    const int* fds = &c.client[i * fanout];
+    workers.start([&, fds, rounds, i] {
+      go.wait(false);
+      for (std::uint64_t r = 0; r < rounds; ++r) {
+        auto start = clock_type::now();
+        for (std::size_t f = 0; f < fanout; ++f) blocking_send(fds[f]);
+        for (std::size_t f = 0; f < fanout; ++f) blocking_receive(fds[f]);
+        per_client[i].push_back(microseconds(clock_type::now() - start));
+      }
+      for (std::size_t f = 0; f < fanout; ++f) ::close(fds[f]);
+    });
+  }
+  measure(state, [&](std::vector<double>& rtt_us) {
+    go.store(true);
+    go.notify_all();
+    workers.join();
+    for (auto& v : per_client) rtt_us.insert(rtt_us.end(), v.begin(), v.end());
+  });
+  for (std::size_t i = 0; i < clients; ++i) {
+    if (share(state.iterations(), clients, i) > 0) continue;
+    for (std::size_t f = 0; f < fanout; ++f) ::close(c.client[i * fanout + f]);
+  }
+  servers.join();
+}
+
+void echo_threads(lab::State& state) {
+  auto conns = static_cast<std::size_t>(state.param("conns"));
+  run_thread_clients(state, connect_pairs(conns), conns, 1);
+}
+
+void rpc_threads(lab::State& state) {
+  auto clients = static_cast<std::size_t>(state.param("clients"));
+  auto fanout = static_cast<std::size_t>(state.param("fanout"));
+  run_thread_clients(state, connect_pairs(clients * fanout), clients, fanout);
+}
+
+const bool registered = [] {
+  std::string why;
+  if (!lab::io::backend_available(lab::io::Backend::uring, &why)) {
+    std::fprintf(stderr, "async_net: skipping coroutines: %s\n", why.c_str());
+  } else {
+    lab::Registry::global().add("echo/coroutines", echo_coroutines,
+                                {{"conns", lab::grid("16,256,4K")}});
+    lab::Registry::global().add("rpc/coroutines", rpc_coroutines,
+                                {{"clients", lab::grid("16,256")},
+                                 {"fanout", lab::grid("4,16")}});
+  }
+  lab::Registry::global().add("echo/threads", echo_threads,
+                              {{"conns", lab::grid("16,256,4K")}});
+  lab::Registry::global().add("rpc/threads", rpc_threads,
+                              {{"clients", lab::grid("16,256")},
+                               {"fanout", lab::grid("4,16")}});
+  return true;
+}();
+
+}  // namespace
+
+}  // namespace async_net_bench
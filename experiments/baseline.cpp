@@ -0,0 +1,24 @@
+// Reference points for reading other results: the cost of the timing loop
+// itself and of a cache-resident memcpy.
+#include <cstring>
+
+#include "lab/bench.hpp"
+
+namespace {
+
+void empty_loop(lab::State& state) {
+  for (auto _ : state) lab::clobber_memory();
+}
+LAB_BENCH(empty_loop);
+
+void memcpy_4k(lab::State& state) {
+  static char src[4096], dst[4096];
+  for (auto _ : state) {
+    std::memcpy(dst, src, sizeof(src));
+    lab::do_not_optimize(dst);
+  }
+  state.set_bytes_per_op(sizeof(src));
+}
+LAB_BENCH(memcpy_4k);
+
+}  // namespace
@@ -0,0 +1,37 @@
+// lab::bitpack: delta + zigzag + bit packing for slowly changing 32-bit
+// series. Fast on telemetry, useless on anything else.
+#include "lab/bitpack.hpp"
+
+#include "codec.hpp"
+
+namespace compression {
+
+namespace {
+
+std::size_t bitpack_compress(const std::byte* in, std::size_t bytes,
+                             std::byte* out) {
+  return lab::bitpack::compress(in, bytes, out);
+}
+
+bool bitpack_decompress(const std::byte* in, std::size_t size,
+                        std::byte* out, std::size_t out_bytes) {
+  return lab::bitpack::decompress(in, size, out, out_bytes);
+}
+
+}  // namespace
+
+const Codec& bitpack_codec() {
+  static const Codec codec{"bitpack", lab::bitpack::bound,
+                           bitpack_compress, bitpack_decompress};
+  return codec;
+}
+
+std::vector<const Codec*> codecs() {
+  std::vector<const Codec*> out = {&bitpack_codec()};
+  for (const Codec* c : {lz4_codec(), zstd_codec(), zlib_codec()}) {
+    if (c != nullptr) out.push_back(c);
+  }
+  return out;
+}
+
+}  // namespace compression
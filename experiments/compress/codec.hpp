@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// One compression codec. Codecs see whole buffers of known size: the
+// pipeline frames each chunk with its raw and compressed lengths, so no
+// codec needs its own stream format.
+namespace compression {
+
+struct Codec {
+  const char* name;
+  // Largest compressed size of `bytes` of input.
+  std::size_t (*bound)(std::size_t bytes);
+  // Compresses `bytes` of `in` into `out`, which holds bound(bytes);
+  // returns the compressed size, or 0 on failure.
+  std::size_t (*compress)(const std::byte* in, std::size_t bytes,
+                          std::byte* out);
+  // Decompresses `size` bytes into exactly `out_bytes`; false on
+  // malformed input.
+  bool (*decompress)(const std::byte* in, std::size_t size, std::byte* out,
+                     std::size_t out_bytes);
+};
+
+const Codec& bitpack_codec();
+// nullptr unless built with the library.
+const Codec* lz4_codec();
+const Codec* zstd_codec();
+const Codec* zlib_codec();
+
+// Every codec of this build, bitpack first.
+std::vector<const Codec*> codecs();
+
+}  // namespace compression
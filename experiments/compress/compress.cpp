@@ -0,0 +1,239 @@
+// Each codec (codec.hpp) over each corpus of the dataset cache, two ways:
+//
+//   compress/<codec>/<corpus>/compress      the whole corpus in one call
+//   compress/<codec>/<corpus>/decompress    and back
+//   compress/<codec>/<corpus>/pipeline/chunk:C/workers:N
+//       the corpus streamed from its file in C-byte chunks through
+//       read -> N compress workers -> write (pipeline.hpp); one op is
+//       the whole corpus, thread start included
+//
+// Codecs are bitpack (lab::bitpack, delta + SIMD bit packing) and, when
+// installed, lz4, zstd and zlib. Corpora are 16 MiB each: uniform
+// (incompressible), zipf (64-bit ranks) and telemetry (columns of 32-bit
+// timestamps, counters, gauges and flags).
+//
+// Counters: mb_per_s of raw bytes over wall time; mb_per_s_per_core over
+// the time spent inside the codec, summed over workers (equal to mb_per_s
+// single-shot); ratio, raw over compressed (framed in the pipeline); and
+// for the pipeline busy, the share of the workers' wall time spent
+// compressing. Pipeline mb_per_s close to workers * mb_per_s_per_core
+// means the stages overlap; low busy means read or write is the limit.
+// Every codec is checked to round-trip each corpus before it is timed.
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <set>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "codec.hpp"
+#include "lab/bench.hpp"
+#include "lab/dataset.hpp"
+#include "lab/params.hpp"
+#include "lab/topology.hpp"
+#include "pipeline.hpp"
+
+namespace compression {
+
+namespace {
+
+constexpr std::size_t kCorpusBytes = std::size_t{16} << 20;
+
+[[noreturn]] void fail(const std::string& message) {
+  std::fprintf(stderr, "compress: %s\n", message.c_str());
+  std::exit(2);
+}
+
+std::uint64_t splitmix(std::uint64_t& x) {
+  std::uint64_t z = (x += 0x9e3779b97f4a7c15ull);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+  return z ^ (z >> 31);
+}
+
+// Four columns of 32-bit words, as a columnar telemetry store holds them:
+// timestamps in ms with jitter, a counter, a random-walk gauge and rare
+// flags.
+void telemetry(std::uint64_t seed, std::span<std::byte> out) {
+  std::size_t n = out.size() / 4, column = n / 4;
+  std::vector<std::uint32_t> words(n);
+  std::uint32_t t = 1700000000, c = 0, g = 1u << 20;
+  for (std::size_t i = 0; i < n; ++i) {
+    std::uint64_t r = splitmix(seed);
+    switch (std::min<std::size_t>(i / column, 3)) {
+      case 0:
+        t += 1000 + static_cast<std::uint32_t>(r % 17) - 8;
+        words[i] = t;
+        break;
+      case 1:
+        c += static_cast<std::uint32_t>(r % 32);
+        words[i] = c;
+        break;
+      case 2:
+        g += static_cast<std::uint32_t>(r % 9) - 4;
+        words[i] = g;
+        break;
+      default:
+        words[i] = r % 64 == 0;
+        break;
+    }
+  }
+  std::memset(out.data(), 0, out.size());
+  std::memcpy(out.data(), words.data(), n * 4);
+}
+
+struct Corpus {
+  const char* name;
+  const char* generator;  // of its dataset key
+  std::uint64_t seed;
+  lab::dataset::Fill fill;
+};
+
+const std::vector<Corpus>& corpora() {
+  static const std::vector<Corpus> all = {
+      {"uniform", "uniform", 1, lab::dataset::uniform},
+      {"zipf", "zipf-1M-0.99", 42, lab::dataset::zipf(1 << 20, 0.99)},
+      {"telemetry", "telemetry-v1", 7, telemetry},
+  };
+  return all;
+}
+
+// The corpus, opened once and checked to round-trip once per codec.
+const lab::dataset::Dataset& corpus(const Codec& codec, const Corpus& c) {
+  static std::mutex mu;
+  static std::map<const Corpus*, lab::dataset::Dataset> open;
+  static std::set<std::pair<const Codec*, const Corpus*>> checked;
+  std::lock_guard lock(mu);
+  auto it = open.find(&c);
+  if (it == open.end()) {
+    lab::dataset::Dataset d;
+    std::string error;
+    if (!lab::dataset::open({c.generator, c.seed, kCorpusBytes}, c.fill, d,
+                            {.populate = true}, &error)) {
+      fail(error);
+    }
+    it = open.emplace(&c, std::move(d)).first;
+  }
+  const lab::dataset::Dataset& data = it->second;
+  if (checked.insert({&codec, &c}).second) {
+    std::vector<std::byte> packed(codec.bound(data.size()));
+    std::vector<std::byte> back(data.size());
+    std::size_t n = codec.compress(data.data(), data.size(), packed.data());
+    if (n == 0 ||
+        !codec.decompress(packed.data(), n, back.data(), back.size()) ||
+        std::memcmp(back.data(), data.data(), back.size()) != 0) {
+      fail(std::string(codec.name) + " does not round-trip " + c.name);
+    }
+  }
+  return data;
+}
+
+void report(lab::State& state, std::size_t raw, std::size_t packed,
+            double codec_seconds) {
+  auto total = static_cast<double>(raw) *
+               static_cast<double>(state.iterations());
+  auto ns = static_cast<double>(state.elapsed().count());
+  state.set_bytes_per_op(static_cast<double>(raw));
+  state.set_counter("mb_per_s", ns > 0 ? total / ns * 1e3 : 0);
+  state.set_counter("mb_per_s_per_core",
+                    codec_seconds > 0 ? total / codec_seconds * 1e-6 : 0);
+  state.set_counter("ratio", packed > 0 ? static_cast<double>(raw) /
+                                              static_cast<double>(packed)
+                                        : 0);
+}
+
+void single_compress(lab::State& state, const Codec& codec, const Corpus& c) {
+  const lab::dataset::Dataset& data = corpus(codec, c);
+  std::vector<std::byte> out(codec.bound(data.size()));
+  std::size_t n = 0;
+  for (auto _ : state) {
+    n = codec.compress(data.data(), data.size(), out.data());
+    lab::do_not_optimize(n);
+  }
+  report(state, data.size(), n,
+         static_cast<double>(state.elapsed().count()) * 1e-9);
+}
+
+void single_decompress(lab::State& state, const Codec& codec,
+                       const Corpus& c) {
+  const lab::dataset::Dataset& data = corpus(codec, c);
+  std::vector<std::byte> packed(codec.bound(data.size()));
+  packed.resize(codec.compress(data.data(), data.size(), packed.data()));
+  std::vector<std::byte> out(data.size());
+  for (auto _ : state) {
+    bool ok = codec.decompress(packed.data(), packed.size(), out.data(),
+                               out.size());
+    lab::do_not_optimize(ok);
+  }
+  report(state, data.size(), packed.size(),
+         static_cast<double>(state.elapsed().count()) * 1e-9);
+}
+
+void pipeline(lab::State& state, const Codec& codec, const Corpus& c,
+              const std::vector<int>& cpus) {
+  const lab::dataset::Dataset& data = corpus(codec, c);
+  int fd = ::open(data.path().c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) fail("cannot open " + data.path());
+  PipelineOptions options;
+  options.chunk = static_cast<std::size_t>(state.param("chunk"));
+  options.workers = static_cast<int>(state.param("workers"));
+  options.cpus = cpus;
+  Pipeline p(codec, options);
+
+  // One untimed run sizes and faults in the sink, and is checked.
+  std::vector<std::byte> sink, back;
+  PipelineStats stats = p.run(fd, data.size(), sink);
+  if (!unframe(codec, sink.data(), stats.out_bytes, back) ||
+      back.size() != data.size() ||
+      std::memcmp(back.data(), data.data(), back.size()) != 0) {
+    fail(std::string(codec.name) + " pipeline does not round-trip " + c.name);
+  }
+  double seconds = 0;
+  for (auto _ : state) {
+    stats = p.run(fd, data.size(), sink);
+    seconds += stats.compress_seconds;
+  }
+  ::close(fd);
+  report(state, data.size(), stats.out_bytes, seconds);
+  auto wall = static_cast<double>(state.elapsed().count()) * 1e-9;
+  state.set_counter("busy", wall > 0 ? seconds / (wall * options.workers) : 0);
+}
+
+const bool registered = [] {
+  lab::Topology topo = lab::Topology::detect();
+  std::vector<int> cpus = topo.pick(topo.cpu_count(), false);
+  for (const Codec* codec : codecs()) {
+    for (const Corpus& c : corpora()) {
+      std::string name =
+          std::string("compress/") + codec->name + "/" + c.name + "/";
+      lab::Registry::global().add(name + "compress",
+                                  [codec, &c](lab::State& state) {
+                                    single_compress(state, *codec, c);
+                                  });
+      lab::Registry::global().add(name + "decompress",
+                                  [codec, &c](lab::State& state) {
+                                    single_decompress(state, *codec, c);
+                                  });
+      lab::Registry::global().add(
+          name + "pipeline",
+          [codec, &c, cpus](lab::State& state) {
+            pipeline(state, *codec, c, cpus);
+          },
+          {{"chunk", lab::grid("64K,1M")}, {"workers", lab::grid("1,2,4")}});
+    }
+  }
+  return true;
+}();
+
+}  // namespace
+
+}  // namespace compression
@@ -0,0 +1,57 @@
+// LZ4 at its default (fastest) setting, when CMake found it
+// (LAB_HAVE_LZ4).
+#include "codec.hpp"
+
+#ifdef LAB_HAVE_LZ4
+
+#include <lz4.h>
+
+#include <climits>
+
+namespace compression {
+
+namespace {
+
+std::size_t lz4_bound(std::size_t bytes) {
+  return static_cast<std::size_t>(LZ4_compressBound(static_cast<int>(bytes)));
+}
+
+std::size_t lz4_compress(const std::byte* in, std::size_t bytes,
+                         std::byte* out) {
+  if (bytes > LZ4_MAX_INPUT_SIZE) return 0;
+  int n = LZ4_compress_default(reinterpret_cast<const char*>(in),
+                               reinterpret_cast<char*>(out),
+                               static_cast<int>(bytes),
+                               static_cast<int>(lz4_bound(bytes)));
+  return n > 0 ? static_cast<std::size_t>(n) : 0;
+}
+
+bool lz4_decompress(const std::byte* in, std::size_t size,
+                    std::byte* out, std::size_t out_bytes) {
+  if (size > INT_MAX || out_bytes > INT_MAX) return false;
+  int n = LZ4_decompress_safe(reinterpret_cast<const char*>(in),
+                              reinterpret_cast<char*>(out),
+                              static_cast<int>(size),
+                              static_cast<int>(out_bytes));
+  return n >= 0 && static_cast<std::size_t>(n) == out_bytes;
+}
+
+}  // namespace
+
+const Codec* lz4_codec() {
+  static const Codec codec{"lz4", lz4_bound, lz4_compress,
+                           lz4_decompress};
+  return &codec;
+}
+
+}  // namespace compression
+
+#else
+
+namespace compression {
+
+const Codec* lz4_codec() { return nullptr; }
+
+}  // namespace compression
+
+#endif
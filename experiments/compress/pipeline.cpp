@@ -0,0 +1,182 @@
+#include "pipeline.hpp"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+#include "lab/cpu.hpp"
+#include "lab/spsc_queue.hpp"
+#include "lab/topology.hpp"
+
+namespace compression {
+
+namespace {
+
+constexpr std::size_t kEnd = ~std::size_t{0};
+constexpr std::size_t kFrame = 2 * sizeof(std::uint32_t);
+
+[[noreturn]] void fail(const Codec& codec, const char* what) {
+  std::fprintf(stderr, "compress/%s: %s\n", codec.name, what);
+  std::exit(2);
+}
+
+// Spins with a pause hint, yielding now and then so that a pipeline with
+// more threads than CPUs still makes progress.
+template <class F>
+void spin_until(F&& done) {
+  for (unsigned n = 1; !done(); ++n) {
+    if (n % 1024 == 0) {
+      std::this_thread::yield();
+    } else {
+      lab::cpu_relax();
+    }
+  }
+}
+
+}  // namespace
+
+struct Pipeline::Job {
+  std::size_t chunk = kEnd;
+  std::uint32_t slot = 0;
+  std::uint32_t bytes = 0;  // raw when filled, compressed when done
+};
+
+struct Pipeline::Worker {
+  Worker(std::size_t depth, std::size_t chunk, std::size_t bound)
+      : filled(depth + 1),
+        done(depth + 1),
+        free(depth + 1),
+        in(depth, std::vector<std::byte>(chunk)),
+        out(depth, std::vector<std::byte>(bound)) {}
+
+  lab::SpscQueue<Job> filled;          // read -> compress
+  lab::SpscQueue<Job> done;            // compress -> write
+  lab::SpscQueue<std::uint32_t> free;  // write -> read
+  std::vector<std::vector<std::byte>> in, out;
+  double seconds = 0;
+};
+
+Pipeline::Pipeline(const Codec& codec, const PipelineOptions& options)
+    : codec_(codec), options_(options) {
+  options_.workers = std::max(options_.workers, 1);
+  options_.depth = std::max<std::size_t>(options_.depth, 1);
+  for (int i = 0; i < options_.workers; ++i) {
+    auto w = std::make_unique<Worker>(options_.depth, options_.chunk,
+                                      codec_.bound(options_.chunk));
+    for (std::size_t s = 0; s < options_.depth; ++s) {
+      w->free.try_push(static_cast<std::uint32_t>(s));
+    }
+    workers_.push_back(std::move(w));
+  }
+}
+
+Pipeline::~Pipeline() = default;
+
+void Pipeline::read_stage(int fd, std::size_t bytes) {
+  const std::size_t chunk = options_.chunk;
+  for (std::size_t k = 0; k * chunk < bytes; ++k) {
+    Worker& w = *workers_[k % workers_.size()];
+    std::uint32_t slot;
+    spin_until([&] { return w.free.try_pop(slot); });
+    std::size_t n = std::min(chunk, bytes - k * chunk);
+    std::byte* p = w.in[slot].data();
+    for (std::size_t got = 0; got < n;) {
+      ssize_t r = ::pread(fd, p + got, n - got,
+                          static_cast<off_t>(k * chunk + got));
+      if (r <= 0) fail(codec_, "short read");
+      got += static_cast<std::size_t>(r);
+    }
+    Job job{k, slot, static_cast<std::uint32_t>(n)};
+    spin_until([&] { return w.filled.try_push(job); });
+  }
+  for (auto& w : workers_) {
+    spin_until([&] { return w->filled.try_push(Job{}); });
+  }
+}
+
+void Pipeline::compress_stage(Worker& w) {
+  for (;;) {
+    Job job;
+    spin_until([&] { return w.filled.try_pop(job); });
+    if (job.chunk == kEnd) return;
+    auto start = std::chrono::steady_clock::now();
+    std::size_t n = codec_.compress(w.in[job.slot].data(), job.bytes,
+                                    w.out[job.slot].data());
+    w.seconds += std::chrono::duration<double>(
+                     std::chrono::steady_clock::now() - start)
+                     .count();
+    if (n == 0) fail(codec_, "compress failed");
+    job.bytes = static_cast<std::uint32_t>(n);
+    spin_until([&] { return w.done.try_push(job); });
+  }
+}
+
+PipelineStats Pipeline::run(int fd, std::size_t bytes,
+                            std::vector<std::byte>& sink) {
+  const std::size_t chunk = options_.chunk;
+  const std::size_t chunks = (bytes + chunk - 1) / chunk;
+  const std::size_t limit = chunks * (kFrame + codec_.bound(chunk));
+  if (sink.size() < limit) sink.resize(limit);
+
+  const std::vector<int>& cpus = options_.cpus;
+  auto pin = [&cpus](std::size_t i) {
+    if (!cpus.empty()) lab::pin_thread(cpus[i % cpus.size()]);
+  };
+  std::vector<std::thread> threads;
+  threads.emplace_back([this, fd, bytes, pin] {
+    pin(0);
+    read_stage(fd, bytes);
+  });
+  for (std::size_t i = 0; i < workers_.size(); ++i) {
+    workers_[i]->seconds = 0;
+    threads.emplace_back([this, i, pin] {
+      pin(i + 1);
+      compress_stage(*workers_[i]);
+    });
+  }
+
+  std::size_t at = 0;
+  for (std::size_t k = 0; k < chunks; ++k) {
+    Worker& w = *workers_[k % workers_.size()];
+    Job job;
+    spin_until([&] { return w.done.try_pop(job); });
+    const std::uint32_t frame[2] = {
+        static_cast<std::uint32_t>(std::min(chunk, bytes - k * chunk)),
+        job.bytes};
+    std::memcpy(sink.data() + at, frame, kFrame);
+    std::memcpy(sink.data() + at + kFrame, w.out[job.slot].data(), job.bytes);
+    at += kFrame + job.bytes;
+    spin_until([&] { return w.free.try_push(job.slot); });
+  }
+  for (auto& t : threads) t.join();
+
+  PipelineStats stats{bytes, at, 0};
+  for (const auto& w : workers_) stats.compress_seconds += w->seconds;
+  return stats;
+}
+
+bool unframe(const Codec& codec, const std::byte* data, std::size_t size,
+             std::vector<std::byte>& out) {
+  out.clear();
+  for (std::size_t at = 0; at < size;) {
+    std::uint32_t frame[2];
+    if (size - at < kFrame) return false;
+    std::memcpy(frame, data + at, kFrame);
+    at += kFrame;
+    if (size - at < frame[1]) return false;
+    std::size_t base = out.size();
+    out.resize(base + frame[0]);
+    if (!codec.decompress(data + at, frame[1], out.data() + base, frame[0])) {
+      return false;
+    }
+    at += frame[1];
+  }
+  return true;
+}
+
+}  // namespace compression
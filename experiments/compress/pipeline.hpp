@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "codec.hpp"
+
+// Chunked streaming compression in three stages, each on its own thread
+// and joined by lab::SpscQueue:
+//
+//   read      pread(2) of each chunk from a file into a free input slot
+//   compress  `workers` threads; chunk k goes to worker k % workers
+//   write     the calling thread, framing each chunk into one sink buffer
+//             in input order
+//
+// Every worker has its own three rings (read -> worker, worker -> write,
+// and free slots write -> read), so each has one producer and one
+// consumer and order is restored by visiting workers round-robin. A
+// worker holds at most `depth` chunks, which bounds memory and lets a
+// slow stage stall the ones before it.
+namespace compression {
+
+struct PipelineOptions {
+  std::size_t chunk = std::size_t{1} << 20;
+  int workers = 1;
+  std::size_t depth = 4;
+  // CPUs for the read thread and then each worker, in turn; empty leaves
+  // them where the caller is allowed to run.
+  std::vector<int> cpus;
+};
+
+struct PipelineStats {
+  std::size_t in_bytes = 0;
+  std::size_t out_bytes = 0;     // framed, as written to the sink
+  double compress_seconds = 0;   // inside Codec::compress, all workers
+};
+
+// The rings and chunk buffers are made once and reused by every run; the
+// threads are started by each run.
+class Pipeline {
+ public:
+  Pipeline(const Codec& codec, const PipelineOptions& options);
+  ~Pipeline();
+
+  Pipeline(const Pipeline&) = delete;
+  Pipeline& operator=(const Pipeline&) = delete;
+
+  // Compresses the first `bytes` of `fd` into the front of `sink`, grown
+  // as needed: per chunk its raw and compressed sizes as two 32-bit
+  // words, then the compressed bytes.
+  PipelineStats run(int fd, std::size_t bytes, std::vector<std::byte>& sink);
+
+ private:
+  struct Job;
+  struct Worker;
+
+  void read_stage(int fd, std::size_t bytes);
+  void compress_stage(Worker& w);
+
+  const Codec& codec_;
+  PipelineOptions options_;
+  std::vector<std::unique_ptr<Worker>> workers_;
+};
+
+// Decompresses the `size` framed bytes run() wrote; false if a frame is
+// malformed.
+bool unframe(const Codec& codec, const std::byte* data, std::size_t size,
+             std::vector<std::byte>& out);
+
+}  // namespace compression
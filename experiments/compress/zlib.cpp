@@ -0,0 +1,55 @@
+// zlib at level 1, when CMake found it (LAB_HAVE_ZLIB): the baseline most
+// existing telemetry pipelines started from.
+#include "codec.hpp"
+
+#ifdef LAB_HAVE_ZLIB
+
+#include <zlib.h>
+
+namespace compression {
+
+namespace {
+
+constexpr int kZlibLevel = 1;
+
+std::size_t zlib_bound(std::size_t bytes) {
+  return static_cast<std::size_t>(compressBound(static_cast<uLong>(bytes)));
+}
+
+std::size_t zlib_compress(const std::byte* in, std::size_t bytes,
+                          std::byte* out) {
+  auto n = static_cast<uLongf>(zlib_bound(bytes));
+  int rc = compress2(reinterpret_cast<Bytef*>(out), &n,
+                     reinterpret_cast<const Bytef*>(in),
+                     static_cast<uLong>(bytes), kZlibLevel);
+  return rc == Z_OK ? static_cast<std::size_t>(n) : 0;
+}
+
+bool zlib_decompress(const std::byte* in, std::size_t size,
+                     std::byte* out, std::size_t out_bytes) {
+  auto n = static_cast<uLongf>(out_bytes);
+  int rc = uncompress(reinterpret_cast<Bytef*>(out), &n,
+                      reinterpret_cast<const Bytef*>(in),
+                      static_cast<uLong>(size));
+  return rc == Z_OK && n == out_bytes;
+}
+
+}  // namespace
+
+const Codec* zlib_codec() {
+  static const Codec codec{"zlib", zlib_bound, zlib_compress,
+                           zlib_decompress};
+  return &codec;
+}
+
+}  // namespace compression
+
+#else
+
+namespace compression {
+
+const Codec* zlib_codec() { return nullptr; }
+
+}  // namespace compression
+
+#endif
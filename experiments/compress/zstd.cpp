@@ -0,0 +1,61 @@
+// Zstandard at level 1, when CMake found it (LAB_HAVE_ZSTD). Contexts are
+// kept per thread, as a long-running compressor would.
+#include "codec.hpp"
+
+#ifdef LAB_HAVE_ZSTD
+
+#include <zstd.h>
+
+#include <memory>
+
+namespace compression {
+
+namespace {
+
+constexpr int kZstdLevel = 1;
+
+struct FreeCCtx {
+  void operator()(ZSTD_CCtx* c) const { ZSTD_freeCCtx(c); }
+};
+struct FreeDCtx {
+  void operator()(ZSTD_DCtx* d) const { ZSTD_freeDCtx(d); }
+};
+
+std::size_t zstd_bound(std::size_t bytes) {
+  return ZSTD_compressBound(bytes);
+}
+
+std::size_t zstd_compress(const std::byte* in, std::size_t bytes,
+                          std::byte* out) {
+  thread_local std::unique_ptr<ZSTD_CCtx, FreeCCtx> ctx(ZSTD_createCCtx());
+  std::size_t n = ZSTD_compressCCtx(ctx.get(), out, zstd_bound(bytes), in,
+                                    bytes, kZstdLevel);
+  return ZSTD_isError(n) ? 0 : n;
+}
+
+bool zstd_decompress(const std::byte* in, std::size_t size,
+                     std::byte* out, std::size_t out_bytes) {
+  thread_local std::unique_ptr<ZSTD_DCtx, FreeDCtx> ctx(ZSTD_createDCtx());
+  std::size_t n = ZSTD_decompressDCtx(ctx.get(), out, out_bytes, in, size);
+  return !ZSTD_isError(n) && n == out_bytes;
+}
+
+}  // namespace
+
+const Codec* zstd_codec() {
+  static const Codec codec{"zstd", zstd_bound, zstd_compress,
+                           zstd_decompress};
+  return &codec;
+}
+
+}  // namespace compression
+
+#else
+
+namespace compression {
+
+const Codec* zstd_codec() { return nullptr; }
+
+}  // namespace compression
+
+#endif
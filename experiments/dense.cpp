@@ -0,0 +1,122 @@
+// The lab::dense kernels naive, tiled and cache-oblivious over n x n
+// matrices, as "<kernel>_<form>/n:N" and "<kernel>_tiled<T>/n:N" for tile
+// size T. Run with --perf: llc_misses_per_op shows what blocking saves
+// once the matrices outgrow the LLC, and how close the recursive form,
+// which has no tile size to tune, gets to the best tile.
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "lab/bench.hpp"
+#include "lab/dense.hpp"
+#include "lab/params.hpp"
+
+namespace {
+
+// Stencil steps per op, enough for time tiling to have something to reuse.
+constexpr std::size_t kSteps = 32;
+
+std::size_t n_of(lab::State& state) {
+  return static_cast<std::size_t>(state.param("n"));
+}
+
+std::vector<double> matrix(std::size_t n, std::uint64_t seed) {
+  std::vector<double> m(n * n);
+  for (auto& v : m) {
+    seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+    v = static_cast<double>(seed >> 40) * 0x1.0p-24;
+  }
+  return m;
+}
+
+template <class Kernel>
+void gemm(lab::State& state, Kernel kernel) {
+  std::size_t n = n_of(state);
+  auto a = matrix(n, 1), b = matrix(n, 2);
+  std::vector<double> c(n * n);
+  for (auto _ : state) {
+    kernel(a.data(), b.data(), c.data(), n, n, n);
+    lab::clobber_memory();
+  }
+  state.set_counter("flops_per_op", 2.0 * n * n * n);
+}
+
+void gemm_naive(lab::State& state) {
+  gemm(state, lab::dense::gemm_naive<double>);
+}
+LAB_BENCH_PARAMS(gemm_naive, {"n", lab::grid("128,512")});
+
+template <std::size_t kTile>
+void gemm_tiled(lab::State& state) {
+  gemm(state, lab::dense::gemm_tiled<kTile, double>);
+}
+LAB_BENCH_VALUES(gemm_tiled, (16, 32, 64), {"n", lab::grid("128,512")});
+
+void gemm_recursive(lab::State& state) {
+  gemm(state, [](const double* a, const double* b, double* c, std::size_t m,
+                 std::size_t n, std::size_t k) {
+    lab::dense::gemm_recursive(a, b, c, m, n, k);
+  });
+}
+LAB_BENCH_PARAMS(gemm_recursive, {"n", lab::grid("128,512")});
+
+template <class Kernel>
+void transpose(lab::State& state, Kernel kernel) {
+  std::size_t n = n_of(state);
+  auto in = matrix(n, 1);
+  std::vector<double> out(n * n);
+  for (auto _ : state) {
+    kernel(in.data(), out.data(), n, n);
+    lab::clobber_memory();
+  }
+  state.set_bytes_per_op(static_cast<double>(2 * n * n * sizeof(double)));
+}
+
+void transpose_naive(lab::State& state) {
+  transpose(state, lab::dense::transpose_naive<double>);
+}
+LAB_BENCH_PARAMS(transpose_naive, {"n", lab::grid("1K,4K")});
+
+template <std::size_t kTile>
+void transpose_tiled(lab::State& state) {
+  transpose(state, lab::dense::transpose_tiled<kTile, double>);
+}
+LAB_BENCH_VALUES(transpose_tiled, (8, 32, 128), {"n", lab::grid("1K,4K")});
+
+void transpose_recursive(lab::State& state) {
+  transpose(state, [](const double* in, double* out, std::size_t rows,
+                      std::size_t cols) {
+    lab::dense::transpose_recursive(in, out, rows, cols);
+  });
+}
+LAB_BENCH_PARAMS(transpose_recursive, {"n", lab::grid("1K,4K")});
+
+template <class Kernel>
+void stencil(lab::State& state, Kernel kernel) {
+  std::size_t n = n_of(state);
+  auto a = matrix(n, 1);
+  auto b = a;
+  for (auto _ : state) {
+    kernel(a.data(), b.data(), n, kSteps);
+    lab::clobber_memory();
+  }
+  state.set_bytes_per_op(static_cast<double>(kSteps * n * n * sizeof(double)));
+}
+
+void stencil_naive(lab::State& state) {
+  stencil(state, lab::dense::stencil_naive<double>);
+}
+LAB_BENCH_PARAMS(stencil_naive, {"n", lab::grid("512,2K")});
+
+template <std::size_t kTile>
+void stencil_tiled(lab::State& state) {
+  stencil(state, lab::dense::stencil_tiled<kTile, double>);
+}
+LAB_BENCH_VALUES(stencil_tiled, (16, 64), {"n", lab::grid("512,2K")});
+
+void stencil_recursive(lab::State& state) {
+  stencil(state, lab::dense::stencil_recursive<double>);
+}
+LAB_BENCH_PARAMS(stencil_recursive, {"n", lab::grid("512,2K")});
+
+}  // namespace
@@ -0,0 +1,107 @@
+// BFS and PageRank over one random geometric graph (lab::graph::geometric)
+// in three vertex layouts, as "<kernel>/<layout>/vertices:N":
+//
+//   plain     ids in ingest order, unrelated to the graph's structure
+//   degree    highest degree first
+//   hilbert   along a Hilbert curve over the vertex positions
+//
+// The graph and the work are the same in every layout; only which vertices
+// share cache lines and pages differs. Run with --perf to see it in
+// llc_misses_per_op next to ns_per_op.
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "lab/bench.hpp"
+#include "lab/graph.hpp"
+#include "lab/params.hpp"
+
+namespace graph_bench {
+
+namespace {
+
+namespace graph = lab::graph;
+
+constexpr double kDegree = 12;
+constexpr int kIterations = 4;  // PageRank rounds per op
+
+struct Layout {
+  graph::Csr csr;
+  std::uint32_t source;  // vertex 0 of the plain layout, renamed
+};
+
+struct Layouts {
+  Layout plain, degree, hilbert;
+};
+
+// Built once per size; generating and reordering a 1M vertex graph takes
+// longer than measuring it.
+const Layouts& layouts(std::uint32_t vertices) {
+  static std::mutex mu;
+  static std::map<std::uint32_t, std::unique_ptr<Layouts>> cache;
+  std::lock_guard lock(mu);
+  auto& slot = cache[vertices];
+  if (!slot) {
+    graph::Geometric g = graph::geometric(vertices, kDegree, 1);
+    auto by_degree = graph::degree_order(g.csr);
+    auto by_hilbert = graph::hilbert_order(g.x, g.y);
+    slot = std::make_unique<Layouts>();
+    slot->degree = {graph::permute(g.csr, by_degree), by_degree[0]};
+    slot->hilbert = {graph::permute(g.csr, by_hilbert), by_hilbert[0]};
+    slot->plain = {std::move(g.csr), 0};
+  }
+  return *slot;
+}
+
+void bfs(lab::State& state, const Layout& layout) {
+  for (auto _ : state) {
+    auto depth = graph::bfs(layout.csr, layout.source);
+    lab::do_not_optimize(depth.data());
+  }
+  state.set_counter("edges", static_cast<double>(layout.csr.edges()));
+}
+
+void pagerank(lab::State& state, const Layout& layout) {
+  for (auto _ : state) {
+    auto rank = graph::pagerank(layout.csr, kIterations);
+    lab::do_not_optimize(rank.data());
+  }
+  state.set_counter("edges", static_cast<double>(kIterations) *
+                                 static_cast<double>(layout.csr.edges()));
+}
+
+struct Kernel {
+  const char* name;
+  void (*fn)(lab::State&, const Layout&);
+};
+
+constexpr Kernel kKernels[] = {{"bfs", bfs}, {"pagerank", pagerank}};
+
+constexpr struct {
+  const char* name;
+  Layout Layouts::*layout;
+} kLayouts[] = {{"plain", &Layouts::plain},
+                {"degree", &Layouts::degree},
+                {"hilbert", &Layouts::hilbert}};
+
+const bool registered = [] {
+  for (const auto& kernel : kKernels) {
+    for (const auto& layout : kLayouts) {
+      lab::Registry::global().add(
+          std::string(kernel.name) + "/" + layout.name,
+          [fn = kernel.fn, member = layout.layout](lab::State& state) {
+            auto n = static_cast<std::uint32_t>(state.param("vertices"));
+            fn(state, layouts(n).*member);
+          },
+          {{"vertices", lab::grid("64K,1M")}});
+    }
+  }
+  return true;
+}();
+
+}  // namespace
+
+}  // namespace graph_bench
@@ -0,0 +1,138 @@
+// lab::FlatMap against std::unordered_map with 64-bit keys and values,
+// reported as "<op>/<map>/size:N" for N elements. Sizes run from an
+// L1-resident table to one far larger than the LLC; the allocation
+// columns show what the node-based map pays per insert.
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "lab/bench.hpp"
+#include "lab/flat_map.hpp"
+#include "lab/params.hpp"
+
+namespace hash_maps_bench {
+
+namespace {
+
+using Flat = lab::FlatMap<std::uint64_t, std::uint64_t>;
+using Std = std::unordered_map<std::uint64_t, std::uint64_t>;
+
+// Distinct pseudo-random keys; odd and even halves give hits and misses.
+std::vector<std::uint64_t> make_keys(std::size_t n, std::uint64_t parity) {
+  std::vector<std::uint64_t> keys(n);
+  std::uint64_t x = 0x9e3779b97f4a7c15ull;
+  for (auto& k : keys) {
+    x += 0x9e3779b97f4a7c15ull;
+    std::uint64_t z = x;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    k = ((z ^ (z >> 31)) & ~std::uint64_t{1}) | parity;
+  }
+  return keys;
+}
+
+template <class Map>
+Map filled(const std::vector<std::uint64_t>& keys) {
+  Map map;
+  for (auto k : keys) map[k] = k;
+  return map;
+}
+
+std::size_t size_of(lab::State& state) {
+  return static_cast<std::size_t>(state.param("size"));
+}
+
+// One op is one insert into a map growing from empty to `size`; the
+// refill between rounds is not timed.
+template <class Map>
+void insert(lab::State& state) {
+  auto keys = make_keys(size_of(state), 0);
+  Map map;
+  std::size_t i = 0;
+  for (auto _ : state) {
+    if (i == keys.size()) {
+      state.pause_timing();
+      map = Map();
+      i = 0;
+      state.resume_timing();
+    }
+    map.insert({keys[i], i});
+    ++i;
+  }
+  lab::do_not_optimize(map);
+}
+
+template <class Map>
+void lookup(lab::State& state, std::uint64_t parity) {
+  auto keys = make_keys(size_of(state), 0);
+  Map map = filled<Map>(keys);
+  auto probes = make_keys(size_of(state), parity);
+  std::size_t i = 0;
+  for (auto _ : state) {
+    lab::do_not_optimize(map.find(probes[i]));
+    if (++i == probes.size()) i = 0;
+  }
+}
+
+template <class Map>
+void lookup_hit(lab::State& state) {
+  lookup<Map>(state, 0);
+}
+
+template <class Map>
+void lookup_miss(lab::State& state) {
+  lookup<Map>(state, 1);
+}
+
+// One op is one erase from a full map; it is refilled, untimed, once
+// empty.
+template <class Map>
+void erase(lab::State& state) {
+  auto keys = make_keys(size_of(state), 0);
+  Map map = filled<Map>(keys);
+  std::size_t i = 0;
+  for (auto _ : state) {
+    if (i == keys.size()) {
+      state.pause_timing();
+      for (auto k : keys) map[k] = k;
+      i = 0;
+      state.resume_timing();
+    }
+    lab::do_not_optimize(map.erase(keys[i++]));
+  }
+}
+
+// FlatMap::insert takes key and value separately.
+struct FlatAdapter : Flat {
+  bool insert(std::pair<std::uint64_t, std::uint64_t> kv) {
+    return Flat::insert(kv.first, kv.second);
+  }
+};
+
+struct Op {
+  const char* name;
+  lab::BenchFn flat;
+  lab::BenchFn std;
+};
+
+const bool registered = [] {
+  const Op ops[] = {
+      {"insert", insert<FlatAdapter>, insert<Std>},
+      {"lookup_hit", lookup_hit<Flat>, lookup_hit<Std>},
+      {"lookup_miss", lookup_miss<Flat>, lookup_miss<Std>},
+      {"erase", erase<Flat>, erase<Std>},
+  };
+  for (const auto& op : ops) {
+    for (auto [map, fn] : {std::pair{"flat_map", op.flat},
+                           std::pair{"unordered_map", op.std}}) {
+      lab::Registry::global().add(std::string(op.name) + "/" + map, fn,
+                                  {{"size", lab::grid("1K..4M:x16")}});
+    }
+  }
+  return true;
+}();
+
+}  // namespace
+
+}  // namespace hash_maps_bench
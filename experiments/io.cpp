@@ -0,0 +1,207 @@
+// One file through every lab::io backend, as "read/<backend>/..." and
+// "write/<backend>/..." with size and block in bytes; uring adds the
+// queue depth and reads add cold:1, which evicts the file from the page
+// cache before every pass. One op is one pass over the whole file, so
+// bytes_per_op is the file size. Besides ns_per_op each point reports
+//   gb_per_s      throughput over its last sample's passes
+//   req_p50_us,   per-request latency (see lab::io::Stats::latency_ns)
+//   req_p99_us
+//   cpu_s_per_gb  process CPU time per GB moved
+// Files go to $LAB_IO_DIR, or the temporary directory; point it at the
+// device under test, since tmpfs neither does O_DIRECT nor reaches a disk.
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "lab/bench.hpp"
+#include "lab/io.hpp"
+#include "lab/params.hpp"
+
+namespace io_bench {
+
+namespace {
+
+using lab::io::Backend;
+
+std::filesystem::path io_dir() {
+  const char* dir = std::getenv("LAB_IO_DIR");
+  return dir != nullptr && *dir != '\0'
+             ? std::filesystem::path(dir)
+             : std::filesystem::temp_directory_path();
+}
+
+std::string scratch_path(const std::string& what) {
+  return (io_dir() / ("lab_io_" + std::to_string(getpid()) + "_" + what))
+      .string();
+}
+
+void fail(const std::string& error) {
+  std::fprintf(stderr, "io: %s\n", error.c_str());
+  std::exit(2);
+}
+
+// Files shared by every read benchmark of a size, removed at exit.
+class Files {
+ public:
+  ~Files() {
+    std::error_code ignored;
+    for (const auto& [size, path] : paths_) {
+      std::filesystem::remove(path, ignored);
+    }
+  }
+
+  const std::string& input(std::uint64_t size) {
+    auto it = paths_.find(size);
+    if (it != paths_.end()) return it->second;
+    std::string path = scratch_path(std::to_string(size));
+    std::string error;
+    if (!lab::io::write_file(Backend::pread, path, size, {}, nullptr,
+                             &error)) {
+      fail(error);
+    }
+    return paths_.emplace(size, std::move(path)).first->second;
+  }
+
+ private:
+  std::map<std::uint64_t, std::string> paths_;
+};
+
+Files& files() {
+  static Files files;
+  return files;
+}
+
+double percentile(std::vector<double>& v, double q) {
+  if (v.empty()) return 0;
+  auto k = static_cast<std::size_t>(q * static_cast<double>(v.size() - 1));
+  std::nth_element(v.begin(), v.begin() + static_cast<std::ptrdiff_t>(k),
+                   v.end());
+  return v[k];
+}
+
+// Sums the passes of one sample into the reported counters.
+class Totals {
+ public:
+  void add(lab::io::Stats& pass) {
+    bytes_ += static_cast<double>(pass.bytes);
+    seconds_ += pass.seconds;
+    cpu_ += pass.cpu_seconds;
+    latency_.insert(latency_.end(), pass.latency_ns.begin(),
+                    pass.latency_ns.end());
+  }
+
+  void report(lab::State& state) {
+    double gb = bytes_ / 1e9;
+    state.set_counter("gb_per_s", seconds_ > 0 ? gb / seconds_ : 0);
+    state.set_counter("req_p50_us", percentile(latency_, 0.50) / 1e3);
+    state.set_counter("req_p99_us", percentile(latency_, 0.99) / 1e3);
+    state.set_counter("cpu_s_per_gb", gb > 0 ? cpu_ / gb : 0);
+    for (double ns : latency_) {
+      state.latency().record(static_cast<std::uint64_t>(ns));
+    }
+  }
+
+ private:
+  double bytes_ = 0;
+  double seconds_ = 0;
+  double cpu_ = 0;
+  std::vector<double> latency_;
+};
+
+lab::io::Options options_of(lab::State& state) {
+  lab::io::Options opts;
+  opts.block_size = static_cast<std::size_t>(state.param("block"));
+  if (state.param("depth") > 0) {
+    opts.queue_depth = static_cast<unsigned>(state.param("depth"));
+  }
+  return opts;
+}
+
+void read_pass(lab::State& state, Backend backend) {
+  auto size = static_cast<std::uint64_t>(state.param("size"));
+  const std::string& path = files().input(size);
+  lab::io::Options opts = options_of(state);
+  bool cold = state.param("cold") != 0;
+  // Touches every cache line, the same work for every backend.
+  std::uint64_t sum = 0;
+  lab::io::Consumer consume = [&](std::uint64_t, const char* data,
+                                  std::size_t n) {
+    for (std::size_t i = 0; i + 8 <= n; i += 64) {
+      std::uint64_t word;
+      __builtin_memcpy(&word, data + i, 8);
+      sum += word;
+    }
+  };
+  lab::io::Stats pass;
+  Totals totals;
+  std::string error;
+  for (auto _ : state) {
+    if (cold) {
+      state.pause_timing();
+      lab::io::drop_cache(path);
+      state.resume_timing();
+    }
+    if (!lab::io::read_file(backend, path, opts, consume, &pass, &error)) {
+      fail(error);
+    }
+    totals.add(pass);
+  }
+  lab::do_not_optimize(sum);
+  state.set_bytes_per_op(static_cast<double>(size));
+  totals.report(state);
+}
+
+void write_pass(lab::State& state, Backend backend) {
+  auto size = static_cast<std::uint64_t>(state.param("size"));
+  std::string path = scratch_path(std::string("write_") +
+                                  lab::io::backend_name(backend));
+  lab::io::Options opts = options_of(state);
+  lab::io::Stats pass;
+  Totals totals;
+  std::string error;
+  for (auto _ : state) {
+    if (!lab::io::write_file(backend, path, size, opts, &pass, &error)) {
+      fail(error);
+    }
+    totals.add(pass);
+  }
+  std::error_code ignored;
+  std::filesystem::remove(path, ignored);
+  state.set_bytes_per_op(static_cast<double>(size));
+  totals.report(state);
+}
+
+const bool registered = [] {
+  for (Backend backend : lab::io::kAllBackends) {
+    std::string why;
+    if (!lab::io::backend_available(backend, &why)) {
+      std::fprintf(stderr, "io: skipping %s: %s\n",
+                   lab::io::backend_name(backend), why.c_str());
+      continue;
+    }
+    std::vector<lab::Param> params = {{"size", lab::grid("64M")},
+                                      {"block", lab::grid("64K,1M")}};
+    if (backend == Backend::uring) {
+      params.push_back({"depth", lab::grid("1,8,32")});
+    }
+    std::string name = lab::io::backend_name(backend);
+    lab::Registry::global().add(
+        "write/" + name,
+        [backend](lab::State& state) { write_pass(state, backend); }, params);
+    params.push_back({"cold", lab::grid("0,1")});
+    lab::Registry::global().add(
+        "read/" + name,
+        [backend](lab::State& state) { read_pass(state, backend); }, params);
+  }
+  return true;
+}();
+
+}  // namespace
+
+}  // namespace io_bench
@@ -0,0 +1,199 @@
+// Where memory lives relative to the CPUs that read it.
+//
+//   numa_read/node:X/memory:Y      one thread on node X streaming a buffer
+//                                  bound to node Y; X != Y is the remote
+//                                  bandwidth, marked remote=1
+//   numa_read_interleaved/node:X   the same buffer interleaved over nodes
+//   first_touch/<placement>/threads:N
+//                                  a parallel read of one buffer whose
+//                                  pages were placed by
+//       serial       the caller writing all of it (the usual mistake)
+//       parallel     Scheduler::first_touch, each part by its reader
+//       interleave   NumaPolicy::interleave
+//
+// Bandwidth follows from bytes_per_op and ns_per_op. first_touch reports
+// remote_pages, the share of pages on another node than their reader's.
+// On a single-node host every variant is local and they should agree.
+#include <sched.h>
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory_resource>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "lab/bench.hpp"
+#include "lab/numa.hpp"
+#include "lab/params.hpp"
+#include "lab/scheduler.hpp"
+#include "lab/topology.hpp"
+
+namespace numa_bench {
+
+namespace {
+
+constexpr std::size_t kBytes = std::size_t{64} << 20;
+
+[[noreturn]] void fail(const std::string& message) {
+  std::fprintf(stderr, "numa: %s\n", message.c_str());
+  std::exit(2);
+}
+
+std::string list(const std::vector<int>& ids) {
+  std::string out;
+  for (int id : ids) {
+    if (!out.empty()) out += ',';
+    out += std::to_string(id);
+  }
+  return out;
+}
+
+// Moves the calling thread onto a CPU of `node` for its lifetime. Any
+// node of the process will do: lab_bench has pinned this thread to one
+// CPU, but Topology::detect() lists those the process started with.
+class OnNode {
+ public:
+  explicit OnNode(int node) {
+    sched_getaffinity(0, sizeof(saved_), &saved_);
+    lab::Topology topo = lab::Topology::detect();
+    for (std::size_t i = 0; i < topo.node_ids.size(); ++i) {
+      if (topo.node_ids[i] == node) {
+        if (lab::pin_thread(topo.node_cpus[i].front()) >= 0) return;
+      }
+    }
+    fail("no usable CPU on node " + std::to_string(node));
+  }
+  ~OnNode() { sched_setaffinity(0, sizeof(saved_), &saved_); }
+
+  OnNode(const OnNode&) = delete;
+  OnNode& operator=(const OnNode&) = delete;
+
+ private:
+  cpu_set_t saved_;
+};
+
+// A buffer of `n` words from `resource`, freed with it.
+struct Buffer {
+  Buffer(std::pmr::memory_resource* resource, std::size_t n)
+      : resource(resource), n(n) {
+    data = static_cast<std::uint64_t*>(
+        resource->allocate(n * sizeof(std::uint64_t), alignof(std::uint64_t)));
+  }
+  ~Buffer() {
+    resource->deallocate(data, n * sizeof(std::uint64_t),
+                         alignof(std::uint64_t));
+  }
+  Buffer(const Buffer&) = delete;
+  Buffer& operator=(const Buffer&) = delete;
+
+  std::pmr::memory_resource* resource;
+  std::size_t n;
+  std::uint64_t* data;
+};
+
+// Four independent sums, so the loop is bound by memory, not latency.
+std::uint64_t sum(const std::uint64_t* data, std::size_t n) {
+  std::uint64_t s[4] = {};
+  std::size_t body = n & ~std::size_t{3};
+  for (std::size_t i = 0; i < body; i += 4) {
+    for (int k = 0; k < 4; ++k) s[k] += data[i + k];
+  }
+  for (std::size_t i = body; i < n; ++i) s[0] += data[i];
+  return s[0] + s[1] + s[2] + s[3];
+}
+
+void read_on(lab::State& state, const lab::NumaPolicy& policy) {
+  OnNode here(static_cast<int>(state.param("node")));
+  Buffer buf(lab::numa_resource(policy), kBytes / sizeof(std::uint64_t));
+  for (std::size_t i = 0; i < buf.n; ++i) buf.data[i] = i;
+  for (auto _ : state) {
+    lab::do_not_optimize(sum(buf.data, buf.n));
+  }
+  state.set_bytes_per_op(static_cast<double>(kBytes));
+}
+
+void numa_read(lab::State& state) {
+  auto memory = static_cast<int>(state.param("memory"));
+  read_on(state, lab::NumaPolicy::on_node(memory));
+  state.set_counter("remote", state.param("node") != memory ? 1 : 0);
+}
+
+void numa_read_interleaved(lab::State& state) {
+  read_on(state, lab::NumaPolicy::interleave());
+}
+
+enum class Placement { serial, parallel, interleave };
+
+// Share of sampled pages of each worker's part that are on another node.
+double remote_pages(const lab::Scheduler& pool, const Buffer& buf) {
+  lab::Topology topo = lab::Topology::detect();
+  constexpr std::size_t kStride = 4096 / sizeof(std::uint64_t) * 16;
+  std::size_t parts = pool.cpus().size();
+  std::size_t sampled = 0, remote = 0;
+  for (std::size_t i = 0; i < parts; ++i) {
+    int index = topo.node_of(pool.cpus()[i]);
+    if (index < 0) continue;
+    int node = topo.node_ids[static_cast<std::size_t>(index)];
+    for (std::size_t w = buf.n * i / parts; w < buf.n * (i + 1) / parts;
+         w += kStride) {
+      int page = lab::node_of_page(buf.data + w);
+      if (page < 0) continue;
+      ++sampled;
+      remote += page != node;
+    }
+  }
+  return sampled == 0 ? 0 : static_cast<double>(remote) /
+                                static_cast<double>(sampled);
+}
+
+void first_touch(lab::State& state, Placement placement) {
+  lab::Scheduler pool({.threads = static_cast<int>(state.param("threads"))});
+  Buffer buf(lab::numa_resource(placement == Placement::interleave
+                                    ? lab::NumaPolicy::interleave()
+                                    : lab::NumaPolicy::local()),
+             kBytes / sizeof(std::uint64_t));
+  if (placement == Placement::parallel) {
+    pool.first_touch(buf.data, buf.n, std::uint64_t{1});
+  } else {
+    for (std::size_t i = 0; i < buf.n; ++i) buf.data[i] = 1;
+  }
+  for (auto _ : state) {
+    std::atomic<std::uint64_t> total{0};
+    pool.parallel_for_static(0, buf.n, [&](std::size_t lo, std::size_t hi) {
+      total.fetch_add(sum(buf.data + lo, hi - lo), std::memory_order_relaxed);
+    });
+    lab::do_not_optimize(total.load(std::memory_order_relaxed));
+  }
+  state.set_bytes_per_op(static_cast<double>(kBytes));
+  state.set_counter("remote_pages", remote_pages(pool, buf));
+}
+
+const bool registered = [] {
+  lab::Topology topo = lab::Topology::detect();
+  std::string nodes = list(topo.node_ids);
+  std::string memory = list(lab::memory_nodes());
+  auto& registry = lab::Registry::global();
+  registry.add("numa_read", numa_read,
+               {{"node", lab::grid(nodes)}, {"memory", lab::grid(memory)}});
+  registry.add("numa_read_interleaved", numa_read_interleaved,
+               {{"node", lab::grid(nodes)}});
+  for (auto [name, placement] :
+       {std::pair{"serial", Placement::serial},
+        std::pair{"parallel", Placement::parallel},
+        std::pair{"interleave", Placement::interleave}}) {
+    registry.add(
+        std::string("first_touch/") + name,
+        [placement = placement](lab::State& state) {
+          first_touch(state, placement);
+        },
+        {{"threads", lab::grid("1.." + std::to_string(topo.cpu_count()))}});
+  }
+  return true;
+}();
+
+}  // namespace
+
+}  // namespace numa_bench
@@ -0,0 +1,38 @@
+// Scaling of a reduction on lab::Scheduler across thread counts and input
+// sizes. Small sizes show fork/join overhead, and sizes past the LLC show
+// where the sum becomes bound by DRAM bandwidth.
+#include <cstdint>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include "lab/bench.hpp"
+#include "lab/params.hpp"
+#include "lab/scheduler.hpp"
+#include "lab/topology.hpp"
+
+namespace {
+
+void parallel_sum(lab::State& state) {
+  auto threads = static_cast<int>(state.param("threads"));
+  auto bytes = static_cast<std::size_t>(state.param("size"));
+  std::vector<float> data(bytes / sizeof(float), 1.0f);
+  lab::Scheduler pool({.threads = threads});
+  for (auto _ : state) {
+    float sum = pool.parallel_reduce(
+        0, data.size(), 0.0f,
+        [&](std::size_t lo, std::size_t hi) {
+          return std::accumulate(data.begin() + lo, data.begin() + hi, 0.0f);
+        },
+        [](float a, float b) { return a + b; });
+    lab::do_not_optimize(sum);
+  }
+  state.set_bytes_per_op(static_cast<double>(bytes));
+}
+LAB_BENCH_PARAMS(parallel_sum,
+                 {"threads",
+                  lab::grid("1.." +
+                            std::to_string(lab::Topology::detect().cpu_count()))},
+                 {"size", lab::grid("64M")});
+
+}  // namespace
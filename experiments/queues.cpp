@@ -0,0 +1,127 @@
+// Producer/consumer throughput of the lab queues against a mutex-guarded
+// std::deque, and SPSC round-trip latency. In the throughput benchmarks
+// one op is one item moved from a producer thread to the benchmark thread.
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "lab/bench.hpp"
+#include "lab/cpu.hpp"
+#include "lab/mpmc_queue.hpp"
+#include "lab/mpsc_queue.hpp"
+#include "lab/params.hpp"
+#include "lab/spsc_queue.hpp"
+
+namespace {
+
+constexpr std::size_t kCapacity = 4096;
+
+class MutexQueue {
+ public:
+  bool try_push(std::uint64_t v) {
+    std::lock_guard<std::mutex> lock(mu_);
+    items_.push_back(v);
+    return true;
+  }
+  bool try_pop(std::uint64_t& v) {
+    std::lock_guard<std::mutex> lock(mu_);
+    if (items_.empty()) return false;
+    v = items_.front();
+    items_.pop_front();
+    return true;
+  }
+
+ private:
+  std::mutex mu_;
+  std::deque<std::uint64_t> items_;
+};
+
+// Spins with a pause hint, yielding now and then so that runs on an
+// oversubscribed machine still make progress.
+template <class F>
+void spin_until(F&& done) {
+  for (unsigned n = 1; !done(); ++n) {
+    if (n % 1024 == 0) {
+      std::this_thread::yield();
+    } else {
+      lab::cpu_relax();
+    }
+  }
+}
+
+template <class Q>
+void push(Q& q, std::uint64_t v) {
+  if constexpr (requires { q.push(v); }) {
+    q.push(v);
+  } else {
+    spin_until([&] { return q.try_push(v); });
+  }
+}
+
+template <class Q>
+void transfer(lab::State& state, Q& q, int producers) {
+  std::uint64_t total = state.iterations();
+  std::vector<std::thread> threads;
+  for (int p = 0; p < producers; ++p) {
+    std::uint64_t n = total / producers + (p == 0 ? total % producers : 0);
+    threads.emplace_back([&q, n] {
+      for (std::uint64_t i = 0; i < n; ++i) push(q, i);
+    });
+  }
+  std::uint64_t sum = 0;
+  for (auto _ : state) {
+    std::uint64_t v;
+    spin_until([&] { return q.try_pop(v); });
+    sum += v;
+  }
+  for (auto& t : threads) t.join();
+  lab::do_not_optimize(sum);
+}
+
+void spsc_throughput(lab::State& state) {
+  lab::SpscQueue<std::uint64_t> q(kCapacity);
+  transfer(state, q, 1);
+}
+LAB_BENCH(spsc_throughput);
+
+void mpmc_throughput(lab::State& state) {
+  lab::MpmcQueue<std::uint64_t> q(kCapacity);
+  transfer(state, q, static_cast<int>(state.param("producers")));
+}
+LAB_BENCH_PARAMS(mpmc_throughput, {"producers", lab::grid("1..4")});
+
+void mpsc_throughput(lab::State& state) {
+  lab::MpscQueue<std::uint64_t> q;
+  transfer(state, q, static_cast<int>(state.param("producers")));
+}
+LAB_BENCH_PARAMS(mpsc_throughput, {"producers", lab::grid("1..4")});
+
+void mutex_throughput(lab::State& state) {
+  MutexQueue q;
+  transfer(state, q, static_cast<int>(state.param("producers")));
+}
+LAB_BENCH_PARAMS(mutex_throughput, {"producers", lab::grid("1..4")});
+
+// One op is a full round trip: ping to an echo thread and back.
+void spsc_round_trip(lab::State& state) {
+  lab::SpscQueue<std::uint64_t> ping(kCapacity), pong(kCapacity);
+  std::uint64_t n = state.iterations();
+  std::thread echo([&] {
+    for (std::uint64_t i = 0; i < n; ++i) {
+      std::uint64_t v;
+      spin_until([&] { return ping.try_pop(v); });
+      spin_until([&] { return pong.try_push(v); });
+    }
+  });
+  for (auto _ : state) {
+    std::uint64_t v = 0;
+    spin_until([&] { return ping.try_push(v); });
+    spin_until([&] { return pong.try_pop(v); });
+  }
+  echo.join();
+}
+LAB_BENCH(spsc_round_trip);
+
+}  // namespace
@@ -0,0 +1,74 @@
+// Why compile-time parameters matter: the same reduction over `size`
+// elements with the unroll factor (independent accumulators) and element
+// type fixed at compile time, e.g. "reduce<float,8>/size:4096", against
+// the unroll factor read at run time, "reduce_runtime<float>/unroll:8/...".
+// Only the former lets the compiler keep the accumulators in registers and
+// vectorize across them.
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "lab/bench.hpp"
+#include "lab/params.hpp"
+
+namespace {
+
+// Built once per type and size, then kept across runs and reloads.
+template <class T>
+std::span<const T> make_data(lab::State& state, std::size_t n) {
+  return state.resident<T>(
+      "reduce/" + std::string(lab::type_name<T>()) + "/" + std::to_string(n),
+      n, [](std::span<T> data) {
+        for (std::size_t i = 0; i < data.size(); ++i) {
+          data[i] = static_cast<T>(i % 7);
+        }
+      });
+}
+
+template <class T, int kUnroll>
+void reduce(lab::State& state) {
+  auto n = static_cast<std::size_t>(state.param("size"));
+  std::span<const T> data = make_data<T>(state, n);
+  for (auto _ : state) {
+    T acc[kUnroll] = {};
+    std::size_t i = 0;
+    for (; i + kUnroll <= n; i += kUnroll) {
+      for (int u = 0; u < kUnroll; ++u) acc[u] += data[i + u];
+    }
+    for (; i < n; ++i) acc[0] += data[i];
+    T total = 0;
+    for (int u = 0; u < kUnroll; ++u) total += acc[u];
+    lab::do_not_optimize(std::as_const(total));
+  }
+  state.set_bytes_per_op(static_cast<double>(n * sizeof(T)));
+}
+LAB_BENCH_TEMPLATE(reduce, (float, double, std::int32_t), (1, 4, 8, 16),
+                   {"size", lab::grid("4K,1M")});
+
+template <class T>
+void reduce_runtime(lab::State& state) {
+  auto n = static_cast<std::size_t>(state.param("size"));
+  auto unroll = static_cast<std::size_t>(state.param("unroll"));
+  std::span<const T> data = make_data<T>(state, n);
+  std::vector<T> acc(unroll);
+  for (auto _ : state) {
+    std::fill(acc.begin(), acc.end(), T{0});
+    std::size_t i = 0;
+    for (; i + unroll <= n; i += unroll) {
+      for (std::size_t u = 0; u < unroll; ++u) acc[u] += data[i + u];
+    }
+    for (; i < n; ++i) acc[0] += data[i];
+    T total = 0;
+    for (std::size_t u = 0; u < unroll; ++u) total += acc[u];
+    lab::do_not_optimize(std::as_const(total));
+  }
+  state.set_bytes_per_op(static_cast<double>(n * sizeof(T)));
+}
+LAB_BENCH_TYPES(reduce_runtime, (float, double, std::int32_t),
+                {"unroll", lab::grid("1,4,8,16")},
+                {"size", lab::grid("4K,1M")});
+
+}  // namespace
@@ -0,0 +1,140 @@
+// Lower-bound lookups over N sorted 64-bit keys in each layout of
+// lab/search.hpp, as "search/<layout>/<keys>/n:N":
+//
+//   std_lower_bound   std::lower_bound, branchy bisection
+//   branchless        lab::search::lower_bound on the same array
+//   eytzinger         lab::search::Eytzinger, BFS order with prefetch
+//   btree             lab::search::BTree, one cache line per node
+//
+// Keys are the first N of the uniform and zipf datasets that sort.cpp
+// sorts, sorted once before timing (zipf keeps its duplicates). One op
+// is one lookup of a key drawn from the first 2N, so about half of them
+// hit on uniform keys. Lookups are independent, so this is throughput:
+// they overlap until the layout's misses fill the load buffers.
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "lab/bench.hpp"
+#include "lab/dataset.hpp"
+#include "lab/params.hpp"
+#include "lab/search.hpp"
+
+namespace search_bench {
+
+namespace {
+
+constexpr std::size_t kDatasetKeys = std::size_t{4} << 20;
+constexpr std::size_t kProbes = std::size_t{1} << 16;
+
+struct SearchKeys {
+  const char* name;
+  const char* generator;  // of its dataset key, shared with sort.cpp
+  std::uint64_t seed;
+  lab::dataset::Fill fill;
+};
+
+const std::vector<SearchKeys>& search_key_sets() {
+  static const std::vector<SearchKeys> all = {
+      {"uniform", "uniform", 1, lab::dataset::uniform},
+      {"zipf", "zipf-1M-0.99", 42, lab::dataset::zipf(1 << 20, 0.99)},
+  };
+  return all;
+}
+
+std::span<const std::uint64_t> search_input(const SearchKeys& set) {
+  static std::map<const SearchKeys*, lab::dataset::Dataset> open;
+  auto it = open.find(&set);
+  if (it == open.end()) {
+    lab::dataset::Dataset d;
+    std::string error;
+    if (!lab::dataset::open({set.generator, set.seed, kDatasetKeys * 8},
+                            set.fill, d, {.populate = true}, &error)) {
+      std::fprintf(stderr, "search: %s\n", error.c_str());
+      std::exit(2);
+    }
+    it = open.emplace(&set, std::move(d)).first;
+  }
+  return it->second.as<std::uint64_t>();
+}
+
+enum class Layout { std_lower_bound, branchless, eytzinger, btree };
+
+template <class Find>
+void probe(lab::State& state, const std::vector<std::uint64_t>& probes,
+           Find find) {
+  std::size_t i = 0;
+  for (auto _ : state) {
+    lab::do_not_optimize(find(probes[i]));
+    i = (i + 1) & (kProbes - 1);
+  }
+}
+
+void run_search(lab::State& state, Layout layout, const SearchKeys& set) {
+  auto n = static_cast<std::size_t>(state.param("n"));
+  auto input = search_input(set);
+  std::vector<std::uint64_t> keys(input.begin(), input.begin() + n);
+  std::sort(keys.begin(), keys.end());
+  std::vector<std::uint64_t> probes(kProbes);
+  std::uint64_t rng = 0x9e3779b97f4a7c15ull;
+  std::size_t range = std::min(2 * n, input.size());
+  for (auto& p : probes) {
+    rng = rng * 6364136223846793005ull + 1442695040888963407ull;
+    p = input[(rng >> 32) % range];
+  }
+
+  switch (layout) {
+    case Layout::std_lower_bound:
+      probe(state, probes, [&](std::uint64_t key) {
+        return std::lower_bound(keys.begin(), keys.end(), key);
+      });
+      break;
+    case Layout::branchless:
+      probe(state, probes, [&](std::uint64_t key) {
+        return lab::search::lower_bound(keys.data(), n, key);
+      });
+      break;
+    case Layout::eytzinger: {
+      lab::search::Eytzinger<std::uint64_t> tree(keys);
+      probe(state, probes,
+            [&](std::uint64_t key) { return tree.lower_bound(key); });
+      break;
+    }
+    case Layout::btree: {
+      lab::search::BTree<std::uint64_t> tree(keys);
+      probe(state, probes,
+            [&](std::uint64_t key) { return tree.lower_bound(key); });
+      break;
+    }
+  }
+}
+
+const bool registered = [] {
+  const std::pair<const char*, Layout> layouts[] = {
+      {"std_lower_bound", Layout::std_lower_bound},
+      {"branchless", Layout::branchless},
+      {"eytzinger", Layout::eytzinger},
+      {"btree", Layout::btree},
+  };
+  for (const auto& [name, layout] : layouts) {
+    for (const SearchKeys& set : search_key_sets()) {
+      lab::Registry::global().add(
+          std::string("search/") + name + "/" + set.name,
+          [layout = layout, &set](lab::State& state) {
+            run_search(state, layout, set);
+          },
+          {{"n", lab::grid("1K..4M:x16")}});
+    }
+  }
+  return true;
+}();
+
+}  // namespace
+
+}  // namespace search_bench
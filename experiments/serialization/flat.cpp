@@ -0,0 +1,159 @@
+// lab::flat: encoding copies each field once into one buffer; scanning
+// reads the fields in place without decoding or allocating.
+#include "lab/flat.hpp"
+#include "schema.hpp"
+
+namespace serialization {
+
+namespace flat_codec {
+
+namespace {
+
+namespace wire {
+
+using lab::flat::String;
+using lab::flat::Vector;
+
+struct Item {
+  std::uint64_t sku;
+  double unit_price;
+  std::uint32_t quantity;
+  String name;
+};
+
+struct Address {
+  String street;
+  String city;
+  String postcode;
+  String country;
+};
+
+struct Order {
+  std::uint64_t id;
+  std::int64_t created_us;
+  String customer;
+  String email;
+  Address shipping;
+  Vector<String> tags;
+  Vector<Item> items;
+  std::uint32_t status;
+  std::uint8_t gift;
+};
+
+struct Batch {
+  Vector<Order> orders;
+};
+
+}  // namespace wire
+
+std::string_view encode(const std::vector<Order>& orders, std::string&) {
+  thread_local lab::flat::Builder b;
+  b.clear();
+  auto batch = b.add<wire::Batch>();
+  auto first = b.set(b.field(batch, &wire::Batch::orders), orders.size());
+  for (std::size_t i = 0; i < orders.size(); ++i) {
+    const Order& o = orders[i];
+    auto at = b.element(first, i);
+    wire::Order& w = b[at];
+    w.id = o.id;
+    w.created_us = o.created_us;
+    w.status = o.status;
+    w.gift = o.gift;
+    b.set(b.field(at, &wire::Order::customer), o.customer);
+    b.set(b.field(at, &wire::Order::email), o.email);
+    auto shipping = b.field(at, &wire::Order::shipping);
+    b.set(b.field(shipping, &wire::Address::street), o.shipping.street);
+    b.set(b.field(shipping, &wire::Address::city), o.shipping.city);
+    b.set(b.field(shipping, &wire::Address::postcode), o.shipping.postcode);
+    b.set(b.field(shipping, &wire::Address::country), o.shipping.country);
+    auto tags = b.set(b.field(at, &wire::Order::tags), o.tags.size());
+    for (std::size_t t = 0; t < o.tags.size(); ++t) {
+      b.set(b.element(tags, t), o.tags[t]);
+    }
+    auto items = b.set(b.field(at, &wire::Order::items), o.items.size());
+    for (std::size_t k = 0; k < o.items.size(); ++k) {
+      auto item = b.element(items, k);
+      b[item].sku = o.items[k].sku;
+      b[item].unit_price = o.items[k].unit_price;
+      b[item].quantity = o.items[k].quantity;
+      b.set(b.field(item, &wire::Item::name), o.items[k].name);
+    }
+  }
+  return b.finish(batch);
+}
+
+const wire::Batch* root(std::string_view bytes) {
+  return lab::flat::root<wire::Batch>(bytes.data(), bytes.size());
+}
+
+bool decode(std::string_view bytes, std::vector<Order>& orders) {
+  const wire::Batch* batch = root(bytes);
+  if (batch == nullptr) return false;
+  orders.resize(batch->orders.size());
+  for (std::size_t i = 0; i < orders.size(); ++i) {
+    const wire::Order& w = batch->orders[i];
+    Order& o = orders[i];
+    o.id = w.id;
+    o.created_us = w.created_us;
+    o.customer = w.customer.view();
+    o.email = w.email.view();
+    o.shipping.street = w.shipping.street.view();
+    o.shipping.city = w.shipping.city.view();
+    o.shipping.postcode = w.shipping.postcode.view();
+    o.shipping.country = w.shipping.country.view();
+    o.tags.resize(w.tags.size());
+    for (std::size_t t = 0; t < w.tags.size(); ++t) {
+      o.tags[t] = w.tags[t].view();
+    }
+    o.items.resize(w.items.size());
+    for (std::size_t k = 0; k < w.items.size(); ++k) {
+      o.items[k].sku = w.items[k].sku;
+      o.items[k].quantity = w.items[k].quantity;
+      o.items[k].unit_price = w.items[k].unit_price;
+      o.items[k].name = w.items[k].name.view();
+    }
+    o.status = w.status;
+    o.gift = w.gift != 0;
+  }
+  return true;
+}
+
+std::uint64_t scan(std::string_view bytes) {
+  const wire::Batch* batch = root(bytes);
+  if (batch == nullptr) return 0;
+  Digest d;
+  for (const wire::Order& o : batch->orders) {
+    d.add(o.id);
+    d.add(static_cast<std::uint64_t>(o.created_us));
+    d.add(o.customer.view());
+    d.add(o.email.view());
+    d.add(o.shipping.street.view());
+    d.add(o.shipping.city.view());
+    d.add(o.shipping.postcode.view());
+    d.add(o.shipping.country.view());
+    d.add(std::uint64_t{o.tags.size()});
+    for (const auto& tag : o.tags) d.add(tag.view());
+    d.add(std::uint64_t{o.items.size()});
+    for (const wire::Item& item : o.items) {
+      d.add(item.sku);
+      d.add(std::uint64_t{item.quantity});
+      d.add(item.unit_price);
+      d.add(item.name.view());
+    }
+    d.add(std::uint64_t{o.status});
+    d.add(std::uint64_t{o.gift != 0});
+  }
+  return d.value();
+}
+
+}  // namespace
+
+}  // namespace flat_codec
+
+const Format& flat_format() {
+  static const Format format{"flat", flat_codec::encode, flat_codec::decode,
+                             flat_codec::scan};
+  return format;
+}
+
+}  // namespace serialization
@@ -0,0 +1,177 @@
+// JSON through lab::json: a schema-directed pull parser, so decoding
+// allocates only for the strings it keeps, and unknown keys are skipped.
+#include "lab/json.hpp"
+#include "schema.hpp"
+
+namespace serialization {
+
+namespace json_codec {
+
+namespace {
+
+std::string_view encode(const std::vector<Order>& orders, std::string& out) {
+  out.clear();
+  lab::json::Writer w(out);
+  w.begin_object();
+  w.key("orders");
+  w.begin_array();
+  for (const Order& o : orders) {
+    w.begin_object();
+    w.key("id");
+    w.value(o.id);
+    w.key("created_us");
+    w.value(o.created_us);
+    w.key("customer");
+    w.value(o.customer);
+    w.key("email");
+    w.value(o.email);
+    w.key("shipping");
+    w.begin_object();
+    w.key("street");
+    w.value(o.shipping.street);
+    w.key("city");
+    w.value(o.shipping.city);
+    w.key("postcode");
+    w.value(o.shipping.postcode);
+    w.key("country");
+    w.value(o.shipping.country);
+    w.end_object();
+    w.key("tags");
+    w.begin_array();
+    for (const auto& tag : o.tags) w.value(tag);
+    w.end_array();
+    w.key("items");
+    w.begin_array();
+    for (const Item& item : o.items) {
+      w.begin_object();
+      w.key("sku");
+      w.value(item.sku);
+      w.key("quantity");
+      w.value(item.quantity);
+      w.key("unit_price");
+      w.value(item.unit_price);
+      w.key("name");
+      w.value(item.name);
+      w.end_object();
+    }
+    w.end_array();
+    w.key("status");
+    w.value(o.status);
+    w.key("gift");
+    w.value(o.gift);
+    w.end_object();
+  }
+  w.end_array();
+  w.end_object();
+  return out;
+}
+
+bool read_address(lab::json::Reader& r, Address& a) {
+  if (!r.begin_object()) return false;
+  for (std::string_view key; r.next_key(key);) {
+    if (key == "street") {
+      r.read(a.street);
+    } else if (key == "city") {
+      r.read(a.city);
+    } else if (key == "postcode") {
+      r.read(a.postcode);
+    } else if (key == "country") {
+      r.read(a.country);
+    } else {
+      r.skip();
+    }
+  }
+  return r.ok();
+}
+
+bool read_item(lab::json::Reader& r, Item& item) {
+  if (!r.begin_object()) return false;
+  for (std::string_view key; r.next_key(key);) {
+    if (key == "sku") {
+      r.read(item.sku);
+    } else if (key == "quantity") {
+      r.read(item.quantity);
+    } else if (key == "unit_price") {
+      r.read(item.unit_price);
+    } else if (key == "name") {
+      r.read(item.name);
+    } else {
+      r.skip();
+    }
+  }
+  return r.ok();
+}
+
+bool read_order(lab::json::Reader& r, Order& o) {
+  if (!r.begin_object()) return false;
+  std::size_t tags = 0, items = 0;
+  for (std::string_view key; r.next_key(key);) {
+    if (key == "id") {
+      r.read(o.id);
+    } else if (key == "created_us") {
+      r.read(o.created_us);
+    } else if (key == "customer") {
+      r.read(o.customer);
+    } else if (key == "email") {
+      r.read(o.email);
+    } else if (key == "shipping") {
+      read_address(r, o.shipping);
+    } else if (key == "tags") {
+      // Element-wise assignment reuses the strings of a recycled order.
+      for (r.begin_array(); r.next_element(); ++tags) {
+        if (tags == o.tags.size()) o.tags.emplace_back();
+        r.read(o.tags[tags]);
+      }
+    } else if (key == "items") {
+      for (r.begin_array(); r.next_element(); ++items) {
+        if (items == o.items.size()) o.items.emplace_back();
+        if (!read_item(r, o.items[items])) break;
+      }
+    } else if (key == "status") {
+      r.read(o.status);
+    } else if (key == "gift") {
+      r.read(o.gift);
+    } else {
+      r.skip();
+    }
+  }
+  o.tags.resize(tags);
+  o.items.resize(items);
+  return r.ok();
+}
+
+bool decode(std::string_view bytes, std::vector<Order>& orders) {
+  lab::json::Reader r(bytes);
+  std::size_t n = 0;
+  if (!r.begin_object()) return false;
+  for (std::string_view key; r.next_key(key);) {
+    if (key != "orders") {
+      r.skip();
+      continue;
+    }
+    for (r.begin_array(); r.next_element(); ++n) {
+      if (n == orders.size()) orders.emplace_back();
+      if (!read_order(r, orders[n])) return false;
+    }
+  }
+  orders.resize(n);
+  return r.ok() && r.at_end();
+}
+
+// Text formats have to be parsed before anything can be read.
+std::uint64_t scan(std::string_view bytes) {
+  thread_local std::vector<Order> orders;
+  return decode(bytes, orders) ? digest(orders) : 0;
+}
+
+}  // namespace
+
+}  // namespace json_codec
+
+const Format& json_format() {
+  static const Format format{"json", json_codec::encode, json_codec::decode,
+                             json_codec::scan};
+  return format;
+}
+
+}  // namespace serialization
@@ -0,0 +1,148 @@
+// protobuf, when CMake found it (LAB_HAVE_PROTOBUF). Messages are reused
+// across calls, as a server would, so steady-state parsing reuses their
+// strings and repeated fields.
+#include "schema.hpp"
+
+#ifdef LAB_HAVE_PROTOBUF
+
+#include "orders.pb.h"
+
+namespace serialization {
+
+namespace protobuf_codec {
+
+namespace {
+
+void to_message(const Order& o, pb::Order& m) {
+  m.set_id(o.id);
+  m.set_created_us(o.created_us);
+  m.set_customer(o.customer);
+  m.set_email(o.email);
+  pb::Address* a = m.mutable_shipping();
+  a->set_street(o.shipping.street);
+  a->set_city(o.shipping.city);
+  a->set_postcode(o.shipping.postcode);
+  a->set_country(o.shipping.country);
+  m.clear_tags();
+  for (const auto& tag : o.tags) m.add_tags(tag);
+  m.clear_items();
+  for (const Item& item : o.items) {
+    pb::Item* i = m.add_items();
+    i->set_sku(item.sku);
+    i->set_quantity(item.quantity);
+    i->set_unit_price(item.unit_price);
+    i->set_name(item.name);
+  }
+  m.set_status(o.status);
+  m.set_gift(o.gift);
+}
+
+void from_message(const pb::Order& m, Order& o) {
+  o.id = m.id();
+  o.created_us = m.created_us();
+  o.customer = m.customer();
+  o.email = m.email();
+  o.shipping.street = m.shipping().street();
+  o.shipping.city = m.shipping().city();
+  o.shipping.postcode = m.shipping().postcode();
+  o.shipping.country = m.shipping().country();
+  o.tags.resize(static_cast<std::size_t>(m.tags_size()));
+  for (int t = 0; t < m.tags_size(); ++t) {
+    o.tags[static_cast<std::size_t>(t)] = m.tags(t);
+  }
+  o.items.resize(static_cast<std::size_t>(m.items_size()));
+  for (int k = 0; k < m.items_size(); ++k) {
+    const pb::Item& i = m.items(k);
+    Item& item = o.items[static_cast<std::size_t>(k)];
+    item.sku = i.sku();
+    item.quantity = i.quantity();
+    item.unit_price = i.unit_price();
+    item.name = i.name();
+  }
+  o.status = m.status();
+  o.gift = m.gift();
+}
+
+pb::Batch& message() {
+  thread_local pb::Batch batch;
+  return batch;
+}
+
+std::string_view encode(const std::vector<Order>& orders, std::string& out) {
+  pb::Batch& batch = message();
+  // Keeps existing messages and trims the rest, so their memory is reused.
+  while (batch.orders_size() > static_cast<int>(orders.size())) {
+    batch.mutable_orders()->RemoveLast();
+  }
+  for (std::size_t i = 0; i < orders.size(); ++i) {
+    auto n = static_cast<int>(i);
+    to_message(orders[i], n < batch.orders_size() ? *batch.mutable_orders(n)
+                                                  : *batch.add_orders());
+  }
+  batch.SerializeToString(&out);
+  return out;
+}
+
+bool parse(std::string_view bytes, pb::Batch& batch) {
+  return batch.ParseFromArray(bytes.data(), static_cast<int>(bytes.size()));
+}
+
+bool decode(std::string_view bytes, std::vector<Order>& orders) {
+  pb::Batch& batch = message();
+  if (!parse(bytes, batch)) return false;
+  orders.resize(static_cast<std::size_t>(batch.orders_size()));
+  for (int i = 0; i < batch.orders_size(); ++i) {
+    from_message(batch.orders(i), orders[static_cast<std::size_t>(i)]);
+  }
+  return true;
+}
+
+std::uint64_t scan(std::string_view bytes) {
+  pb::Batch& batch = message();
+  if (!parse(bytes, batch)) return 0;
+  Digest d;
+  for (const pb::Order& o : batch.orders()) {
+    d.add(o.id());
+    d.add(static_cast<std::uint64_t>(o.created_us()));
+    d.add(o.customer());
+    d.add(o.email());
+    d.add(o.shipping().street());
+    d.add(o.shipping().city());
+    d.add(o.shipping().postcode());
+    d.add(o.shipping().country());
+    d.add(static_cast<std::uint64_t>(o.tags_size()));
+    for (const auto& tag : o.tags()) d.add(tag);
+    d.add(static_cast<std::uint64_t>(o.items_size()));
+    for (const pb::Item& item : o.items()) {
+      d.add(item.sku());
+      d.add(std::uint64_t{item.quantity()});
+      d.add(item.unit_price());
+      d.add(item.name());
+    }
+    d.add(std::uint64_t{o.status()});
+    d.add(std::uint64_t{o.gift()});
+  }
+  return d.value();
+}
+
+}  // namespace
+
+}  // namespace protobuf_codec
+
+const Format* protobuf_format() {
+  static const Format format{"protobuf", protobuf_codec::encode,
+                             protobuf_codec::decode, protobuf_codec::scan};
+  return &format;
+}
+
+}  // namespace serialization
+
+#else
+
+namespace serialization {
+
+const Format* protobuf_format() { return nullptr; }
+
+}  // namespace serialization
+
+#endif
@@ -0,0 +1,89 @@
+#include "schema.hpp"
+
+#include <random>
+
+namespace serialization {
+
+namespace {
+
+const char* const kWords[] = {
+    "alpine", "basalt", "cedar",  "delta",  "ember",   "fjord",  "granite",
+    "harbor", "indigo", "juniper", "kestrel", "lagoon", "meadow", "nimbus",
+    "orchid", "prairie", "quartz", "ravine", "sierra", "tundra", "umber",
+    "valley", "willow", "yarrow", "zephyr"};
+const char* const kCountries[] = {"DE", "FR", "US", "JP", "BR", "IN", "SE"};
+const char* const kTags[] = {"priority", "fragile", "gift-wrap", "b2b",
+                             "returning", "promo", "express"};
+
+template <class T, std::size_t N>
+const T& pick(std::mt19937_64& rng, const T (&options)[N]) {
+  return options[rng() % N];
+}
+
+std::string words(std::mt19937_64& rng, int n, char sep = ' ') {
+  std::string out;
+  for (int i = 0; i < n; ++i) {
+    if (i != 0) out += sep;
+    out += pick(rng, kWords);
+  }
+  return out;
+}
+
+}  // namespace
+
+std::vector<Order> generate(std::size_t n, std::uint64_t seed) {
+  std::mt19937_64 rng(seed);
+  std::vector<Order> orders(n);
+  std::int64_t now_us = 1700000000000000;
+  for (std::size_t i = 0; i < n; ++i) {
+    Order& o = orders[i];
+    o.id = 1000000 + i;
+    o.created_us = now_us + static_cast<std::int64_t>(rng() % 86400000000);
+    o.customer = words(rng, 2);
+    o.email = words(rng, 2, '.') + "@example.com";
+    o.shipping.street = std::to_string(rng() % 400 + 1) + " " +
+                        words(rng, 2) + " street";
+    o.shipping.city = words(rng, 1);
+    o.shipping.postcode = std::to_string(10000 + rng() % 90000);
+    o.shipping.country = pick(rng, kCountries);
+    for (auto t = rng() % 4; t > 0; --t) o.tags.push_back(pick(rng, kTags));
+    o.items.resize(1 + rng() % 6);
+    for (Item& item : o.items) {
+      item.sku = rng() % 10000000;
+      item.quantity = static_cast<std::uint32_t>(1 + rng() % 5);
+      item.unit_price = static_cast<double>(rng() % 100000) / 100;
+      item.name = words(rng, 1 + static_cast<int>(rng() % 3));
+    }
+    o.status = static_cast<std::uint32_t>(rng() % 5);
+    o.gift = rng() % 10 == 0;
+  }
+  return orders;
+}
+
+std::uint64_t digest(const std::vector<Order>& orders) {
+  Digest d;
+  for (const Order& o : orders) {
+    d.add(o.id);
+    d.add(static_cast<std::uint64_t>(o.created_us));
+    d.add(o.customer);
+    d.add(o.email);
+    d.add(o.shipping.street);
+    d.add(o.shipping.city);
+    d.add(o.shipping.postcode);
+    d.add(o.shipping.country);
+    d.add(std::uint64_t{o.tags.size()});
+    for (const auto& tag : o.tags) d.add(tag);
+    d.add(std::uint64_t{o.items.size()});
+    for (const Item& item : o.items) {
+      d.add(item.sku);
+      d.add(std::uint64_t{item.quantity});
+      d.add(item.unit_price);
+      d.add(item.name);
+    }
+    d.add(std::uint64_t{o.status});
+    d.add(std::uint64_t{o.gift});
+  }
+  return d.value();
+}
+
+}  // namespace serialization
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// The records every format encodes: a batch of web-shop orders with
+// nested addresses, string lists and line items of realistic sizes.
+namespace serialization {
+
+struct Item {
+  std::uint64_t sku = 0;
+  std::uint32_t quantity = 0;
+  double unit_price = 0;
+  std::string name;
+
+  bool operator==(const Item&) const = default;
+};
+
+struct Address {
+  std::string street;
+  std::string city;
+  std::string postcode;
+  std::string country;
+
+  bool operator==(const Address&) const = default;
+};
+
+struct Order {
+  std::uint64_t id = 0;
+  std::int64_t created_us = 0;
+  std::string customer;
+  std::string email;
+  Address shipping;
+  std::vector<std::string> tags;
+  std::vector<Item> items;
+  std::uint32_t status = 0;
+  bool gift = false;
+
+  bool operator==(const Order&) const = default;
+};
+
+// `n` orders, the same for the same seed.
+std::vector<Order> generate(std::size_t n, std::uint64_t seed = 42);
+
+// Order-sensitive digest of every field, so that scans of different
+// formats can be checked against each other.
+class Digest {
+ public:
+  void add(std::uint64_t v) { h_ = (h_ ^ v) * 0x100000001b3; }
+  void add(double v) { add(std::bit_cast<std::uint64_t>(v)); }
+  // Length and end bytes: enough to touch the string without hashing it.
+  void add(std::string_view s) {
+    add(std::uint64_t{s.size()});
+    if (!s.empty()) {
+      add(std::uint64_t{static_cast<unsigned char>(s.front())} << 8 |
+          static_cast<unsigned char>(s.back()));
+    }
+  }
+  std::uint64_t value() const { return h_; }
+
+ private:
+  std::uint64_t h_ = 0xcbf29ce484222325;
+};
+
+std::uint64_t digest(const std::vector<Order>& orders);
+
+// One wire format. Buffers passed in are reused across calls.
+struct Format {
+  const char* name;
+  // Returns the encoded batch, in `buffer` or in the codec's own buffer,
+  // valid until the next call on the same thread.
+  std::string_view (*encode)(const std::vector<Order>& orders,
+                             std::string& buffer);
+  // Replaces `orders` with the decoded batch; false on malformed input.
+  bool (*decode)(std::string_view bytes, std::vector<Order>& orders);
+  // Digest of the batch read with as little work as the format allows.
+  std::uint64_t (*scan)(std::string_view bytes);
+};
+
+const Format& json_format();
+const Format& flat_format();
+// nullptr unless built with protobuf.
+const Format* protobuf_format();
+
+}  // namespace serialization
@@ -0,0 +1,118 @@
+// One batch of nested records (schema.hpp) through each wire format:
+//
+//   serialize/<format>/encode/records:N  native structs to bytes
+//   serialize/<format>/decode/records:N  bytes back to native structs
+//   serialize/<format>/scan/records:N    read every field from the bytes
+//
+// Formats are json (lab::json), flat (lab::flat, read in place) and, when
+// installed, protobuf. Counters: mb_per_s of encoded bytes, and
+// bytes_per_record; lab_bench adds allocs_per_op. Each format is checked
+// to round-trip the batch before it is timed.
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <utility>
+
+#include "lab/bench.hpp"
+#include "lab/params.hpp"
+#include "schema.hpp"
+
+namespace serialization {
+
+namespace {
+
+[[noreturn]] void fail(const Format& f, const char* what) {
+  std::fprintf(stderr, "serialize/%s: %s\n", f.name, what);
+  std::exit(2);
+}
+
+// The batch of `n` records, generated once per size and checked once per
+// format.
+const std::vector<Order>& batch(const Format& f, std::size_t n) {
+  static std::mutex mu;
+  static std::map<std::size_t, std::vector<Order>> batches;
+  static std::set<std::pair<const Format*, std::size_t>> checked;
+  std::lock_guard lock(mu);
+  auto it = batches.find(n);
+  if (it == batches.end()) it = batches.emplace(n, generate(n)).first;
+  const std::vector<Order>& orders = it->second;
+  if (checked.insert({&f, n}).second) {
+    std::string buffer;
+    std::string bytes(f.encode(orders, buffer));
+    std::vector<Order> back;
+    if (!f.decode(bytes, back) || back != orders) {
+      fail(f, "decode does not reproduce the batch");
+    }
+    if (f.scan(bytes) != digest(orders)) fail(f, "scan digest mismatch");
+  }
+  return orders;
+}
+
+void report(lab::State& state, std::size_t bytes, std::size_t records) {
+  auto total = static_cast<double>(bytes) *
+               static_cast<double>(state.iterations());
+  auto ns = static_cast<double>(state.elapsed().count());
+  state.set_bytes_per_op(static_cast<double>(bytes));
+  state.set_counter("mb_per_s", ns > 0 ? total / ns * 1e3 : 0);
+  state.set_counter("bytes_per_record", static_cast<double>(bytes) /
+                                            static_cast<double>(records));
+}
+
+std::size_t records_of(lab::State& state) {
+  return static_cast<std::size_t>(state.param("records"));
+}
+
+void encode(lab::State& state, const Format& f) {
+  const std::vector<Order>& orders = batch(f, records_of(state));
+  std::string buffer;
+  std::string_view bytes;
+  for (auto _ : state) {
+    bytes = f.encode(orders, buffer);
+    lab::do_not_optimize(bytes.data());
+  }
+  report(state, bytes.size(), orders.size());
+}
+
+void decode(lab::State& state, const Format& f) {
+  const std::vector<Order>& orders = batch(f, records_of(state));
+  std::string buffer;
+  std::string bytes(f.encode(orders, buffer));
+  std::vector<Order> out;
+  for (auto _ : state) {
+    bool ok = f.decode(bytes, out);
+    lab::do_not_optimize(ok);
+  }
+  report(state, bytes.size(), orders.size());
+}
+
+void scan(lab::State& state, const Format& f) {
+  const std::vector<Order>& orders = batch(f, records_of(state));
+  std::string buffer;
+  std::string bytes(f.encode(orders, buffer));
+  for (auto _ : state) lab::do_not_optimize(f.scan(bytes));
+  report(state, bytes.size(), orders.size());
+}
+
+const bool registered = [] {
+  std::vector<const Format*> formats = {&json_format(), &flat_format()};
+  if (const Format* pb = protobuf_format()) formats.push_back(pb);
+  for (const Format* f : formats) {
+    using Body = void (*)(lab::State&, const Format&);
+    const std::pair<const char*, Body> ops[] = {
+        {"encode", encode}, {"decode", decode}, {"scan", scan}};
+    for (auto [op, fn] : ops) {
+      lab::Registry::global().add(
+          std::string("serialize/") + f->name + "/" + op,
+          [f, fn = fn](lab::State& state) { fn(state, *f); },
+          {{"records", lab::grid("100,10K")}});
+    }
+  }
+  return true;
+}();
+
+}  // namespace
+
+}  // namespace serialization
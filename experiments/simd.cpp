@@ -0,0 +1,167 @@
+// Every lab::simd kernel in every variant this CPU supports, side by side
+// as "<kernel>/<isa>/size:N" (size in input bytes). Correctness against
+// scalar is covered by tests/simd_test.cpp, which lab_bench runs first.
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "lab/bench.hpp"
+#include "lab/dataset.hpp"
+#include "lab/params.hpp"
+#include "lab/simd.hpp"
+
+namespace {
+
+using lab::simd::Kernels;
+
+// Shared with every other run through the dataset cache.
+lab::dataset::Dataset random_bytes(std::size_t n) {
+  lab::dataset::Dataset data;
+  std::string error;
+  if (!lab::dataset::open({"uniform", 1, n}, lab::dataset::uniform, data,
+                          &error)) {
+    std::fprintf(stderr, "simd: %s\n", error.c_str());
+    std::exit(2);
+  }
+  return data;
+}
+
+std::size_t size_of(lab::State& state) {
+  return static_cast<std::size_t>(state.param("size"));
+}
+
+void sum_u32(lab::State& state, const Kernels& k) {
+  std::vector<std::uint32_t> data(size_of(state) / 4, 3);
+  for (auto _ : state) {
+    lab::do_not_optimize(data.data());
+    lab::do_not_optimize(k.sum_u32(data.data(), data.size()));
+  }
+  state.set_bytes_per_op(static_cast<double>(data.size() * 4));
+}
+
+void dot_f32(lab::State& state, const Kernels& k) {
+  std::size_t n = size_of(state) / 8;
+  std::vector<float> a(n, 0.5f), b(n, 2.0f);
+  for (auto _ : state) {
+    lab::do_not_optimize(a.data());
+    lab::do_not_optimize(k.dot_f32(a.data(), b.data(), n));
+  }
+  state.set_bytes_per_op(static_cast<double>(n * 8));
+}
+
+// Needle at the very end, so every variant scans the whole buffer.
+void find_byte(lab::State& state, const Kernels& k) {
+  std::vector<std::uint8_t> data(size_of(state), 'a');
+  data.back() = 'z';
+  for (auto _ : state) {
+    lab::do_not_optimize(data.data());
+    lab::do_not_optimize(k.find_byte(data.data(), data.size(), 'z'));
+  }
+  state.set_bytes_per_op(static_cast<double>(data.size()));
+}
+
+void prefix_sum_u32(lab::State& state, const Kernels& k) {
+  std::vector<std::uint32_t> data(size_of(state) / 4, 1);
+  for (auto _ : state) {
+    k.prefix_sum_u32(data.data(), data.size());
+    lab::clobber_memory();
+  }
+  state.set_bytes_per_op(static_cast<double>(data.size() * 4));
+}
+
+void histogram_u8(lab::State& state, const Kernels& k) {
+  auto bytes = random_bytes(size_of(state));
+  auto data = bytes.as<std::uint8_t>();
+  std::uint64_t counts[256] = {};
+  for (auto _ : state) {
+    k.histogram_u8(data.data(), data.size(), counts);
+    lab::clobber_memory();
+  }
+  state.set_bytes_per_op(static_cast<double>(data.size()));
+}
+
+void hex_encode(lab::State& state, const Kernels& k) {
+  auto bytes = random_bytes(size_of(state));
+  auto data = bytes.as<std::uint8_t>();
+  std::string out(2 * data.size(), '\0');
+  for (auto _ : state) {
+    k.hex_encode(data.data(), data.size(), out.data());
+    lab::clobber_memory();
+  }
+  state.set_bytes_per_op(static_cast<double>(data.size()));
+}
+
+void base64_encode(lab::State& state, const Kernels& k) {
+  auto bytes = random_bytes(size_of(state));
+  auto data = bytes.as<std::uint8_t>();
+  std::string out(lab::simd::base64_size(data.size()), '\0');
+  for (auto _ : state) {
+    k.base64_encode(data.data(), data.size(), out.data());
+    lab::clobber_memory();
+  }
+  state.set_bytes_per_op(static_cast<double>(data.size()));
+}
+
+// Slowly varying words, as in a telemetry series.
+void delta_encode_u32(lab::State& state, const Kernels& k) {
+  std::vector<std::uint32_t> data(size_of(state) / 4), out(data.size());
+  for (std::size_t i = 0; i < data.size(); ++i) {
+    data[i] = static_cast<std::uint32_t>(1000 * i + i % 7);
+  }
+  for (auto _ : state) {
+    lab::do_not_optimize(
+        k.delta_encode_u32(data.data(), data.size(), 0, out.data()));
+    lab::clobber_memory();
+  }
+  state.set_bytes_per_op(static_cast<double>(data.size() * 4));
+}
+
+// Random keys in blocks of kSortBlock; each op re-copies them from the
+// source, which sort_block_u64 then dominates.
+void sort_block_u64(lab::State& state, const Kernels& k) {
+  auto data = random_bytes(size_of(state));
+  std::size_t n = data.size() / 8;
+  std::vector<std::uint64_t> keys(n);
+  const auto* src = reinterpret_cast<const std::uint64_t*>(data.data());
+  for (auto _ : state) {
+    std::copy(src, src + n, keys.begin());
+    for (std::size_t i = 0; i < n; i += lab::simd::kSortBlock) {
+      k.sort_block_u64(keys.data() + i,
+                       std::min(lab::simd::kSortBlock, n - i));
+    }
+    lab::clobber_memory();
+  }
+  state.set_bytes_per_op(static_cast<double>(n * 8));
+}
+
+struct Kernel {
+  const char* name;
+  void (*fn)(lab::State&, const Kernels&);
+};
+
+constexpr Kernel kKernels[] = {
+    {"sum_u32", sum_u32},          {"dot_f32", dot_f32},
+    {"find_byte", find_byte},      {"prefix_sum_u32", prefix_sum_u32},
+    {"histogram_u8", histogram_u8}, {"hex_encode", hex_encode},
+    {"base64_encode", base64_encode}, {"delta_encode_u32", delta_encode_u32},
+    {"sort_block_u64", sort_block_u64},
+};
+
+const bool registered = [] {
+  for (auto isa : lab::simd::kAllIsas) {
+    const Kernels* k = lab::simd::kernels(isa);
+    if (k == nullptr) continue;
+    for (const auto& kernel : kKernels) {
+      lab::Registry::global().add(
+          std::string(kernel.name) + "/" + lab::simd::isa_name(isa),
+          [fn = kernel.fn, k](lab::State& state) { fn(state, *k); },
+          {{"size", lab::grid("4K..16M:x16")}});
+    }
+  }
+  return true;
+}();
+
+}  // namespace
@@ -0,0 +1,165 @@
+// Sorting 64-bit keys (lab/sort.hpp) against std::sort, as
+// "sort/<algorithm>/<keys>/n:N", one op being one sort of N keys:
+//
+//   std_sort, pdqsort, radix_lsd, radix_msd
+//   block_merge    64-key blocks by simd::sort_block_u64, then merges
+//   sample_sort/threads:T   on a lab::Scheduler of T workers
+//
+// Keys are the first N of a 4M-key dataset from the cache: uniform
+// (random 64-bit), zipf (ranks 1..1M, skew 0.99, so many duplicates) and
+// nearly_sorted (ascending, one key in 100 replaced by a random one).
+// Copying them into the buffer before each sort is not timed. bytes_per_op
+// is 8 * N, so bytes_per_op / ns_per_op is GB/s of keys sorted.
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "lab/bench.hpp"
+#include "lab/dataset.hpp"
+#include "lab/params.hpp"
+#include "lab/scheduler.hpp"
+#include "lab/sort.hpp"
+#include "lab/topology.hpp"
+
+namespace sort_bench {
+
+namespace {
+
+constexpr std::size_t kMaxKeys = std::size_t{4} << 20;
+
+// Ascending keys with random ones mixed in: the runs pdqsort and
+// insertion sort exploit, broken often enough to need real work.
+void nearly_sorted(std::uint64_t seed, std::span<std::byte> out) {
+  std::vector<std::uint64_t> keys(out.size() / 8);
+  for (std::size_t i = 0; i < keys.size(); ++i) {
+    seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+    keys[i] = (seed >> 32) % 100 == 0 ? seed : std::uint64_t{i} << 20;
+  }
+  std::fill(out.begin(), out.end(), std::byte{0});
+  std::copy_n(reinterpret_cast<const std::byte*>(keys.data()),
+              keys.size() * 8, out.begin());
+}
+
+struct KeySet {
+  const char* name;
+  const char* generator;  // of its dataset key
+  std::uint64_t seed;
+  lab::dataset::Fill fill;
+};
+
+const std::vector<KeySet>& key_sets() {
+  static const std::vector<KeySet> all = {
+      {"uniform", "uniform", 1, lab::dataset::uniform},
+      {"zipf", "zipf-1M-0.99", 42, lab::dataset::zipf(1 << 20, 0.99)},
+      {"nearly_sorted", "nearly-sorted-v1", 3, nearly_sorted},
+  };
+  return all;
+}
+
+// Opened on first use; benchmarks run one at a time.
+std::span<const std::uint64_t> sort_input(const KeySet& set) {
+  static std::map<const KeySet*, lab::dataset::Dataset> open;
+  auto it = open.find(&set);
+  if (it == open.end()) {
+    lab::dataset::Dataset d;
+    std::string error;
+    if (!lab::dataset::open({set.generator, set.seed, kMaxKeys * 8},
+                            set.fill, d, {.populate = true}, &error)) {
+      std::fprintf(stderr, "sort: %s\n", error.c_str());
+      std::exit(2);
+    }
+    it = open.emplace(&set, std::move(d)).first;
+  }
+  return it->second.as<std::uint64_t>();
+}
+
+enum class Algorithm {
+  std_sort,
+  pdqsort,
+  radix_lsd,
+  radix_msd,
+  block_merge,
+  sample_sort,
+};
+
+void run_sort(lab::State& state, const char* name, Algorithm algorithm,
+              const KeySet& set) {
+  auto n = static_cast<std::size_t>(state.param("n"));
+  auto in = sort_input(set).first(n);
+  std::vector<std::uint64_t> keys(n), scratch(n);
+  int threads = 1;
+  if (algorithm == Algorithm::sample_sort) {
+    threads = static_cast<int>(state.param("threads"));
+  }
+  lab::Scheduler pool({.threads = threads});
+  for (auto _ : state) {
+    state.pause_timing();
+    std::copy(in.begin(), in.end(), keys.begin());
+    state.resume_timing();
+    switch (algorithm) {
+      case Algorithm::std_sort:
+        std::sort(keys.begin(), keys.end());
+        break;
+      case Algorithm::pdqsort:
+        lab::sort::pdqsort(keys.data(), n);
+        break;
+      case Algorithm::radix_lsd:
+        lab::sort::radix_sort_lsd(keys.data(), n, scratch.data());
+        break;
+      case Algorithm::radix_msd:
+        lab::sort::radix_sort_msd(keys.data(), n);
+        break;
+      case Algorithm::block_merge:
+        lab::sort::block_merge_sort(keys.data(), n, scratch.data());
+        break;
+      case Algorithm::sample_sort:
+        lab::sort::sample_sort(pool, keys.data(), n, scratch.data());
+        break;
+    }
+    lab::clobber_memory();
+  }
+  if (!std::is_sorted(keys.begin(), keys.end())) {
+    std::fprintf(stderr, "sort: %s output of %s is not sorted\n", name,
+                 set.name);
+    std::exit(2);
+  }
+  state.set_bytes_per_op(static_cast<double>(n * 8));
+}
+
+const bool registered = [] {
+  const std::pair<const char*, Algorithm> algorithms[] = {
+      {"std_sort", Algorithm::std_sort},
+      {"pdqsort", Algorithm::pdqsort},
+      {"radix_lsd", Algorithm::radix_lsd},
+      {"radix_msd", Algorithm::radix_msd},
+      {"block_merge", Algorithm::block_merge},
+      {"sample_sort", Algorithm::sample_sort},
+  };
+  // Benchmarks run pinned to one CPU, so count them now.
+  std::string cpus = std::to_string(lab::Topology::detect().cpu_count());
+  for (const auto& [name, algorithm] : algorithms) {
+    for (const KeySet& set : key_sets()) {
+      std::vector<lab::Param> params = {{"n", lab::grid("1K..4M:x16")}};
+      if (algorithm == Algorithm::sample_sort) {
+        params.push_back({"threads", lab::grid("1.." + cpus)});
+      }
+      lab::Registry::global().add(
+          std::string("sort/") + name + "/" + set.name,
+          [name = name, algorithm = algorithm, &set](lab::State& state) {
+            run_sort(state, name, algorithm, set);
+          },
+          params);
+    }
+  }
+  return true;
+}();
+
+}  // namespace
+
+}  // namespace sort_bench
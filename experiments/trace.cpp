@@ -0,0 +1,36 @@
+// What a LAB_TRACE_SCOPE costs on a hot path: compiled in but switched
+// off at run time, and recording into the thread's ring.
+#include "lab/bench.hpp"
+#include "lab/trace.hpp"
+
+namespace trace_bench {
+
+namespace {
+
+template <bool kOn>
+void trace_scope(lab::State& state) {
+  bool was = lab::trace::enabled();
+  lab::trace::set_enabled(kOn);
+  std::uint64_t x = 0;
+  for (auto _ : state) {
+    LAB_TRACE_SCOPE("trace_scope");
+    lab::do_not_optimize(++x);
+  }
+  lab::trace::set_enabled(was);
+}
+
+void untraced(lab::State& state) {
+  std::uint64_t x = 0;
+  for (auto _ : state) lab::do_not_optimize(++x);
+}
+LAB_BENCH(untraced);
+
+const bool registered = [] {
+  lab::Registry::global().add("trace_scope/off", trace_scope<false>);
+  lab::Registry::global().add("trace_scope/on", trace_scope<true>);
+  return true;
+}();
+
+}  // namespace
+
+}  // namespace trace_bench
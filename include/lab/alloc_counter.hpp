@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+
+#include "lab/bench.hpp"
+
+namespace lab {
+
+struct AllocCounts {
+  std::uint64_t allocs = 0;
+  std::uint64_t bytes = 0;
+};
+
+namespace detail {
+// Updated by the operator new replacement in src/alloc_counter.cpp, which
+// only executables that want counting link in (lab_bench and lab_test do).
+inline thread_local AllocCounts thread_alloc_counts;
+inline bool alloc_hooks_installed = false;
+}  // namespace detail
+
+// True when the global operator new is the counting replacement.
+inline bool alloc_counting_enabled() {
+  return detail::alloc_hooks_installed;
+}
+
+// Allocations made through operator new on the calling thread so far.
+inline AllocCounts thread_alloc_counts() {
+  return detail::thread_alloc_counts;
+}
+
+// Accumulates allocations made on the benchmark thread inside timed
+// regions. Setup done under pause_timing() is not counted.
+class AllocProbe : public Probe {
+ public:
+  void reset() { total_ = {}; }
+  void start() override { at_start_ = thread_alloc_counts(); }
+  void stop() override {
+    AllocCounts now = thread_alloc_counts();
+    total_.allocs += now.allocs - at_start_.allocs;
+    total_.bytes += now.bytes - at_start_.bytes;
+  }
+  AllocCounts total() const { return total_; }
+
+ private:
+  AllocCounts at_start_;
+  AllocCounts total_;
+};
+
+}  // namespace lab
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "lab/results.hpp"
+
+namespace lab {
+
+// Append-only history of benchmark runs, read through a read-only mmap.
+//
+// The file is a 16-byte header followed by one self-contained block per
+// run. Within a block every metric is a contiguous column of doubles
+// (NaN where a row has no value), benchmark names are a column of
+// offsets into the block's string table, and a name-sorted row index
+// makes lookups a binary search. Readers get pointers straight into the
+// mapping, so a trend query touches a few cache lines per run rather than
+// parsing text. Blocks use the host's byte order.
+//
+// Appenders hold an exclusive flock on the archive, so concurrent runs
+// never interleave. Readers stop at a block cut short by a crash, and the
+// next append truncates it.
+
+struct RunInfo {
+  std::string commit;
+  std::int64_t timestamp = 0;  // Unix seconds; 0 means now
+  std::string host;            // empty means gethostname()
+};
+
+// Appends one run, creating the archive if needed. Each Result field
+// (iterations, ns_per_op, p50_ns, p99_ns, bytes_per_op) and each counter
+// becomes a metric column; samples are not archived.
+bool append_run(const std::string& path, const RunInfo& info,
+                const std::vector<Result>& results,
+                std::string* error = nullptr);
+
+class Archive {
+ public:
+  // A zero-copy view of one archived run, valid while the Archive is.
+  class Run {
+   public:
+    std::int64_t timestamp() const;
+    std::string_view commit() const;
+    std::string_view host() const;
+
+    std::size_t rows() const;
+    std::string_view name(std::size_t row) const;
+    // Row of benchmark `name`, or -1.
+    std::ptrdiff_t find(std::string_view name) const;
+
+    std::size_t metric_count() const;
+    std::string_view metric_name(std::size_t i) const;
+    // rows() values; nullptr if the run lacks the metric.
+    const double* metric(std::size_t i) const;
+    const double* metric(std::string_view name) const;
+
+   private:
+    friend class Archive;
+    explicit Run(const char* block) : block_(block) {}
+    std::string_view string(std::uint32_t offset) const;
+    const char* block_;
+  };
+
+  class Iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Run;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = Run;
+
+    Iterator() = default;
+    Run operator*() const { return archive_->run(index_); }
+    Iterator& operator++() {
+      ++index_;
+      return *this;
+    }
+    Iterator operator++(int) {
+      Iterator old = *this;
+      ++index_;
+      return old;
+    }
+    bool operator==(const Iterator& other) const {
+      return index_ == other.index_;
+    }
+
+   private:
+    friend class Archive;
+    Iterator(const Archive* archive, std::size_t index)
+        : archive_(archive), index_(index) {}
+    const Archive* archive_ = nullptr;
+    std::size_t index_ = 0;
+  };
+
+  Archive() = default;
+  ~Archive();
+  Archive(Archive&& other) noexcept;
+  Archive& operator=(Archive&& other) noexcept;
+  Archive(const Archive&) = delete;
+  Archive& operator=(const Archive&) = delete;
+
+  // Maps the archive and indexes its blocks. Runs appended afterwards are
+  // not visible until the next open().
+  bool open(const std::string& path, std::string* error = nullptr);
+  void close();
+
+  std::size_t size() const { return blocks_.size(); }
+  Run run(std::size_t i) const { return Run(data_ + blocks_[i]); }
+  Iterator begin() const { return Iterator(this, 0); }
+  Iterator end() const { return Iterator(this, blocks_.size()); }
+
+ private:
+  const char* data_ = nullptr;
+  std::size_t size_ = 0;
+  std::vector<std::size_t> blocks_;  // file offsets, in append order
+};
+
+struct TrendPoint {
+  std::int64_t timestamp;
+  std::string_view commit;
+  double value;
+};
+
+// `metric` of `benchmark` in every run that recorded it, in append order.
+std::vector<TrendPoint> trend(const Archive& archive,
+                              std::string_view benchmark,
+                              std::string_view metric);
+
+}  // namespace lab
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <new>
+#include <utility>
+
+#include "lab/pages.hpp"
+
+namespace lab {
+
+// Bump-pointer allocator over a chain of chunks. Individual frees are not
+// supported; reset() rewinds to the first chunk and keeps every chunk for
+// reuse, so a steady-state loop of allocate/reset never calls upstream.
+class Arena {
+ public:
+  static constexpr std::size_t kDefaultChunkSize = 64 * 1024;
+
+  explicit Arena(std::size_t chunk_size = kDefaultChunkSize,
+                 std::pmr::memory_resource* upstream =
+                     std::pmr::new_delete_resource());
+  // Chunks mapped with `pages`, e.g. {.hugetlb = true, .populate = true}
+  // so nothing faults or misses the TLB after the first allocate. Each
+  // chunk is a mapping, so make them large: 2 MiB multiples with hugetlb.
+  Arena(std::size_t chunk_size, const PageOptions& pages)
+      : Arena(chunk_size, page_resource(pages)) {}
+  ~Arena();
+
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+
+  void* allocate(std::size_t bytes,
+                 std::size_t align = alignof(std::max_align_t)) {
+    if (char* p = bump(bytes, align)) return p;
+    return allocate_slow(bytes, align);
+  }
+
+  // Constructs a T in the arena. Its destructor is never run.
+  template <class T, class... Args>
+  T* make(Args&&... args) {
+    return ::new (allocate(sizeof(T), alignof(T)))
+        T(std::forward<Args>(args)...);
+  }
+
+  // Rewinds to the first chunk without returning memory upstream.
+  void reset();
+  // Returns every chunk upstream.
+  void release();
+
+  // Bytes handed out since the last reset, including alignment padding.
+  std::size_t used() const;
+  // Bytes obtained from upstream, including chunk headers.
+  std::size_t capacity() const { return capacity_; }
+
+ private:
+  struct Chunk {
+    Chunk* next;
+    std::size_t size;  // total size including this header
+    char* begin() { return reinterpret_cast<char*>(this + 1); }
+    char* end() { return reinterpret_cast<char*>(this) + size; }
+  };
+
+  // Carves `bytes` from the current chunk, or returns nullptr.
+  char* bump(std::size_t bytes, std::size_t align) {
+    if (ptr_ == nullptr) return nullptr;
+    auto addr = reinterpret_cast<std::uintptr_t>(ptr_);
+    auto aligned = (addr + align - 1) & ~(std::uintptr_t{align} - 1);
+    auto limit = reinterpret_cast<std::uintptr_t>(end_);
+    if (aligned > limit || limit - aligned < bytes) return nullptr;
+    ptr_ = reinterpret_cast<char*>(aligned + bytes);
+    return reinterpret_cast<char*>(aligned);
+  }
+
+  void* allocate_slow(std::size_t bytes, std::size_t align);
+  void enter(Chunk* chunk);
+
+  std::size_t chunk_size_;
+  std::pmr::memory_resource* upstream_;
+  Chunk* first_ = nullptr;
+  Chunk* current_ = nullptr;
+  char* ptr_ = nullptr;
+  char* end_ = nullptr;
+  std::size_t capacity_ = 0;
+};
+
+// std::pmr adapter; deallocate is a no-op, memory returns on Arena::reset.
+class ArenaResource final : public std::pmr::memory_resource {
+ public:
+  explicit ArenaResource(Arena& arena) : arena_(arena) {}
+
+  Arena& arena() const { return arena_; }
+
+ private:
+  void* do_allocate(std::size_t bytes, std::size_t align) override {
+    return arena_.allocate(bytes, align);
+  }
+  void do_deallocate(void*, std::size_t, std::size_t) override {}
+  bool do_is_equal(const memory_resource& other) const noexcept override {
+    auto* o = dynamic_cast<const ArenaResource*>(&other);
+    return o != nullptr && &o->arena_ == &arena_;
+  }
+
+  Arena& arena_;
+};
+
+}  // namespace lab
@@ -0,0 +1,393 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "lab/histogram.hpp"
+#include "lab/resident.hpp"
+
+namespace lab {
+
+// Keeps the compiler from discarding `value` or the work that produced it.
+template <class T>
+inline void do_not_optimize(T const& value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+template <class T>
+inline void do_not_optimize(T& value) {
+  asm volatile("" : "+r,m"(value) : : "memory");
+}
+
+// Forces pending stores to be treated as visible to the outside world.
+inline void clobber_memory() { asm volatile("" : : : "memory"); }
+
+// Observes the timed regions of a run, e.g. to read hardware counters.
+// start() runs just before the clock starts and stop() just after it
+// stops, so a probe's own cost stays out of the measurement.
+class Probe {
+ public:
+  virtual ~Probe() = default;
+  virtual void start() = 0;
+  virtual void stop() = 0;
+};
+
+// A named integer parameter and the values the runner sweeps by default.
+// `lab_bench --NAME=GRID` (see lab/params.hpp) replaces the defaults.
+struct Param {
+  std::string name;
+  std::vector<std::int64_t> values;
+};
+
+// One point of a parameter grid, in declaration order.
+using ParamValues = std::vector<std::pair<std::string, std::int64_t>>;
+
+// Per-run handle passed to a benchmark body. The body iterates over the
+// state exactly once; only the iterations themselves are timed.
+//
+//   void bm_foo(lab::State& state) {
+//     for (auto _ : state) lab::do_not_optimize(foo());
+//   }
+class State {
+ public:
+  using clock = std::chrono::steady_clock;
+
+  explicit State(std::uint64_t iterations, ParamValues params = {})
+      : iterations_(iterations), params_(std::move(params)) {}
+
+  std::uint64_t iterations() const { return iterations_; }
+
+  // Value of a declared parameter at this grid point, or 0 if undeclared.
+  std::int64_t param(std::string_view name) const {
+    for (const auto& [n, v] : params_) {
+      if (n == name) return v;
+    }
+    return 0;
+  }
+  const ParamValues& params() const { return params_; }
+
+  // Excludes setup or teardown inside the loop from the measurement.
+  void pause_timing() {
+    elapsed_ += clock::now() - start_;
+    running_ = false;
+    if (probe_ != nullptr) probe_->stop();
+  }
+
+  void resume_timing() {
+    running_ = true;
+    if (probe_ != nullptr) probe_->start();
+    start_ = clock::now();
+  }
+
+  void set_probe(Probe* probe) { probe_ = probe; }
+  Probe* probe() const { return probe_; }
+
+  // Where resident() keeps its blocks: Resident::process() unless set,
+  // e.g. by a plugin to the store of its host.
+  void set_resident_store(Resident* store) { resident_ = store; }
+  Resident& resident_store() const {
+    return resident_ != nullptr ? *resident_ : Resident::process();
+  }
+
+  // `n` Ts kept under `key` across runs and plugin reloads. `init` fills
+  // the span only when the block is created, so build expensive inputs
+  // here rather than in every run. Change the key whenever the contents
+  // or the layout of T change.
+  template <class T, class Init>
+  std::span<T> resident(const std::string& key, std::size_t n, Init&& init) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    using Fn = std::remove_reference_t<Init>;
+    auto fill = [](void* data, std::size_t bytes, void* ctx) {
+      (*static_cast<Fn*>(ctx))(
+          std::span<T>(static_cast<T*>(data), bytes / sizeof(T)));
+    };
+    void* ctx = const_cast<void*>(static_cast<const void*>(&init));
+    void* data = resident_store().get(key, n * sizeof(T), fill, ctx);
+    return {static_cast<T*>(data), n};
+  }
+
+  // For bodies that time themselves, e.g. plugins or multi-threaded runs.
+  void add_elapsed(std::chrono::nanoseconds ns) { elapsed_ += ns; }
+
+  // Bytes of input the benchmark touches per iteration, reported as
+  // bytes_per_op so throughput can be derived from ns_per_op.
+  void set_bytes_per_op(double bytes) { bytes_per_op_ = bytes; }
+
+  // Extra per-op metric, emitted as an additional output column.
+  void set_counter(std::string name, double value) {
+    for (auto& [n, v] : counters_) {
+      if (n == name) {
+        v = value;
+        return;
+      }
+    }
+    counters_.emplace_back(std::move(name), value);
+  }
+
+  // Per-op latencies in ns, for bodies that measure their own operations
+  // (e.g. each request); multi-threaded bodies merge one histogram per
+  // thread in after joining. The runner merges them over all samples into
+  // the lat_* columns.
+  Histogram& latency() { return latency_; }
+  const Histogram& latency() const { return latency_; }
+
+  // Makes the loop record the timed duration of every iteration into
+  // latency(). The runner uses this on one extra, separate run, as the
+  // clock reads would otherwise skew ns/op.
+  void time_each_iteration() { time_each_ = true; }
+  bool times_each_iteration() const { return time_each_; }
+
+  std::chrono::nanoseconds elapsed() const { return elapsed_; }
+  double bytes_per_op() const { return bytes_per_op_; }
+  bool running() const { return running_; }
+  const std::vector<std::pair<std::string, double>>& counters() const {
+    return counters_;
+  }
+
+  struct Sentinel {};
+
+  class Iterator {
+   public:
+    // Non-trivial so `for (auto _ : state)` does not warn as unused.
+    struct Value {
+      ~Value() {}
+    };
+
+    explicit Iterator(State* state)
+        : state_(state), remaining_(state->iterations_) {
+      // Timed iterations run in batches of one, so the common loop stays
+      // a single count down either way.
+      if (state->time_each_ && remaining_ > 1) {
+        laps_ = remaining_ - 1;
+        remaining_ = 1;
+      }
+    }
+
+    Value operator*() const { return {}; }
+    Iterator& operator++() {
+      --remaining_;
+      return *this;
+    }
+    bool operator!=(Sentinel) {
+      if (remaining_ != 0) return true;
+      if (state_->time_each_) state_->lap();
+      if (laps_ != 0) {
+        --laps_;
+        remaining_ = 1;
+        return true;
+      }
+      state_->pause_timing();
+      return false;
+    }
+
+   private:
+    State* state_;
+    std::uint64_t remaining_;
+    std::uint64_t laps_ = 0;
+  };
+
+  Iterator begin() {
+    Iterator it(this);
+    resume_timing();
+    return it;
+  }
+  Sentinel end() { return {}; }
+
+ private:
+  // Records the timed duration since the previous lap.
+  void lap() {
+    std::chrono::nanoseconds timed = elapsed_;
+    if (running_) timed += clock::now() - start_;
+    latency_.record(static_cast<std::uint64_t>((timed - lap_start_).count()));
+    lap_start_ = timed;
+  }
+
+  std::uint64_t iterations_;
+  ParamValues params_;
+  clock::time_point start_{};
+  std::chrono::nanoseconds elapsed_{0};
+  bool running_ = false;
+  Probe* probe_ = nullptr;
+  Resident* resident_ = nullptr;
+  double bytes_per_op_ = 0;
+  std::vector<std::pair<std::string, double>> counters_;
+  Histogram latency_;
+  bool time_each_ = false;
+  std::chrono::nanoseconds lap_start_{0};
+};
+
+using BenchFn = std::function<void(State&)>;
+
+struct Benchmark {
+  std::string name;
+  BenchFn fn;
+  std::vector<Param> params;  // empty: a single run, no grid
+};
+
+// Process-wide list of benchmarks, filled by LAB_BENCH at static init.
+class Registry {
+ public:
+  static Registry& global();
+
+  void add(std::string name, BenchFn fn, std::vector<Param> params = {});
+  // Appends a parameter to the benchmark added last.
+  void add_param(Param param) {
+    benchmarks_.back().params.push_back(std::move(param));
+  }
+  // Removes the benchmark named `name`, e.g. before its plugin unloads.
+  bool remove(std::string_view name);
+  const std::vector<Benchmark>& benchmarks() const { return benchmarks_; }
+
+ private:
+  std::vector<Benchmark> benchmarks_;
+};
+
+struct Registration {
+  Registration(std::string name, BenchFn fn, std::vector<Param> params = {}) {
+    Registry::global().add(std::move(name), std::move(fn), std::move(params));
+  }
+};
+
+// Compile-time parameter lists for LAB_BENCH_TEMPLATE and friends.
+template <class... Ts>
+struct types {};
+template <auto... Vs>
+struct values {};
+
+// Readable name of T as the compiler spells it, e.g. "float" or
+// "unsigned int".
+template <class T>
+constexpr std::string_view type_name() {
+  // GCC: "... [with T = float; std::string_view = ...]", Clang: "[T = float]"
+  std::string_view p = __PRETTY_FUNCTION__;
+  std::size_t start = p.find("T = ") + 4;
+  return p.substr(start, p.find_first_of(";]", start) - start);
+}
+
+template <auto V>
+std::string value_name() {
+  if constexpr (std::is_same_v<decltype(V), bool>) {
+    return V ? "true" : "false";
+  } else if constexpr (std::is_enum_v<decltype(V)>) {
+    return std::to_string(static_cast<std::underlying_type_t<decltype(V)>>(V));
+  } else {
+    return std::to_string(V);
+  }
+}
+
+// Implementation of the LAB_BENCH_TEMPLATE macros: registers f's
+// instantiation for every combination as "base<arg,...>".
+namespace detail {
+
+inline std::string instance_name(std::string_view base,
+                                 std::initializer_list<std::string> args) {
+  std::string name(base);
+  name += '<';
+  for (const auto& arg : args) {
+    if (name.back() != '<') name += ',';
+    name += arg;
+  }
+  return name + '>';
+}
+
+template <class F, class... Ts, auto... Vs>
+bool add_instances(Registry& registry, std::string_view base, F f,
+                   types<Ts...>, values<Vs...>, std::vector<Param> params) {
+  (
+      [&]<class T>() {
+        (registry.add(
+             instance_name(base, {std::string(type_name<T>()),
+                                  value_name<Vs>()}),
+             [f](State& s) { f.template operator()<T, Vs>(s); }, params),
+         ...);
+      }.template operator()<Ts>(),
+      ...);
+  return true;
+}
+
+template <class F, class... Ts>
+bool add_instances(Registry& registry, std::string_view base, F f,
+                   types<Ts...>, std::vector<Param> params) {
+  (registry.add(instance_name(base, {std::string(type_name<Ts>())}),
+                [f](State& s) { f.template operator()<Ts>(s); }, params),
+   ...);
+  return true;
+}
+
+template <class F, auto... Vs>
+bool add_instances(Registry& registry, std::string_view base, F f,
+                   values<Vs...>, std::vector<Param> params) {
+  (registry.add(instance_name(base, {value_name<Vs>()}),
+                [f](State& s) { f.template operator()<Vs>(s); }, params),
+   ...);
+  return true;
+}
+
+}  // namespace detail
+
+}  // namespace lab
+
+#define LAB_CONCAT_IMPL(a, b) a##b
+#define LAB_CONCAT(a, b) LAB_CONCAT_IMPL(a, b)
+
+// Registers `fn` (a void(lab::State&) function) under its own name.
+// __COUNTER__ keeps registrations distinct when unity builds merge TUs.
+#define LAB_BENCH(fn)                                            \
+  static ::lab::Registration LAB_CONCAT(lab_bench_registration_, \
+                                        __COUNTER__)(#fn, fn)
+
+// Registers `fn` with parameters, run once per point of their grid:
+//
+//   LAB_BENCH_PARAMS(bm_scan, {"threads", lab::grid("1..8")},
+//                             {"size", lab::grid("1K..64M:x4")});
+//
+// Each point is reported as "bm_scan/threads:2/size:4096".
+#define LAB_BENCH_PARAMS(fn, ...)                                \
+  static ::lab::Registration LAB_CONCAT(lab_bench_registration_, \
+                                        __COUNTER__)(#fn, fn, {__VA_ARGS__})
+
+#define LAB_EXPAND(...) __VA_ARGS__
+
+// Registers every instantiation of `template <class T, auto V> void fn(
+// lab::State&)` over the parenthesized lists, each specialized at compile
+// time so that constants fold and loops unroll or vectorize as in real
+// code. Runtime parameters may follow, as for LAB_BENCH_PARAMS:
+//
+//   LAB_BENCH_TEMPLATE(bm_sum, (float, double), (1, 4, 8),
+//                      {"size", lab::grid("4K,1M")});
+//
+// Each instantiation is a benchmark of its own, e.g. "bm_sum<float,4>",
+// with points such as "bm_sum<float,4>/size:4096".
+#define LAB_BENCH_TEMPLATE(fn, type_list, value_list, ...)                 \
+  static const bool LAB_CONCAT(lab_bench_template_, __COUNTER__) =         \
+      ::lab::detail::add_instances(                                        \
+          ::lab::Registry::global(), #fn,                                  \
+          []<class T, auto V>(::lab::State& s) { fn<T, V>(s); },           \
+          ::lab::types<LAB_EXPAND type_list>{},                            \
+          ::lab::values<LAB_EXPAND value_list>{}, {__VA_ARGS__})
+
+// The same for `template <class T> void fn(lab::State&)`, e.g.
+// LAB_BENCH_TYPES(bm_sort, (int, float, std::string)).
+#define LAB_BENCH_TYPES(fn, type_list, ...)                                \
+  static const bool LAB_CONCAT(lab_bench_template_, __COUNTER__) =         \
+      ::lab::detail::add_instances(                                        \
+          ::lab::Registry::global(), #fn,                                  \
+          []<class T>(::lab::State& s) { fn<T>(s); },                      \
+          ::lab::types<LAB_EXPAND type_list>{}, {__VA_ARGS__})
+
+// The same for `template <auto V> void fn(lab::State&)`, e.g.
+// LAB_BENCH_VALUES(bm_block, (64, 256, 4096)).
+#define LAB_BENCH_VALUES(fn, value_list, ...)                              \
+  static const bool LAB_CONCAT(lab_bench_template_, __COUNTER__) =         \
+      ::lab::detail::add_instances(                                        \
+          ::lab::Registry::global(), #fn,                                  \
+          []<auto V>(::lab::State& s) { fn<V>(s); },                       \
+          ::lab::values<LAB_EXPAND value_list>{}, {__VA_ARGS__})
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace lab::bitpack {
+
+// A codec for series of 32-bit words that change slowly, such as
+// timestamps, counters and gauges: each word becomes the zigzag delta to
+// its predecessor (simd::delta_encode_u32), and every block of 128 deltas
+// is packed at the bit width of its largest one. Bytes that are not a
+// whole word at the end are stored as they are. Words are read in host
+// byte order, so compressed data is only portable between hosts of the
+// same byte order.
+//
+// Layout: the input size as a 64-bit word, then per block one byte of
+// width w and 16 * w bytes, in the "vertical" order of Lemire and Boytsov,
+// "Decoding billions of integers per second through vectorization": delta
+// i goes to lane i % 4 of four interleaved 32-bit streams, so one
+// instruction shifts four of them. A final partial block is padded with
+// zero deltas.
+//
+//   std::vector<std::byte> packed(lab::bitpack::bound(n));
+//   packed.resize(lab::bitpack::compress(data, n, packed.data()));
+//   lab::bitpack::decompress(packed.data(), packed.size(), data, n);
+
+inline constexpr std::size_t kBlock = 128;  // deltas per block
+
+// Largest compress() output for `bytes` of input.
+std::size_t bound(std::size_t bytes);
+
+// Compresses `bytes` of `in` into `out`, which needs bound(bytes) bytes;
+// returns the compressed size.
+std::size_t compress(const void* in, std::size_t bytes, void* out);
+
+// The input size recorded in compressed data, or false if `size` bytes
+// are too few to hold it.
+bool decompressed_size(const void* in, std::size_t size, std::size_t& out);
+
+// Decompresses `size` bytes of `in` into `out`, which must be exactly
+// decompressed_size() bytes. False on truncated or malformed input, or a
+// size mismatch.
+bool decompress(const void* in, std::size_t size, void* out,
+                std::size_t out_bytes);
+
+}  // namespace lab::bitpack
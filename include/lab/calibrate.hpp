@@ -0,0 +1,29 @@
+#pragma once
+
+#include "lab/bench.hpp"
+
+namespace lab {
+
+// Machine baselines: benchmarks of the hardware rather than of code, kept
+// out of Registry::global() so they run only when asked for
+// (`lab_bench --calibrate`). Their rows, all named "calibrate/...", go
+// to bench_output.txt with the rest, so other results can be normalized
+// against them (`lab_compare --normalize=ROW`) and lab_farm can tell a
+// slow host from a slow change.
+//
+//   calibrate/stream/{copy,scale,add,triad}
+//       McCalpin's STREAM kernels over three 64 MiB arrays of doubles, far
+//       past any LLC; bytes_per_op counts STREAM's way (no write
+//       allocate), so bandwidth is bytes_per_op / ns_per_op GB/s.
+//   calibrate/chase/size:N
+//       a dependent load per op, chasing a random cycle through N bytes
+//       with one pointer per cache line: ns_per_op is the load-to-use
+//       latency of whichever level N fits in.
+//   calibrate/tlb/{4k,2m}/pages:N
+//       the same chase touching one line in each of N 4 KiB blocks, so
+//       the data stays cached and misses are in the TLB; 2m backs the
+//       blocks with 2 MiB pages (hugetlbfs when reserved, else THP), and
+//       its huge_pages column says which (2, 1).
+Registry& calibration_registry();
+
+}  // namespace lab
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+
+namespace lab {
+
+// Padding unit for data written by different threads. 128 rather than 64
+// on x86 because the adjacent-line prefetcher pulls lines in pairs.
+#if defined(__x86_64__) || defined(__aarch64__)
+inline constexpr std::size_t kCacheLine = 128;
+#else
+inline constexpr std::size_t kCacheLine = 64;
+#endif
+
+// Spin-wait hint: frees pipeline resources for the sibling hyperthread.
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__)
+  asm volatile("yield" ::: "memory");
+#else
+  asm volatile("" ::: "memory");
+#endif
+}
+
+}  // namespace lab
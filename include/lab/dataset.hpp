@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "lab/pages.hpp"
+
+namespace lab::dataset {
+
+// Benchmark inputs generated once and shared through files. A dataset is
+// named by its key, (generator, seed, bytes), and stored under its content
+// digest:
+//
+//   <dir>/keys/<generator>.<seed>.<bytes>   the digest of its contents
+//   <dir>/objects/<digest>                  the contents
+//
+// Later opens, from any process, map the object read-only instead of
+// generating it again, so setup is a page-cache hit, concurrent runs share
+// the physical pages, and every benchmark compared sees the same bytes.
+//
+//   lab::dataset::Dataset keys;
+//   if (!lab::dataset::open({"uniform", 1, n * 8}, lab::dataset::uniform,
+//                           keys, &error)) ...
+//   std::span<const std::uint64_t> k = keys.as<std::uint64_t>();
+struct Key {
+  // Names the fill function. Give it a new name whenever it would produce
+  // other bytes, e.g. "zipf-v2", or stale files will be reused.
+  std::string generator;
+  std::uint64_t seed = 0;
+  std::uint64_t bytes = 0;
+};
+
+// Writes exactly out.size() bytes, a function of `seed` alone.
+using Fill = std::function<void(std::uint64_t seed, std::span<std::byte> out)>;
+
+// A read-only mapping of one dataset, valid until destroyed.
+class Dataset {
+ public:
+  Dataset() = default;
+  ~Dataset();
+  Dataset(Dataset&& other) noexcept;
+  Dataset& operator=(Dataset&& other) noexcept;
+
+  const std::byte* data() const { return data_; }
+  std::size_t size() const { return size_; }
+  // The contents as Ts; a trailing partial T is left out.
+  template <class T>
+  std::span<const T> as() const {
+    static_assert(std::is_trivially_copyable_v<T>);
+    return {reinterpret_cast<const T*>(data_), size_ / sizeof(T)};
+  }
+
+  const std::string& digest() const { return digest_; }
+  const std::string& path() const { return path_; }
+
+ private:
+  friend bool open(const Key&, const Fill&, Dataset&, std::string*,
+                   const std::string&);
+  friend bool open(const Key&, const Fill&, Dataset&, const PageOptions&,
+                   std::string*, const std::string&);
+  void reset();
+
+  const std::byte* data_ = nullptr;
+  std::size_t size_ = 0;
+  std::size_t mapped_ = 0;  // bytes to unmap
+  std::string digest_;
+  std::string path_;
+};
+
+// $LAB_DATASETS, else $XDG_CACHE_HOME/lab/datasets, else
+// ~/.cache/lab/datasets.
+std::string default_directory();
+
+// Maps the dataset of `key` from `dir`, first generating it with `fill`
+// if the directory has none. Safe to call from several processes at once:
+// files appear by rename, so a reader never sees a partial one.
+bool open(const Key& key, const Fill& fill, Dataset& out,
+          std::string* error = nullptr,
+          const std::string& dir = default_directory());
+
+// The same, with the mapping prepared per `pages`: populate reads every
+// page in (a page-cache hit costs a minor fault per 4 KiB otherwise) and
+// lock keeps them resident. A file mapping cannot use huge pages, so
+// hugetlb or thp copy the dataset into such an anonymous mapping instead,
+// which is private to this process.
+bool open(const Key& key, const Fill& fill, Dataset& out,
+          const PageOptions& pages, std::string* error = nullptr,
+          const std::string& dir = default_directory());
+
+// Content address of `bytes`: "xxh64-" and 16 hex digits of XXH64 with
+// seed 0, reading words in host byte order.
+std::string digest(std::span<const std::byte> bytes);
+std::uint64_t xxh64(const void* data, std::size_t size,
+                    std::uint64_t seed = 0);
+
+// Rereads the whole dataset and checks it against its digest.
+bool verify(const Dataset& dataset);
+
+// Generators that give the same bytes on every host of the same byte
+// order: they use their own RNG (SplitMix64) rather than <random>, whose
+// distributions differ between standard libraries.
+
+// Uniformly random bytes.
+void uniform(std::uint64_t seed, std::span<std::byte> out);
+
+// 64-bit ranks in [1, universe], rank r drawn with probability
+// proportional to 1 / r^skew (skew > 0, != 1), as in YCSB. Startup costs
+// O(universe) to sum the distribution. Put both parameters in the key's
+// generator name.
+Fill zipf(std::uint64_t universe, double skew);
+
+}  // namespace lab::dataset
@@ -0,0 +1,287 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+
+namespace lab::dense {
+
+// Dense kernels over row-major matrices in three forms each:
+//
+//   naive       the textbook loop nest
+//   tiled       the same loops over kTile x kTile blocks, kTile fixed at
+//               compile time so the inner loops unroll and vectorize
+//   recursive   cache-oblivious: halve the largest dimension until the
+//               block is small, which fits every cache level at once
+//               without knowing its size
+//
+// `ld*` arguments are leading dimensions, the distance between rows.
+
+// C[m x n] += A[m x k] * B[k x n], in i-j-k order: B is walked down its
+// columns, one cache line per multiply-add once B outgrows the cache.
+template <class T>
+void gemm_naive(const T* a, const T* b, T* c, std::size_t m, std::size_t n,
+                std::size_t k) {
+  for (std::size_t i = 0; i < m; ++i) {
+    for (std::size_t j = 0; j < n; ++j) {
+      T sum = c[i * n + j];
+      for (std::size_t p = 0; p < k; ++p) sum += a[i * k + p] * b[p * n + j];
+      c[i * n + j] = sum;
+    }
+  }
+}
+
+namespace detail {
+
+// i-k-j over one block: streams rows of B and C, so the inner loop
+// vectorizes.
+template <class T>
+void gemm_block(const T* a, std::size_t lda, const T* b, std::size_t ldb,
+                T* c, std::size_t ldc, std::size_t m, std::size_t n,
+                std::size_t k) {
+  for (std::size_t i = 0; i < m; ++i) {
+    T* ci = c + i * ldc;
+    for (std::size_t p = 0; p < k; ++p) {
+      T aip = a[i * lda + p];
+      const T* bp = b + p * ldb;
+      for (std::size_t j = 0; j < n; ++j) ci[j] += aip * bp[j];
+    }
+  }
+}
+
+template <class T>
+void gemm_recursive(const T* a, std::size_t lda, const T* b, std::size_t ldb,
+                    T* c, std::size_t ldc, std::size_t m, std::size_t n,
+                    std::size_t k, std::size_t base) {
+  if (m <= base && n <= base && k <= base) {
+    gemm_block(a, lda, b, ldb, c, ldc, m, n, k);
+  } else if (m >= n && m >= k) {
+    std::size_t h = m / 2;
+    gemm_recursive(a, lda, b, ldb, c, ldc, h, n, k, base);
+    gemm_recursive(a + h * lda, lda, b, ldb, c + h * ldc, ldc, m - h, n, k,
+                   base);
+  } else if (n >= k) {
+    std::size_t h = n / 2;
+    gemm_recursive(a, lda, b, ldb, c, ldc, m, h, k, base);
+    gemm_recursive(a, lda, b + h, ldb, c + h, ldc, m, n - h, k, base);
+  } else {
+    // Both halves add into the same C; one after the other.
+    std::size_t h = k / 2;
+    gemm_recursive(a, lda, b, ldb, c, ldc, m, n, h, base);
+    gemm_recursive(a + h, lda, b + h * ldb, ldb, c, ldc, m, n, k - h, base);
+  }
+}
+
+template <class T>
+void transpose_recursive(const T* in, std::size_t ldin, T* out,
+                         std::size_t ldout, std::size_t rows,
+                         std::size_t cols, std::size_t base) {
+  if (rows <= base && cols <= base) {
+    for (std::size_t i = 0; i < rows; ++i) {
+      for (std::size_t j = 0; j < cols; ++j) {
+        out[j * ldout + i] = in[i * ldin + j];
+      }
+    }
+  } else if (rows >= cols) {
+    std::size_t h = rows / 2;
+    transpose_recursive(in, ldin, out, ldout, h, cols, base);
+    transpose_recursive(in + h * ldin, ldin, out + h, ldout, rows - h, cols,
+                        base);
+  } else {
+    std::size_t h = cols / 2;
+    transpose_recursive(in, ldin, out, ldout, rows, h, base);
+    transpose_recursive(in + h, ldin, out + h * ldout, ldout, rows, cols - h,
+                        base);
+  }
+}
+
+}  // namespace detail
+
+template <std::size_t kTile, class T>
+void gemm_tiled(const T* a, const T* b, T* c, std::size_t m, std::size_t n,
+                std::size_t k) {
+  static_assert(kTile > 0);
+  for (std::size_t i = 0; i < m; i += kTile) {
+    for (std::size_t p = 0; p < k; p += kTile) {
+      for (std::size_t j = 0; j < n; j += kTile) {
+        detail::gemm_block(a + i * k + p, k, b + p * n + j, n, c + i * n + j,
+                           n, std::min(kTile, m - i), std::min(kTile, n - j),
+                           std::min(kTile, k - p));
+      }
+    }
+  }
+}
+
+// Recursion stops at blocks of at most `base` in every dimension, small
+// enough for L1 and large enough to amortize the calls.
+template <class T>
+void gemm_recursive(const T* a, const T* b, T* c, std::size_t m,
+                    std::size_t n, std::size_t k, std::size_t base = 32) {
+  detail::gemm_recursive(a, k, b, n, c, n, m, n, k, std::max<std::size_t>(base, 1));
+}
+
+// out[cols x rows] = transpose(in[rows x cols]). Reads stream; writes
+// stride by `rows`, a new cache line (and often a new page) each.
+template <class T>
+void transpose_naive(const T* in, T* out, std::size_t rows,
+                     std::size_t cols) {
+  for (std::size_t i = 0; i < rows; ++i) {
+    for (std::size_t j = 0; j < cols; ++j) out[j * rows + i] = in[i * cols + j];
+  }
+}
+
+template <std::size_t kTile, class T>
+void transpose_tiled(const T* in, T* out, std::size_t rows,
+                     std::size_t cols) {
+  static_assert(kTile > 0);
+  for (std::size_t i0 = 0; i0 < rows; i0 += kTile) {
+    for (std::size_t j0 = 0; j0 < cols; j0 += kTile) {
+      std::size_t i1 = std::min(i0 + kTile, rows);
+      std::size_t j1 = std::min(j0 + kTile, cols);
+      for (std::size_t i = i0; i < i1; ++i) {
+        for (std::size_t j = j0; j < j1; ++j) {
+          out[j * rows + i] = in[i * cols + j];
+        }
+      }
+    }
+  }
+}
+
+template <class T>
+void transpose_recursive(const T* in, T* out, std::size_t rows,
+                         std::size_t cols, std::size_t base = 16) {
+  detail::transpose_recursive(in, cols, out, rows, rows, cols,
+                              std::max<std::size_t>(base, 1));
+}
+
+// `steps` Jacobi iterations of the 5-point stencil
+//
+//   u'[i][j] = (u[i][j] + u[i-1][j] + u[i+1][j] + u[i][j-1] + u[i][j+1]) / 5
+//
+// over an n x n grid whose border stays fixed. `a` holds the initial grid
+// and `b` is scratch with the same border; the result ends in a when
+// `steps` is even, else in b. Each sweep streams the whole grid, so
+// beyond the LLC every step costs a trip to DRAM.
+template <class T>
+void stencil_naive(T* a, T* b, std::size_t n, std::size_t steps);
+
+// Trapezoidal time tiling: bands of kTile rows advance kTile / 2 steps
+// at a time while they are in cache, shrinking by one row per side per
+// step, and the triangles left between bands are filled in after.
+template <std::size_t kTile, class T>
+void stencil_tiled(T* a, T* b, std::size_t n, std::size_t steps);
+
+// Frigo and Strumpen's cache-oblivious walk over (time, row) space:
+// trapezoids are cut in space while wide and in time while tall.
+template <class T>
+void stencil_recursive(T* a, T* b, std::size_t n, std::size_t steps);
+
+namespace detail {
+
+// Computes rows [x0, x1) between the border rows at `t` + 1 from `t`.
+template <class T>
+void stencil_rows(T* const grid[2], std::size_t n, std::size_t t,
+                  std::size_t x0, std::size_t x1) {
+  const T* in = grid[t & 1];
+  T* out = grid[(t + 1) & 1];
+  for (std::size_t i = x0; i < x1; ++i) {
+    const T* up = in + (i - 1) * n;
+    const T* mid = in + i * n;
+    const T* down = in + (i + 1) * n;
+    T* o = out + i * n;
+    for (std::size_t j = 1; j + 1 < n; ++j) {
+      o[j] = (mid[j] + up[j] + down[j] + mid[j - 1] + mid[j + 1]) / T(5);
+    }
+  }
+}
+
+// Rows [x0 + dx0 * s, x1 + dx1 * s) at step t0 + s, for t0 <= t < t1;
+// slopes are -1, 0 or 1. Signed, as inverted trapezoids start at width 0.
+template <class T>
+void stencil_trapezoid(T* const grid[2], std::size_t n, std::ptrdiff_t t0,
+                       std::ptrdiff_t t1, std::ptrdiff_t x0,
+                       std::ptrdiff_t dx0, std::ptrdiff_t x1,
+                       std::ptrdiff_t dx1) {
+  for (std::ptrdiff_t t = t0; t < t1; ++t) {
+    std::ptrdiff_t lo = x0 + dx0 * (t - t0);
+    std::ptrdiff_t hi = x1 + dx1 * (t - t0);
+    if (lo < hi) {
+      stencil_rows(grid, n, static_cast<std::size_t>(t),
+                   static_cast<std::size_t>(lo), static_cast<std::size_t>(hi));
+    }
+  }
+}
+
+template <class T>
+void stencil_walk(T* const grid[2], std::size_t n, std::ptrdiff_t t0,
+                  std::ptrdiff_t t1, std::ptrdiff_t x0, std::ptrdiff_t dx0,
+                  std::ptrdiff_t x1, std::ptrdiff_t dx1) {
+  std::ptrdiff_t dt = t1 - t0;
+  if (dt == 1) {
+    stencil_trapezoid(grid, n, t0, t1, x0, dx0, x1, dx1);
+  } else if (dt > 1) {
+    if (2 * (x1 - x0) + (dx1 - dx0) * dt >= 4 * dt) {
+      // Wide: cut along a line of slope -1 through the middle.
+      std::ptrdiff_t xm = (2 * (x0 + x1) + (2 + dx0 + dx1) * dt) / 4;
+      stencil_walk(grid, n, t0, t1, x0, dx0, xm, -1);
+      stencil_walk(grid, n, t0, t1, xm, -1, x1, dx1);
+    } else {
+      std::ptrdiff_t s = dt / 2;
+      stencil_walk(grid, n, t0, t0 + s, x0, dx0, x1, dx1);
+      stencil_walk(grid, n, t0 + s, t1, x0 + dx0 * s, dx0, x1 + dx1 * s,
+                   dx1);
+    }
+  }
+}
+
+}  // namespace detail
+
+template <class T>
+void stencil_naive(T* a, T* b, std::size_t n, std::size_t steps) {
+  if (n < 3) return;
+  T* grid[2] = {a, b};
+  for (std::size_t t = 0; t < steps; ++t) {
+    detail::stencil_rows(grid, n, t, 1, n - 1);
+  }
+}
+
+template <std::size_t kTile, class T>
+void stencil_tiled(T* a, T* b, std::size_t n, std::size_t steps) {
+  static_assert(kTile >= 2);
+  if (n < 3) return;
+  T* grid[2] = {a, b};
+  constexpr auto kHeight = static_cast<std::ptrdiff_t>(kTile / 2);
+  auto first = std::ptrdiff_t{1};
+  auto last = static_cast<std::ptrdiff_t>(n - 1);
+  // Band starts; the last band takes the remainder, so every band is at
+  // least kTile rows and its triangles never meet a neighbour's.
+  std::ptrdiff_t bands =
+      std::max<std::ptrdiff_t>(1, (last - first) / static_cast<std::ptrdiff_t>(kTile));
+  auto start = [&](std::ptrdiff_t i) {
+    return i == bands ? last
+                      : first + i * static_cast<std::ptrdiff_t>(kTile);
+  };
+  for (std::ptrdiff_t t0 = 0; t0 < static_cast<std::ptrdiff_t>(steps);
+       t0 += kHeight) {
+    std::ptrdiff_t t1 =
+        std::min(t0 + kHeight, static_cast<std::ptrdiff_t>(steps));
+    // The grid border is fixed, so bands touching it do not shrink there.
+    for (std::ptrdiff_t i = 0; i < bands; ++i) {
+      detail::stencil_trapezoid(grid, n, t0, t1, start(i), i == 0 ? 0 : 1,
+                                start(i + 1), i + 1 == bands ? 0 : -1);
+    }
+    for (std::ptrdiff_t i = 1; i < bands; ++i) {
+      detail::stencil_trapezoid(grid, n, t0, t1, start(i), -1, start(i), 1);
+    }
+  }
+}
+
+template <class T>
+void stencil_recursive(T* a, T* b, std::size_t n, std::size_t steps) {
+  if (n < 3) return;
+  T* grid[2] = {a, b};
+  detail::stencil_walk(grid, n, 0, static_cast<std::ptrdiff_t>(steps), 1, 0,
+                       static_cast<std::ptrdiff_t>(n - 1), 0);
+}
+
+}  // namespace lab::dense
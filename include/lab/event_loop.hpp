@@ -0,0 +1,213 @@
+#pragma once
+
+#include <sys/socket.h>
+
+#include <chrono>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "lab/scheduler.hpp"
+#include "lab/task.hpp"
+
+namespace lab {
+
+// A single-threaded coroutine event loop over io_uring. Every coroutine of
+// a loop runs on the thread inside run(); awaiting an I/O operation queues
+// one io_uring request, and the loop resumes the coroutine when its
+// completion arrives. Requests are submitted in batches whenever the loop
+// runs out of ready coroutines.
+//
+//   lab::task<> echo(lab::EventLoop& loop, int fd) {
+//     char buf[512];
+//     for (int n; (n = co_await loop.read(fd, buf, sizeof buf)) > 0;) {
+//       co_await loop.write(fd, buf, n);
+//     }
+//   }
+//
+// CPU-heavy work can be moved to a lab::Scheduler with offload(), which
+// resumes the coroutine back on the loop thread.
+class EventLoop {
+ public:
+  struct Options {
+    unsigned entries = 4096;  // submission queue size
+    // Completion queue size, clamped to the kernel's limit. Completions
+    // that do not fit wait in the kernel until the loop catches up.
+    unsigned completions = 1 << 16;
+  };
+
+  // One io_uring request. co_await yields its result: bytes transferred,
+  // an accepted descriptor or 0, and -errno on failure.
+  class [[nodiscard]] Op {
+   public:
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> h) {
+      waiter_ = h;
+      loop_->submit(*this);
+    }
+    int await_resume() const noexcept { return result_; }
+
+   private:
+    friend class EventLoop;
+    enum class Kind : std::uint8_t { read, write, accept, connect, timeout };
+
+    Op(EventLoop* loop, Kind kind, int fd, const void* addr,
+       std::uint64_t len, std::uint64_t offset)
+        : loop_(loop),
+          kind_(kind),
+          fd_(fd),
+          addr_(addr),
+          len_(len),
+          offset_(offset) {}
+
+    EventLoop* loop_;
+    Kind kind_;
+    int fd_;
+    const void* addr_;
+    std::uint64_t len_;
+    std::uint64_t offset_;
+    std::int64_t timeout_[2] = {0, 0};  // seconds, nanoseconds
+    std::coroutine_handle<> waiter_;
+    int result_ = 0;
+  };
+
+  // For read() and write() on sockets and pipes, or to use and advance
+  // the file position.
+  static constexpr std::uint64_t kNoOffset = ~std::uint64_t{0};
+
+  EventLoop();
+  ~EventLoop();
+  EventLoop(const EventLoop&) = delete;
+  EventLoop& operator=(const EventLoop&) = delete;
+
+  // Sets up the ring. Returns false and sets `error` if io_uring is not
+  // available; nothing else may be called then.
+  bool init(const Options& opts, std::string* error = nullptr);
+  bool init(std::string* error = nullptr) { return init(Options{}, error); }
+
+  Op read(int fd, void* buf, std::size_t n, std::uint64_t offset = kNoOffset) {
+    return {this, Op::Kind::read, fd, buf, n, offset};
+  }
+  Op write(int fd, const void* buf, std::size_t n,
+           std::uint64_t offset = kNoOffset) {
+    return {this, Op::Kind::write, fd, buf, n, offset};
+  }
+  // Yields the accepted descriptor.
+  Op accept(int listen_fd) {
+    return {this, Op::Kind::accept, listen_fd, nullptr, 0, 0};
+  }
+  Op connect(int fd, const sockaddr* addr, socklen_t len) {
+    return {this, Op::Kind::connect, fd, addr, len, 0};
+  }
+  // Yields 0 after `d` has elapsed.
+  Op sleep_for(std::chrono::nanoseconds d) {
+    Op op{this, Op::Kind::timeout, -1, nullptr, 0, 0};
+    op.timeout_[0] = d.count() / 1000000000;
+    op.timeout_[1] = d.count() % 1000000000;
+    return op;
+  }
+
+  // Runs f() on `pool` and resumes the awaiting coroutine on the loop
+  // thread with its result.
+  template <class F>
+  auto offload(Scheduler& pool, F f);
+
+  // Starts `t` now, running it until its first suspension; the loop owns
+  // it from then on. An exception escaping it terminates the process.
+  void spawn(task<> t);
+
+  // Runs until every spawned task has finished.
+  void run();
+
+  // Runs until `t` finishes and returns its result; other spawned tasks
+  // only make progress meanwhile.
+  template <class T>
+  T run(task<T> t);
+
+  // Resumes `h` on the loop thread; any thread may call this.
+  void post(std::coroutine_handle<> h);
+
+  // Coroutines spawned and not yet finished.
+  std::size_t live() const { return live_; }
+
+ private:
+  struct Impl;
+
+  void submit(Op& op);
+  // Submits pending requests, waits for at least one completion or posted
+  // coroutine and resumes the coroutines they belong to.
+  void poll();
+
+  std::unique_ptr<Impl> impl_;
+  std::size_t live_ = 0;
+};
+
+// Implementation of offload().
+namespace detail {
+
+template <class F, class R = std::invoke_result_t<F&>>
+struct OffloadAwaiter {
+  EventLoop* loop;
+  Scheduler* pool;
+  F f;
+  std::optional<std::conditional_t<std::is_void_v<R>, bool, R>> result;
+
+  bool await_ready() const noexcept { return false; }
+  void await_suspend(std::coroutine_handle<> h);
+  R await_resume() {
+    if constexpr (!std::is_void_v<R>) return std::move(*result);
+  }
+};
+
+template <class F, class R>
+void OffloadAwaiter<F, R>::await_suspend(std::coroutine_handle<> h) {
+  pool->spawn([this, h] {
+    if constexpr (std::is_void_v<R>) {
+      f();
+      result.emplace(true);
+    } else {
+      result.emplace(f());
+    }
+    loop->post(h);
+  });
+}
+
+}  // namespace detail
+
+template <class F>
+auto EventLoop::offload(Scheduler& pool, F f) {
+  return detail::OffloadAwaiter<F>{this, &pool, std::move(f), {}};
+}
+
+template <class T>
+T EventLoop::run(task<T> t) {
+  std::optional<std::conditional_t<std::is_void_v<T>, bool, T>> result;
+  std::exception_ptr error;
+  bool done = false;
+  auto wrapper = [](task<T>& inner, decltype(result)& out,
+                    std::exception_ptr& err, bool& finished) -> task<> {
+    try {
+      if constexpr (std::is_void_v<T>) {
+        co_await inner;
+        out.emplace(true);
+      } else {
+        out.emplace(co_await inner);
+      }
+    } catch (...) {
+      err = std::current_exception();
+    }
+    finished = true;
+  };
+  spawn(wrapper(t, result, error, done));
+  while (!done) poll();
+  if (error) std::rethrow_exception(error);
+  if constexpr (!std::is_void_v<T>) return std::move(*result);
+}
+
+}  // namespace lab
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace lab::flat {
+
+// A zero-copy binary format. Records are plain structs whose strings and
+// arrays are flat::String and flat::Vector fields, holding an offset
+// relative to the field itself. An encoded buffer has no pointers and
+// needs no decoding: reading is pointer arithmetic over the bytes, which
+// may come from a file mmap'd at any address.
+//
+//   struct Item { std::uint64_t sku; lab::flat::String name; };
+//   struct Order { lab::flat::Vector<Item> items; };
+//
+//   lab::flat::Builder b;
+//   auto order = b.add<Order>();
+//   auto item = b.set(b.field(order, &Order::items), 1);
+//   b[item].sku = 7;
+//   b.set(b.field(item, &Item::name), "bolt");
+//   std::string_view bytes = b.finish(order);
+//
+//   const Order* o = lab::flat::root<Order>(bytes.data(), bytes.size());
+//   o->items[0].name.view();  // "bolt"
+//
+// Records must be trivially copyable with alignment of at most 8. The
+// byte order is the host's.
+struct String {
+  std::uint32_t offset = 0;
+  std::uint32_t size = 0;
+
+  std::string_view view() const {
+    return {reinterpret_cast<const char*>(this) + offset, size};
+  }
+  bool empty() const { return size == 0; }
+};
+
+template <class T>
+struct Vector {
+  std::uint32_t offset = 0;
+  std::uint32_t count = 0;
+
+  const T* data() const {
+    return reinterpret_cast<const T*>(reinterpret_cast<const char*>(this) +
+                                      offset);
+  }
+  std::size_t size() const { return count; }
+  bool empty() const { return count == 0; }
+  const T& operator[](std::size_t i) const { return data()[i]; }
+  const T* begin() const { return data(); }
+  const T* end() const { return data() + count; }
+};
+
+// Leads every buffer.
+struct Header {
+  char magic[4];
+  std::uint32_t version;
+  std::uint32_t root;  // offset of the root record
+  std::uint32_t size;  // of the whole buffer
+};
+
+inline constexpr char kMagic[4] = {'L', 'A', 'B', 'F'};
+inline constexpr std::uint32_t kVersion = 1;
+
+// Location of a T inside a Builder's buffer.
+template <class T>
+struct Ref {
+  std::uint32_t offset;
+};
+
+class Builder {
+ public:
+  Builder() { clear(); }
+
+  // Starts a new buffer, keeping the allocated capacity.
+  void clear() { bytes_.assign(sizeof(Header), 0); }
+
+  // A zero-initialized T at the end of the buffer.
+  template <class T>
+  Ref<T> add() {
+    static_assert(checked<T>());
+    return {allocate(sizeof(T), alignof(T))};
+  }
+
+  // The record at `r`. Valid until the next add() or set(), which may
+  // move the buffer.
+  template <class T>
+  T& operator[](Ref<T> r) {
+    return *reinterpret_cast<T*>(bytes_.data() + r.offset);
+  }
+
+  template <class P, class F>
+  Ref<F> field(Ref<P> parent, F P::*member) {
+    auto* f = reinterpret_cast<char*>(&((*this)[parent].*member));
+    return {static_cast<std::uint32_t>(f - bytes_.data())};
+  }
+
+  template <class T>
+  static Ref<T> element(Ref<T> first, std::size_t i) {
+    return {static_cast<std::uint32_t>(first.offset + i * sizeof(T))};
+  }
+
+  // Stores a copy of `s` and points the field at it.
+  void set(Ref<String> at, std::string_view s) {
+    if (s.empty()) return;
+    std::uint32_t to = allocate(s.size(), 1);
+    std::memcpy(bytes_.data() + to, s.data(), s.size());
+    (*this)[at] = {to - at.offset, static_cast<std::uint32_t>(s.size())};
+  }
+
+  // Allocates `n` zero-initialized elements for the field and returns the
+  // first; use element() for the others.
+  template <class T>
+  Ref<T> set(Ref<Vector<T>> at, std::size_t n) {
+    static_assert(checked<T>());
+    std::uint32_t to = allocate(n * sizeof(T), alignof(T));
+    if (n != 0) {
+      (*this)[at] = {to - at.offset, static_cast<std::uint32_t>(n)};
+    }
+    return {to};
+  }
+
+  // Fills in the header and returns the encoded bytes, valid until the
+  // builder changes.
+  template <class T>
+  std::string_view finish(Ref<T> root) {
+    Header h;
+    std::memcpy(h.magic, kMagic, sizeof h.magic);
+    h.version = kVersion;
+    h.root = root.offset;
+    h.size = static_cast<std::uint32_t>(bytes_.size());
+    std::memcpy(bytes_.data(), &h, sizeof h);
+    return {bytes_.data(), bytes_.size()};
+  }
+
+  std::size_t size() const { return bytes_.size(); }
+
+ private:
+  template <class T>
+  static constexpr bool checked() {
+    static_assert(std::is_trivially_copyable_v<T>);
+    static_assert(alignof(T) <= 8);
+    return true;
+  }
+
+  std::uint32_t allocate(std::size_t n, std::size_t align) {
+    std::size_t at = (bytes_.size() + align - 1) & ~(align - 1);
+    bytes_.resize(at + n);
+    return static_cast<std::uint32_t>(at);
+  }
+
+  std::vector<char> bytes_;
+};
+
+// The root record of an encoded buffer, which must be 8-byte aligned, or
+// nullptr if the header does not match. Only the header is checked: the
+// records are trusted.
+template <class T>
+const T* root(const void* data, std::size_t size,
+              std::string* error = nullptr) {
+  auto fail = [&](const char* what) -> const T* {
+    if (error != nullptr) *error = what;
+    return nullptr;
+  };
+  if (reinterpret_cast<std::uintptr_t>(data) % 8 != 0) {
+    return fail("buffer not 8-byte aligned");
+  }
+  if (size < sizeof(Header)) return fail("buffer smaller than its header");
+  Header h;
+  std::memcpy(&h, data, sizeof h);
+  if (std::memcmp(h.magic, kMagic, sizeof h.magic) != 0) {
+    return fail("not a flat buffer");
+  }
+  if (h.version != kVersion) return fail("unsupported flat buffer version");
+  if (h.size > size || sizeof(T) > h.size || h.root < sizeof(Header) ||
+      h.root > h.size - sizeof(T) || h.root % alignof(T) != 0) {
+    return fail("flat buffer truncated");
+  }
+  return reinterpret_cast<const T*>(static_cast<const char*>(data) + h.root);
+}
+
+}  // namespace lab::flat
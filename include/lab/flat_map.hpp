@@ -0,0 +1,347 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <new>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace lab {
+
+// std::hash followed by a multiply-xorshift finaliser. std::hash is the
+// identity for integers on common standard libraries, which would leave
+// FlatMap's 7-bit tags (the top bits) constant for small keys.
+template <class K>
+struct MixHash {
+  std::size_t operator()(const K& key) const {
+    std::uint64_t h = std::hash<K>{}(key);
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    return static_cast<std::size_t>(h);
+  }
+};
+
+namespace detail {
+
+// Control byte per slot: empty, deleted (tombstone), or the 7-bit tag of a
+// full slot's hash. Empty and deleted are the only negative values.
+using ctrl_t = std::int8_t;
+inline constexpr ctrl_t kEmpty = -128;
+inline constexpr ctrl_t kDeleted = -2;
+
+// Set bits of a match, one slot every `Shift` bits.
+template <int Shift>
+class BitMask {
+ public:
+  explicit BitMask(std::uint64_t bits) : bits_(bits) {}
+  explicit operator bool() const { return bits_ != 0; }
+  int lowest() const { return std::countr_zero(bits_) / Shift; }
+  void clear_lowest() { bits_ &= bits_ - 1; }
+
+ private:
+  std::uint64_t bits_;
+};
+
+// Sixteen control bytes compared at once.
+struct Group {
+  static constexpr std::size_t kWidth = 16;
+
+#if defined(__SSE2__)
+  using Mask = BitMask<1>;
+  explicit Group(const ctrl_t* ctrl)
+      : v_(_mm_load_si128(reinterpret_cast<const __m128i*>(ctrl))) {}
+  Mask match(ctrl_t tag) const {
+    return Mask(static_cast<std::uint32_t>(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(tag), v_))));
+  }
+  Mask match_empty_or_deleted() const {
+    return Mask(static_cast<std::uint32_t>(_mm_movemask_epi8(v_)));
+  }
+  __m128i v_;
+#elif defined(__ARM_NEON)
+  // No movemask: narrow each byte to a nibble of a 64-bit mask, keeping
+  // one bit per nibble so clear_lowest() clears one slot.
+  using Mask = BitMask<4>;
+  explicit Group(const ctrl_t* ctrl) : v_(vld1q_s8(ctrl)) {}
+  static Mask to_mask(uint8x16_t bytes) {
+    std::uint64_t bits = vget_lane_u64(
+        vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(bytes), 4)), 0);
+    return Mask(bits & 0x8888888888888888ull);
+  }
+  Mask match(ctrl_t tag) const {
+    return to_mask(vceqq_s8(vdupq_n_s8(tag), v_));
+  }
+  Mask match_empty_or_deleted() const { return to_mask(vcltzq_s8(v_)); }
+  int8x16_t v_;
+#else
+  using Mask = BitMask<1>;
+  explicit Group(const ctrl_t* ctrl) { std::memcpy(v_, ctrl, kWidth); }
+  Mask match(ctrl_t tag) const {
+    std::uint32_t bits = 0;
+    for (std::size_t i = 0; i < kWidth; ++i) bits |= (v_[i] == tag) << i;
+    return Mask(bits);
+  }
+  Mask match_empty_or_deleted() const {
+    std::uint32_t bits = 0;
+    for (std::size_t i = 0; i < kWidth; ++i) bits |= (v_[i] < 0) << i;
+    return Mask(bits);
+  }
+  ctrl_t v_[kWidth];
+#endif
+
+  Mask match_empty() const { return match(kEmpty); }
+};
+
+}  // namespace detail
+
+// Open-addressing hash map in the SwissTable style, with control bytes,
+// keys and values in three separate arrays so that probing touches only
+// the dense control bytes until a tag matches.
+//
+// Slots form aligned groups of 16. A lookup hashes once, takes the group
+// from the low bits and a 7-bit tag from the high bits, compares the tag
+// against all 16 control bytes in one SIMD step (SSE2 or NEON), and
+// moves on to the next group in triangular order only if the group holds
+// no empty slot. Erase leaves a tombstone only when the group is full, so
+// probe chains stay short. The load factor stays below 7/8.
+//
+// Pointers and references into the map are invalidated by any insert
+// that grows it.
+template <class K, class V, class Hash = MixHash<K>,
+          class Eq = std::equal_to<K>>
+class FlatMap {
+ public:
+  FlatMap() = default;
+  explicit FlatMap(std::size_t expected) { reserve(expected); }
+  ~FlatMap() { destroy(); }
+
+  FlatMap(FlatMap&& other) noexcept { swap(other); }
+  FlatMap& operator=(FlatMap&& other) noexcept {
+    if (this != &other) {
+      destroy();
+      swap(other);
+    }
+    return *this;
+  }
+  FlatMap(const FlatMap&) = delete;
+  FlatMap& operator=(const FlatMap&) = delete;
+
+  std::size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  std::size_t capacity() const { return capacity_; }
+
+  V* find(const K& key) {
+    std::size_t slot = find_slot(key, hash_(key));
+    return slot == kNone ? nullptr : &values_[slot];
+  }
+  const V* find(const K& key) const {
+    return const_cast<FlatMap*>(this)->find(key);
+  }
+  bool contains(const K& key) const { return find(key) != nullptr; }
+
+  // Inserts key -> value unless the key is present. Returns the stored
+  // value and whether it was inserted.
+  template <class... Args>
+  std::pair<V*, bool> try_emplace(const K& key, Args&&... args) {
+    std::size_t hash = hash_(key);
+    if (std::size_t slot = find_slot(key, hash); slot != kNone) {
+      return {&values_[slot], false};
+    }
+    if (growth_left_ == 0) rehash_for_insert();
+    std::size_t slot = find_free_slot(hash);
+    if (ctrl_[slot] == detail::kEmpty) --growth_left_;
+    ctrl_[slot] = tag(hash);
+    ::new (&keys_[slot]) K(key);
+    ::new (&values_[slot]) V(std::forward<Args>(args)...);
+    ++size_;
+    return {&values_[slot], true};
+  }
+
+  bool insert(const K& key, V value) {
+    return try_emplace(key, std::move(value)).second;
+  }
+
+  V& operator[](const K& key) { return *try_emplace(key).first; }
+
+  bool erase(const K& key) {
+    std::size_t slot = find_slot(key, hash_(key));
+    if (slot == kNone) return false;
+    keys_[slot].~K();
+    values_[slot].~V();
+    --size_;
+    // A group that has an empty slot ends every probe passing through it,
+    // so its slots can go back to empty; a full one needs a tombstone.
+    std::size_t group = slot & ~(detail::Group::kWidth - 1);
+    if (detail::Group(ctrl_ + group).match_empty()) {
+      ctrl_[slot] = detail::kEmpty;
+      ++growth_left_;
+    } else {
+      ctrl_[slot] = detail::kDeleted;
+    }
+    return true;
+  }
+
+  void clear() {
+    for_each_slot([&](std::size_t slot) {
+      keys_[slot].~K();
+      values_[slot].~V();
+    });
+    if (capacity_ != 0) std::memset(ctrl_, detail::kEmpty, capacity_);
+    size_ = 0;
+    growth_left_ = max_load(capacity_);
+  }
+
+  // Makes room for `n` elements without further rehashing.
+  void reserve(std::size_t n) {
+    std::size_t cap = detail::Group::kWidth;
+    while (max_load(cap) < n) cap *= 2;
+    if (cap > capacity_) rehash(cap);
+  }
+
+  // Calls f(const K&, V&) for every element, in slot order.
+  template <class F>
+  void for_each(F&& f) {
+    for_each_slot([&](std::size_t slot) { f(keys_[slot], values_[slot]); });
+  }
+
+  void swap(FlatMap& other) noexcept {
+    std::swap(ctrl_, other.ctrl_);
+    std::swap(keys_, other.keys_);
+    std::swap(values_, other.values_);
+    std::swap(capacity_, other.capacity_);
+    std::swap(size_, other.size_);
+    std::swap(growth_left_, other.growth_left_);
+    std::swap(hash_, other.hash_);
+    std::swap(eq_, other.eq_);
+  }
+
+ private:
+  static constexpr std::size_t kNone = ~std::size_t{0};
+
+  static std::size_t max_load(std::size_t cap) { return cap - cap / 8; }
+  static detail::ctrl_t tag(std::size_t hash) {
+    return static_cast<detail::ctrl_t>(hash >> (sizeof(std::size_t) * 8 - 7));
+  }
+
+  // Calls visit(first slot of group) from the hash's home group on until
+  // it returns true. Triangular steps reach every group of a power-of-two
+  // table within `groups` steps.
+  template <class F>
+  void probe(std::size_t hash, F&& visit) const {
+    std::size_t groups = capacity_ / detail::Group::kWidth;
+    std::size_t g = hash & (groups - 1);
+    for (std::size_t step = 1; step <= groups; ++step) {
+      if (visit(g * detail::Group::kWidth)) return;
+      g = (g + step) & (groups - 1);
+    }
+  }
+
+  std::size_t find_slot(const K& key, std::size_t hash) const {
+    if (capacity_ == 0) return kNone;
+    detail::ctrl_t t = tag(hash);
+    std::size_t found = kNone;
+    probe(hash, [&](std::size_t base) {
+      detail::Group group(ctrl_ + base);
+      for (auto m = group.match(t); m; m.clear_lowest()) {
+        std::size_t slot = base + static_cast<std::size_t>(m.lowest());
+        if (eq_(keys_[slot], key)) {
+          found = slot;
+          return true;
+        }
+      }
+      // An empty slot means the key was never placed further along.
+      return static_cast<bool>(group.match_empty());
+    });
+    return found;
+  }
+
+  // Growth left guarantees a free slot exists.
+  std::size_t find_free_slot(std::size_t hash) const {
+    std::size_t found = kNone;
+    probe(hash, [&](std::size_t base) {
+      auto m = detail::Group(ctrl_ + base).match_empty_or_deleted();
+      if (m) found = base + static_cast<std::size_t>(m.lowest());
+      return static_cast<bool>(m);
+    });
+    return found;
+  }
+
+  template <class F>
+  void for_each_slot(F&& f) {
+    for (std::size_t slot = 0; slot < capacity_; ++slot) {
+      if (ctrl_[slot] >= 0) f(slot);
+    }
+  }
+
+  // Out of growth: reclaim tombstones in place when they are most of the
+  // used slots, otherwise double.
+  void rehash_for_insert() {
+    if (capacity_ != 0 && size_ <= max_load(capacity_) / 2) {
+      rehash(capacity_);
+    } else {
+      rehash(capacity_ == 0 ? detail::Group::kWidth : capacity_ * 2);
+    }
+  }
+
+  void rehash(std::size_t cap) {
+    FlatMap next;
+    next.allocate(cap);
+    for_each_slot([&](std::size_t slot) {
+      std::size_t hash = hash_(keys_[slot]);
+      std::size_t to = next.find_free_slot(hash);
+      next.ctrl_[to] = tag(hash);
+      ::new (&next.keys_[to]) K(std::move(keys_[slot]));
+      ::new (&next.values_[to]) V(std::move(values_[slot]));
+      --next.growth_left_;
+      ++next.size_;
+    });
+    destroy();
+    swap(next);
+  }
+
+  void allocate(std::size_t cap) {
+    ctrl_ = static_cast<detail::ctrl_t*>(
+        ::operator new(cap, std::align_val_t{detail::Group::kWidth}));
+    std::memset(ctrl_, detail::kEmpty, cap);
+    keys_ = std::allocator<K>().allocate(cap);
+    values_ = std::allocator<V>().allocate(cap);
+    capacity_ = cap;
+    growth_left_ = max_load(cap);
+  }
+
+  void destroy() {
+    if (capacity_ == 0) return;
+    for_each_slot([&](std::size_t slot) {
+      keys_[slot].~K();
+      values_[slot].~V();
+    });
+    ::operator delete(ctrl_, std::align_val_t{detail::Group::kWidth});
+    std::allocator<K>().deallocate(keys_, capacity_);
+    std::allocator<V>().deallocate(values_, capacity_);
+    ctrl_ = nullptr;
+    keys_ = nullptr;
+    values_ = nullptr;
+    capacity_ = size_ = growth_left_ = 0;
+  }
+
+  detail::ctrl_t* ctrl_ = nullptr;
+  K* keys_ = nullptr;
+  V* values_ = nullptr;
+  std::size_t capacity_ = 0;
+  std::size_t size_ = 0;
+  std::size_t growth_left_ = 0;
+  [[no_unique_address]] Hash hash_;
+  [[no_unique_address]] Eq eq_;
+};
+
+}  // namespace lab
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace lab::graph {
+
+// Undirected graph in compressed sparse row form: the neighbours of v are
+// targets[offsets[v] .. offsets[v + 1]), and every edge is stored in both
+// directions.
+struct Csr {
+  std::vector<std::uint64_t> offsets{0};
+  std::vector<std::uint32_t> targets;
+
+  std::uint32_t vertices() const {
+    return static_cast<std::uint32_t>(offsets.size() - 1);
+  }
+  std::uint64_t edges() const { return targets.size(); }
+  std::uint32_t degree(std::uint32_t v) const {
+    return static_cast<std::uint32_t>(offsets[v + 1] - offsets[v]);
+  }
+  std::span<const std::uint32_t> neighbours(std::uint32_t v) const {
+    return {targets.data() + offsets[v], degree(v)};
+  }
+};
+
+// A graph with a position for every vertex.
+struct Geometric {
+  Csr csr;
+  std::vector<float> x, y;  // in [0, 1)
+};
+
+// Random geometric graph standing in for a road or social graph: vertices
+// at uniform points of the unit square, joined when closer than the radius
+// that gives `degree` neighbours on average, plus one vertex in a hundred
+// as a hub with `degree` extra edges to random vertices anywhere. Ids come
+// in generation order, i.e. unrelated to position, as from an ingest.
+Geometric geometric(std::uint32_t vertices, double degree,
+                    std::uint64_t seed);
+
+// Layouts. Each returns new_id, with new_id[v] the position of vertex v.
+
+// Highest degree first, so hubs and their hot data share cache lines.
+std::vector<std::uint32_t> degree_order(const Csr& g);
+
+// Along a Hilbert curve over the positions, so that vertices near in space,
+// and so likely neighbours, are near in memory.
+std::vector<std::uint32_t> hilbert_order(std::span<const float> x,
+                                         std::span<const float> y);
+
+// Distance of (x, y) along the Hilbert curve that fills the
+// 2^order x 2^order grid, starting at (0, 0) and ending at (2^order - 1, 0).
+std::uint64_t hilbert_index(std::uint32_t x, std::uint32_t y, int order);
+
+// The same graph with vertex v renamed new_id[v]; neighbour lists are
+// sorted.
+Csr permute(const Csr& g, std::span<const std::uint32_t> new_id);
+
+// Kernels.
+
+inline constexpr std::uint32_t kUnreached =
+    std::numeric_limits<std::uint32_t>::max();
+
+// Hop count from `source` to every vertex, kUnreached if none.
+std::vector<std::uint32_t> bfs(const Csr& g, std::uint32_t source);
+
+// `iterations` rounds of pull-style PageRank; vertices without edges keep
+// only the teleport share.
+std::vector<double> pagerank(const Csr& g, int iterations,
+                             double damping = 0.85);
+
+}  // namespace lab::graph
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace lab {
+
+// A log-bucketed histogram of non-negative integers in the style of
+// HdrHistogram. Each power-of-two range is split into equal sub-buckets,
+// so any recorded value is reported within a relative error of
+// 10^-significant_digits, from 0 up to 2^64-1, in memory that grows with
+// the largest value seen (about 170 KiB for nanoseconds up to a second at
+// the default 3 digits).
+//
+// Recording is not synchronized: give each thread its own histogram and
+// merge() them once the threads are done.
+class Histogram {
+ public:
+  // `significant_digits` is clamped to [1, 5].
+  explicit Histogram(int significant_digits = 3);
+
+  void record(std::uint64_t value, std::uint64_t count = 1) {
+    std::size_t i = index_of(value);
+    if (i >= counts_.size()) counts_.resize(i + 1);
+    counts_[i] += count;
+    total_ += count;
+    sum_ += value * count;
+    if (value < min_) min_ = value;
+    if (value > max_) max_ = value;
+  }
+
+  // Adds the other histogram's values. Those of a histogram with another
+  // precision are re-bucketed at this one's, from their bucket midpoints.
+  void merge(const Histogram& other);
+  void clear();
+
+  int significant_digits() const { return digits_; }
+  std::uint64_t count() const { return total_; }
+  bool empty() const { return total_ == 0; }
+  // Exact, unlike percentiles; 0 when empty.
+  std::uint64_t min() const { return total_ == 0 ? 0 : min_; }
+  std::uint64_t max() const { return max_; }
+  double mean() const;
+
+  // The value at quantile `q` in [0, 1]: the top of the bucket holding the
+  // ceil(q * count())-th smallest value, capped by max().
+  std::uint64_t percentile(double q) const;
+
+  // A compact text form without whitespace, e.g. for a results column:
+  //
+  //   hdr1:<digits>:<min>:<max>:<sum>:<gap>*<count>,<gap>*<count>,...
+  //
+  // listing the non-empty buckets in order. Each <gap> counts the buckets
+  // skipped since the previous one.
+  std::string serialize() const;
+  // Parses serialize() output, replacing the contents of `out`.
+  static bool deserialize(std::string_view text, Histogram& out,
+                          std::string* error = nullptr);
+
+ private:
+  std::size_t index_of(std::uint64_t value) const {
+    if (value < sub_count_) return static_cast<std::size_t>(value);
+    int shift = 63 - std::countl_zero(value) - half_bits_;
+    std::uint64_t sub = value >> shift;
+    return static_cast<std::size_t>(sub_count_ + (shift - 1) * half_count() +
+                                    (sub - half_count()));
+  }
+  std::uint64_t half_count() const { return sub_count_ >> 1; }
+  // Smallest and largest value falling into bucket `index`.
+  std::uint64_t lowest(std::size_t index) const;
+  std::uint64_t highest(std::size_t index) const;
+
+  int digits_;
+  int half_bits_;           // log2(sub_count_) - 1
+  std::uint64_t sub_count_;  // buckets per power-of-two range
+  std::vector<std::uint64_t> counts_;
+  std::uint64_t total_ = 0;
+  std::uint64_t sum_ = 0;
+  std::uint64_t min_ = ~std::uint64_t{0};
+  std::uint64_t max_ = 0;
+};
+
+}  // namespace lab
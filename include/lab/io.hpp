@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace lab::io {
+
+// Interchangeable ways to move a file through memory:
+//
+//   read    buffered read()/write() on a plain descriptor
+//   pread   pread()/pwrite() at explicit offsets, with sequential
+//           readahead hints (posix_fadvise)
+//   mmap    a shared mapping with madvise(MADV_SEQUENTIAL); writes are
+//           memcpy plus msync
+//   uring   io_uring with registered (fixed) buffers and queue_depth
+//           requests in flight, driven by raw syscalls
+//   direct  O_DIRECT pread()/pwrite(), bypassing the page cache
+enum class Backend { read, pread, mmap, uring, direct };
+
+inline constexpr Backend kAllBackends[] = {Backend::read, Backend::pread,
+                                           Backend::mmap, Backend::uring,
+                                           Backend::direct};
+
+const char* backend_name(Backend backend);
+
+// False, with the reason in `why`, when the kernel refuses the backend
+// (e.g. io_uring disabled by sysctl or seccomp).
+bool backend_available(Backend backend, std::string* why = nullptr);
+
+// Block sizes must be multiples of this, the O_DIRECT alignment.
+inline constexpr std::size_t kAlignment = 4096;
+
+struct Options {
+  std::size_t block_size = 1 << 20;  // bytes per request
+  unsigned queue_depth = 8;          // requests in flight (uring)
+  bool record_latency = true;        // fill Stats::latency_ns
+};
+
+struct Stats {
+  std::uint64_t bytes = 0;
+  std::uint64_t requests = 0;
+  double seconds = 0;      // wall time of the whole pass
+  // User + system time of the process, which includes io_uring's kernel
+  // workers but also any other busy thread.
+  double cpu_seconds = 0;
+  // Per request: the syscall, the submit-to-completion time for uring, or
+  // for mmap the page faults taken by touching the block.
+  std::vector<double> latency_ns;
+};
+
+// Called once per block with its file offset. Blocks arrive in file order
+// except with uring, where they arrive in completion order.
+using Consumer =
+    std::function<void(std::uint64_t offset, const char* data, std::size_t size)>;
+
+// What write_file writes: every 4 KiB page starts with its file offset as
+// a native-endian uint64_t, followed by pattern_byte(i) at page offset i.
+inline std::uint8_t pattern_byte(std::size_t i) {
+  return static_cast<std::uint8_t>((i * 131) ^ (i >> 8));
+}
+
+// Reads the whole file at `path`. Returns false and sets `error` on
+// failure; `stats` may be null.
+bool read_file(Backend backend, const std::string& path, const Options& opts,
+               const Consumer& consume, Stats* stats,
+               std::string* error = nullptr);
+
+// Replaces `path` with `size` bytes of the pattern above and waits for
+// them to reach the device (fdatasync), which is part of the timing.
+bool write_file(Backend backend, const std::string& path, std::uint64_t size,
+                const Options& opts, Stats* stats,
+                std::string* error = nullptr);
+
+// Evicts the file's cached pages, so the next read comes from the device.
+// Needs no privileges, but only drops clean pages.
+bool drop_cache(const std::string& path);
+
+}  // namespace lab::io
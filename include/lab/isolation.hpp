@@ -0,0 +1,45 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace lab {
+
+// The host settings that make timings drift, as sysfs reports them for
+// one CPU. Anything the kernel does not expose (e.g. cpufreq in most VMs)
+// is left unknown.
+struct HostState {
+  std::vector<int> isolated;  // isolcpus= CPUs, away from the scheduler
+  std::string governor;       // cpufreq scaling governor; empty if unknown
+  int turbo = -1;             // 1 enabled, 0 disabled, -1 unknown
+  int smt = -1;               // 1 active, 0 inactive, -1 unknown
+  std::vector<int> siblings;  // hardware threads of the CPU's core
+
+  // Reads everything for `cpu` from `root`, the sysfs CPU directory.
+  static HostState read(int cpu,
+                        const std::string& root = "/sys/devices/system/cpu");
+};
+
+// One line per setting that is known to add noise when benchmarking on
+// `cpu`; empty when nothing is wrong or nothing is known.
+std::vector<std::string> host_warnings(const HostState& host, int cpu);
+
+// Drops the page cache, dentries and inodes so that file benchmarks start
+// cold. Needs root.
+bool drop_caches(std::string* error = nullptr);
+
+// Host noise: the robust coefficient of variation (1.4826 * MAD / median)
+// of `runs` timings of a fixed ~100 us dependent-multiply loop. About
+// 0.001 on a quiet, pinned core; interrupts, frequency changes and
+// neighbours sharing the core push it up.
+double measure_noise(int runs = 16);
+
+// What decides whether two hosts' timings are comparable: CPU model,
+// online CPUs, NUMA nodes, memory and SIMD support, e.g.
+// "Intel(R) Xeon(R) Processor; 1 cpus; 1 nodes; 6 GiB; sse42,avx2,avx512".
+std::string hardware_description();
+
+// Short stable id of a hardware_description(), e.g. "hw-5f2c0e1ab93d4e77".
+std::string hardware_fingerprint(const std::string& description);
+
+}  // namespace lab
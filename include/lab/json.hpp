@@ -0,0 +1,145 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace lab::json {
+
+// Appends JSON text to a string, inserting separators; nesting is the
+// caller's responsibility.
+//
+//   lab::json::Writer w(out);
+//   w.begin_object();
+//   w.key("id");
+//   w.value(42);
+//   w.end_object();
+class Writer {
+ public:
+  explicit Writer(std::string& out) : out_(&out) {}
+
+  void begin_object() { open('{'); }
+  void end_object() { close('}'); }
+  void begin_array() { open('['); }
+  void end_array() { close(']'); }
+  void key(std::string_view k);
+
+  void value(std::string_view s);
+  void value(const char* s) { value(std::string_view(s)); }
+  template <class T>
+    requires std::is_arithmetic_v<T>
+  void value(T v) {
+    if constexpr (std::is_same_v<T, bool>) {
+      literal(v ? "true" : "false");
+    } else if constexpr (std::is_floating_point_v<T>) {
+      number(static_cast<double>(v));
+    } else if constexpr (std::is_signed_v<T>) {
+      number(static_cast<std::int64_t>(v));
+    } else {
+      number(static_cast<std::uint64_t>(v));
+    }
+  }
+  void null() { literal("null"); }
+
+ private:
+  void separate() {
+    if (!first_) *out_ += ',';
+    first_ = false;
+  }
+  void open(char c) {
+    separate();
+    *out_ += c;
+    first_ = true;
+  }
+  void close(char c) {
+    *out_ += c;
+    first_ = false;
+  }
+  void literal(const char* text) {
+    separate();
+    *out_ += text;
+  }
+  // Shortest text that parses back to the same double; non-finite values
+  // are written as null.
+  void number(double v);
+  void number(std::int64_t v);
+  void number(std::uint64_t v);
+
+  std::string* out_;
+  bool first_ = true;  // no separator before the next element
+};
+
+// A pull parser over JSON text. The caller walks the document it expects;
+// each call returns false on malformed input or a type mismatch, after
+// which ok() is false and error() says where.
+//
+//   if (!r.begin_object()) return false;
+//   for (std::string_view key; r.next_key(key);) {
+//     if (key == "id") r.read(id); else r.skip();
+//   }
+//   return r.ok();
+class Reader {
+ public:
+  explicit Reader(std::string_view text) : text_(text) {}
+
+  bool begin_object();
+  // Reads the next key of the current object, or consumes its closing
+  // brace and returns false. `key` stays valid until the next call.
+  bool next_key(std::string_view& key);
+
+  bool begin_array();
+  // True if another element of the current array follows, false after
+  // consuming its closing bracket.
+  bool next_element();
+
+  bool read(std::string& out);
+  bool read(double& out);
+  bool read(std::int64_t& out);
+  bool read(std::uint64_t& out);
+  bool read(bool& out);
+  // read() into any other integer type, failing if the value does not fit.
+  template <class T>
+    requires(std::is_integral_v<T> && !std::is_same_v<T, bool> &&
+             !std::is_same_v<T, std::int64_t> &&
+             !std::is_same_v<T, std::uint64_t>)
+  bool read(T& out) {
+    using Wide =
+        std::conditional_t<std::is_signed_v<T>, std::int64_t, std::uint64_t>;
+    Wide v;
+    if (!read(v)) return false;
+    if (!std::in_range<T>(v)) return fail("integer out of range");
+    out = static_cast<T>(v);
+    return true;
+  }
+  // Consumes "null" if it comes next.
+  bool read_null();
+  // Skips one value of any type.
+  bool skip();
+
+  // True once only whitespace is left.
+  bool at_end();
+  bool ok() const { return error_.empty(); }
+  const std::string& error() const { return error_; }
+
+ private:
+  bool fail(const char* what);
+  void skip_space();
+  bool consume(char c);
+  // Reads a string into `out`, returning a view of the text itself when
+  // it holds no escapes.
+  bool string(std::string_view& view, std::string& scratch);
+  // Separator handling shared by next_key and next_element.
+  bool next(char close);
+  bool number_text(std::string_view& text);
+
+  std::string_view text_;
+  std::size_t pos_ = 0;
+  std::vector<bool> first_;  // per open container: no element read yet
+  std::string scratch_;
+  std::string error_;
+};
+
+}  // namespace lab::json
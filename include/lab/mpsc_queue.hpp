@@ -0,0 +1,125 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+#include "lab/cpu.hpp"
+
+namespace lab {
+
+// Unbounded multi-producer single-consumer queue made of fixed-size
+// segments. The tail is a single word packing the current segment pointer
+// with the next free index, so claiming a slot and moving to a new segment
+// are both one CAS. A producer only dereferences a segment after winning a
+// claim on it, so the consumer may free a segment once it has drained it
+// and seen its successor linked, without hazard pointers or epochs.
+template <class T, std::size_t SegmentSize = 1024>
+class MpscQueue {
+  static_assert(sizeof(void*) == 8, "tail packing needs 64-bit pointers");
+  static_assert(SegmentSize >= 2 && SegmentSize < (1u << 15));
+
+ public:
+  MpscQueue() {
+    auto* seg = new Segment;
+    head_ = seg;
+    tail_.store(pack(seg, 0), std::memory_order_relaxed);
+  }
+
+  ~MpscQueue() {
+    T tmp;
+    while (try_pop(tmp)) {
+    }
+    delete head_;
+  }
+
+  MpscQueue(const MpscQueue&) = delete;
+  MpscQueue& operator=(const MpscQueue&) = delete;
+
+  // Any thread. Never fails; allocates a segment every SegmentSize pushes.
+  template <class U>
+  void push(U&& value) {
+    std::uint64_t word = tail_.load(std::memory_order_acquire);
+    Segment* fresh = nullptr;
+    for (;;) {
+      Segment* seg = segment(word);
+      std::size_t index = this->index(word);
+      if (index < SegmentSize) {
+        if (tail_.compare_exchange_weak(word, pack(seg, index + 1),
+                                        std::memory_order_acquire)) {
+          seg->slots[index].publish(std::forward<U>(value));
+          delete fresh;
+          return;
+        }
+        continue;
+      }
+      // Segment full: race to install a new one, taking its slot 0.
+      if (fresh == nullptr) fresh = new Segment;
+      if (tail_.compare_exchange_weak(word, pack(fresh, 1),
+                                      std::memory_order_acq_rel)) {
+        fresh->slots[0].publish(std::forward<U>(value));
+        seg->next.store(fresh, std::memory_order_release);
+        return;
+      }
+    }
+  }
+
+  // Consumer only. Returns false when empty, or when the next item's
+  // producer has claimed its slot but not finished writing it.
+  bool try_pop(T& out) {
+    if (head_index_ == SegmentSize) {
+      Segment* next = head_->next.load(std::memory_order_acquire);
+      if (next == nullptr) return false;
+      delete head_;
+      head_ = next;
+      head_index_ = 0;
+    }
+    Slot& slot = head_->slots[head_index_];
+    if (!slot.ready.load(std::memory_order_acquire)) return false;
+    T* item = std::launder(reinterpret_cast<T*>(slot.storage));
+    out = std::move(*item);
+    item->~T();
+    ++head_index_;
+    return true;
+  }
+
+ private:
+  struct Slot {
+    std::atomic<bool> ready{false};
+    alignas(T) unsigned char storage[sizeof(T)];
+
+    template <class U>
+    void publish(U&& value) {
+      ::new (storage) T(std::forward<U>(value));
+      ready.store(true, std::memory_order_release);
+    }
+  };
+
+  struct Segment {
+    std::atomic<Segment*> next{nullptr};
+    Slot slots[SegmentSize];
+  };
+
+  // User-space pointers fit in 48 bits on x86-64 and AArch64 Linux.
+  static constexpr int kIndexShift = 48;
+
+  static std::uint64_t pack(Segment* seg, std::size_t index) {
+    return reinterpret_cast<std::uint64_t>(seg) |
+           (static_cast<std::uint64_t>(index) << kIndexShift);
+  }
+  static Segment* segment(std::uint64_t word) {
+    return reinterpret_cast<Segment*>(
+        word & ((std::uint64_t{1} << kIndexShift) - 1));
+  }
+  static std::size_t index(std::uint64_t word) {
+    return static_cast<std::size_t>(word >> kIndexShift);
+  }
+
+  alignas(kCacheLine) std::atomic<std::uint64_t> tail_;
+  alignas(kCacheLine) Segment* head_;
+  std::size_t head_index_ = 0;
+};
+
+}  // namespace lab
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace lab {
+
+// Where pages of a mapping may live. The kernel places each page when it
+// is first touched: by default on the node of the touching CPU, else as
+// the policy says.
+struct NumaPolicy {
+  enum Mode {
+    kLocal,       // the node of the CPU that touches the page first
+    kBind,        // only on `nodes`
+    kInterleave,  // round-robin over `nodes`, page by page
+  };
+  Mode mode = kLocal;
+  std::vector<int> nodes;
+
+  static NumaPolicy local() { return {}; }
+  static NumaPolicy on_node(int node) { return {kBind, {node}}; }
+  // Every node with memory when `nodes` is empty.
+  static NumaPolicy interleave(std::vector<int> nodes = {});
+};
+
+// NUMA node ids that have memory, ascending; {0} without NUMA information.
+std::vector<int> memory_nodes();
+
+// Node of the CPU the calling thread runs on, or -1.
+int current_node();
+
+// Node the page holding `p` is on, or -1 if it is not yet backed.
+int node_of_page(const void* p);
+
+// Sets the policy of the pages in [p, p + bytes), which must be page
+// aligned, before they are touched (mbind(2)). Without kernel NUMA support
+// this succeeds for kLocal only.
+bool set_numa_policy(void* p, std::size_t bytes, const NumaPolicy& policy,
+                     std::string* error = nullptr);
+
+// Anonymous mappings placed by one policy, as the upstream of an Arena or
+// of any std::pmr container:
+//
+//   lab::Arena arena(1 << 20, lab::numa_resource(lab::NumaPolicy::on_node(1)));
+//
+// Every allocation is its own mapping rounded up to pages, so keep them
+// large. Throws std::bad_alloc when the mapping or the policy fails.
+class NumaResource final : public std::pmr::memory_resource {
+ public:
+  explicit NumaResource(NumaPolicy policy) : policy_(std::move(policy)) {}
+
+  const NumaPolicy& policy() const { return policy_; }
+
+ private:
+  void* do_allocate(std::size_t bytes, std::size_t align) override;
+  void do_deallocate(void* p, std::size_t bytes, std::size_t align) override;
+  bool do_is_equal(const memory_resource& other) const noexcept override {
+    return this == &other;
+  }
+
+  NumaPolicy policy_;
+};
+
+// A NumaResource for `policy` that lives as long as the process, like
+// std::pmr::new_delete_resource(); equal policies share one.
+NumaResource* numa_resource(const NumaPolicy& policy);
+
+}  // namespace lab
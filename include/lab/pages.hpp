@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+
+namespace lab {
+
+// How a buffer's pages are backed and faulted in. Every option moves a
+// cost out of the timed region: a first touch inside a benchmark pays a
+// minor fault per 4 KiB, and a large working set on 4 KiB pages pays TLB
+// misses that 2 MiB pages would not.
+struct PageOptions {
+  bool hugetlb = false;   // MAP_HUGETLB: 2 MiB pages from the pool reserved
+                          // in vm.nr_hugepages; normal pages if it is empty
+  bool thp = false;       // MADV_HUGEPAGE: transparent huge pages
+  bool populate = false;  // MAP_POPULATE: fault every page in up front
+  bool lock = false;      // mlock: keep every page resident; needs
+                          // RLIMIT_MEMLOCK (ulimit -l) to cover it
+
+  bool operator==(const PageOptions&) const = default;
+};
+
+inline constexpr std::size_t kHugePageSize = std::size_t{2} << 20;
+
+// The base page size, sysconf(_SC_PAGESIZE).
+std::size_t page_size();
+
+// An anonymous mapping made by map_pages().
+struct PageMapping {
+  void* data = nullptr;
+  std::size_t bytes = 0;  // mapped length: rounded up to 4 KiB, or to
+                          // 2 MiB with hugetlb whether or not it got them
+  bool huge = false;      // backed by hugetlb pages
+};
+
+// Maps `bytes` of zeroed anonymous memory per `options`. Fails only when
+// the mapping or mlock fails; missing huge pages fall back silently
+// (check PageMapping::huge).
+bool map_pages(std::size_t bytes, const PageOptions& options,
+               PageMapping& out, std::string* error = nullptr);
+void unmap_pages(const PageMapping& mapping);
+
+// Faults in (populate) and/or locks an existing mapping, e.g. of a file.
+// `p` must be page aligned. hugetlb and thp do not apply here.
+bool prefault(const void* p, std::size_t bytes, const PageOptions& options,
+              std::string* error = nullptr);
+
+// Allocations served by map_pages(), as the upstream of an Arena (see
+// Arena(std::size_t, const PageOptions&)) or of any std::pmr container.
+// Each allocation is its own mapping; throws std::bad_alloc on failure.
+class PageResource final : public std::pmr::memory_resource {
+ public:
+  explicit PageResource(const PageOptions& options) : options_(options) {}
+
+  const PageOptions& options() const { return options_; }
+
+ private:
+  void* do_allocate(std::size_t bytes, std::size_t align) override;
+  void do_deallocate(void* p, std::size_t bytes, std::size_t align) override;
+  bool do_is_equal(const memory_resource& other) const noexcept override {
+    return this == &other;
+  }
+
+  PageOptions options_;
+};
+
+// A PageResource for `options` that lives as long as the process.
+PageResource* page_resource(const PageOptions& options);
+
+// Page faults so far (getrusage(2)): of the whole process, or with
+// `thread` of the calling thread only.
+struct PageFaults {
+  std::uint64_t minor = 0;  // served without I/O, e.g. a first touch
+  std::uint64_t major = 0;  // needed I/O, e.g. a file page not cached
+};
+PageFaults page_faults(bool thread = false);
+
+}  // namespace lab
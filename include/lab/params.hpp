@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "lab/bench.hpp"
+
+namespace lab {
+
+// Parses a parameter grid: comma-separated values and ranges.
+//
+//   4096          a single value; K, M, G and T suffixes are powers of 1024
+//   1..64         a geometric range, doubling: 1, 2, 4, ..., 64
+//   1K..1G:x4     multiplying by 4 each step
+//   0..100:+25    an arithmetic range: 0, 25, 50, 75, 100
+//
+// Ranges stop at the last value not above the upper bound. Values are
+// appended to `out` in order. Returns false on a malformed spec.
+bool parse_grid(std::string_view spec, std::vector<std::int64_t>& out,
+                std::string* error = nullptr);
+
+// parse_grid for registration-time defaults; aborts on a malformed spec.
+std::vector<std::int64_t> grid(std::string_view spec);
+
+// Every combination of the parameters' values, first parameter slowest.
+std::vector<ParamValues> expand_grid(const std::vector<Param>& params);
+
+// "base/name:value/..." as reported in bench_output.txt.
+std::string point_name(const std::string& base, const ParamValues& point);
+
+}  // namespace lab
@@ -0,0 +1,18 @@
+// Precompiled for every lab target when LAB_PCH is on. Keep this to
+// standard headers and stable lab headers; anything edited often here
+// invalidates the whole build.
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "lab/bench.hpp"
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "lab/bench.hpp"
+
+namespace lab {
+
+// Hardware counters for the calling thread, read with perf_event_open.
+// Events are opened in groups so that related counts (e.g. cycles and
+// instructions) are scheduled together and their ratios stay meaningful
+// under multiplexing. Events the kernel or PMU refuses are dropped.
+class PerfCounters : public Probe {
+ public:
+  PerfCounters();
+  ~PerfCounters() override;
+
+  PerfCounters(const PerfCounters&) = delete;
+  PerfCounters& operator=(const PerfCounters&) = delete;
+
+  // True when at least one event could be opened.
+  bool available() const { return !events_.empty(); }
+  // Events that failed to open, for a one-time warning.
+  const std::vector<std::string>& missing() const { return missing_; }
+
+  void reset();
+  void start() override;
+  void stop() override;
+
+  // Counts since reset(), scaled by time_enabled/time_running when the
+  // group was multiplexed, as (event name, count) pairs.
+  std::vector<std::pair<std::string, double>> read() const;
+
+ private:
+  struct Event {
+    const char* name;
+    int fd;
+    int group;
+  };
+  std::vector<Event> events_;
+  std::vector<int> leaders_;  // one fd per group
+  std::vector<std::string> missing_;
+};
+
+// Adds per-op columns for the counts in `counts` to `out`, plus ipc:
+// cycles_per_op, instructions_per_op, ipc, branch_misses_per_op, ...
+void append_perf_columns(
+    const std::vector<std::pair<std::string, double>>& counts,
+    std::uint64_t iterations,
+    std::vector<std::pair<std::string, double>>& out);
+
+}  // namespace lab
@@ -0,0 +1,81 @@
+/* C ABI between lab_bench and experiment plugins (*.so).
+ *
+ * A plugin exports lab_experiment_register(), which the host calls once
+ * after dlopen(). The plugin calls host->add_benchmark() for each of its
+ * benchmarks. Only this header crosses the boundary, so plugins and the
+ * host may be built by different compilers or at different revisions.
+ *
+ * The host passes its own LAB_PLUGIN_ABI_VERSION; a plugin uses members
+ * added after version 1 only when the host's version includes them. */
+#ifndef LAB_PLUGIN_H
+#define LAB_PLUGIN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LAB_PLUGIN_ABI_VERSION 3
+
+typedef void (*lab_resident_init)(void* data, size_t bytes, void* ctx);
+
+/* One timed invocation. The host sets `iterations`; the plugin runs that
+ * many iterations and fills in the outputs.
+ *
+ * Fields are only ever appended. A plugin must check `size` before using
+ * a field newer than the ones it was written against (LAB_RUN_HAS). */
+typedef struct lab_run {
+  uint32_t size; /* sizeof(lab_run) as compiled into the host */
+  uint64_t iterations;
+  uint64_t elapsed_ns;
+  double bytes_per_op;
+  void* host_ctx;
+  void (*set_counter)(struct lab_run* run, const char* name, double value);
+  /* Called around each timed region; null when the host has no probe. */
+  void (*probe_start)(struct lab_run* run);
+  void (*probe_stop)(struct lab_run* run);
+  /* Parameter values of this grid point, in declaration order. */
+  uint32_t param_count;
+  const char* const* param_names;
+  const int64_t* param_values;
+  /* Memory the host keeps across runs and plugin reloads: the block named
+   * `key`, created with `bytes` zeroed bytes and filled by init(data,
+   * bytes, ctx) when there is no block of that size. Null on allocation
+   * failure. See lab/resident.hpp. */
+  void* (*resident)(struct lab_run* run, const char* key, uint64_t bytes,
+                    lab_resident_init init, void* ctx);
+  /* Version 3: non-zero to time every iteration into the run's latency
+   * histogram (lab::State::time_each_iteration). */
+  uint32_t time_each_iteration;
+  /* Merges a histogram, in lab::Histogram::serialize() form, into the
+   * run's per-op latencies (lab::State::latency()). */
+  void (*merge_latency)(struct lab_run* run, const char* histogram);
+} lab_run;
+
+#define LAB_RUN_HAS(run, field)                              \
+  ((run)->size >= offsetof(lab_run, field) + sizeof((run)->field))
+
+typedef void (*lab_bench_fn)(lab_run* run, void* user);
+
+typedef struct lab_host {
+  uint32_t abi_version;
+  void* ctx;
+  /* `name` is copied; `user` is passed back to `fn` unchanged. */
+  void (*add_benchmark)(void* ctx, const char* name, lab_bench_fn fn,
+                        void* user);
+  /* Version 2: declares a parameter of the benchmark added last, with its
+   * default values (copied). */
+  void (*add_param)(void* ctx, const char* name, const int64_t* values,
+                    uint32_t count);
+} lab_host;
+
+/* Returns 0 on success, non-zero if the plugin refuses to load. */
+int lab_experiment_register(const lab_host* host);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LAB_PLUGIN_H */
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "lab/bench.hpp"
+
+namespace lab {
+
+// Loads experiment plugins and registers their benchmarks with a Registry.
+// Plugins stay loaded until reloaded or the host is destroyed, so the host
+// must outlive every use of the benchmarks it registered.
+class PluginHost {
+ public:
+  explicit PluginHost(Registry& registry) : registry_(registry) {}
+  ~PluginHost();
+
+  PluginHost(const PluginHost&) = delete;
+  PluginHost& operator=(const PluginHost&) = delete;
+
+  // Loads one plugin. Returns false and sets error() on failure.
+  bool load(const std::string& path);
+
+  // Loads every *.so in `dir`, in name order. Returns the number loaded;
+  // failures are reported on stderr and skipped.
+  int load_directory(const std::string& dir);
+
+  // Reloads each plugin whose file changed since it was loaded and then
+  // stayed the same until this call, so that a plugin is not loaded while
+  // the linker is still writing it. A reloaded plugin's benchmarks replace
+  // its old ones at the end of the registry; one that fails to load keeps
+  // its old benchmarks, with the failure on stderr. Returns the paths
+  // reloaded.
+  std::vector<std::string> reload_changed();
+
+  // Names of the benchmarks the plugin at `path` registered.
+  std::vector<std::string> benchmarks_of(const std::string& path) const;
+
+  const std::string& error() const { return error_; }
+
+ private:
+  // What a rebuild changes about a file.
+  struct Stamp {
+    std::filesystem::file_time_type mtime{};
+    std::uintmax_t size = 0;
+    bool operator==(const Stamp&) const = default;
+  };
+
+  struct Plugin {
+    std::string path;
+    void* handle = nullptr;
+    Stamp loaded;  // of the file that was loaded
+    Stamp seen;    // at the last reload_changed()
+    std::vector<std::string> benchmarks;
+  };
+
+  static bool stamp(const std::string& path, Stamp& out);
+  // dlopens `file` and registers its benchmarks into `into`.
+  bool open(const std::string& file, const std::string& path, void*& handle,
+            Registry& into);
+
+  Registry& registry_;
+  std::vector<Plugin> plugins_;
+  int generation_ = 0;  // names the copies loaded by reloads
+  std::string error_;
+};
+
+}  // namespace lab
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <memory_resource>
+
+namespace lab {
+
+// Size-class allocator: power-of-two classes from 8 to 4096 bytes, each
+// with an intrusive free list refilled from 64 KiB slabs. Larger or more
+// strictly aligned requests go straight to upstream. Slabs are only
+// returned by release() or the destructor.
+class Pool {
+ public:
+  static constexpr std::size_t kMinClass = 8;
+  static constexpr std::size_t kMaxClass = 4096;
+  static constexpr std::size_t kSlabSize = 64 * 1024;
+
+  explicit Pool(std::pmr::memory_resource* upstream =
+                    std::pmr::new_delete_resource());
+  ~Pool();
+
+  Pool(const Pool&) = delete;
+  Pool& operator=(const Pool&) = delete;
+
+  void* allocate(std::size_t bytes,
+                 std::size_t align = alignof(std::max_align_t)) {
+    int c = size_class(bytes, align);
+    if (c < 0) return upstream_->allocate(bytes, align);
+    FreeNode* node = free_[c];
+    if (node == nullptr) return refill(c);
+    free_[c] = node->next;
+    return node;
+  }
+
+  // `bytes` and `align` must match the allocate() call.
+  void deallocate(void* p, std::size_t bytes,
+                  std::size_t align = alignof(std::max_align_t)) {
+    int c = size_class(bytes, align);
+    if (c < 0) {
+      upstream_->deallocate(p, bytes, align);
+      return;
+    }
+    auto* node = static_cast<FreeNode*>(p);
+    node->next = free_[c];
+    free_[c] = node;
+  }
+
+  // Returns every slab upstream. Outstanding blocks become invalid.
+  void release();
+
+  // Bytes of slabs obtained from upstream.
+  std::size_t capacity() const { return slabs_ * kSlabSize; }
+
+ private:
+  static constexpr int kNumClasses = 10;  // 8, 16, ..., 4096
+
+  struct FreeNode {
+    FreeNode* next;
+  };
+  struct Slab {
+    Slab* next;
+  };
+
+  static int size_class(std::size_t bytes, std::size_t align) {
+    std::size_t n = bytes > align ? bytes : align;
+    if (n > kMaxClass) return -1;
+    if (n < kMinClass) n = kMinClass;
+    return static_cast<int>(std::bit_width(n - 1)) - 3;
+  }
+
+  void* refill(int c);
+
+  std::pmr::memory_resource* upstream_;
+  FreeNode* free_[kNumClasses] = {};
+  Slab* slab_list_ = nullptr;
+  std::size_t slabs_ = 0;
+};
+
+// std::pmr adapter over a Pool.
+class PoolResource final : public std::pmr::memory_resource {
+ public:
+  explicit PoolResource(Pool& pool) : pool_(pool) {}
+
+  Pool& pool() const { return pool_; }
+
+ private:
+  void* do_allocate(std::size_t bytes, std::size_t align) override {
+    return pool_.allocate(bytes, align);
+  }
+  void do_deallocate(void* p, std::size_t bytes, std::size_t align) override {
+    pool_.deallocate(p, bytes, align);
+  }
+  bool do_is_equal(const memory_resource& other) const noexcept override {
+    auto* o = dynamic_cast<const PoolResource*>(&other);
+    return o != nullptr && &o->pool_ == &pool_;
+  }
+
+  Pool& pool_;
+};
+
+}  // namespace lab
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "lab/archive.hpp"
+#include "lab/results.hpp"
+
+namespace lab::probe {
+
+// Lab measurement inside a service. Packaged with lab/trace.hpp,
+// lab/histogram.hpp, lab/perf_counters.hpp and the results archive as
+// liblab_probe.so, which leaves the benchmark runner out. drain() turns
+// what was recorded since the previous drain into the Result rows
+// lab_bench writes, and a Sidecar appends them to an archive on a timer,
+// so lab_history and lab_compare read production numbers next to lab
+// ones:
+//
+//   lab::probe::Latency& get = lab::probe::latency("rpc/get");
+//   lab::probe::Sidecar sidecar({.archive = "/var/lib/svc/probe.bin",
+//                                .info = {.commit = kBuildId}});
+//   ...
+//   get.record(ns);
+//
+// Rows, each over the interval since the previous drain:
+//
+//   latency/<name>   values recorded into latency(name): iterations is
+//                    their count, ns_per_op their mean, p50_ns, p99_ns,
+//                    the lat_* columns and the histogram (as set_latency),
+//                    and per_s, the count per second
+//   trace/<scope>    the same for durations of LAB_TRACE_SCOPE scopes
+//                    left, while tracing is on (lab::trace::start())
+//   perf             <event>_per_s summed over the threads that called
+//                    count_thread(), and ipc; iterations is their number
+//
+// Names with nothing recorded in the interval get no row.
+
+// A named latency distribution. record() may be called from any thread:
+// each thread writes its own histogram behind its own lock, which only a
+// drain ever contends.
+class Latency {
+ public:
+  Latency(const Latency&) = delete;
+  Latency& operator=(const Latency&) = delete;
+
+  void record(std::uint64_t ns);
+  const std::string& name() const { return name_; }
+
+ private:
+  friend Latency& latency(std::string_view name);
+  Latency(std::string name, std::size_t index)
+      : name_(std::move(name)), index_(index) {}
+
+  std::string name_;
+  std::size_t index_;  // into the registry and each thread's slots
+};
+
+// The process-lifetime Latency named `name`, the same object on every
+// call with equal text. Look it up once, not per record().
+Latency& latency(std::string_view name);
+
+// Counts hardware events (lab::PerfCounters) on the calling thread until
+// it exits. False when none could be opened, e.g. under
+// perf_event_paranoid > 2.
+bool count_thread();
+
+// Everything recorded since the previous drain, as rows; clears it. Safe
+// to call while other threads record.
+std::vector<Result> drain();
+
+struct SidecarOptions {
+  std::string archive;  // appended to, see lab/archive.hpp
+  std::chrono::milliseconds interval{10000};
+  RunInfo info;  // commit and host of every run; timestamps are per drain
+};
+
+// A thread that calls drain() every interval and appends the rows to the
+// archive as one run, and once more on destruction. Intervals with no
+// rows append nothing.
+class Sidecar {
+ public:
+  explicit Sidecar(SidecarOptions opts);
+  ~Sidecar();
+
+  Sidecar(const Sidecar&) = delete;
+  Sidecar& operator=(const Sidecar&) = delete;
+
+  // Runs appended so far, and appends that failed with the last error.
+  std::uint64_t appended() const;
+  std::uint64_t failures() const;
+  std::string last_error() const;
+
+ private:
+  void flush();
+
+  SidecarOptions opts_;
+  mutable std::mutex mu_;
+  std::condition_variable wake_;
+  bool stopping_ = false;
+  std::uint64_t appended_ = 0;
+  std::uint64_t failures_ = 0;
+  std::string last_error_;
+  std::thread thread_;
+};
+
+}  // namespace lab::probe
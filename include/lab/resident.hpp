@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace lab {
+
+// Memory that outlives the code using it. Benchmarks keep their inputs
+// here (see State::resident), so that later runs, and a plugin reloaded by
+// `lab_bench --watch`, find a multi-GB input where the previous run left
+// it instead of generating it again.
+class Resident {
+ public:
+  // Fills a new block; a C function so that plugins can pass one in.
+  using Init = void (*)(void* data, std::size_t bytes, void* ctx);
+
+  virtual ~Resident() = default;
+
+  // The block named `key`. When there is none, or it has another size, a
+  // zero-filled block of `bytes` replaces it and `init(data, bytes, ctx)`
+  // fills it; concurrent callers for the same key wait for that. Blocks
+  // are page-aligned and stay mapped until replaced or the process exits.
+  // Throws std::bad_alloc when out of memory.
+  virtual void* get(const std::string& key, std::size_t bytes, Init init,
+                    void* ctx) = 0;
+
+  // The store of this process.
+  static Resident& process();
+};
+
+}  // namespace lab
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace lab {
+
+class Histogram;
+
+// One row of bench_output.txt.
+struct Result {
+  std::string name;
+  std::uint64_t iterations = 0;  // total timed iterations over all samples
+  double ns_per_op = 0;
+  double p50_ns = 0;
+  double p99_ns = 0;
+  double bytes_per_op = 0;
+  // Extra columns, in first-seen order; see State::set_counter.
+  std::vector<std::pair<std::string, double>> counters;
+  // ns/op of each timed sample, in run order. Feeds lab_compare.
+  std::vector<double> samples;
+  // Histogram::serialize() of per-op latencies in ns, or empty.
+  std::string latency;
+
+  const double* counter(const std::string& name) const;
+  // Replaces the counter's value or adds it as the last column.
+  void set_counter(const std::string& name, double value);
+};
+
+// Stores `h` in Result::latency and its percentiles in the lat_p50_ns,
+// lat_p90_ns, lat_p99_ns, lat_p999_ns and lat_max_ns columns.
+void set_latency(Result& result, const Histogram& h);
+
+// Pools rows with equal names, e.g. one benchmark run on several hosts
+// or in several runs, keeping first-seen order. Iterations add up,
+// ns_per_op and counters become iteration-weighted means, samples are
+// concatenated and p50/p99 recomputed from them, and latency histograms
+// are merged.
+std::vector<Result> merge_results(const std::vector<Result>& rows);
+
+// Writes results as tab-separated rows under a single header line:
+//
+//   name iterations ns_per_op p50_ns p99_ns bytes_per_op [counters...] samples
+//   [latency]
+//
+// Counters become columns between the fixed ones and `samples`, which is a
+// comma-separated list. `latency` is only present when some result has a
+// histogram. Missing cells are "-".
+void write_results(std::ostream& out, const std::vector<Result>& results);
+
+// Parses the output of write_results. Columns are located by header name,
+// so files written by older or newer runners still load; unknown columns
+// are read as counters. Returns false on a malformed file.
+bool read_results(std::istream& in, std::vector<Result>& results,
+                  std::string* error = nullptr);
+
+}  // namespace lab
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "lab/bench.hpp"
+#include "lab/perf_counters.hpp"
+#include "lab/results.hpp"
+#include "lab/topology.hpp"
+
+namespace lab {
+
+struct RunnerOptions {
+  std::string filter;           // ECMAScript regex matched against names
+  double warmup_seconds = 0.1;  // untimed run before calibration
+  double min_seconds = 0.5;     // total measured time per benchmark
+  int samples = 20;             // timed repetitions used for percentiles
+  int cpu = -1;                 // CPU to pin to; -1 means the current one
+  bool pin = true;
+  bool perf_counters = false;   // add hardware counter columns (--perf)
+  int jobs = 1;                 // benchmarks run concurrently (--jobs)
+  bool latency = true;          // per-iteration latency pass (--no-latency)
+  bool drop_caches = false;     // drop the page cache before each sample
+  int shard = 0;                // run only the selected points whose name
+  int shards = 1;               // hashes to `shard` mod shards (--shard=I/N)
+  std::vector<Param> grids;     // replace declared parameter defaults
+  std::string output = "bench_output.txt";
+};
+
+// Warms up, calibrates and measures one grid point of a benchmark. The
+// parameter values become columns. When `perf` is given, its counts over
+// the timed samples are added as per-op columns.
+//
+// Latencies the body records into State::latency() are merged over the
+// samples; otherwise, with opts.latency, one more untimed run records the
+// duration of each iteration, which then includes a clock read. Either
+// way the percentiles become lat_p50_ns, lat_p90_ns, lat_p99_ns,
+// lat_p999_ns and lat_max_ns, and the histogram is kept in
+// Result::latency.
+//
+// Page faults in the timed samples are always counted, from getrusage(2),
+// as minor_faults_per_op and major_faults_per_op: a benchmark that keeps
+// faulting is measuring the kernel's first touch (see lab/pages.hpp).
+//
+// Each point also gets a `noise` column, measure_noise() taken just
+// before it, which lab_compare uses to widen its threshold on noisy hosts.
+Result run_benchmark(const Benchmark& bench, const ParamValues& params,
+                     const RunnerOptions& opts, PerfCounters* perf = nullptr);
+
+// Runs every grid point whose name matches opts.filter. With opts.jobs >
+// 1, independent points run at the same time on a Scheduler with one
+// pinned worker per job; results keep registry order. Points with a
+// "threads" parameter also get speedup and efficiency columns.
+std::vector<Result> run_all(const Registry& registry,
+                            const RunnerOptions& opts);
+
+}  // namespace lab
@@ -0,0 +1,173 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "lab/chase_lev_deque.hpp"
+#include "lab/mpmc_queue.hpp"
+
+namespace lab {
+
+// Work-stealing thread pool. Each worker owns a Chase-Lev deque; idle
+// workers steal from random victims. The thread that calls parallel_for
+// from outside the pool joins in as worker 0 for the duration of the
+// call, so Scheduler({.threads = 1}) runs everything on the caller and a
+// 1-thread point on a scaling curve carries no hand-off cost.
+//
+// Only one thread outside the pool may be inside a parallel call at a
+// time; calls from inside a task nest freely.
+class Scheduler {
+ public:
+  struct Options {
+    int threads = 0;     // 0: one per usable CPU
+    bool pin = true;     // pin spawned workers to distinct CPUs
+    bool spread = true;  // round-robin workers across NUMA nodes
+  };
+
+  Scheduler() : Scheduler(Options{}) {}
+  explicit Scheduler(Options opts);
+  ~Scheduler();
+
+  Scheduler(const Scheduler&) = delete;
+  Scheduler& operator=(const Scheduler&) = delete;
+
+  int size() const { return static_cast<int>(workers_.size()); }
+  // CPU each worker is pinned to (worker 0 is the caller), or -1.
+  const std::vector<int>& cpus() const { return cpus_; }
+  // Index of the calling worker, or -1 outside the pool.
+  int current_worker() const;
+
+  // Runs f on some worker without waiting for it; any thread may call
+  // this. With a single worker there is no other thread to run it, so
+  // the caller runs it inline, as it does when the injection queue is
+  // full. Tasks still queued at destruction run in the destructor.
+  void spawn(std::function<void()> f);
+
+  // Calls f(lo, hi) over disjoint subranges covering [begin, end). `grain`
+  // is the subrange size; 0 picks about eight per worker.
+  template <class F>
+  void parallel_for(std::size_t begin, std::size_t end, F&& f,
+                    std::size_t grain = 0) {
+    if (end <= begin) return;
+    grain = pick_grain(end - begin, grain);
+    struct Ctx {
+      std::remove_reference_t<F>* f;
+      std::size_t begin, end, grain;
+    } ctx{&f, begin, end, grain};
+    run_chunks(
+        (end - begin + grain - 1) / grain,
+        [](void* p, std::size_t chunk) {
+          auto* c = static_cast<Ctx*>(p);
+          std::size_t lo = c->begin + chunk * c->grain;
+          std::size_t hi = lo + c->grain < c->end ? lo + c->grain : c->end;
+          (*c->f)(lo, hi);
+        },
+        &ctx);
+  }
+
+  // Like parallel_for, but splits [begin, end) into size() equal parts
+  // and runs part i on worker i, so the same range always lands on the
+  // same CPU. Memory is placed on the node of the CPU that first touches
+  // it, so initializing data with parallel_for_static (or first_touch)
+  // and then computing on it the same way keeps every access local,
+  // where work stealing would scatter the parts. From inside a task it
+  // falls back to parallel_for.
+  template <class F>
+  void parallel_for_static(std::size_t begin, std::size_t end, F&& f) {
+    if (end <= begin) return;
+    std::size_t parts = static_cast<std::size_t>(size());
+    struct Ctx {
+      std::remove_reference_t<F>* f;
+      std::size_t begin, end, parts;
+    } ctx{&f, begin, end, parts};
+    auto part = [](void* p, std::size_t i) {
+      auto* c = static_cast<Ctx*>(p);
+      std::size_t n = c->end - c->begin;
+      std::size_t lo = c->begin + n * i / c->parts;
+      std::size_t hi = c->begin + n * (i + 1) / c->parts;
+      if (lo < hi) (*c->f)(lo, hi);
+    };
+    if (current_worker() >= 0) {
+      run_chunks(parts, part, &ctx);
+    } else {
+      run_pinned(part, &ctx);
+    }
+  }
+
+  // Writes `value` over `data` with parallel_for_static, placing each
+  // part's pages on its worker's node: call it on fresh memory, before
+  // anything else touches it.
+  template <class T>
+  void first_touch(T* data, std::size_t n, const T& value = T{}) {
+    parallel_for_static(0, n, [&](std::size_t lo, std::size_t hi) {
+      for (std::size_t i = lo; i < hi; ++i) data[i] = value;
+    });
+  }
+
+  // Reduces map(lo, hi) over subranges of [begin, end) with `reduce`,
+  // combining partial results in range order so the result does not
+  // depend on scheduling.
+  template <class T, class Map, class Reduce>
+  T parallel_reduce(std::size_t begin, std::size_t end, T identity, Map map,
+                    Reduce reduce, std::size_t grain = 0) {
+    if (end <= begin) return identity;
+    grain = pick_grain(end - begin, grain);
+    std::size_t chunks = (end - begin + grain - 1) / grain;
+    std::vector<T> partial(chunks, identity);
+    parallel_for(
+        0, chunks,
+        [&](std::size_t lo, std::size_t hi) {
+          for (std::size_t c = lo; c < hi; ++c) {
+            std::size_t a = begin + c * grain;
+            std::size_t b = a + grain < end ? a + grain : end;
+            partial[c] = map(a, b);
+          }
+        },
+        1);
+    T result = std::move(identity);
+    for (auto& p : partial) result = reduce(std::move(result), std::move(p));
+    return result;
+  }
+
+ private:
+  struct Task;
+  struct Job;
+  struct Worker;
+  struct Spawned;
+
+  std::size_t pick_grain(std::size_t n, std::size_t grain) const {
+    if (grain != 0) return grain;
+    std::size_t g = n / (static_cast<std::size_t>(size()) * 8);
+    return g == 0 ? 1 : g;
+  }
+
+  // Runs fn(ctx, i) for every i in [0, chunks) and waits for completion.
+  void run_chunks(std::size_t chunks, void (*fn)(void*, std::size_t),
+                  void* ctx);
+  // Runs fn(ctx, i) on worker i for every worker and waits.
+  void run_pinned(void (*fn)(void*, std::size_t), void* ctx);
+
+  void worker_main(int index);
+  bool find_task(Worker& self, Task*& task);
+  void execute(Worker& self, Task* task);
+  void push(Worker& self, Task* task);
+  void wake();
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::vector<std::thread> threads_;
+  std::vector<int> cpus_;
+  MpmcQueue<Task*> inject_{1024};  // spawned tasks, taken by any worker
+  std::mutex external_;  // serializes callers from outside the pool
+  std::atomic<std::uint64_t> epoch_{0};
+  std::atomic<int> sleepers_{0};
+  std::atomic<bool> stop_{false};
+};
+
+}  // namespace lab
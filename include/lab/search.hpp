@@ -0,0 +1,179 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+namespace lab::search {
+
+// Lower bound over sorted keys in three layouts, after Khuong and Morin,
+// "Array layouts for comparison-based searching":
+//
+//   lower_bound   the sorted array itself, bisected without branches
+//   Eytzinger     the keys in BFS order of an implicit binary tree, so
+//                 the next levels share cache lines and can be prefetched
+//   BTree         a static B-tree with one cache line per node: one miss
+//                 per level, log_(B+1) n levels, and a branchless rank
+//                 inside the node
+//
+// The layouts are built once from a sorted span and are read-only after.
+
+// Index of the first of a[0..n) that is not less than key, or n. The
+// trip count depends only on n and the step is a conditional move, so a
+// lookup never mispredicts; its loads still miss once a is out of cache.
+template <class T>
+std::size_t lower_bound(const T* a, std::size_t n, const T& key) {
+  if (n == 0) return 0;
+  const T* base = a;
+  while (n > 1) {
+    std::size_t half = n / 2;
+    base += (base[half - 1] < key) * half;
+    n -= half;
+  }
+  return static_cast<std::size_t>(base - a) + (*base < key);
+}
+
+namespace detail {
+
+inline constexpr std::size_t kLine = 64;
+
+// Cache-line aligned storage for trivially copyable keys.
+template <class T>
+class LineArray {
+ public:
+  LineArray() = default;
+  explicit LineArray(std::size_t n)
+      : data_(static_cast<T*>(::operator new(
+            n * sizeof(T), std::align_val_t{kLine}))), size_(n) {}
+  ~LineArray() {
+    if (data_ != nullptr) ::operator delete(data_, std::align_val_t{kLine});
+  }
+  LineArray(LineArray&& other) noexcept
+      : data_(std::exchange(other.data_, nullptr)),
+        size_(std::exchange(other.size_, 0)) {}
+  LineArray& operator=(LineArray&& other) noexcept {
+    std::swap(data_, other.data_);
+    std::swap(size_, other.size_);
+    return *this;
+  }
+
+  T* data() { return data_; }
+  const T* data() const { return data_; }
+  std::size_t size() const { return size_; }
+  T& operator[](std::size_t i) { return data_[i]; }
+  const T& operator[](std::size_t i) const { return data_[i]; }
+
+ private:
+  T* data_ = nullptr;
+  std::size_t size_ = 0;
+};
+
+}  // namespace detail
+
+// Node k has children 2k and 2k + 1 (1-based). The descent is branchless;
+// the line holding node k's descendants kPerLine levels down is
+// prefetched as it goes, which is what makes it beat bisection out of
+// cache.
+template <class T>
+class Eytzinger {
+  static_assert(std::is_trivially_copyable_v<T>);
+
+ public:
+  Eytzinger() = default;
+  explicit Eytzinger(std::span<const T> sorted) : tree_(sorted.size() + 1) {
+    std::size_t i = 0;
+    build(sorted, i, 1);
+  }
+
+  std::size_t size() const { return tree_.size() == 0 ? 0 : tree_.size() - 1; }
+
+  // The first key not less than `key`, or nullptr.
+  const T* lower_bound(const T& key) const {
+    const std::size_t n = size();
+    std::size_t k = 1;
+    while (k <= n) {
+      // Integer arithmetic: the prefetch may point past the tree.
+      __builtin_prefetch(reinterpret_cast<const void*>(
+          reinterpret_cast<std::uintptr_t>(tree_.data()) +
+          k * kPerLine * sizeof(T)));
+      k = 2 * k + (tree_[k] < key);
+    }
+    // Undo the right turns taken after the last left one.
+    k >>= std::countr_one(k) + 1;
+    return k == 0 ? nullptr : &tree_[k];
+  }
+
+ private:
+  static constexpr std::size_t kPerLine = detail::kLine / sizeof(T);
+
+  void build(std::span<const T> sorted, std::size_t& i, std::size_t k) {
+    if (k > size()) return;
+    build(sorted, i, 2 * k);
+    tree_[k] = sorted[i++];
+    build(sorted, i, 2 * k + 1);
+  }
+
+  detail::LineArray<T> tree_;
+};
+
+// An S-tree: node k holds kB sorted keys and has kB + 1 children at
+// k * (kB + 1) + 1 + i, so the tree needs no pointers. Slots past the
+// last key hold the largest T.
+template <class T, std::size_t kB = detail::kLine / sizeof(T)>
+class BTree {
+  static_assert(std::is_trivially_copyable_v<T>);
+  static_assert(std::numeric_limits<T>::is_specialized);
+
+ public:
+  BTree() = default;
+  explicit BTree(std::span<const T> sorted)
+      : nodes_((sorted.size() + kB - 1) / kB),
+        keys_(nodes_ * kB),
+        size_(sorted.size()) {
+    if (size_ == 0) return;
+    last_ = sorted.back();
+    std::size_t i = 0;
+    build(sorted, i, 0);
+  }
+
+  std::size_t size() const { return size_; }
+
+  // The first key not less than `key`, or nullptr.
+  const T* lower_bound(const T& key) const {
+    // Past the last key the search would land on padding.
+    if (size_ == 0 || last_ < key) return nullptr;
+    const T* best = nullptr;
+    std::size_t k = 0;
+    while (k < nodes_) {
+      const T* node = keys_.data() + k * kB;
+      std::size_t rank = 0;
+      for (std::size_t j = 0; j < kB; ++j) rank += node[j] < key;
+      if (rank < kB) best = node + rank;
+      k = k * (kB + 1) + 1 + rank;
+    }
+    return best;
+  }
+
+ private:
+  void build(std::span<const T> sorted, std::size_t& i, std::size_t k) {
+    if (k >= nodes_) return;
+    for (std::size_t j = 0; j < kB; ++j) {
+      build(sorted, i, k * (kB + 1) + 1 + j);
+      keys_[k * kB + j] = i < sorted.size() ? sorted[i++]
+                                            : std::numeric_limits<T>::max();
+    }
+    build(sorted, i, k * (kB + 1) + 1 + kB);
+  }
+
+  std::size_t nodes_ = 0;
+  detail::LineArray<T> keys_;
+  std::size_t size_ = 0;
+  T last_{};
+};
+
+}  // namespace lab::search
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace lab::simd {
+
+// Instruction sets a kernel variant can be built for. A binary contains
+// the variants for its architecture and picks the best one the CPU
+// supports at startup.
+enum class Isa { scalar, sse42, avx2, avx512, neon };
+
+inline constexpr Isa kAllIsas[] = {Isa::scalar, Isa::sse42, Isa::avx2,
+                                   Isa::avx512, Isa::neon};
+
+const char* isa_name(Isa isa);
+
+// Parses an isa_name() back; returns false for unknown names.
+bool parse_isa(const std::string& name, Isa& out);
+
+// One table per variant. Kernels without a vector form for an ISA point
+// at the scalar implementation.
+struct Kernels {
+  Isa isa;
+  // Sum of n values, widened to 64 bits so it cannot overflow.
+  std::uint64_t (*sum_u32)(const std::uint32_t* data, std::size_t n);
+  // Dot product. Vector variants reassociate, so results differ from
+  // scalar by rounding.
+  float (*dot_f32)(const float* a, const float* b, std::size_t n);
+  // Offset of the first `byte` in data, or n if there is none.
+  std::size_t (*find_byte)(const std::uint8_t* data, std::size_t n,
+                           std::uint8_t byte);
+  // In-place inclusive prefix sum, wrapping on overflow.
+  void (*prefix_sum_u32)(std::uint32_t* data, std::size_t n);
+  // Adds the count of each byte value in data to counts[value].
+  void (*histogram_u8)(const std::uint8_t* data, std::size_t n,
+                       std::uint64_t counts[256]);
+  // Lowercase hex; writes 2 * n chars and returns that count.
+  std::size_t (*hex_encode)(const std::uint8_t* in, std::size_t n, char* out);
+  // Padded standard base64; writes base64_size(n) chars and returns it.
+  std::size_t (*base64_encode)(const std::uint8_t* in, std::size_t n,
+                               char* out);
+  // out[i] = zigzag(in[i] - in[i - 1]), with `prev` before in[0], so small
+  // steps either way become small values; returns the OR of all outputs,
+  // whose bit width is what a bit packer needs.
+  std::uint32_t (*delta_encode_u32)(const std::uint32_t* in, std::size_t n,
+                                    std::uint32_t prev, std::uint32_t* out);
+  // Sorts n <= kSortBlock values ascending in place: a sorting network
+  // where the ISA has 64-bit min/max, else insertion sort.
+  void (*sort_block_u64)(std::uint64_t* data, std::size_t n);
+};
+
+inline constexpr std::size_t base64_size(std::size_t n) {
+  return (n + 2) / 3 * 4;
+}
+
+inline constexpr std::size_t kSortBlock = 64;
+
+// Whether this CPU (and OS) can run `isa`, from cpuid on x86 and
+// getauxval on aarch64.
+bool isa_supported(Isa isa);
+
+// The table for `isa`, or nullptr when it is not compiled into this
+// binary or not supported by this CPU.
+const Kernels* kernels(Isa isa);
+
+// The table chosen at startup: the best supported variant, unless the
+// LAB_SIMD environment variable names another (e.g. LAB_SIMD=scalar).
+const Kernels& active();
+
+// Runs every kernel of `isa` against scalar on generated inputs of
+// assorted lengths and alignments. Returns false and describes the first
+// mismatch in `error`.
+bool cross_check(Isa isa, std::string* error = nullptr);
+
+inline std::uint64_t sum_u32(const std::uint32_t* data, std::size_t n) {
+  return active().sum_u32(data, n);
+}
+inline float dot_f32(const float* a, const float* b, std::size_t n) {
+  return active().dot_f32(a, b, n);
+}
+inline std::size_t find_byte(const std::uint8_t* data, std::size_t n,
+                             std::uint8_t byte) {
+  return active().find_byte(data, n, byte);
+}
+inline void prefix_sum_u32(std::uint32_t* data, std::size_t n) {
+  active().prefix_sum_u32(data, n);
+}
+inline void histogram_u8(const std::uint8_t* data, std::size_t n,
+                         std::uint64_t counts[256]) {
+  active().histogram_u8(data, n, counts);
+}
+inline std::size_t hex_encode(const std::uint8_t* in, std::size_t n,
+                              char* out) {
+  return active().hex_encode(in, n, out);
+}
+inline std::size_t base64_encode(const std::uint8_t* in, std::size_t n,
+                                 char* out) {
+  return active().base64_encode(in, n, out);
+}
+inline std::uint32_t delta_encode_u32(const std::uint32_t* in, std::size_t n,
+                                      std::uint32_t prev, std::uint32_t* out) {
+  return active().delta_encode_u32(in, n, prev, out);
+}
+inline void sort_block_u64(std::uint64_t* data, std::size_t n) {
+  active().sort_block_u64(data, n);
+}
+
+}  // namespace lab::simd
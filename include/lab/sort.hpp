@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace lab {
+class Scheduler;
+}
+
+namespace lab::sort {
+
+// Sorts of 64-bit keys, ascending, to set against std::sort:
+//
+//   pdqsort           Peters' pattern-defeating quicksort: introsort with
+//                     BlockQuicksort's branchless partition, linear time on
+//                     sorted, reversed and all-equal runs
+//   radix_sort_lsd    eight stable byte passes between data and scratch,
+//                     skipping passes where every key has the same byte
+//   radix_sort_msd    in-place American flag sort from the top byte, with
+//                     pdqsort for small buckets
+//   block_merge_sort  simd::sort_block_u64 (a bitonic network on AVX-512)
+//                     over blocks of simd::kSortBlock, then merge passes
+//   sample_sort       buckets split at sampled keys, scattered and sorted
+//                     in parallel on a Scheduler
+//
+// `scratch` must hold n keys; its contents afterwards are unspecified.
+
+void pdqsort(std::uint64_t* data, std::size_t n);
+void radix_sort_lsd(std::uint64_t* data, std::size_t n,
+                    std::uint64_t* scratch);
+void radix_sort_msd(std::uint64_t* data, std::size_t n);
+void block_merge_sort(std::uint64_t* data, std::size_t n,
+                      std::uint64_t* scratch);
+// Runs pdqsort on the caller below about 64K keys or with one worker.
+void sample_sort(Scheduler& pool, std::uint64_t* data, std::size_t n,
+                 std::uint64_t* scratch);
+
+}  // namespace lab::sort
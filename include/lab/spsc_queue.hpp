@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <new>
+#include <utility>
+
+#include "lab/cpu.hpp"
+
+namespace lab {
+
+// Bounded single-producer single-consumer ring. Each side keeps a cached
+// copy of the other side's index and only reloads the shared atomic when
+// the cache says the ring is full (producer) or empty (consumer), so in
+// steady state the index cache lines are not bounced.
+template <class T>
+class SpscQueue {
+ public:
+  explicit SpscQueue(std::size_t capacity)
+      : mask_(std::bit_ceil(capacity < 2 ? 2 : capacity) - 1),
+        slots_(static_cast<Slot*>(::operator new[](
+            (mask_ + 1) * sizeof(Slot), std::align_val_t(alignof(Slot))))) {}
+
+  ~SpscQueue() {
+    T tmp;
+    while (try_pop(tmp)) {
+    }
+    ::operator delete[](slots_, std::align_val_t(alignof(Slot)));
+  }
+
+  SpscQueue(const SpscQueue&) = delete;
+  SpscQueue& operator=(const SpscQueue&) = delete;
+
+  std::size_t capacity() const { return mask_ + 1; }
+
+  // Producer only.
+  template <class U>
+  bool try_push(U&& value) {
+    std::size_t tail = producer_.tail.load(std::memory_order_relaxed);
+    if (tail - producer_.cached_head > mask_) {
+      producer_.cached_head = consumer_.head.load(std::memory_order_acquire);
+      if (tail - producer_.cached_head > mask_) return false;
+    }
+    ::new (slots_[tail & mask_].storage) T(std::forward<U>(value));
+    producer_.tail.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer only.
+  bool try_pop(T& out) {
+    std::size_t head = consumer_.head.load(std::memory_order_relaxed);
+    if (head == consumer_.cached_tail) {
+      consumer_.cached_tail = producer_.tail.load(std::memory_order_acquire);
+      if (head == consumer_.cached_tail) return false;
+    }
+    T* item = std::launder(reinterpret_cast<T*>(slots_[head & mask_].storage));
+    out = std::move(*item);
+    item->~T();
+    consumer_.head.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+ private:
+  struct Slot {
+    alignas(T) unsigned char storage[sizeof(T)];
+  };
+  // Each side's written index shares a line with its private cache.
+  struct alignas(kCacheLine) Producer {
+    std::atomic<std::size_t> tail{0};
+    std::size_t cached_head = 0;
+  };
+  struct alignas(kCacheLine) Consumer {
+    std::atomic<std::size_t> head{0};
+    std::size_t cached_tail = 0;
+  };
+
+  const std::size_t mask_;
+  Slot* const slots_;
+  Producer producer_;
+  Consumer consumer_;
+};
+
+}  // namespace lab
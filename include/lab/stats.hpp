@@ -0,0 +1,67 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace lab {
+
+// Linearly interpolated percentile, `q` in [0, 1]. Sorts `values` in place.
+inline double percentile(std::vector<double>& values, double q) {
+  if (values.empty()) return 0;
+  std::sort(values.begin(), values.end());
+  double pos = q * static_cast<double>(values.size() - 1);
+  auto lo = static_cast<std::size_t>(std::floor(pos));
+  auto hi = static_cast<std::size_t>(std::ceil(pos));
+  double frac = pos - static_cast<double>(lo);
+  return values[lo] + (values[hi] - values[lo]) * frac;
+}
+
+inline double median(std::vector<double>& values) {
+  return percentile(values, 0.5);
+}
+
+// One-sided Mann-Whitney U test. Returns the p-value for the hypothesis
+// that values in `b` tend to be larger than values in `a`, using the
+// normal approximation with tie and continuity corrections. Fine for the
+// 10+ samples per side the runner produces; returns 1 on empty input.
+inline double mann_whitney_greater(const std::vector<double>& a,
+                                   const std::vector<double>& b) {
+  if (a.empty() || b.empty()) return 1;
+  struct Obs {
+    double value;
+    bool from_b;
+  };
+  std::vector<Obs> all;
+  all.reserve(a.size() + b.size());
+  for (double v : a) all.push_back({v, false});
+  for (double v : b) all.push_back({v, true});
+  std::sort(all.begin(), all.end(),
+            [](const Obs& x, const Obs& y) { return x.value < y.value; });
+
+  double n1 = static_cast<double>(a.size());
+  double n2 = static_cast<double>(b.size());
+  double n = n1 + n2;
+  double rank_sum_b = 0;
+  double tie_term = 0;  // sum of t^3 - t over tie groups
+  for (std::size_t i = 0; i < all.size();) {
+    std::size_t j = i;
+    while (j < all.size() && all[j].value == all[i].value) ++j;
+    double rank = (static_cast<double>(i + j) + 1) / 2;  // 1-based midrank
+    for (std::size_t k = i; k < j; ++k) {
+      if (all[k].from_b) rank_sum_b += rank;
+    }
+    double t = static_cast<double>(j - i);
+    tie_term += t * t * t - t;
+    i = j;
+  }
+
+  double u = rank_sum_b - n2 * (n2 + 1) / 2;
+  double mean = n1 * n2 / 2;
+  double var = n1 * n2 / 12 * ((n + 1) - tie_term / (n * (n - 1)));
+  if (var <= 0) return 1;
+  double z = (u - mean - 0.5) / std::sqrt(var);
+  return 0.5 * std::erfc(z / std::sqrt(2.0));
+}
+
+}  // namespace lab
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace lab {
+
+template <class T = void>
+class task;
+
+namespace detail {
+
+struct PromiseBase {
+  // Resumed when the task finishes: whoever co_awaited it.
+  std::coroutine_handle<> continuation = std::noop_coroutine();
+  std::exception_ptr error;
+
+  struct FinalAwaiter {
+    bool await_ready() const noexcept { return false; }
+    template <class P>
+    std::coroutine_handle<> await_suspend(
+        std::coroutine_handle<P> h) const noexcept {
+      return h.promise().continuation;
+    }
+    void await_resume() const noexcept {}
+  };
+
+  std::suspend_always initial_suspend() const noexcept { return {}; }
+  FinalAwaiter final_suspend() const noexcept { return {}; }
+  void unhandled_exception() { error = std::current_exception(); }
+  void rethrow() const {
+    if (error) std::rethrow_exception(error);
+  }
+};
+
+template <class T>
+struct Promise : PromiseBase {
+  std::optional<T> value;
+
+  task<T> get_return_object();
+  template <class U>
+  void return_value(U&& v) {
+    value.emplace(std::forward<U>(v));
+  }
+  T result() {
+    rethrow();
+    return std::move(*value);
+  }
+};
+
+template <>
+struct Promise<void> : PromiseBase {
+  task<void> get_return_object();
+  void return_void() const noexcept {}
+  void result() const { rethrow(); }
+};
+
+}  // namespace detail
+
+// A lazily started coroutine producing a T: the body runs only once the
+// task is co_awaited, and the awaiter resumes by symmetric transfer when
+// it finishes, so chains of tasks do not grow the stack. Exceptions
+// propagate to the awaiter. Move-only; destroying an unfinished task
+// destroys its frame.
+//
+//   lab::task<int> answer() { co_return 42; }
+//   lab::task<> caller() { int x = co_await answer(); ... }
+//
+// Run a top-level task with lab::EventLoop::run (lab/event_loop.hpp).
+template <class T>
+class [[nodiscard]] task {
+ public:
+  using promise_type = detail::Promise<T>;
+  using handle_type = std::coroutine_handle<promise_type>;
+
+  task() = default;
+  explicit task(handle_type h) : h_(h) {}
+  task(task&& other) noexcept : h_(std::exchange(other.h_, {})) {}
+  task& operator=(task&& other) noexcept {
+    if (this != &other) {
+      if (h_) h_.destroy();
+      h_ = std::exchange(other.h_, {});
+    }
+    return *this;
+  }
+  ~task() {
+    if (h_) h_.destroy();
+  }
+
+  bool valid() const { return static_cast<bool>(h_); }
+  bool done() const { return h_ && h_.done(); }
+
+  bool await_ready() const noexcept { return false; }
+  std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiter) {
+    h_.promise().continuation = awaiter;
+    return h_;
+  }
+  T await_resume() { return h_.promise().result(); }
+
+ private:
+  handle_type h_;
+};
+
+namespace detail {
+
+template <class T>
+task<T> Promise<T>::get_return_object() {
+  return task<T>(std::coroutine_handle<Promise<T>>::from_promise(*this));
+}
+
+inline task<void> Promise<void>::get_return_object() {
+  return task<void>(std::coroutine_handle<Promise<void>>::from_promise(*this));
+}
+
+// A started child of when_all: awaits its task, then resumes the parent
+// once the last child is done. Frees its own frame at the end.
+struct WhenAllChild {
+  struct promise_type {
+    std::size_t* remaining;
+    std::coroutine_handle<>* parent;
+
+    WhenAllChild get_return_object() {
+      return {std::coroutine_handle<promise_type>::from_promise(*this)};
+    }
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    struct FinalAwaiter {
+      bool await_ready() const noexcept { return false; }
+      std::coroutine_handle<> await_suspend(
+          std::coroutine_handle<promise_type> h) const noexcept {
+        std::coroutine_handle<> next = std::noop_coroutine();
+        if (--*h.promise().remaining == 0) next = *h.promise().parent;
+        h.destroy();
+        return next;
+      }
+      void await_resume() const noexcept {}
+    };
+    FinalAwaiter final_suspend() const noexcept { return {}; }
+    void return_void() const noexcept {}
+    void unhandled_exception() const noexcept { std::terminate(); }
+  };
+  std::coroutine_handle<promise_type> h;
+};
+
+inline WhenAllChild when_all_child(task<>& t, std::exception_ptr& error) {
+  try {
+    co_await t;
+  } catch (...) {
+    if (!error) error = std::current_exception();
+  }
+}
+
+struct WhenAllAwaiter {
+  std::vector<task<>>& tasks;
+  std::size_t remaining;
+  std::coroutine_handle<> parent;
+  std::exception_ptr error;
+
+  bool await_ready() const noexcept { return tasks.empty(); }
+  bool await_suspend(std::coroutine_handle<> h) {
+    parent = h;
+    // Each child may finish immediately, so count them all in first.
+    remaining = tasks.size() + 1;
+    for (auto& t : tasks) {
+      WhenAllChild child = when_all_child(t, error);
+      child.h.promise().remaining = &remaining;
+      child.h.promise().parent = &parent;
+      child.h.resume();
+    }
+    return --remaining != 0;
+  }
+  void await_resume() const {
+    if (error) std::rethrow_exception(error);
+  }
+};
+
+}  // namespace detail
+
+// Starts every task and finishes when all have; the first exception, if
+// any, is rethrown after the others are done. For the lab's single-thread
+// event loop, so completions must not race each other.
+inline task<> when_all(std::vector<task<>> tasks) {
+  co_await detail::WhenAllAwaiter{tasks, 0, {}, {}};
+}
+
+}  // namespace lab
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "lab/bench.hpp"
+
+namespace lab {
+
+// Collects the failures of one running test.
+class TestContext {
+ public:
+  void fail(const char* file, int line, std::string message);
+  bool failed() const { return !failures_.empty(); }
+  const std::vector<std::string>& failures() const { return failures_; }
+
+ private:
+  std::vector<std::string> failures_;
+};
+
+using TestFn = std::function<void(TestContext&)>;
+
+struct Test {
+  std::string name;
+  TestFn fn;
+};
+
+// Process-wide list of tests, filled by LAB_TEST at static init.
+class TestRegistry {
+ public:
+  static TestRegistry& global();
+
+  void add(std::string name, TestFn fn) {
+    tests_.push_back({std::move(name), std::move(fn)});
+  }
+  const std::vector<Test>& tests() const { return tests_; }
+
+ private:
+  std::vector<Test> tests_;
+};
+
+struct TestRegistration {
+  TestRegistration(std::string name, TestFn fn) {
+    TestRegistry::global().add(std::move(name), std::move(fn));
+  }
+};
+
+enum class TestFormat { json, junit };
+
+struct TestOptions {
+  std::string filter;    // ECMAScript regex matched against test names
+  int shard_index = 0;   // run tests whose position % shard_count matches
+  int shard_count = 1;
+  int jobs = 1;          // processes the shard is split across
+  TestFormat format = TestFormat::json;
+  std::string output = "test_output.txt";
+};
+
+struct TestResult {
+  std::string name;
+  bool passed = false;
+  double seconds = 0;
+  std::vector<std::string> failures;
+};
+
+// Parses "i/n" with 0 <= i < n.
+bool parse_shard(const std::string& spec, int& index, int& count);
+
+// Runs the selected tests of this shard in registry order. With jobs > 1
+// they are split across forked processes, so a test that crashes fails
+// alone (along with the tests of its process left unrun, which are
+// reported as such) instead of taking the whole run down.
+std::vector<TestResult> run_tests(const TestRegistry& registry,
+                                  const TestOptions& opts);
+
+// Line-delimited JSON, one object per test:
+//   {"name":"...","status":"pass","seconds":0.001,"failures":[]}
+// or a JUnit XML <testsuites> document.
+void write_test_results(std::ostream& out,
+                        const std::vector<TestResult>& results,
+                        TestFormat format);
+
+namespace detail {
+
+template <class T>
+std::string describe(const T& value) {
+  if constexpr (std::is_same_v<T, bool>) {
+    return value ? "true" : "false";
+  } else if constexpr (std::is_arithmetic_v<T>) {
+    return std::to_string(value);
+  } else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+    return "\"" + std::string(std::string_view(value)) + "\"";
+  } else {
+    return "<value>";
+  }
+}
+
+template <class A, class B>
+std::string describe_pair(const char* expr, const A& a, const B& b) {
+  return std::string(expr) + " with " + describe(a) + " vs " + describe(b);
+}
+
+}  // namespace detail
+
+}  // namespace lab
+
+// Defines and registers a test:
+//
+//   LAB_TEST(grid_parses_ranges) {
+//     LAB_CHECK_EQ(lab::grid("1..4").size(), 3u);
+//   }
+#define LAB_TEST(name)                                                        \
+  static void name(::lab::TestContext&);                                      \
+  static ::lab::TestRegistration LAB_CONCAT(lab_test_registration_,           \
+                                            __COUNTER__)(#name, name);        \
+  static void name([[maybe_unused]] ::lab::TestContext& lab_test_context)
+
+// Records a failure and carries on.
+#define LAB_CHECK(cond)                                                       \
+  do {                                                                        \
+    if (!(cond)) {                                                            \
+      lab_test_context.fail(__FILE__, __LINE__, "LAB_CHECK(" #cond ")");      \
+    }                                                                         \
+  } while (0)
+
+#define LAB_CHECK_OP(a, op, b)                                                \
+  do {                                                                        \
+    const auto& lab_a = (a);                                                  \
+    const auto& lab_b = (b);                                                  \
+    if (!(lab_a op lab_b)) {                                                  \
+      lab_test_context.fail(                                                  \
+          __FILE__, __LINE__,                                                 \
+          ::lab::detail::describe_pair(#a " " #op " " #b, lab_a, lab_b));     \
+    }                                                                         \
+  } while (0)
+
+#define LAB_CHECK_EQ(a, b) LAB_CHECK_OP(a, ==, b)
+#define LAB_CHECK_NE(a, b) LAB_CHECK_OP(a, !=, b)
+#define LAB_CHECK_LT(a, b) LAB_CHECK_OP(a, <, b)
+#define LAB_CHECK_LE(a, b) LAB_CHECK_OP(a, <=, b)
+
+// Records a failure and returns from the test.
+#define LAB_REQUIRE(cond)                                                     \
+  do {                                                                        \
+    if (!(cond)) {                                                            \
+      lab_test_context.fail(__FILE__, __LINE__, "LAB_REQUIRE(" #cond ")");    \
+      return;                                                                 \
+    }                                                                         \
+  } while (0)
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace lab {
+
+// CPUs this process may run on, grouped by NUMA node, read from sysfs and
+// the affinity mask the process started with, so threads pinned since
+// (lab_bench pins its main thread) still see the whole machine. Machines
+// without NUMA information report one node.
+struct Topology {
+  std::vector<std::vector<int>> node_cpus;
+  std::vector<int> node_ids;  // sysfs node id of each node_cpus entry
+
+  static Topology detect();
+
+  int cpu_count() const;
+  int node_of(int cpu) const;  // index into node_cpus, -1 if unknown
+
+  // `n` CPUs, filling each node before moving on to the next (compact) or
+  // round-robin across nodes (spread). Wraps around when n > cpu_count().
+  std::vector<int> pick(int n, bool spread) const;
+};
+
+// Pins the calling thread to `cpu` (or the CPU it is on when `cpu` < 0).
+// Returns the CPU pinned to, or -1 on failure.
+int pin_thread(int cpu);
+
+// Runs `fn` on the calling thread with the affinity the process started
+// with, then restores the thread's own. Plugins each link their own copy
+// of lab, which reads that mask when it is loaded, so --watch reloads
+// them inside this.
+void with_startup_affinity(const std::function<void()>& fn);
+
+// Parses a sysfs CPU list such as "0-3,8,10-11".
+std::vector<int> parse_cpu_list(const std::string& list);
+
+}  // namespace lab
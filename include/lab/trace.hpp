@@ -0,0 +1,168 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// Set to 0 by -DLAB_TRACE=OFF: LAB_TRACE_SCOPE then compiles to nothing.
+#ifndef LAB_TRACE_ENABLED
+#define LAB_TRACE_ENABLED 1
+#endif
+
+namespace lab::trace {
+
+// A raw timestamp: the TSC on x86, the virtual counter on aarch64, else
+// steady_clock nanoseconds. Converted to time when the trace is written.
+inline std::uint64_t ticks() {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#elif defined(__aarch64__)
+  std::uint64_t v;
+  asm volatile("mrs %0, cntvct_el0" : "=r"(v));
+  return v;
+#else
+  return static_cast<std::uint64_t>(
+      std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+// One scope boundary, 16 bytes.
+struct Record {
+  std::uint64_t ticks;
+  std::uint32_t name;  // from intern()
+  std::uint32_t end;   // 0: scope entered, 1: scope left
+};
+
+namespace detail {
+
+// A ring entry. drain() reads slots while their thread may be rewriting
+// them, so the fields are relaxed atomics; a torn copy is detected by
+// rereading head, as in a seqlock, and thrown away.
+struct Slot {
+  std::atomic<std::uint64_t> ticks{0};
+  std::atomic<std::uint32_t> name{0};
+  std::atomic<std::uint32_t> end{0};
+
+  void store(const Record& r) {
+    ticks.store(r.ticks, std::memory_order_relaxed);
+    name.store(r.name, std::memory_order_relaxed);
+    end.store(r.end, std::memory_order_relaxed);
+  }
+  Record load() const {
+    return {ticks.load(std::memory_order_relaxed),
+            name.load(std::memory_order_relaxed),
+            end.load(std::memory_order_relaxed)};
+  }
+};
+
+// One thread's ring; only that thread writes, and the oldest records are
+// overwritten once it is full.
+struct ThreadBuffer {
+  Slot* records = nullptr;
+  std::uint64_t mask = 0;
+  std::atomic<std::uint64_t> head{0};
+};
+
+inline std::atomic<bool> enabled{false};
+inline thread_local ThreadBuffer* buffer = nullptr;
+// Handed to threads beyond Options::max_threads; never written.
+inline ThreadBuffer overflow;
+
+ThreadBuffer* register_thread();
+
+}  // namespace detail
+
+struct Options {
+  std::size_t records_per_thread = 1 << 16;  // rounded up to a power of 2
+  std::size_t max_threads = 256;  // later threads are not traced
+};
+
+// Clears every buffer and starts recording. Like stop() and write_json(),
+// it must not run concurrently with traced code.
+void start(const Options& opts = {});
+void stop();
+
+// Pauses or resumes recording without clearing anything.
+inline void set_enabled(bool on) {
+  detail::enabled.store(on, std::memory_order_relaxed);
+}
+inline bool enabled() {
+  return detail::enabled.load(std::memory_order_relaxed);
+}
+
+// Stable id of `name`, the same for every call with equal text.
+std::uint32_t intern(std::string_view name);
+
+inline void record(std::uint32_t name, bool end) {
+  detail::ThreadBuffer* b = detail::buffer;
+  if (b == nullptr) b = detail::register_thread();
+  if (b == &detail::overflow) return;
+  std::uint64_t h = b->head.load(std::memory_order_relaxed);
+  // Orders the previous publish of head before this overwrite, so a
+  // drain() that copies any of the new fields also sees head >= h.
+  std::atomic_thread_fence(std::memory_order_release);
+  b->records[h & b->mask].store({ticks(), name, end ? 1u : 0u});
+  b->head.store(h + 1, std::memory_order_release);
+}
+
+// Records entering on construction and leaving on destruction, if tracing
+// was enabled when it was constructed.
+class Scope {
+ public:
+  explicit Scope(std::uint32_t name) : name_(name), active_(enabled()) {
+    if (active_) record(name_, false);
+  }
+  ~Scope() {
+    if (active_) record(name_, true);
+  }
+  Scope(const Scope&) = delete;
+  Scope& operator=(const Scope&) = delete;
+
+ private:
+  std::uint32_t name_;
+  bool active_;
+};
+
+// Writes every thread's records as Chrome trace-event JSON, which
+// chrome://tracing and ui.perfetto.dev open. Leave events whose enter was
+// overwritten are dropped.
+bool write_json(const std::string& path, std::string* error = nullptr);
+
+// Calls visit(name, ns) for each scope left since the previous drain() or
+// start(), on every thread. Unlike write_json() it may run while traced
+// threads record: it copies each ring past its last visit and drops what
+// the writer overwrote meanwhile, as perf(1) reads the kernel's rings.
+// Scopes cut off that way, or entered before the previous drain and lost
+// to a wrap, are not visited. `visit` must not call into lab::trace.
+void drain(const std::function<void(std::uint32_t name, std::uint64_t ns)>&
+               visit);
+
+// The text interned as `id`, or an empty string.
+std::string name_of(std::uint32_t id);
+
+}  // namespace lab::trace
+
+#define LAB_TRACE_CONCAT_IMPL(a, b) a##b
+#define LAB_TRACE_CONCAT(a, b) LAB_TRACE_CONCAT_IMPL(a, b)
+
+// Traces the enclosing scope under `name`, a string literal. Interning
+// happens once per call site; afterwards a disabled scope costs one load
+// and branch, an enabled one two timestamped 16-byte stores.
+#if LAB_TRACE_ENABLED
+#define LAB_TRACE_SCOPE(name)                                         \
+  static const std::uint32_t LAB_TRACE_CONCAT(lab_trace_id_,          \
+                                              __LINE__) =             \
+      ::lab::trace::intern(name);                                     \
+  ::lab::trace::Scope LAB_TRACE_CONCAT(lab_trace_scope_, __LINE__)(   \
+      LAB_TRACE_CONCAT(lab_trace_id_, __LINE__))
+#else
+#define LAB_TRACE_SCOPE(name) static_cast<void>(0)
+#endif
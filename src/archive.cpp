@@ -0,0 +1,410 @@
+#include "lab/archive.hpp"
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <ctime>
+#include <limits>
+#include <utility>
+
+namespace lab {
+
+namespace {
+
+constexpr char kFileMagic[8] = {'L', 'A', 'B', 'H', 'I', 'S', 'T', '\0'};
+constexpr std::uint32_t kVersion = 1;
+constexpr std::uint32_t kBlockMagic = 0x4e55524c;  // "LRUN"
+
+struct FileHeader {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t reserved;
+};
+
+// Offsets are relative to the start of the block; string references are
+// relative to its string table.
+struct BlockHeader {
+  std::uint32_t magic;
+  std::uint32_t header_size;
+  std::uint64_t block_size;  // including header and padding to 8 bytes
+  std::int64_t timestamp;
+  std::uint32_t rows;
+  std::uint32_t metric_count;
+  std::uint32_t commit;
+  std::uint32_t host;
+  std::uint32_t names;    // uint32_t[rows] string references
+  std::uint32_t order;    // uint32_t[rows] row numbers sorted by name
+  std::uint32_t metrics;  // MetricEntry[metric_count]
+  std::uint32_t strings;
+};
+
+struct MetricEntry {
+  std::uint32_t name;
+  std::uint32_t column;  // double[rows]
+};
+
+const BlockHeader& header_of(const char* block) {
+  return *reinterpret_cast<const BlockHeader*>(block);
+}
+
+// Whether `h`, found at `off` in a file of `size` bytes, heads a complete
+// and consistent block. Only a torn final append fails this.
+bool block_ok(const BlockHeader& h, std::size_t off, std::size_t size) {
+  std::uint64_t columns_end = std::uint64_t{h.metrics} +
+                              std::uint64_t{h.metric_count} *
+                                  sizeof(MetricEntry);
+  return h.magic == kBlockMagic && h.header_size >= sizeof(BlockHeader) &&
+         h.block_size <= size - off && h.block_size % 8 == 0 &&
+         h.strings < h.block_size && columns_end <= h.block_size &&
+         std::uint64_t{h.names} + h.rows * 4ull <= h.block_size &&
+         std::uint64_t{h.order} + h.rows * 4ull <= h.block_size;
+}
+
+void set_error(std::string* error, std::string message) {
+  if (error != nullptr) *error = std::move(message);
+}
+
+std::string errno_message(const std::string& what) {
+  return what + ": " + std::strerror(errno);
+}
+
+// Builds one block in memory.
+class BlockWriter {
+ public:
+  std::size_t reserve(std::size_t bytes, std::size_t align = 4) {
+    buf_.resize((buf_.size() + align - 1) / align * align);
+    std::size_t at = buf_.size();
+    buf_.resize(at + bytes);
+    return at;
+  }
+  std::uint32_t add_string(std::string_view s) {
+    auto at = static_cast<std::uint32_t>(strings_.size());
+    strings_.append(s);
+    strings_.push_back('\0');
+    return at;
+  }
+  template <typename T>
+  T* at(std::size_t offset) {
+    return reinterpret_cast<T*>(buf_.data() + offset);
+  }
+  // Appends the string table and pads the block to 8 bytes.
+  std::size_t finish() {
+    std::size_t at = buf_.size();
+    buf_.append(strings_);
+    buf_.resize((buf_.size() + 7) / 8 * 8);
+    return at;
+  }
+  std::string& bytes() { return buf_; }
+
+ private:
+  std::string buf_;
+  std::string strings_;
+};
+
+bool write_all(int fd, const char* data, std::size_t size) {
+  while (size > 0) {
+    ssize_t n = ::write(fd, data, size);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    data += n;
+    size -= static_cast<std::size_t>(n);
+  }
+  return true;
+}
+
+// Truncates the archive open on `fd` after its last complete block. A
+// crash mid-append leaves a block that readers stop at, and without this
+// every run appended after it would be unreachable.
+bool drop_torn_tail(int fd) {
+  struct stat st;
+  if (::fstat(fd, &st) != 0) return false;
+  auto size = static_cast<std::size_t>(st.st_size);
+  std::size_t off = sizeof(FileHeader);
+  BlockHeader h;
+  while (off + sizeof(h) <= size &&
+         ::pread(fd, &h, sizeof(h), static_cast<off_t>(off)) ==
+             static_cast<ssize_t>(sizeof(h)) &&
+         block_ok(h, off, size)) {
+    off += h.block_size;
+  }
+  return off >= size || ::ftruncate(fd, static_cast<off_t>(off)) == 0;
+}
+
+// Creates the archive with its file header unless it exists. The header
+// goes into a private file that is then linked into place, so another
+// appender never sees an archive without one.
+bool create_archive(const std::string& path, std::string* error) {
+  if (::access(path.c_str(), F_OK) == 0) return true;
+  std::string tmp = path + ".tmp." + std::to_string(::getpid());
+  int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    set_error(error, errno_message(tmp));
+    return false;
+  }
+  FileHeader fh{};
+  std::memcpy(fh.magic, kFileMagic, sizeof(kFileMagic));
+  fh.version = kVersion;
+  bool ok = write_all(fd, reinterpret_cast<const char*>(&fh), sizeof(fh));
+  ::close(fd);
+  if (ok && ::link(tmp.c_str(), path.c_str()) != 0 && errno != EEXIST) {
+    ok = false;
+  }
+  if (!ok) set_error(error, errno_message(path));
+  ::unlink(tmp.c_str());
+  return ok;
+}
+
+}  // namespace
+
+bool append_run(const std::string& path, const RunInfo& info,
+                const std::vector<Result>& results, std::string* error) {
+  std::vector<std::string> metric_names = {"iterations", "ns_per_op",
+                                           "p50_ns", "p99_ns", "bytes_per_op"};
+  for (const auto& r : results) {
+    for (const auto& [name, value] : r.counters) {
+      if (std::find(metric_names.begin(), metric_names.end(), name) ==
+          metric_names.end()) {
+        metric_names.push_back(name);
+      }
+    }
+  }
+
+  std::size_t rows = results.size();
+  std::size_t metrics = metric_names.size();
+  BlockWriter w;
+  std::size_t header = w.reserve(sizeof(BlockHeader), 8);
+  std::size_t entries = w.reserve(metrics * sizeof(MetricEntry));
+  std::size_t names = w.reserve(rows * sizeof(std::uint32_t));
+  std::size_t order = w.reserve(rows * sizeof(std::uint32_t));
+  std::vector<std::size_t> columns(metrics);
+  for (auto& c : columns) c = w.reserve(rows * sizeof(double), 8);
+
+  for (std::size_t m = 0; m < metrics; ++m) {
+    auto* e = w.at<MetricEntry>(entries) + m;
+    e->name = w.add_string(metric_names[m]);
+    e->column = static_cast<std::uint32_t>(columns[m]);
+  }
+  constexpr double kMissing = std::numeric_limits<double>::quiet_NaN();
+  for (std::size_t row = 0; row < rows; ++row) {
+    const Result& r = results[row];
+    w.at<std::uint32_t>(names)[row] = w.add_string(r.name);
+    const double fixed[] = {static_cast<double>(r.iterations), r.ns_per_op,
+                            r.p50_ns, r.p99_ns, r.bytes_per_op};
+    for (std::size_t m = 0; m < metrics; ++m) {
+      const double* v = m < 5 ? &fixed[m] : r.counter(metric_names[m]);
+      w.at<double>(columns[m])[row] = v != nullptr ? *v : kMissing;
+    }
+  }
+  std::vector<std::uint32_t> sorted(rows);
+  for (std::size_t i = 0; i < rows; ++i) {
+    sorted[i] = static_cast<std::uint32_t>(i);
+  }
+  std::stable_sort(sorted.begin(), sorted.end(),
+                   [&](std::uint32_t a, std::uint32_t b) {
+                     return results[a].name < results[b].name;
+                   });
+  std::copy(sorted.begin(), sorted.end(), w.at<std::uint32_t>(order));
+
+  std::string host = info.host;
+  if (host.empty()) {
+    char buf[256] = {};
+    if (gethostname(buf, sizeof(buf) - 1) == 0) host = buf;
+  }
+  std::uint32_t commit_ref = w.add_string(info.commit);
+  std::uint32_t host_ref = w.add_string(host);
+  std::size_t strings = w.finish();
+  if (w.bytes().size() > std::numeric_limits<std::uint32_t>::max()) {
+    set_error(error, "run too large for one archive block");
+    return false;
+  }
+
+  auto* h = w.at<BlockHeader>(header);
+  h->magic = kBlockMagic;
+  h->header_size = sizeof(BlockHeader);
+  h->block_size = w.bytes().size();
+  h->timestamp = info.timestamp != 0
+                     ? info.timestamp
+                     : static_cast<std::int64_t>(std::time(nullptr));
+  h->rows = static_cast<std::uint32_t>(rows);
+  h->metric_count = static_cast<std::uint32_t>(metrics);
+  h->commit = commit_ref;
+  h->host = host_ref;
+  h->names = static_cast<std::uint32_t>(names);
+  h->order = static_cast<std::uint32_t>(order);
+  h->metrics = static_cast<std::uint32_t>(entries);
+  h->strings = static_cast<std::uint32_t>(strings);
+
+  if (!create_archive(path, error)) return false;
+  int fd = ::open(path.c_str(), O_RDWR | O_APPEND);
+  if (fd < 0) {
+    set_error(error, errno_message(path));
+    return false;
+  }
+  // Held until close(): appenders take turns, so a write that returns
+  // short and is continued still cannot interleave with another run.
+  bool ok = ::flock(fd, LOCK_EX) == 0 && drop_torn_tail(fd) &&
+            write_all(fd, w.bytes().data(), w.bytes().size());
+  if (!ok) set_error(error, errno_message(path));
+  ::close(fd);
+  return ok;
+}
+
+Archive::~Archive() { close(); }
+
+Archive::Archive(Archive&& other) noexcept { *this = std::move(other); }
+
+Archive& Archive::operator=(Archive&& other) noexcept {
+  if (this != &other) {
+    close();
+    data_ = std::exchange(other.data_, nullptr);
+    size_ = std::exchange(other.size_, 0);
+    blocks_ = std::move(other.blocks_);
+  }
+  return *this;
+}
+
+void Archive::close() {
+  if (data_ != nullptr) {
+    ::munmap(const_cast<char*>(data_), size_);
+  }
+  data_ = nullptr;
+  size_ = 0;
+  blocks_.clear();
+}
+
+bool Archive::open(const std::string& path, std::string* error) {
+  close();
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    set_error(error, errno_message(path));
+    return false;
+  }
+  // Shared against appenders, which may truncate a torn tail that the
+  // indexing below would read.
+  struct stat st;
+  if (::flock(fd, LOCK_SH) != 0 || ::fstat(fd, &st) != 0) {
+    set_error(error, errno_message(path));
+    ::close(fd);
+    return false;
+  }
+  auto size = static_cast<std::size_t>(st.st_size);
+  FileHeader fh{};
+  if (size < sizeof(fh) ||
+      ::pread(fd, &fh, sizeof(fh), 0) != static_cast<ssize_t>(sizeof(fh)) ||
+      std::memcmp(fh.magic, kFileMagic, sizeof(kFileMagic)) != 0) {
+    set_error(error, path + ": not a lab archive");
+    ::close(fd);
+    return false;
+  }
+  if (fh.version != kVersion) {
+    set_error(error, path + ": unsupported archive version " +
+                         std::to_string(fh.version));
+    ::close(fd);
+    return false;
+  }
+  void* map = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  if (map == MAP_FAILED) {
+    set_error(error, errno_message(path));
+    ::close(fd);
+    return false;
+  }
+  data_ = static_cast<const char*>(map);
+  size_ = size;
+
+  // Index blocks up to the first one that is incomplete or inconsistent,
+  // which can only be a torn final append.
+  for (std::size_t off = sizeof(FileHeader);
+       off + sizeof(BlockHeader) <= size_;) {
+    const BlockHeader& h = header_of(data_ + off);
+    if (!block_ok(h, off, size_)) break;
+    blocks_.push_back(off);
+    off += h.block_size;
+  }
+  // Explicitly: the mapping keeps the open file, and so the lock, alive.
+  ::flock(fd, LOCK_UN);
+  ::close(fd);
+  return true;
+}
+
+std::string_view Archive::Run::string(std::uint32_t offset) const {
+  return std::string_view(block_ + header_of(block_).strings + offset);
+}
+
+std::int64_t Archive::Run::timestamp() const {
+  return header_of(block_).timestamp;
+}
+
+std::string_view Archive::Run::commit() const {
+  return string(header_of(block_).commit);
+}
+
+std::string_view Archive::Run::host() const {
+  return string(header_of(block_).host);
+}
+
+std::size_t Archive::Run::rows() const { return header_of(block_).rows; }
+
+std::string_view Archive::Run::name(std::size_t row) const {
+  const auto* names = reinterpret_cast<const std::uint32_t*>(
+      block_ + header_of(block_).names);
+  return string(names[row]);
+}
+
+std::ptrdiff_t Archive::Run::find(std::string_view name) const {
+  const auto* order = reinterpret_cast<const std::uint32_t*>(
+      block_ + header_of(block_).order);
+  const auto* end = order + rows();
+  const auto* it = std::lower_bound(
+      order, end, name,
+      [&](std::uint32_t row, std::string_view n) { return this->name(row) < n; });
+  if (it == end || this->name(*it) != name) return -1;
+  return static_cast<std::ptrdiff_t>(*it);
+}
+
+std::size_t Archive::Run::metric_count() const {
+  return header_of(block_).metric_count;
+}
+
+std::string_view Archive::Run::metric_name(std::size_t i) const {
+  const auto* entries = reinterpret_cast<const MetricEntry*>(
+      block_ + header_of(block_).metrics);
+  return string(entries[i].name);
+}
+
+const double* Archive::Run::metric(std::size_t i) const {
+  const auto* entries = reinterpret_cast<const MetricEntry*>(
+      block_ + header_of(block_).metrics);
+  return reinterpret_cast<const double*>(block_ + entries[i].column);
+}
+
+const double* Archive::Run::metric(std::string_view name) const {
+  for (std::size_t i = 0; i < metric_count(); ++i) {
+    if (metric_name(i) == name) return metric(i);
+  }
+  return nullptr;
+}
+
+std::vector<TrendPoint> trend(const Archive& archive,
+                              std::string_view benchmark,
+                              std::string_view metric) {
+  std::vector<TrendPoint> points;
+  for (Archive::Run run : archive) {
+    std::ptrdiff_t row = run.find(benchmark);
+    if (row < 0) continue;
+    const double* column = run.metric(metric);
+    if (column == nullptr || std::isnan(column[row])) continue;
+    points.push_back({run.timestamp(), run.commit(), column[row]});
+  }
+  return points;
+}
+
+}  // namespace lab
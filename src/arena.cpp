@@ -0,0 +1,69 @@
+#include "lab/arena.hpp"
+
+#include <algorithm>
+
+namespace lab {
+
+Arena::Arena(std::size_t chunk_size, std::pmr::memory_resource* upstream)
+    : chunk_size_(std::max(chunk_size, sizeof(Chunk) * 2)),
+      upstream_(upstream) {}
+
+Arena::~Arena() { release(); }
+
+void Arena::enter(Chunk* chunk) {
+  current_ = chunk;
+  ptr_ = chunk->begin();
+  end_ = chunk->end();
+}
+
+void* Arena::allocate_slow(std::size_t bytes, std::size_t align) {
+  // Reuse chunks kept by reset() before asking upstream for more.
+  while (current_ != nullptr && current_->next != nullptr) {
+    enter(current_->next);
+    if (char* p = bump(bytes, align)) return p;
+  }
+
+  std::size_t need = sizeof(Chunk) + bytes + align;
+  std::size_t size = std::max(chunk_size_, need);
+  auto* chunk = static_cast<Chunk*>(
+      upstream_->allocate(size, alignof(std::max_align_t)));
+  chunk->next = nullptr;
+  chunk->size = size;
+  capacity_ += size;
+  if (current_ == nullptr) {
+    first_ = chunk;
+  } else {
+    current_->next = chunk;
+  }
+  enter(chunk);
+  return bump(bytes, align);
+}
+
+void Arena::reset() {
+  if (first_ == nullptr) return;
+  enter(first_);
+}
+
+void Arena::release() {
+  for (Chunk* c = first_; c != nullptr;) {
+    Chunk* next = c->next;
+    upstream_->deallocate(c, c->size, alignof(std::max_align_t));
+    c = next;
+  }
+  first_ = current_ = nullptr;
+  ptr_ = end_ = nullptr;
+  capacity_ = 0;
+}
+
+std::size_t Arena::used() const {
+  std::size_t total = 0;
+  for (Chunk* c = first_; c != nullptr; c = c->next) {
+    if (c == current_) {
+      return total + static_cast<std::size_t>(ptr_ - c->begin());
+    }
+    total += static_cast<std::size_t>(c->end() - c->begin());
+  }
+  return total;
+}
+
+}  // namespace lab
@@ -0,0 +1,140 @@
+#include "lab/bitpack.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+#include "lab/simd.hpp"
+
+namespace lab::bitpack {
+
+namespace {
+
+constexpr std::size_t kLanes = 4;
+constexpr std::size_t kHeader = sizeof(std::uint64_t);
+
+// Packs a block of values below 2^w into 4 * w words. The lane loops have
+// uniform shifts, so the compiler turns each into one vector instruction.
+void pack(const std::uint32_t* v, unsigned w, std::uint32_t* out) {
+  if (w == 32) {
+    std::memcpy(out, v, kBlock * sizeof(std::uint32_t));
+    return;
+  }
+  std::uint32_t acc[kLanes] = {};
+  unsigned bits = 0;
+  for (std::size_t g = 0; g < kBlock; g += kLanes) {
+    for (std::size_t l = 0; l < kLanes; ++l) acc[l] |= v[g + l] << bits;
+    bits += w;
+    if (bits < 32) continue;
+    bits -= 32;
+    for (std::size_t l = 0; l < kLanes; ++l) out[l] = acc[l];
+    out += kLanes;
+    // The high bits that did not fit start the next word.
+    for (std::size_t l = 0; l < kLanes; ++l) {
+      acc[l] = bits == 0 ? 0 : v[g + l] >> (w - bits);
+    }
+  }
+}
+
+void unpack(const std::uint32_t* in, unsigned w, std::uint32_t* v) {
+  if (w == 0) {
+    std::fill(v, v + kBlock, 0);
+    return;
+  }
+  if (w == 32) {
+    std::memcpy(v, in, kBlock * sizeof(std::uint32_t));
+    return;
+  }
+  const std::uint32_t mask = (std::uint32_t{1} << w) - 1;
+  unsigned bits = 0;
+  for (std::size_t g = 0; g < kBlock; g += kLanes) {
+    for (std::size_t l = 0; l < kLanes; ++l) v[g + l] = in[l] >> bits;
+    bits += w;
+    if (bits >= 32) {
+      bits -= 32;
+      in += kLanes;
+      if (bits > 0) {
+        for (std::size_t l = 0; l < kLanes; ++l) {
+          v[g + l] |= in[l] << (w - bits);
+        }
+      }
+    }
+    for (std::size_t l = 0; l < kLanes; ++l) v[g + l] &= mask;
+  }
+}
+
+}  // namespace
+
+std::size_t bound(std::size_t bytes) {
+  std::size_t blocks = (bytes / 4 + kBlock - 1) / kBlock;
+  return kHeader + blocks * (1 + kBlock * 4) + bytes % 4;
+}
+
+std::size_t compress(const void* in, std::size_t bytes, void* out) {
+  const auto* src = static_cast<const std::byte*>(in);
+  auto* dst = static_cast<std::byte*>(out);
+  const std::uint64_t size = bytes;
+  std::memcpy(dst, &size, kHeader);
+  dst += kHeader;
+
+  // Each block is copied out first: `in` need not be word aligned.
+  std::uint32_t block[kBlock], deltas[kBlock], packed[kBlock];
+  std::uint32_t prev = 0;
+  std::size_t words = bytes / 4;
+  for (std::size_t i = 0; i < words; i += kBlock) {
+    std::size_t n = std::min(kBlock, words - i);
+    std::memcpy(block, src + i * 4, n * 4);
+    std::fill(block + n, block + kBlock, block[n - 1]);
+    auto w = static_cast<unsigned>(
+        std::bit_width(simd::delta_encode_u32(block, kBlock, prev, deltas)));
+    prev = block[kBlock - 1];
+    pack(deltas, w, packed);
+    *dst++ = static_cast<std::byte>(w);
+    std::memcpy(dst, packed, w * 16);
+    dst += w * 16;
+  }
+  std::memcpy(dst, src + words * 4, bytes % 4);
+  dst += bytes % 4;
+  return static_cast<std::size_t>(dst - static_cast<std::byte*>(out));
+}
+
+bool decompressed_size(const void* in, std::size_t size, std::size_t& out) {
+  if (size < kHeader) return false;
+  std::uint64_t bytes;
+  std::memcpy(&bytes, in, kHeader);
+  out = static_cast<std::size_t>(bytes);
+  return true;
+}
+
+bool decompress(const void* in, std::size_t size, void* out,
+                std::size_t out_bytes) {
+  std::size_t expected;
+  if (!decompressed_size(in, size, expected) || expected != out_bytes) {
+    return false;
+  }
+  const auto* src = static_cast<const std::byte*>(in) + kHeader;
+  const auto* end = static_cast<const std::byte*>(in) + size;
+  auto* dst = static_cast<std::byte*>(out);
+
+  std::uint32_t packed[kBlock], block[kBlock];
+  std::uint32_t prev = 0;
+  std::size_t words = out_bytes / 4;
+  for (std::size_t i = 0; i < words; i += kBlock) {
+    if (src == end) return false;
+    auto w = static_cast<unsigned>(*src++);
+    if (w > 32 || static_cast<std::size_t>(end - src) < w * 16) return false;
+    std::memcpy(packed, src, w * 16);
+    src += w * 16;
+    unpack(packed, w, block);
+    for (std::uint32_t& d : block) d = (d >> 1) ^ (0 - (d & 1));
+    block[0] += prev;
+    simd::prefix_sum_u32(block, kBlock);
+    prev = block[kBlock - 1];
+    std::memcpy(dst + i * 4, block, std::min(kBlock, words - i) * 4);
+  }
+  if (static_cast<std::size_t>(end - src) != out_bytes % 4) return false;
+  std::memcpy(dst + words * 4, src, out_bytes % 4);
+  return true;
+}
+
+}  // namespace lab::bitpack
@@ -0,0 +1,148 @@
+#include "lab/calibrate.hpp"
+
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <numeric>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "lab/pages.hpp"
+#include "lab/params.hpp"
+
+namespace lab {
+
+namespace {
+
+constexpr std::size_t kStreamBytes = std::size_t{64} << 20;  // per array
+constexpr std::size_t kLine = 64;
+constexpr std::size_t kBlock = 4096;
+
+// ---- STREAM ----------------------------------------------------------
+
+enum class Stream { copy, scale, add, triad };
+
+void stream(State& state, Stream kernel) {
+  std::size_t n = kStreamBytes / sizeof(double);
+  std::vector<double> a(n, 1.0), b(n, 2.0), c(n, 0.0);
+  const double s = 3.0;
+  double* __restrict pa = a.data();
+  double* __restrict pb = b.data();
+  double* __restrict pc = c.data();
+  for (auto _ : state) {
+    switch (kernel) {
+      case Stream::copy:
+        for (std::size_t i = 0; i < n; ++i) pc[i] = pa[i];
+        break;
+      case Stream::scale:
+        for (std::size_t i = 0; i < n; ++i) pb[i] = s * pc[i];
+        break;
+      case Stream::add:
+        for (std::size_t i = 0; i < n; ++i) pc[i] = pa[i] + pb[i];
+        break;
+      case Stream::triad:
+        for (std::size_t i = 0; i < n; ++i) pa[i] = pb[i] + s * pc[i];
+        break;
+    }
+    clobber_memory();
+  }
+  int arrays = kernel == Stream::copy || kernel == Stream::scale ? 2 : 3;
+  state.set_bytes_per_op(static_cast<double>(arrays * kStreamBytes));
+}
+
+// ---- pointer chasing -------------------------------------------------
+
+std::uint64_t splitmix(std::uint64_t& x) {
+  std::uint64_t z = (x += 0x9e3779b97f4a7c15ull);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+  return z ^ (z >> 31);
+}
+
+// Links slots[0..n) into one random cycle (Sattolo's algorithm), so the
+// chase visits every slot before repeating and no prefetcher can follow.
+void link_cycle(const std::vector<void**>& slots) {
+  std::vector<std::size_t> order(slots.size());
+  std::iota(order.begin(), order.end(), std::size_t{0});
+  std::uint64_t rng = 42;
+  for (std::size_t i = order.size(); i > 1; --i) {
+    std::swap(order[i - 1], order[splitmix(rng) % (i - 1)]);
+  }
+  for (std::size_t i = 0; i < order.size(); ++i) {
+    *slots[order[i]] = slots[order[(i + 1) % order.size()]];
+  }
+}
+
+void chase_from(State& state, void** p) {
+  for (auto _ : state) p = static_cast<void**>(*p);
+  do_not_optimize(p);
+}
+
+void chase(State& state) {
+  auto bytes = static_cast<std::size_t>(state.param("size"));
+  std::size_t lines = std::max<std::size_t>(bytes / kLine, 2);
+  std::vector<std::byte> buf(lines * kLine + kLine);
+  auto* base = reinterpret_cast<std::byte*>(
+      (reinterpret_cast<std::uintptr_t>(buf.data()) + kLine - 1) &
+      ~std::uintptr_t{kLine - 1});
+  std::vector<void**> slots(lines);
+  for (std::size_t i = 0; i < lines; ++i) {
+    slots[i] = reinterpret_cast<void**>(base + i * kLine);
+  }
+  link_cycle(slots);
+  chase_from(state, slots[0]);
+}
+
+void tlb(State& state, bool huge) {
+  auto pages = static_cast<std::size_t>(state.param("pages"));
+  pages = std::max<std::size_t>(pages, 2);
+  std::size_t bytes =
+      (pages * kBlock + kHugePageSize - 1) / kHugePageSize * kHugePageSize;
+  PageMapping map;
+  if (!map_pages(bytes, {.hugetlb = huge, .thp = huge}, map)) {
+    throw std::bad_alloc();
+  }
+  if (!huge) madvise(map.data, map.bytes, MADV_NOHUGEPAGE);
+  auto* base = static_cast<std::byte*>(map.data);
+  // A different line in each block, so blocks do not all compete for the
+  // same cache sets.
+  std::vector<void**> slots(pages);
+  for (std::size_t i = 0; i < pages; ++i) {
+    slots[i] = reinterpret_cast<void**>(base + i * kBlock +
+                                        (i * 7 % (kBlock / kLine)) * kLine);
+  }
+  link_cycle(slots);
+  chase_from(state, slots[0]);
+  unmap_pages(map);
+  if (huge) state.set_counter("huge_pages", map.huge ? 2 : 1);
+}
+
+Registry make_registry() {
+  Registry r;
+  for (auto [name, kernel] : {std::pair{"copy", Stream::copy},
+                              std::pair{"scale", Stream::scale},
+                              std::pair{"add", Stream::add},
+                              std::pair{"triad", Stream::triad}}) {
+    r.add(std::string("calibrate/stream/") + name,
+          [kernel = kernel](State& state) { stream(state, kernel); });
+  }
+  r.add("calibrate/chase", chase, {{"size", grid("16K..256M:x4")}});
+  r.add("calibrate/tlb/4k", [](State& state) { tlb(state, false); },
+        {{"pages", grid("16..64K:x4")}});
+  r.add("calibrate/tlb/2m", [](State& state) { tlb(state, true); },
+        {{"pages", grid("16..64K:x4")}});
+  return r;
+}
+
+}  // namespace
+
+Registry& calibration_registry() {
+  static Registry registry = make_registry();
+  return registry;
+}
+
+}  // namespace lab
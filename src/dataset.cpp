@@ -0,0 +1,387 @@
+#include "lab/dataset.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <bit>
+#include <cctype>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <utility>
+
+namespace lab::dataset {
+
+namespace {
+
+namespace fs = std::filesystem;
+
+bool fail(std::string* error, std::string message) {
+  if (error != nullptr) *error = std::move(message);
+  return false;
+}
+
+bool fail_errno(std::string* error, const std::string& what) {
+  return fail(error, what + ": " + std::strerror(errno));
+}
+
+// keys/ file name of a key, with the generator name escaped so that '.'
+// only ever separates the three parts.
+std::string key_name(const Key& key) {
+  std::string name;
+  for (char c : key.generator) {
+    auto u = static_cast<unsigned char>(c);
+    if (std::isalnum(u) || c == '-' || c == '_') {
+      name += c;
+    } else {
+      char buf[4];
+      std::snprintf(buf, sizeof buf, "%%%02x", u);
+      name += buf;
+    }
+  }
+  return name + "." + std::to_string(key.seed) + "." +
+         std::to_string(key.bytes);
+}
+
+struct SplitMix64 {
+  std::uint64_t state;
+  std::uint64_t next() {
+    std::uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+  }
+  // Uniform in [0, 1).
+  double unit() { return static_cast<double>(next() >> 11) * 0x1.0p-53; }
+};
+
+// Fills `out` with next() words, the last one truncated if need be.
+template <class Next>
+void fill_words(std::span<std::byte> out, Next next) {
+  std::size_t i = 0;
+  for (; i + 8 <= out.size(); i += 8) {
+    std::uint64_t v = next();
+    std::memcpy(out.data() + i, &v, 8);
+  }
+  if (i < out.size()) {
+    std::uint64_t v = next();
+    std::memcpy(out.data() + i, &v, out.size() - i);
+  }
+}
+
+constexpr std::uint64_t kPrime1 = 0x9e3779b185ebca87ull;
+constexpr std::uint64_t kPrime2 = 0xc2b2ae3d27d4eb4full;
+constexpr std::uint64_t kPrime3 = 0x165667b19e3779f9ull;
+constexpr std::uint64_t kPrime4 = 0x85ebca77c2b2ae63ull;
+constexpr std::uint64_t kPrime5 = 0x27d4eb2f165667c5ull;
+
+std::uint64_t read64(const unsigned char* p) {
+  std::uint64_t v;
+  std::memcpy(&v, p, 8);
+  return v;
+}
+
+std::uint64_t xxh_round(std::uint64_t acc, std::uint64_t input) {
+  acc += input * kPrime2;
+  return std::rotl(acc, 31) * kPrime1;
+}
+
+std::uint64_t xxh_merge(std::uint64_t acc, std::uint64_t v) {
+  acc ^= xxh_round(0, v);
+  return acc * kPrime1 + kPrime4;
+}
+
+// Maps `path`, which must have `bytes` bytes, read-only.
+bool map_file(const std::string& path, std::uint64_t bytes,
+              const void*& data, std::string* error) {
+  int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) return fail_errno(error, path);
+  struct stat st;
+  if (::fstat(fd, &st) != 0 ||
+      static_cast<std::uint64_t>(st.st_size) != bytes) {
+    ::close(fd);
+    return fail(error, path + ": size does not match its key");
+  }
+  data = nullptr;
+  if (bytes != 0) {
+    void* p = ::mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) {
+      ::close(fd);
+      return fail_errno(error, path + ": mmap");
+    }
+    ::madvise(p, bytes, MADV_WILLNEED);
+    data = p;
+  }
+  ::close(fd);
+  return true;
+}
+
+// Writes `text` to `path` through a temporary file and a rename.
+bool replace_file(const fs::path& path, const std::string& text,
+                  std::string* error) {
+  fs::path tmp = path;
+  tmp += ".tmp." + std::to_string(::getpid());
+  {
+    std::ofstream out(tmp, std::ios::binary);
+    out << text;
+    if (!out) return fail_errno(error, tmp.string());
+  }
+  if (::rename(tmp.c_str(), path.c_str()) != 0) {
+    int saved = errno;
+    ::unlink(tmp.c_str());
+    errno = saved;
+    return fail_errno(error, path.string());
+  }
+  return true;
+}
+
+// Generates the object for `key` and returns its digest.
+bool generate(const Key& key, const Fill& fill, const fs::path& objects,
+              std::string& digest_out, std::string* error) {
+  std::string tmp = (objects / ".tmp-XXXXXX").string();
+  int fd = ::mkstemp(tmp.data());
+  if (fd < 0) return fail_errno(error, tmp);
+  auto abandon = [&](const std::string& what) {
+    int saved = errno;
+    ::close(fd);
+    ::unlink(tmp.c_str());
+    errno = saved;
+    return fail_errno(error, what);
+  };
+  if (::ftruncate(fd, static_cast<off_t>(key.bytes)) != 0) {
+    return abandon(tmp);
+  }
+  std::span<std::byte> bytes;
+  if (key.bytes != 0) {
+    void* p = ::mmap(nullptr, key.bytes, PROT_READ | PROT_WRITE, MAP_SHARED,
+                     fd, 0);
+    if (p == MAP_FAILED) return abandon(tmp + ": mmap");
+    bytes = {static_cast<std::byte*>(p),
+             static_cast<std::size_t>(key.bytes)};
+  }
+  fill(key.seed, bytes);
+  digest_out = digest(bytes);
+  if (!bytes.empty()) ::munmap(bytes.data(), bytes.size());
+  ::fchmod(fd, 0444);
+  ::close(fd);
+  // Identical contents under another key are already there: keep those.
+  fs::path object = objects / digest_out;
+  if (::rename(tmp.c_str(), object.c_str()) != 0) {
+    int saved = errno;
+    ::unlink(tmp.c_str());
+    errno = saved;
+    return fail_errno(error, object.string());
+  }
+  return true;
+}
+
+}  // namespace
+
+Dataset::~Dataset() { reset(); }
+
+Dataset::Dataset(Dataset&& other) noexcept
+    : data_(std::exchange(other.data_, nullptr)),
+      size_(std::exchange(other.size_, 0)),
+      mapped_(std::exchange(other.mapped_, 0)),
+      digest_(std::move(other.digest_)),
+      path_(std::move(other.path_)) {}
+
+Dataset& Dataset::operator=(Dataset&& other) noexcept {
+  if (this != &other) {
+    reset();
+    data_ = std::exchange(other.data_, nullptr);
+    size_ = std::exchange(other.size_, 0);
+    mapped_ = std::exchange(other.mapped_, 0);
+    digest_ = std::move(other.digest_);
+    path_ = std::move(other.path_);
+  }
+  return *this;
+}
+
+void Dataset::reset() {
+  if (data_ != nullptr) {
+    ::munmap(const_cast<std::byte*>(data_), mapped_);
+  }
+  data_ = nullptr;
+  size_ = 0;
+  mapped_ = 0;
+  digest_.clear();
+  path_.clear();
+}
+
+std::string default_directory() {
+  if (const char* dir = std::getenv("LAB_DATASETS"); dir && *dir) return dir;
+  if (const char* cache = std::getenv("XDG_CACHE_HOME"); cache && *cache) {
+    return std::string(cache) + "/lab/datasets";
+  }
+  if (const char* home = std::getenv("HOME"); home && *home) {
+    return std::string(home) + "/.cache/lab/datasets";
+  }
+  return "/tmp/lab-datasets";
+}
+
+bool open(const Key& key, const Fill& fill, Dataset& out, std::string* error,
+          const std::string& dir) {
+  out.reset();
+  fs::path keys = fs::path(dir) / "keys";
+  fs::path objects = fs::path(dir) / "objects";
+  fs::path key_path = keys / key_name(key);
+
+  std::string digest_text;
+  {
+    std::ifstream in(key_path);
+    std::getline(in, digest_text);
+  }
+  const void* data = nullptr;
+  // A key whose object is missing or damaged is generated again.
+  if (digest_text.empty() ||
+      !map_file((objects / digest_text).string(), key.bytes, data, nullptr)) {
+    std::error_code ec;
+    fs::create_directories(keys, ec);
+    fs::create_directories(objects, ec);
+    if (ec) return fail(error, dir + ": " + ec.message());
+    if (!generate(key, fill, objects, digest_text, error)) return false;
+    if (!map_file((objects / digest_text).string(), key.bytes, data, error)) {
+      return false;
+    }
+    if (!replace_file(key_path, digest_text + "\n", error)) {
+      if (data != nullptr) ::munmap(const_cast<void*>(data), key.bytes);
+      return false;
+    }
+  }
+  out.data_ = static_cast<const std::byte*>(data);
+  out.size_ = static_cast<std::size_t>(key.bytes);
+  out.mapped_ = out.size_;
+  out.digest_ = digest_text;
+  out.path_ = (objects / digest_text).string();
+  return true;
+}
+
+bool open(const Key& key, const Fill& fill, Dataset& out,
+          const PageOptions& pages, std::string* error,
+          const std::string& dir) {
+  if (!open(key, fill, out, error, dir)) return false;
+  if (out.size_ == 0) return true;
+  if (!pages.hugetlb && !pages.thp) {
+    if (prefault(out.data_, out.size_, pages, error)) return true;
+    out.reset();
+    return false;
+  }
+  PageMapping copy;
+  PageOptions anon = pages;
+  anon.populate = true;  // written right away anyway
+  if (!map_pages(out.size_, anon, copy, error)) {
+    out.reset();
+    return false;
+  }
+  std::memcpy(copy.data, out.data_, out.size_);
+  ::mprotect(copy.data, copy.bytes, PROT_READ);
+  ::munmap(const_cast<std::byte*>(out.data_), out.mapped_);
+  out.data_ = static_cast<const std::byte*>(copy.data);
+  out.mapped_ = copy.bytes;
+  return true;
+}
+
+std::uint64_t xxh64(const void* data, std::size_t size, std::uint64_t seed) {
+  const auto* p = static_cast<const unsigned char*>(data);
+  const unsigned char* end = p + size;
+  std::uint64_t h;
+  if (size >= 32) {
+    std::uint64_t v1 = seed + kPrime1 + kPrime2;
+    std::uint64_t v2 = seed + kPrime2;
+    std::uint64_t v3 = seed;
+    std::uint64_t v4 = seed - kPrime1;
+    for (; p + 32 <= end; p += 32) {
+      v1 = xxh_round(v1, read64(p));
+      v2 = xxh_round(v2, read64(p + 8));
+      v3 = xxh_round(v3, read64(p + 16));
+      v4 = xxh_round(v4, read64(p + 24));
+    }
+    h = std::rotl(v1, 1) + std::rotl(v2, 7) + std::rotl(v3, 12) +
+        std::rotl(v4, 18);
+    h = xxh_merge(h, v1);
+    h = xxh_merge(h, v2);
+    h = xxh_merge(h, v3);
+    h = xxh_merge(h, v4);
+  } else {
+    h = seed + kPrime5;
+  }
+  h += size;
+  for (; p + 8 <= end; p += 8) {
+    h ^= xxh_round(0, read64(p));
+    h = std::rotl(h, 27) * kPrime1 + kPrime4;
+  }
+  if (p + 4 <= end) {
+    std::uint32_t v;
+    std::memcpy(&v, p, 4);
+    h ^= static_cast<std::uint64_t>(v) * kPrime1;
+    h = std::rotl(h, 23) * kPrime2 + kPrime3;
+    p += 4;
+  }
+  for (; p < end; ++p) {
+    h ^= *p * kPrime5;
+    h = std::rotl(h, 11) * kPrime1;
+  }
+  h ^= h >> 33;
+  h *= kPrime2;
+  h ^= h >> 29;
+  h *= kPrime3;
+  h ^= h >> 32;
+  return h;
+}
+
+std::string digest(std::span<const std::byte> bytes) {
+  char buf[24];
+  std::snprintf(buf, sizeof buf, "xxh64-%016llx",
+                static_cast<unsigned long long>(
+                    xxh64(bytes.data(), bytes.size())));
+  return buf;
+}
+
+bool verify(const Dataset& dataset) {
+  return !dataset.digest().empty() &&
+         digest({dataset.data(), dataset.size()}) == dataset.digest();
+}
+
+void uniform(std::uint64_t seed, std::span<std::byte> out) {
+  SplitMix64 rng{seed};
+  fill_words(out, [&] { return rng.next(); });
+}
+
+Fill zipf(std::uint64_t universe, double skew) {
+  return [n = std::max<std::uint64_t>(universe, 1), theta = skew](
+             std::uint64_t seed, std::span<std::byte> out) {
+    // Gray et al., "Quickly generating billion-record synthetic
+    // databases": one pass to sum the distribution, then O(1) per draw.
+    double zetan = 0;
+    for (std::uint64_t i = 1; i <= n; ++i) {
+      zetan += 1 / std::pow(static_cast<double>(i), theta);
+    }
+    double zeta2 = 1 + std::pow(0.5, theta);
+    double alpha = 1 / (1 - theta);
+    double eta = n < 3 ? 0
+                       : (1 - std::pow(2.0 / static_cast<double>(n),
+                                       1 - theta)) /
+                             (1 - zeta2 / zetan);
+    SplitMix64 rng{seed};
+    fill_words(out, [&]() -> std::uint64_t {
+      double u = rng.unit();
+      double uz = u * zetan;
+      if (uz < 1) return 1;
+      if (uz < zeta2) return 2;
+      auto r = 1 + static_cast<std::uint64_t>(
+                       static_cast<double>(n) *
+                       std::pow(eta * u - eta + 1, alpha));
+      return std::min(r, n);
+    });
+  };
+}
+
+}  // namespace lab::dataset
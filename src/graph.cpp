@@ -0,0 +1,245 @@
+#include "lab/graph.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <numeric>
+#include <utility>
+
+namespace lab::graph {
+
+namespace {
+
+struct SplitMix64 {
+  std::uint64_t state;
+
+  std::uint64_t next() {
+    std::uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+  }
+  // In [0, 1).
+  float unit() { return static_cast<float>(next() >> 40) * 0x1.0p-24f; }
+  std::uint32_t below(std::uint32_t n) {
+    return static_cast<std::uint32_t>(((next() >> 32) * n) >> 32);
+  }
+};
+
+// Both directions of every edge; duplicates and self loops dropped.
+Csr from_edges(std::uint32_t vertices,
+               const std::vector<std::pair<std::uint32_t, std::uint32_t>>&
+                   edges) {
+  Csr g;
+  g.offsets.assign(std::size_t{vertices} + 1, 0);
+  for (auto [u, v] : edges) {
+    if (u == v) continue;
+    ++g.offsets[u + 1];
+    ++g.offsets[v + 1];
+  }
+  std::partial_sum(g.offsets.begin(), g.offsets.end(), g.offsets.begin());
+  g.targets.resize(g.offsets.back());
+  std::vector<std::uint64_t> next(g.offsets.begin(), g.offsets.end() - 1);
+  for (auto [u, v] : edges) {
+    if (u == v) continue;
+    g.targets[next[u]++] = v;
+    g.targets[next[v]++] = u;
+  }
+  // Sort and deduplicate each list, compacting in place.
+  std::uint64_t out = 0;
+  for (std::uint32_t v = 0; v < vertices; ++v) {
+    auto first = g.targets.begin() + static_cast<std::ptrdiff_t>(g.offsets[v]);
+    auto last =
+        g.targets.begin() + static_cast<std::ptrdiff_t>(g.offsets[v + 1]);
+    std::sort(first, last);
+    last = std::unique(first, last);
+    g.offsets[v] = out;
+    for (auto it = first; it != last; ++it) g.targets[out++] = *it;
+  }
+  g.offsets[vertices] = out;
+  g.targets.resize(out);
+  g.targets.shrink_to_fit();
+  return g;
+}
+
+// new_id from an order of the old ids.
+std::vector<std::uint32_t> ranks(const std::vector<std::uint32_t>& order) {
+  std::vector<std::uint32_t> new_id(order.size());
+  for (std::size_t i = 0; i < order.size(); ++i) {
+    new_id[order[i]] = static_cast<std::uint32_t>(i);
+  }
+  return new_id;
+}
+
+}  // namespace
+
+Geometric geometric(std::uint32_t vertices, double degree,
+                    std::uint64_t seed) {
+  Geometric out;
+  SplitMix64 rng{seed};
+  out.x.resize(vertices);
+  out.y.resize(vertices);
+  for (std::uint32_t v = 0; v < vertices; ++v) {
+    out.x[v] = rng.unit();
+    out.y[v] = rng.unit();
+  }
+
+  // Bucket the points into cells one radius wide, so only the 3 x 3 cells
+  // around a point can hold its neighbours.
+  double radius =
+      std::sqrt(degree / (std::numbers::pi * std::max<double>(vertices, 1)));
+  auto side = static_cast<std::uint32_t>(
+      std::clamp(1.0 / radius, 1.0, 65536.0));
+  auto cell_of = [side](float c) {
+    return std::min(static_cast<std::uint32_t>(c * static_cast<float>(side)),
+                    side - 1);
+  };
+  std::vector<std::uint32_t> start(std::size_t{side} * side + 1, 0);
+  for (std::uint32_t v = 0; v < vertices; ++v) {
+    ++start[std::size_t{cell_of(out.y[v])} * side + cell_of(out.x[v]) + 1];
+  }
+  std::partial_sum(start.begin(), start.end(), start.begin());
+  std::vector<std::uint32_t> members(vertices);
+  {
+    std::vector<std::uint32_t> next(start.begin(), start.end() - 1);
+    for (std::uint32_t v = 0; v < vertices; ++v) {
+      members[next[std::size_t{cell_of(out.y[v])} * side +
+                   cell_of(out.x[v])]++] = v;
+    }
+  }
+
+  std::vector<std::pair<std::uint32_t, std::uint32_t>> edges;
+  edges.reserve(static_cast<std::size_t>(degree * vertices * 0.6));
+  auto r2 = static_cast<float>(radius * radius);
+  for (std::uint32_t u = 0; u < vertices; ++u) {
+    std::uint32_t cx = cell_of(out.x[u]), cy = cell_of(out.y[u]);
+    for (std::uint32_t y = cy == 0 ? 0 : cy - 1; y <= std::min(cy + 1, side - 1);
+         ++y) {
+      for (std::uint32_t x = cx == 0 ? 0 : cx - 1;
+           x <= std::min(cx + 1, side - 1); ++x) {
+        std::size_t cell = std::size_t{y} * side + x;
+        for (std::uint32_t i = start[cell]; i < start[cell + 1]; ++i) {
+          std::uint32_t v = members[i];
+          float dx = out.x[u] - out.x[v], dy = out.y[u] - out.y[v];
+          if (v > u && dx * dx + dy * dy < r2) edges.emplace_back(u, v);
+        }
+      }
+    }
+  }
+  auto extra = static_cast<std::uint32_t>(std::lround(degree));
+  for (std::uint32_t u = 0; vertices > 1 && u < vertices; u += 100) {
+    for (std::uint32_t i = 0; i < extra; ++i) {
+      edges.emplace_back(u, rng.below(vertices));
+    }
+  }
+  out.csr = from_edges(vertices, edges);
+  return out;
+}
+
+std::vector<std::uint32_t> degree_order(const Csr& g) {
+  std::vector<std::uint32_t> order(g.vertices());
+  std::iota(order.begin(), order.end(), 0u);
+  std::stable_sort(order.begin(), order.end(),
+                   [&](std::uint32_t a, std::uint32_t b) {
+                     return g.degree(a) > g.degree(b);
+                   });
+  return ranks(order);
+}
+
+std::uint64_t hilbert_index(std::uint32_t x, std::uint32_t y, int order) {
+  std::uint64_t d = 0;
+  for (std::uint64_t s = std::uint64_t{1} << (order - 1); s > 0; s /= 2) {
+    std::uint32_t rx = (x & s) != 0;
+    std::uint32_t ry = (y & s) != 0;
+    d += s * s * ((3 * rx) ^ ry);
+    // Rotate the quadrant so the sub-curve starts where the last ended.
+    if (ry == 0) {
+      if (rx == 1) {
+        auto last = static_cast<std::uint32_t>((std::uint64_t{1} << order) - 1);
+        x = last - x;
+        y = last - y;
+      }
+      std::swap(x, y);
+    }
+  }
+  return d;
+}
+
+std::vector<std::uint32_t> hilbert_order(std::span<const float> x,
+                                         std::span<const float> y) {
+  constexpr int kOrder = 16;
+  auto grid = [](float c) {
+    return std::min(static_cast<std::uint32_t>(std::max(c, 0.0f) * 65536.0f),
+                    65535u);
+  };
+  std::vector<std::pair<std::uint64_t, std::uint32_t>> keys(x.size());
+  for (std::size_t v = 0; v < x.size(); ++v) {
+    keys[v] = {hilbert_index(grid(x[v]), grid(y[v]), kOrder),
+               static_cast<std::uint32_t>(v)};
+  }
+  std::sort(keys.begin(), keys.end());
+  std::vector<std::uint32_t> order(keys.size());
+  for (std::size_t i = 0; i < keys.size(); ++i) order[i] = keys[i].second;
+  return ranks(order);
+}
+
+Csr permute(const Csr& g, std::span<const std::uint32_t> new_id) {
+  std::uint32_t n = g.vertices();
+  std::vector<std::uint32_t> old_of(n);
+  for (std::uint32_t v = 0; v < n; ++v) old_of[new_id[v]] = v;
+  Csr out;
+  out.offsets.resize(std::size_t{n} + 1);
+  out.offsets[0] = 0;
+  for (std::uint32_t w = 0; w < n; ++w) {
+    out.offsets[w + 1] = out.offsets[w] + g.degree(old_of[w]);
+  }
+  out.targets.resize(g.targets.size());
+  for (std::uint32_t w = 0; w < n; ++w) {
+    auto first = out.targets.begin() + static_cast<std::ptrdiff_t>(out.offsets[w]);
+    auto it = first;
+    for (std::uint32_t u : g.neighbours(old_of[w])) *it++ = new_id[u];
+    std::sort(first, it);
+  }
+  return out;
+}
+
+std::vector<std::uint32_t> bfs(const Csr& g, std::uint32_t source) {
+  std::vector<std::uint32_t> depth(g.vertices(), kUnreached);
+  std::vector<std::uint32_t> frontier{source}, next;
+  depth[source] = 0;
+  for (std::uint32_t d = 1; !frontier.empty(); ++d) {
+    next.clear();
+    for (std::uint32_t u : frontier) {
+      for (std::uint32_t v : g.neighbours(u)) {
+        if (depth[v] == kUnreached) {
+          depth[v] = d;
+          next.push_back(v);
+        }
+      }
+    }
+    frontier.swap(next);
+  }
+  return depth;
+}
+
+std::vector<double> pagerank(const Csr& g, int iterations, double damping) {
+  std::uint32_t n = g.vertices();
+  if (n == 0) return {};
+  std::vector<double> rank(n, 1.0 / n), share(n);
+  double teleport = (1.0 - damping) / n;
+  for (int it = 0; it < iterations; ++it) {
+    for (std::uint32_t v = 0; v < n; ++v) {
+      std::uint32_t d = g.degree(v);
+      share[v] = d == 0 ? 0.0 : rank[v] / d;
+    }
+    // The gather from share[] is where the layout shows.
+    for (std::uint32_t v = 0; v < n; ++v) {
+      double sum = 0;
+      for (std::uint32_t u : g.neighbours(v)) sum += share[u];
+      rank[v] = teleport + damping * sum;
+    }
+  }
+  return rank;
+}
+
+}  // namespace lab::graph
@@ -0,0 +1,165 @@
+#include "lab/histogram.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+
+namespace lab {
+
+namespace {
+
+bool parse_fail(std::string* error, std::string message) {
+  if (error != nullptr) *error = std::move(message);
+  return false;
+}
+
+// Parses one unsigned field followed by `sep` or the end of `text`, and
+// advances past both.
+bool take(std::string_view& text, char sep, std::uint64_t& out) {
+  auto [end, ec] =
+      std::from_chars(text.data(), text.data() + text.size(), out);
+  if (ec != std::errc() || end == text.data()) return false;
+  text.remove_prefix(static_cast<std::size_t>(end - text.data()));
+  if (text.empty()) return true;
+  if (text.front() != sep) return false;
+  text.remove_prefix(1);
+  return true;
+}
+
+}  // namespace
+
+Histogram::Histogram(int significant_digits)
+    : digits_(std::clamp(significant_digits, 1, 5)) {
+  // Enough sub-buckets that adjacent ones differ by under 10^-digits.
+  std::uint64_t largest = 2;
+  for (int i = 0; i < digits_; ++i) largest *= 10;
+  int bits = std::bit_width(largest - 1);
+  sub_count_ = std::uint64_t{1} << bits;
+  half_bits_ = bits - 1;
+}
+
+std::uint64_t Histogram::lowest(std::size_t index) const {
+  if (index < sub_count_) return index;
+  std::uint64_t k = index - sub_count_;
+  int shift = static_cast<int>(k / half_count()) + 1;
+  return (half_count() + k % half_count()) << shift;
+}
+
+std::uint64_t Histogram::highest(std::size_t index) const {
+  if (index < sub_count_) return index;
+  int shift = static_cast<int>((index - sub_count_) / half_count()) + 1;
+  return lowest(index) + ((std::uint64_t{1} << shift) - 1);
+}
+
+void Histogram::merge(const Histogram& other) {
+  if (other.total_ == 0) return;
+  if (other.sub_count_ == sub_count_) {
+    if (counts_.size() < other.counts_.size()) {
+      counts_.resize(other.counts_.size());
+    }
+    for (std::size_t i = 0; i < other.counts_.size(); ++i) {
+      counts_[i] += other.counts_[i];
+    }
+  } else {
+    for (std::size_t i = 0; i < other.counts_.size(); ++i) {
+      if (other.counts_[i] == 0) continue;
+      std::uint64_t lo = other.lowest(i);
+      std::size_t j = index_of(lo + (other.highest(i) - lo) / 2);
+      if (j >= counts_.size()) counts_.resize(j + 1);
+      counts_[j] += other.counts_[i];
+    }
+  }
+  total_ += other.total_;
+  sum_ += other.sum_;
+  min_ = std::min(min_, other.min_);
+  max_ = std::max(max_, other.max_);
+}
+
+void Histogram::clear() {
+  counts_.clear();
+  total_ = 0;
+  sum_ = 0;
+  min_ = ~std::uint64_t{0};
+  max_ = 0;
+}
+
+double Histogram::mean() const {
+  return total_ == 0 ? 0
+                     : static_cast<double>(sum_) / static_cast<double>(total_);
+}
+
+std::uint64_t Histogram::percentile(double q) const {
+  if (total_ == 0) return 0;
+  auto rank = static_cast<std::uint64_t>(
+      std::ceil(std::clamp(q, 0.0, 1.0) * static_cast<double>(total_)));
+  rank = std::max<std::uint64_t>(rank, 1);
+  std::uint64_t seen = 0;
+  for (std::size_t i = 0; i < counts_.size(); ++i) {
+    seen += counts_[i];
+    if (seen >= rank) return std::min(std::max(highest(i), min_), max_);
+  }
+  return max_;
+}
+
+std::string Histogram::serialize() const {
+  std::string out = "hdr1:" + std::to_string(digits_) + ":" +
+                    std::to_string(min()) + ":" + std::to_string(max_) + ":" +
+                    std::to_string(sum_) + ":";
+  std::size_t next = 0;  // first index not yet covered
+  bool first = true;
+  for (std::size_t i = 0; i < counts_.size(); ++i) {
+    if (counts_[i] == 0) continue;
+    if (!first) out += ',';
+    first = false;
+    out += std::to_string(i - next);
+    out += '*';
+    out += std::to_string(counts_[i]);
+    next = i + 1;
+  }
+  return out;
+}
+
+bool Histogram::deserialize(std::string_view text, Histogram& out,
+                            std::string* error) {
+  if (text.substr(0, 5) != "hdr1:") {
+    return parse_fail(error, "not a serialized histogram");
+  }
+  text.remove_prefix(5);
+  std::uint64_t digits, min, max, sum;
+  if (!take(text, ':', digits) || digits < 1 || digits > 5 ||
+      !take(text, ':', min) || !take(text, ':', max) ||
+      !take(text, ':', sum)) {
+    return parse_fail(error, "malformed histogram header");
+  }
+  Histogram h(static_cast<int>(digits));
+  if (!text.empty() && text.back() == ',') {
+    return parse_fail(error, "malformed histogram bucket");
+  }
+  std::size_t last = h.index_of(~std::uint64_t{0});
+  std::size_t next = 0;
+  while (!text.empty()) {
+    std::uint64_t gap, count;
+    if (!take(text, '*', gap) || text.empty() || !take(text, ',', count) ||
+        count == 0) {
+      return parse_fail(error, "malformed histogram bucket");
+    }
+    if (next > last || gap > last - next) {
+      return parse_fail(error, "histogram bucket out of range");
+    }
+    std::size_t i = next + gap;
+    if (i >= h.counts_.size()) h.counts_.resize(i + 1);
+    h.counts_[i] = count;
+    h.total_ += count;
+    next = i + 1;
+  }
+  if (h.total_ != 0) {
+    if (min > max) return parse_fail(error, "histogram min above max");
+    h.min_ = min;
+    h.max_ = max;
+    h.sum_ = sum;
+  }
+  out = std::move(h);
+  return true;
+}
+
+}  // namespace lab
@@ -0,0 +1,68 @@
+#pragma once
+
+// Shared by the backends in src/io/; not part of the public API.
+
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "lab/io.hpp"
+
+namespace lab::io::detail {
+
+using clock = std::chrono::steady_clock;
+
+class Fd {
+ public:
+  explicit Fd(int fd) : fd_(fd) {}
+  ~Fd() {
+    if (fd_ >= 0) ::close(fd_);
+  }
+  Fd(const Fd&) = delete;
+  Fd& operator=(const Fd&) = delete;
+  int get() const { return fd_; }
+
+ private:
+  int fd_;
+};
+
+struct FreeDeleter {
+  void operator()(char* p) const;
+};
+
+// kAlignment-aligned, as O_DIRECT and registered buffers want.
+using Buffer = std::unique_ptr<char[], FreeDeleter>;
+Buffer make_buffer(std::size_t bytes);
+
+// Fills `data` with the pattern of a block starting at file offset
+// `offset`, which must be a multiple of kAlignment.
+void fill_block(char* data, std::size_t size, std::uint64_t offset);
+// Rewrites only the per-page offsets of a block filled for another offset.
+void stamp_block(char* data, std::size_t size, std::uint64_t offset);
+
+// One finished request of `bytes`, issued at `start`.
+inline void record(Stats& stats, const Options& opts, std::uint64_t bytes,
+                   clock::time_point start) {
+  ++stats.requests;
+  stats.bytes += bytes;
+  if (opts.record_latency) {
+    stats.latency_ns.push_back(
+        std::chrono::duration<double, std::nano>(clock::now() - start)
+            .count());
+  }
+}
+
+void set_error(std::string* error, std::string message);
+std::string errno_message(const std::string& what);
+
+// Defined in uring.cpp.
+bool uring_supported(std::string* why);
+bool uring_read(int fd, std::uint64_t size, const Options& opts,
+                const Consumer& consume, Stats& stats, std::string* error);
+bool uring_write(int fd, std::uint64_t size, const Options& opts,
+                 Stats& stats, std::string* error);
+
+}  // namespace lab::io::detail
@@ -0,0 +1,164 @@
+#include "lab/event_loop.hpp"
+
+#include <linux/time_types.h>
+#include <sys/eventfd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "lab/mpsc_queue.hpp"
+#include "ring.hpp"
+
+namespace lab {
+
+namespace {
+
+// user_data of the eventfd read that wakes the loop for post().
+constexpr std::uint64_t kWakeTag = 0;
+
+// Owns a spawned task and counts it out of the loop when it finishes.
+struct Detached {
+  struct promise_type {
+    Detached get_return_object() const noexcept { return {}; }
+    std::suspend_never initial_suspend() const noexcept { return {}; }
+    std::suspend_never final_suspend() const noexcept { return {}; }
+    void return_void() const noexcept {}
+    void unhandled_exception() const noexcept { std::terminate(); }
+  };
+};
+
+Detached run_detached(task<> t, std::size_t& live) {
+  co_await t;
+  --live;
+}
+
+[[noreturn]] void die(const std::string& error) {
+  std::fprintf(stderr, "lab::EventLoop: %s\n", error.c_str());
+  std::abort();
+}
+
+}  // namespace
+
+struct EventLoop::Impl {
+  io::detail::Ring ring;
+  int wake_fd = -1;
+  std::uint64_t wake_count = 0;  // target of the eventfd read
+  bool wake_armed = false;
+  MpscQueue<std::coroutine_handle<>> posted;
+
+  ~Impl() {
+    if (wake_fd >= 0) ::close(wake_fd);
+  }
+
+  // The next free submission entry, flushing the queue to the kernel when
+  // it is full.
+  io_uring_sqe* sqe() {
+    for (;;) {
+      if (io_uring_sqe* s = ring.next_sqe()) return s;
+      std::string error;
+      if (!ring.submit(0, &error)) die(error);
+    }
+  }
+
+  bool resume_posted() {
+    bool any = false;
+    std::coroutine_handle<> h;
+    while (posted.try_pop(h)) {
+      h.resume();
+      any = true;
+    }
+    return any;
+  }
+};
+
+EventLoop::EventLoop() = default;
+EventLoop::~EventLoop() = default;
+
+bool EventLoop::init(const Options& opts, std::string* error) {
+  auto impl = std::make_unique<Impl>();
+  if (!impl->ring.init(opts.entries, error, opts.completions)) return false;
+  impl->wake_fd = eventfd(0, EFD_CLOEXEC);
+  if (impl->wake_fd < 0) {
+    io::detail::set_error(error, io::detail::errno_message("eventfd"));
+    return false;
+  }
+  impl_ = std::move(impl);
+  return true;
+}
+
+void EventLoop::submit(Op& op) {
+  io_uring_sqe* sqe = impl_->sqe();
+  sqe->fd = op.fd_;
+  sqe->user_data = reinterpret_cast<std::uint64_t>(&op);
+  switch (op.kind_) {
+    case Op::Kind::read:
+    case Op::Kind::write:
+      sqe->opcode = op.kind_ == Op::Kind::read ? IORING_OP_READ
+                                               : IORING_OP_WRITE;
+      sqe->addr = reinterpret_cast<std::uint64_t>(op.addr_);
+      sqe->len = static_cast<std::uint32_t>(
+          std::min<std::uint64_t>(op.len_, 0x7ffff000));
+      sqe->off = op.offset_;
+      break;
+    case Op::Kind::accept:
+      sqe->opcode = IORING_OP_ACCEPT;
+      sqe->accept_flags = SOCK_CLOEXEC;
+      break;
+    case Op::Kind::connect:
+      sqe->opcode = IORING_OP_CONNECT;
+      sqe->addr = reinterpret_cast<std::uint64_t>(op.addr_);
+      sqe->off = op.len_;
+      break;
+    case Op::Kind::timeout:
+      static_assert(sizeof(__kernel_timespec) == sizeof op.timeout_);
+      sqe->opcode = IORING_OP_TIMEOUT;
+      sqe->addr = reinterpret_cast<std::uint64_t>(op.timeout_);
+      sqe->len = 1;
+      break;
+  }
+}
+
+void EventLoop::spawn(task<> t) {
+  ++live_;
+  run_detached(std::move(t), live_);
+}
+
+void EventLoop::run() {
+  while (live_ > 0) poll();
+}
+
+void EventLoop::post(std::coroutine_handle<> h) {
+  impl_->posted.push(h);
+  std::uint64_t one = 1;
+  ssize_t n = ::write(impl_->wake_fd, &one, sizeof one);
+  (void)n;
+}
+
+void EventLoop::poll() {
+  Impl& impl = *impl_;
+  if (impl.resume_posted()) return;
+  if (!impl.wake_armed) {
+    io_uring_sqe* sqe = impl.sqe();
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = impl.wake_fd;
+    sqe->addr = reinterpret_cast<std::uint64_t>(&impl.wake_count);
+    sqe->len = sizeof impl.wake_count;
+    sqe->user_data = kWakeTag;
+    impl.wake_armed = true;
+  }
+  std::string error;
+  if (!impl.ring.submit(1, &error)) die(error);
+  impl.ring.drain([&](const io_uring_cqe& cqe) {
+    if (cqe.user_data == kWakeTag) {
+      impl.wake_armed = false;
+      return;
+    }
+    auto* op = reinterpret_cast<Op*>(cqe.user_data);
+    op->result_ = cqe.res;
+    if (op->kind_ == Op::Kind::timeout && cqe.res == -ETIME) op->result_ = 0;
+    op->waiter_.resume();
+  });
+}
+
+}  // namespace lab
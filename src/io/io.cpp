@@ -0,0 +1,368 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#include "detail.hpp"
+
+namespace lab::io {
+
+namespace detail {
+
+void FreeDeleter::operator()(char* p) const { std::free(p); }
+
+Buffer make_buffer(std::size_t bytes) {
+  std::size_t rounded = (bytes + kAlignment - 1) / kAlignment * kAlignment;
+  void* p = std::aligned_alloc(kAlignment, std::max(rounded, kAlignment));
+  if (p == nullptr) throw std::bad_alloc();
+  return Buffer(static_cast<char*>(p));
+}
+
+void fill_block(char* data, std::size_t size, std::uint64_t offset) {
+  for (std::size_t i = 0; i < size; ++i) {
+    data[i] = static_cast<char>(pattern_byte(i % kAlignment));
+  }
+  stamp_block(data, size, offset);
+}
+
+void stamp_block(char* data, std::size_t size, std::uint64_t offset) {
+  for (std::size_t page = 0; page < size; page += kAlignment) {
+    std::uint64_t at = offset + page;
+    std::memcpy(data + page, &at, std::min(sizeof at, size - page));
+  }
+}
+
+void set_error(std::string* error, std::string message) {
+  if (error != nullptr) *error = std::move(message);
+}
+
+std::string errno_message(const std::string& what) {
+  return what + ": " + std::strerror(errno);
+}
+
+}  // namespace detail
+
+namespace {
+
+using detail::clock;
+using detail::errno_message;
+using detail::record;
+using detail::set_error;
+
+double process_cpu_seconds() {
+  rusage usage{};
+  getrusage(RUSAGE_SELF, &usage);
+  auto seconds = [](const timeval& tv) {
+    return static_cast<double>(tv.tv_sec) + tv.tv_usec * 1e-6;
+  };
+  return seconds(usage.ru_utime) + seconds(usage.ru_stime);
+}
+
+std::size_t align_up(std::size_t n) {
+  return (n + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+// read(): no offsets and no hints, so only the kernel's default readahead.
+bool read_stream(int fd, const Options& opts, const Consumer& consume,
+                 Stats& stats, std::string* error) {
+  detail::Buffer buf = detail::make_buffer(opts.block_size);
+  std::uint64_t offset = 0;
+  for (;;) {
+    std::size_t filled = 0;
+    while (filled < opts.block_size) {
+      auto start = clock::now();
+      ssize_t n = ::read(fd, buf.get() + filled, opts.block_size - filled);
+      if (n < 0 && errno == EINTR) continue;
+      if (n < 0) {
+        set_error(error, errno_message("read"));
+        return false;
+      }
+      if (n == 0) break;
+      record(stats, opts, static_cast<std::uint64_t>(n), start);
+      filled += static_cast<std::size_t>(n);
+    }
+    if (filled > 0) consume(offset, buf.get(), filled);
+    offset += filled;
+    if (filled < opts.block_size) return true;
+  }
+}
+
+// pread() for both the hinted buffered backend and O_DIRECT, which can
+// only transfer whole aligned pages (short at end of file).
+bool read_positional(int fd, std::uint64_t size, bool direct,
+                     const Options& opts, const Consumer& consume,
+                     Stats& stats, std::string* error) {
+  if (!direct) posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+  detail::Buffer buf = detail::make_buffer(opts.block_size);
+  for (std::uint64_t offset = 0; offset < size; offset += opts.block_size) {
+    std::size_t want = std::min<std::uint64_t>(opts.block_size, size - offset);
+    if (!direct && offset + want < size) {
+      // Start reading the next block while this one is consumed.
+      posix_fadvise(fd, static_cast<off_t>(offset + want),
+                    static_cast<off_t>(opts.block_size), POSIX_FADV_WILLNEED);
+    }
+    std::size_t filled = 0;
+    while (filled < want) {
+      std::size_t len = direct ? align_up(want - filled) : want - filled;
+      auto start = clock::now();
+      ssize_t n = ::pread(fd, buf.get() + filled, len,
+                          static_cast<off_t>(offset + filled));
+      if (n < 0 && errno == EINTR) continue;
+      if (n < 0) {
+        set_error(error, errno_message("pread"));
+        return false;
+      }
+      if (n == 0) {
+        set_error(error, "pread: file shrank while reading");
+        return false;
+      }
+      record(stats, opts, static_cast<std::uint64_t>(n), start);
+      filled = std::min(want, filled + static_cast<std::size_t>(n));
+    }
+    consume(offset, buf.get(), want);
+  }
+  return true;
+}
+
+// Touches one byte per page before handing the block over, so the page
+// faults show up as the block's latency rather than in the consumer.
+bool read_mapped(int fd, std::uint64_t size, const Options& opts,
+                 const Consumer& consume, Stats& stats, std::string* error) {
+  if (size == 0) return true;
+  void* map = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  if (map == MAP_FAILED) {
+    set_error(error, errno_message("mmap"));
+    return false;
+  }
+  madvise(map, size, MADV_SEQUENTIAL);
+  const char* base = static_cast<const char*>(map);
+  volatile char sink = 0;
+  for (std::uint64_t offset = 0; offset < size; offset += opts.block_size) {
+    std::size_t len = std::min<std::uint64_t>(opts.block_size, size - offset);
+    auto start = clock::now();
+    char x = 0;
+    for (std::size_t page = 0; page < len; page += kAlignment) {
+      x ^= base[offset + page];
+    }
+    sink = x;
+    record(stats, opts, len, start);
+    consume(offset, base + offset, len);
+  }
+  (void)sink;
+  munmap(map, size);
+  return true;
+}
+
+bool write_all(int fd, const char* data, std::size_t len, std::uint64_t offset,
+               bool positional, const Options& opts, Stats& stats,
+               std::string* error) {
+  std::size_t done = 0;
+  while (done < len) {
+    auto start = clock::now();
+    ssize_t n = positional ? ::pwrite(fd, data + done, len - done,
+                                      static_cast<off_t>(offset + done))
+                           : ::write(fd, data + done, len - done);
+    if (n < 0 && errno == EINTR) continue;
+    if (n < 0) {
+      set_error(error, errno_message(positional ? "pwrite" : "write"));
+      return false;
+    }
+    record(stats, opts, static_cast<std::uint64_t>(n), start);
+    done += static_cast<std::size_t>(n);
+  }
+  return true;
+}
+
+// write() or pwrite(); O_DIRECT writes a whole last page and truncates the
+// excess afterwards.
+bool write_sequential(int fd, std::uint64_t size, Backend backend,
+                      const Options& opts, Stats& stats, std::string* error) {
+  bool direct = backend == Backend::direct;
+  detail::Buffer buf = detail::make_buffer(opts.block_size);
+  detail::fill_block(buf.get(), opts.block_size, 0);
+  for (std::uint64_t offset = 0; offset < size; offset += opts.block_size) {
+    std::size_t len = std::min<std::uint64_t>(opts.block_size, size - offset);
+    detail::stamp_block(buf.get(), len, offset);
+    if (!write_all(fd, buf.get(), direct ? align_up(len) : len, offset,
+                   backend != Backend::read, opts, stats, error)) {
+      return false;
+    }
+  }
+  if (direct && size % kAlignment != 0 &&
+      ftruncate(fd, static_cast<off_t>(size)) != 0) {
+    set_error(error, errno_message("ftruncate"));
+    return false;
+  }
+  return true;
+}
+
+// memcpy into a shared mapping, then msync; each block's latency includes
+// the faults that allocate its pages.
+bool write_mapped(int fd, std::uint64_t size, const Options& opts,
+                  Stats& stats, std::string* error) {
+  if (size == 0) return true;
+  if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+    set_error(error, errno_message("ftruncate"));
+    return false;
+  }
+  void* map = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (map == MAP_FAILED) {
+    set_error(error, errno_message("mmap"));
+    return false;
+  }
+  madvise(map, size, MADV_SEQUENTIAL);
+  char* base = static_cast<char*>(map);
+  detail::Buffer buf = detail::make_buffer(opts.block_size);
+  detail::fill_block(buf.get(), opts.block_size, 0);
+  for (std::uint64_t offset = 0; offset < size; offset += opts.block_size) {
+    std::size_t len = std::min<std::uint64_t>(opts.block_size, size - offset);
+    auto start = clock::now();
+    std::memcpy(base + offset, buf.get(), len);
+    detail::stamp_block(base + offset, len, offset);
+    record(stats, opts, len, start);
+  }
+  bool ok = msync(map, size, MS_SYNC) == 0;
+  if (!ok) set_error(error, errno_message("msync"));
+  munmap(map, size);
+  return ok;
+}
+
+bool check_options(const Options& opts, std::string* error) {
+  if (opts.block_size == 0 || opts.block_size % kAlignment != 0) {
+    set_error(error, "block size must be a positive multiple of 4096");
+    return false;
+  }
+  return true;
+}
+
+void reset(Stats& stats) {
+  stats.bytes = 0;
+  stats.requests = 0;
+  stats.seconds = 0;
+  stats.cpu_seconds = 0;
+  stats.latency_ns.clear();
+}
+
+}  // namespace
+
+const char* backend_name(Backend backend) {
+  switch (backend) {
+    case Backend::read: return "read";
+    case Backend::pread: return "pread";
+    case Backend::mmap: return "mmap";
+    case Backend::uring: return "uring";
+    case Backend::direct: return "direct";
+  }
+  return "?";
+}
+
+bool backend_available(Backend backend, std::string* why) {
+  if (backend == Backend::uring) return detail::uring_supported(why);
+  return true;
+}
+
+bool read_file(Backend backend, const std::string& path, const Options& opts,
+               const Consumer& consume, Stats* stats_out, std::string* error) {
+  if (!check_options(opts, error)) return false;
+  int flags = O_RDONLY | O_CLOEXEC;
+  if (backend == Backend::direct) flags |= O_DIRECT;
+  detail::Fd fd(::open(path.c_str(), flags));
+  if (fd.get() < 0) {
+    set_error(error, errno_message(path));
+    return false;
+  }
+  struct stat st {};
+  if (fstat(fd.get(), &st) != 0) {
+    set_error(error, errno_message(path));
+    return false;
+  }
+  auto size = static_cast<std::uint64_t>(st.st_size);
+
+  Stats local;
+  Stats& stats = stats_out != nullptr ? *stats_out : local;
+  reset(stats);
+  if (opts.record_latency) {
+    stats.latency_ns.reserve(size / opts.block_size + 1);
+  }
+  auto start = clock::now();
+  double cpu = process_cpu_seconds();
+  bool ok = false;
+  switch (backend) {
+    case Backend::read:
+      ok = read_stream(fd.get(), opts, consume, stats, error);
+      break;
+    case Backend::pread:
+    case Backend::direct:
+      ok = read_positional(fd.get(), size, backend == Backend::direct, opts,
+                           consume, stats, error);
+      break;
+    case Backend::mmap:
+      ok = read_mapped(fd.get(), size, opts, consume, stats, error);
+      break;
+    case Backend::uring:
+      ok = detail::uring_read(fd.get(), size, opts, consume, stats, error);
+      break;
+  }
+  stats.seconds = std::chrono::duration<double>(clock::now() - start).count();
+  stats.cpu_seconds = process_cpu_seconds() - cpu;
+  return ok;
+}
+
+bool write_file(Backend backend, const std::string& path, std::uint64_t size,
+                const Options& opts, Stats* stats_out, std::string* error) {
+  if (!check_options(opts, error)) return false;
+  int flags = O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC;
+  if (backend == Backend::direct) flags |= O_DIRECT;
+  detail::Fd fd(::open(path.c_str(), flags, 0644));
+  if (fd.get() < 0) {
+    set_error(error, errno_message(path));
+    return false;
+  }
+
+  Stats local;
+  Stats& stats = stats_out != nullptr ? *stats_out : local;
+  reset(stats);
+  if (opts.record_latency) {
+    stats.latency_ns.reserve(size / opts.block_size + 1);
+  }
+  auto start = clock::now();
+  double cpu = process_cpu_seconds();
+  bool ok = false;
+  switch (backend) {
+    case Backend::read:
+    case Backend::pread:
+    case Backend::direct:
+      ok = write_sequential(fd.get(), size, backend, opts, stats, error);
+      break;
+    case Backend::mmap:
+      ok = write_mapped(fd.get(), size, opts, stats, error);
+      break;
+    case Backend::uring:
+      ok = detail::uring_write(fd.get(), size, opts, stats, error);
+      break;
+  }
+  if (ok && fdatasync(fd.get()) != 0) {
+    set_error(error, errno_message("fdatasync"));
+    ok = false;
+  }
+  stats.seconds = std::chrono::duration<double>(clock::now() - start).count();
+  stats.cpu_seconds = process_cpu_seconds() - cpu;
+  return ok;
+}
+
+bool drop_cache(const std::string& path) {
+  detail::Fd fd(::open(path.c_str(), O_RDONLY | O_CLOEXEC));
+  if (fd.get() < 0) return false;
+  // Dirty pages cannot be dropped, so write them back first.
+  fdatasync(fd.get());
+  return posix_fadvise(fd.get(), 0, 0, POSIX_FADV_DONTNEED) == 0;
+}
+
+}  // namespace lab::io
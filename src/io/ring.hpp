@@ -0,0 +1,181 @@
+#pragma once
+
+// A minimal io_uring through raw syscalls and the kernel's UAPI header, so
+// lab needs no liburing. Shared by the uring file backend and EventLoop.
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <string>
+
+#include "detail.hpp"
+
+namespace lab::io::detail {
+
+inline int io_uring_setup(unsigned entries, io_uring_params* params) {
+  return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+inline int io_uring_enter(int fd, unsigned to_submit, unsigned min_complete,
+                          unsigned flags) {
+  return static_cast<int>(syscall(__NR_io_uring_enter, fd, to_submit,
+                                  min_complete, flags, nullptr, 0));
+}
+
+inline int io_uring_register(int fd, unsigned opcode, const void* arg,
+                             unsigned count) {
+  return static_cast<int>(
+      syscall(__NR_io_uring_register, fd, opcode, arg, count));
+}
+
+inline unsigned load_acquire(const unsigned* p) {
+  return std::atomic_ref<const unsigned>(*p).load(std::memory_order_acquire);
+}
+
+inline void store_release(unsigned* p, unsigned v) {
+  std::atomic_ref<unsigned>(*p).store(v, std::memory_order_release);
+}
+
+// One submission and one completion queue, used from a single thread.
+class Ring {
+ public:
+  Ring() = default;
+  Ring(const Ring&) = delete;
+  Ring& operator=(const Ring&) = delete;
+
+  ~Ring() {
+    if (sqes_ != nullptr) munmap(sqes_, sqes_bytes_);
+    if (cq_map_ != nullptr && cq_map_ != sq_map_) munmap(cq_map_, cq_bytes_);
+    if (sq_map_ != nullptr) munmap(sq_map_, sq_bytes_);
+    if (fd_ >= 0) ::close(fd_);
+  }
+
+  // `cq_entries` of 0 keeps the kernel default of twice `entries`; larger
+  // sizes are clamped to the kernel's maximum.
+  bool init(unsigned entries, std::string* error, unsigned cq_entries = 0) {
+    io_uring_params params{};
+    if (cq_entries > 0) {
+      params.flags |= IORING_SETUP_CQSIZE | IORING_SETUP_CLAMP;
+      params.cq_entries = cq_entries;
+    }
+    fd_ = io_uring_setup(entries, &params);
+    if (fd_ < 0) {
+      set_error(error, errno_message("io_uring_setup"));
+      return false;
+    }
+    sq_bytes_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_bytes_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single) sq_bytes_ = cq_bytes_ = std::max(sq_bytes_, cq_bytes_);
+    sq_map_ = map(sq_bytes_, IORING_OFF_SQ_RING);
+    cq_map_ = single ? sq_map_ : map(cq_bytes_, IORING_OFF_CQ_RING);
+    sqes_bytes_ = params.sq_entries * sizeof(io_uring_sqe);
+    sqes_ = static_cast<io_uring_sqe*>(map(sqes_bytes_, IORING_OFF_SQES));
+    if (sq_map_ == nullptr || cq_map_ == nullptr || sqes_ == nullptr) {
+      set_error(error, errno_message("mapping io_uring rings"));
+      return false;
+    }
+    auto* sq = static_cast<char*>(sq_map_);
+    sq_head_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sq_mask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    sq_entries_ = params.sq_entries;
+    tail_ = *sq_tail_;
+    auto* cq = static_cast<char*>(cq_map_);
+    cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cq_mask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+    return true;
+  }
+
+  bool register_buffers(const iovec* iov, unsigned count, std::string* error) {
+    if (io_uring_register(fd_, IORING_REGISTER_BUFFERS, iov, count) == 0) {
+      return true;
+    }
+    std::string message = errno_message("registering io_uring buffers");
+    if (errno == ENOMEM) message += " (RLIMIT_MEMLOCK too low?)";
+    set_error(error, std::move(message));
+    return false;
+  }
+
+  // A zeroed entry to fill in, queued until the next submit(); nullptr
+  // when the submission queue is full.
+  io_uring_sqe* next_sqe() {
+    if (tail_ - load_acquire(sq_head_) == sq_entries_) return nullptr;
+    unsigned index = tail_ & sq_mask_;
+    sq_array_[index] = index;
+    ++tail_;
+    io_uring_sqe* sqe = &sqes_[index];
+    std::memset(sqe, 0, sizeof *sqe);
+    return sqe;
+  }
+
+  // Submits the queued entries and waits for at least `wait` completions.
+  bool submit(unsigned wait, std::string* error) {
+    store_release(sq_tail_, tail_);
+    unsigned queued = tail_ - submitted_;
+    for (;;) {
+      int n = io_uring_enter(fd_, queued, wait,
+                             wait > 0 ? IORING_ENTER_GETEVENTS : 0);
+      if (n < 0 && errno == EINTR) continue;
+      if (n < 0) {
+        set_error(error, errno_message("io_uring_enter"));
+        return false;
+      }
+      submitted_ += static_cast<unsigned>(n);
+      return true;
+    }
+  }
+
+  // Calls f(cqe) for every available completion. Each entry is released
+  // before f sees it, so f may queue new requests.
+  template <class F>
+  void drain(F&& f) {
+    unsigned head = *cq_head_;
+    unsigned tail = load_acquire(cq_tail_);
+    for (; head != tail; ++head) {
+      io_uring_cqe cqe = cqes_[head & cq_mask_];
+      store_release(cq_head_, head + 1);
+      f(cqe);
+    }
+  }
+
+ private:
+  void* map(std::size_t bytes, std::uint64_t offset) {
+    void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE, fd_, static_cast<off_t>(offset));
+    return p == MAP_FAILED ? nullptr : p;
+  }
+
+  int fd_ = -1;
+  void* sq_map_ = nullptr;
+  void* cq_map_ = nullptr;
+  std::size_t sq_bytes_ = 0;
+  std::size_t cq_bytes_ = 0;
+  io_uring_sqe* sqes_ = nullptr;
+  std::size_t sqes_bytes_ = 0;
+
+  unsigned* sq_head_ = nullptr;
+  unsigned* sq_tail_ = nullptr;
+  unsigned* sq_array_ = nullptr;
+  unsigned sq_mask_ = 0;
+  unsigned sq_entries_ = 0;
+  unsigned tail_ = 0;       // entries handed out by next_sqe()
+  unsigned submitted_ = 0;  // of those, accepted by the kernel
+
+  unsigned* cq_head_ = nullptr;
+  unsigned* cq_tail_ = nullptr;
+  unsigned cq_mask_ = 0;
+  io_uring_cqe* cqes_ = nullptr;
+};
+
+}  // namespace lab::io::detail
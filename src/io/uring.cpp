@@ -0,0 +1,145 @@
+// The uring backend: each pass sets up its own ring with one registered
+// buffer per queue slot and keeps every slot busy until the file is done.
+#include <sys/uio.h>
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "detail.hpp"
+#include "ring.hpp"
+
+namespace lab::io::detail {
+
+namespace {
+
+// One queue slot: a block of the file and its registered buffer.
+struct Slot {
+  std::uint64_t offset = 0;
+  std::size_t len = 0;
+  std::size_t done = 0;  // bytes transferred so far (short transfers)
+  clock::time_point start;
+};
+
+// Runs a whole-file pass over up to queue_depth slots.
+// `on_slot(i, buffer, slot)` prepares slot i for a new block and
+// `on_done(i, buffer, slot)` sees it once fully transferred.
+template <class Prepare, class Done>
+bool run(int fd, std::uint64_t size, std::uint8_t opcode, const Options& opts,
+         Stats& stats, std::string* error, Prepare&& on_slot,
+         Done&& on_done) {
+  std::uint64_t blocks = (size + opts.block_size - 1) / opts.block_size;
+  auto depth = static_cast<unsigned>(
+      std::min<std::uint64_t>(std::max(opts.queue_depth, 1u), blocks));
+  if (depth == 0) return true;
+
+  Ring ring;
+  if (!ring.init(depth, error)) return false;
+  Buffer buffer = make_buffer(depth * opts.block_size);
+  std::vector<iovec> iov(depth);
+  for (unsigned i = 0; i < depth; ++i) {
+    iov[i] = {buffer.get() + i * opts.block_size, opts.block_size};
+  }
+  if (!ring.register_buffers(iov.data(), depth, error)) return false;
+
+  std::vector<Slot> slots(depth);
+  auto issue = [&](unsigned i) {
+    Slot& s = slots[i];
+    io_uring_sqe* sqe = ring.next_sqe();  // never full: depth <= entries
+    sqe->opcode = opcode;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<std::uint64_t>(
+        static_cast<char*>(iov[i].iov_base) + s.done);
+    sqe->len = static_cast<std::uint32_t>(s.len - s.done);
+    sqe->off = s.offset + s.done;
+    sqe->buf_index = static_cast<std::uint16_t>(i);
+    sqe->user_data = i;
+    s.start = clock::now();
+  };
+  std::uint64_t next = 0;
+  auto start_block = [&](unsigned i) {
+    Slot& s = slots[i];
+    s.offset = next;
+    s.len = std::min<std::uint64_t>(opts.block_size, size - next);
+    s.done = 0;
+    next += s.len;
+    on_slot(i, static_cast<char*>(iov[i].iov_base), s);
+    issue(i);
+  };
+
+  for (unsigned i = 0; i < depth; ++i) start_block(i);
+  unsigned in_flight = depth;
+  bool ok = true;
+  while (in_flight > 0) {
+    if (!ring.submit(1, error)) return false;
+    ring.drain([&](const io_uring_cqe& cqe) {
+      auto i = static_cast<unsigned>(cqe.user_data);
+      Slot& s = slots[i];
+      // After a failure, only wait for what is still in flight.
+      if (ok && cqe.res <= 0) {
+        set_error(error, cqe.res == 0 ? std::string("io_uring: unexpected "
+                                                    "end of file")
+                                      : std::string("io_uring: ") +
+                                            std::strerror(-cqe.res));
+        ok = false;
+      }
+      if (!ok) {
+        --in_flight;
+        return;
+      }
+      record(stats, opts, static_cast<std::uint64_t>(cqe.res), s.start);
+      s.done += static_cast<std::size_t>(cqe.res);
+      if (s.done < s.len) {
+        issue(i);
+        return;
+      }
+      on_done(i, static_cast<const char*>(iov[i].iov_base), s);
+      if (next < size) {
+        start_block(i);
+      } else {
+        --in_flight;
+      }
+    });
+  }
+  return ok;
+}
+
+}  // namespace
+
+bool uring_supported(std::string* why) {
+  static const std::string error = [] {
+    Ring ring;
+    std::string e;
+    ring.init(1, &e);
+    return e;
+  }();
+  if (!error.empty()) set_error(why, error);
+  return error.empty();
+}
+
+bool uring_read(int fd, std::uint64_t size, const Options& opts,
+                const Consumer& consume, Stats& stats, std::string* error) {
+  return run(
+      fd, size, IORING_OP_READ_FIXED, opts, stats, error,
+      [](unsigned, char*, const Slot&) {},
+      [&](unsigned, const char* data, const Slot& s) {
+        consume(s.offset, data, s.len);
+      });
+}
+
+bool uring_write(int fd, std::uint64_t size, const Options& opts,
+                 Stats& stats, std::string* error) {
+  std::vector<bool> filled(std::max(opts.queue_depth, 1u));
+  return run(
+      fd, size, IORING_OP_WRITE_FIXED, opts, stats, error,
+      [&](unsigned i, char* data, const Slot& s) {
+        if (!filled[i]) {
+          fill_block(data, opts.block_size, s.offset);
+          filled[i] = true;
+        }
+        stamp_block(data, s.len, s.offset);
+      },
+      [](unsigned, const char*, const Slot&) {});
+}
+
+}  // namespace lab::io::detail
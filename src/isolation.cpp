@@ -0,0 +1,179 @@
+#include "lab/isolation.hpp"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string_view>
+
+#include "lab/bench.hpp"
+#include "lab/dataset.hpp"
+#include "lab/simd.hpp"
+#include "lab/stats.hpp"
+#include "lab/topology.hpp"
+
+namespace lab {
+
+namespace {
+
+// First line of a sysfs file, or empty if it cannot be read.
+std::string read_line(const std::string& path) {
+  std::ifstream in(path);
+  std::string line;
+  std::getline(in, line);
+  while (!line.empty() && (line.back() == '\n' || line.back() == ' ')) {
+    line.pop_back();
+  }
+  return line;
+}
+
+int read_flag(const std::string& path) {
+  std::string v = read_line(path);
+  if (v == "0") return 0;
+  if (v == "1") return 1;
+  return -1;
+}
+
+std::string join(const std::vector<int>& cpus) {
+  std::string s;
+  for (int c : cpus) {
+    if (!s.empty()) s += ',';
+    s += std::to_string(c);
+  }
+  return s;
+}
+
+}  // namespace
+
+HostState HostState::read(int cpu, const std::string& root) {
+  HostState host;
+  std::string dir = root + "/cpu" + std::to_string(cpu);
+  host.isolated = parse_cpu_list(read_line(root + "/isolated"));
+  host.governor = read_line(dir + "/cpufreq/scaling_governor");
+
+  // intel_pstate inverts the sense; acpi-cpufreq and amd-pstate use boost.
+  int no_turbo = read_flag(root + "/intel_pstate/no_turbo");
+  if (no_turbo >= 0) {
+    host.turbo = 1 - no_turbo;
+  } else {
+    host.turbo = read_flag(root + "/cpufreq/boost");
+  }
+
+  host.smt = read_flag(root + "/smt/active");
+  host.siblings =
+      parse_cpu_list(read_line(dir + "/topology/thread_siblings_list"));
+  return host;
+}
+
+std::vector<std::string> host_warnings(const HostState& host, int cpu) {
+  std::vector<std::string> warnings;
+  std::string c = "cpu " + std::to_string(cpu);
+  if (std::find(host.isolated.begin(), host.isolated.end(), cpu) ==
+      host.isolated.end()) {
+    warnings.push_back(
+        host.isolated.empty()
+            ? "no isolated cpus (boot with isolcpus=); " + c +
+                  " is shared with the scheduler"
+            : c + " is not isolated (isolated: " + join(host.isolated) + ")");
+  }
+  if (!host.governor.empty() && host.governor != "performance") {
+    warnings.push_back(c + " governor is " + host.governor +
+                       ", not performance");
+  }
+  if (host.turbo == 1) {
+    warnings.emplace_back("turbo boost is enabled; clocks follow temperature");
+  }
+  if (host.siblings.size() > 1) {
+    warnings.push_back(c + " shares its core with cpus " +
+                       join(host.siblings) + " (SMT)");
+  } else if (host.smt == 1 && host.siblings.empty()) {
+    warnings.emplace_back("SMT is active");
+  }
+  return warnings;
+}
+
+bool drop_caches(std::string* error) {
+  ::sync();
+  std::ofstream out("/proc/sys/vm/drop_caches");
+  out << "3\n";
+  out.close();
+  if (!out) {
+    if (error != nullptr) {
+      *error =
+          std::string("/proc/sys/vm/drop_caches: ") + std::strerror(errno);
+    }
+    return false;
+  }
+  return true;
+}
+
+double measure_noise(int runs) {
+  constexpr int kSpins = 1 << 15;
+  std::vector<double> ns;
+  ns.reserve(std::max(runs, 1));
+  std::uint64_t x = 1;
+  for (int r = 0; r < std::max(runs, 1); ++r) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kSpins; ++i) {
+      x = x * 6364136223846793005u + 1442695040888963407u;
+      do_not_optimize(x);
+    }
+    auto took = std::chrono::steady_clock::now() - start;
+    ns.push_back(std::chrono::duration<double, std::nano>(took).count());
+  }
+  double mid = median(ns);
+  if (mid <= 0) return 0;
+  std::vector<double> deviations;
+  deviations.reserve(ns.size());
+  for (double v : ns) deviations.push_back(std::abs(v - mid));
+  return 1.4826 * median(deviations) / mid;
+}
+
+std::string hardware_description() {
+  std::string model = "unknown cpu";
+  std::ifstream cpuinfo("/proc/cpuinfo");
+  for (std::string line; std::getline(cpuinfo, line);) {
+    // "model name" on x86; aarch64 only has part numbers.
+    if (line.rfind("model name", 0) == 0 || line.rfind("CPU part", 0) == 0) {
+      auto colon = line.find(':');
+      if (colon != std::string::npos && colon + 2 <= line.size()) {
+        model = line.substr(colon + 2);
+      }
+      break;
+    }
+  }
+
+  long kib = 0;
+  std::ifstream meminfo("/proc/meminfo");
+  for (std::string line; std::getline(meminfo, line);) {
+    if (std::sscanf(line.c_str(), "MemTotal: %ld kB", &kib) == 1) break;
+  }
+
+  std::string isas;
+  for (auto isa : simd::kAllIsas) {
+    if (isa == simd::Isa::scalar || !simd::isa_supported(isa)) continue;
+    if (!isas.empty()) isas += ',';
+    isas += simd::isa_name(isa);
+  }
+
+  return model + "; " + std::to_string(::sysconf(_SC_NPROCESSORS_ONLN)) +
+         " cpus; " + std::to_string(Topology::detect().node_cpus.size()) +
+         " nodes; " + std::to_string((kib + (1 << 19)) >> 20) + " GiB; " +
+         (isas.empty() ? "scalar" : isas);
+}
+
+std::string hardware_fingerprint(const std::string& description) {
+  char buf[24];
+  std::snprintf(buf, sizeof buf, "hw-%016llx",
+                static_cast<unsigned long long>(dataset::xxh64(
+                    description.data(), description.size())));
+  return buf;
+}
+
+}  // namespace lab
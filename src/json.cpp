@@ -0,0 +1,332 @@
+#include "lab/json.hpp"
+
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+
+namespace lab::json {
+
+namespace {
+
+void append_utf8(std::string& out, std::uint32_t cp) {
+  if (cp < 0x80) {
+    out += static_cast<char>(cp);
+  } else if (cp < 0x800) {
+    out += static_cast<char>(0xc0 | (cp >> 6));
+    out += static_cast<char>(0x80 | (cp & 0x3f));
+  } else if (cp < 0x10000) {
+    out += static_cast<char>(0xe0 | (cp >> 12));
+    out += static_cast<char>(0x80 | ((cp >> 6) & 0x3f));
+    out += static_cast<char>(0x80 | (cp & 0x3f));
+  } else {
+    out += static_cast<char>(0xf0 | (cp >> 18));
+    out += static_cast<char>(0x80 | ((cp >> 12) & 0x3f));
+    out += static_cast<char>(0x80 | ((cp >> 6) & 0x3f));
+    out += static_cast<char>(0x80 | (cp & 0x3f));
+  }
+}
+
+bool hex4(std::string_view text, std::size_t at, std::uint32_t& out) {
+  if (at + 4 > text.size()) return false;
+  auto [end, ec] =
+      std::from_chars(text.data() + at, text.data() + at + 4, out, 16);
+  return ec == std::errc() && end == text.data() + at + 4;
+}
+
+}  // namespace
+
+void Writer::key(std::string_view k) {
+  value(k);
+  *out_ += ':';
+  first_ = true;
+}
+
+void Writer::value(std::string_view s) {
+  separate();
+  *out_ += '"';
+  std::size_t run = 0;  // start of the pending unescaped run
+  for (std::size_t i = 0; i < s.size(); ++i) {
+    auto c = static_cast<unsigned char>(s[i]);
+    if (c >= 0x20 && c != '"' && c != '\\') continue;
+    out_->append(s.data() + run, i - run);
+    run = i + 1;
+    switch (c) {
+      case '"': *out_ += "\\\""; break;
+      case '\\': *out_ += "\\\\"; break;
+      case '\n': *out_ += "\\n"; break;
+      case '\t': *out_ += "\\t"; break;
+      case '\r': *out_ += "\\r"; break;
+      default: {
+        char buf[8];
+        std::snprintf(buf, sizeof buf, "\\u%04x", c);
+        *out_ += buf;
+      }
+    }
+  }
+  out_->append(s.data() + run, s.size() - run);
+  *out_ += '"';
+}
+
+void Writer::number(double v) {
+  if (!std::isfinite(v)) return null();
+  separate();
+  char buf[32];
+  auto [end, ec] = std::to_chars(buf, buf + sizeof buf, v);
+  out_->append(buf, ec == std::errc() ? end : buf);
+}
+
+void Writer::number(std::int64_t v) {
+  separate();
+  char buf[24];
+  out_->append(buf, std::to_chars(buf, buf + sizeof buf, v).ptr);
+}
+
+void Writer::number(std::uint64_t v) {
+  separate();
+  char buf[24];
+  out_->append(buf, std::to_chars(buf, buf + sizeof buf, v).ptr);
+}
+
+bool Reader::fail(const char* what) {
+  if (error_.empty()) {
+    error_ = std::string(what) + " at offset " + std::to_string(pos_);
+  }
+  return false;
+}
+
+void Reader::skip_space() {
+  while (pos_ < text_.size()) {
+    char c = text_[pos_];
+    if (c != ' ' && c != '\n' && c != '\r' && c != '\t') break;
+    ++pos_;
+  }
+}
+
+bool Reader::consume(char c) {
+  if (!ok()) return false;
+  skip_space();
+  if (pos_ < text_.size() && text_[pos_] == c) {
+    ++pos_;
+    return true;
+  }
+  return false;
+}
+
+bool Reader::begin_object() {
+  if (!consume('{')) return fail("expected '{'");
+  first_.push_back(true);
+  return true;
+}
+
+bool Reader::begin_array() {
+  if (!consume('[')) return fail("expected '['");
+  first_.push_back(true);
+  return true;
+}
+
+bool Reader::next(char close) {
+  if (!ok()) return false;
+  if (first_.empty()) return fail("not inside a container");
+  if (consume(close)) {
+    first_.pop_back();
+    return false;
+  }
+  if (!first_.back() && !consume(',')) return fail("expected ','");
+  first_.back() = false;
+  return true;
+}
+
+bool Reader::next_key(std::string_view& key) {
+  if (!next('}')) return false;
+  if (!string(key, scratch_)) return false;
+  if (!consume(':')) return fail("expected ':'");
+  return true;
+}
+
+bool Reader::next_element() { return next(']'); }
+
+bool Reader::string(std::string_view& view, std::string& scratch) {
+  if (!consume('"')) return fail("expected a string");
+  std::size_t start = pos_;
+  while (pos_ < text_.size()) {
+    char c = text_[pos_];
+    if (c == '"') {
+      view = text_.substr(start, pos_ - start);
+      ++pos_;
+      return true;
+    }
+    if (c == '\\') break;
+    if (static_cast<unsigned char>(c) < 0x20) return fail("control character");
+    ++pos_;
+  }
+  // Escapes: decode into scratch.
+  scratch.assign(text_.data() + start, pos_ - start);
+  while (pos_ < text_.size()) {
+    char c = text_[pos_++];
+    if (c == '"') {
+      view = scratch;
+      return true;
+    }
+    if (static_cast<unsigned char>(c) < 0x20) return fail("control character");
+    if (c != '\\') {
+      scratch += c;
+      continue;
+    }
+    if (pos_ >= text_.size()) break;
+    switch (text_[pos_++]) {
+      case '"': scratch += '"'; break;
+      case '\\': scratch += '\\'; break;
+      case '/': scratch += '/'; break;
+      case 'b': scratch += '\b'; break;
+      case 'f': scratch += '\f'; break;
+      case 'n': scratch += '\n'; break;
+      case 'r': scratch += '\r'; break;
+      case 't': scratch += '\t'; break;
+      case 'u': {
+        std::uint32_t cp;
+        if (!hex4(text_, pos_, cp)) return fail("bad \\u escape");
+        pos_ += 4;
+        if (cp >= 0xd800 && cp < 0xdc00) {
+          std::uint32_t low;
+          if (text_.substr(pos_, 2) != "\\u" || !hex4(text_, pos_ + 2, low) ||
+              low < 0xdc00 || low >= 0xe000) {
+            return fail("unpaired surrogate");
+          }
+          pos_ += 6;
+          cp = 0x10000 + ((cp - 0xd800) << 10) + (low - 0xdc00);
+        } else if (cp >= 0xdc00 && cp < 0xe000) {
+          return fail("unpaired surrogate");
+        }
+        append_utf8(scratch, cp);
+        break;
+      }
+      default:
+        return fail("bad escape");
+    }
+  }
+  return fail("unterminated string");
+}
+
+bool Reader::read(std::string& out) {
+  std::string_view view;
+  if (!string(view, scratch_)) return false;
+  out.assign(view);
+  return true;
+}
+
+bool Reader::number_text(std::string_view& text) {
+  if (!ok()) return false;
+  skip_space();
+  std::size_t start = pos_;
+  while (pos_ < text_.size()) {
+    char c = text_[pos_];
+    bool part = (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' ||
+                c == 'e' || c == 'E';
+    if (!part) break;
+    ++pos_;
+  }
+  text = text_.substr(start, pos_ - start);
+  if (text.empty() || (text[0] != '-' && (text[0] < '0' || text[0] > '9'))) {
+    pos_ = start;
+    return fail("expected a number");
+  }
+  return true;
+}
+
+namespace {
+
+template <class T>
+bool parse_number(std::string_view text, T& out) {
+  auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), out);
+  return ec == std::errc() && end == text.data() + text.size();
+}
+
+}  // namespace
+
+bool Reader::read(double& out) {
+  std::string_view text;
+  if (!number_text(text)) return false;
+  if (!parse_number(text, out)) return fail("malformed number");
+  return true;
+}
+
+bool Reader::read(std::int64_t& out) {
+  std::string_view text;
+  if (!number_text(text)) return false;
+  if (!parse_number(text, out)) return fail("expected an integer");
+  return true;
+}
+
+bool Reader::read(std::uint64_t& out) {
+  std::string_view text;
+  if (!number_text(text)) return false;
+  if (!parse_number(text, out)) return fail("expected an unsigned integer");
+  return true;
+}
+
+bool Reader::read(bool& out) {
+  if (!ok()) return false;
+  skip_space();
+  if (text_.substr(pos_, 4) == "true") {
+    out = true;
+    pos_ += 4;
+  } else if (text_.substr(pos_, 5) == "false") {
+    out = false;
+    pos_ += 5;
+  } else {
+    return fail("expected true or false");
+  }
+  return true;
+}
+
+bool Reader::read_null() {
+  if (!ok()) return false;
+  skip_space();
+  if (text_.substr(pos_, 4) != "null") return false;
+  pos_ += 4;
+  return true;
+}
+
+bool Reader::skip() {
+  if (!ok()) return false;
+  skip_space();
+  if (pos_ >= text_.size()) return fail("expected a value");
+  switch (text_[pos_]) {
+    case '{': {
+      begin_object();
+      for (std::string_view key; next_key(key);) {
+        if (!skip()) return false;
+      }
+      return ok();
+    }
+    case '[': {
+      begin_array();
+      while (next_element()) {
+        if (!skip()) return false;
+      }
+      return ok();
+    }
+    case '"': {
+      std::string_view view;
+      return string(view, scratch_);
+    }
+    case 't':
+    case 'f': {
+      bool b;
+      return read(b);
+    }
+    case 'n':
+      return read_null() || fail("expected a value");
+    default: {
+      double d;
+      return read(d);
+    }
+  }
+}
+
+bool Reader::at_end() {
+  skip_space();
+  return pos_ == text_.size();
+}
+
+}  // namespace lab::json
@@ -0,0 +1,337 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "lab/archive.hpp"
+#include "lab/calibrate.hpp"
+#include "lab/isolation.hpp"
+#include "lab/params.hpp"
+#include "lab/plugin_host.hpp"
+#include "lab/runner.hpp"
+#include "lab/test.hpp"
+#include "lab/trace.hpp"
+
+namespace {
+
+void usage(const char* argv0) {
+  std::fprintf(stderr,
+               "usage: %s [--filter=REGEX] [--list] [--warmup=SECONDS]\n"
+               "          [--min-time=SECONDS] [--samples=N] [--cpu=N]\n"
+               "          [--no-pin] [--perf] [--jobs=N] [--out=PATH]\n"
+               "          [--plugins=DIR] [--threads=GRID] [--size=GRID]\n"
+               "          [--param=NAME=GRID] [--archive=PATH] [--commit=SHA]\n"
+               "          [--no-check] [--no-latency] [--trace[=PATH]]\n"
+               "          [--isolate] [--drop-caches] [--watch]\n"
+               "          [--shard=I/N] [--fingerprint] [--calibrate[=only]]\n",
+               argv0);
+}
+
+// Parses "NAME=GRID" or, with `name` given, just "GRID".
+bool add_grid(std::vector<lab::Param>& grids, std::string name,
+              std::string spec) {
+  if (name.empty()) {
+    auto eq = spec.find('=');
+    if (eq == std::string::npos) {
+      std::fprintf(stderr, "error: --param expects NAME=GRID\n");
+      return false;
+    }
+    name = spec.substr(0, eq);
+    spec = spec.substr(eq + 1);
+  }
+  lab::Param param{name, {}};
+  std::string error;
+  if (!lab::parse_grid(spec, param.values, &error)) {
+    std::fprintf(stderr, "error: --%s: %s\n", name.c_str(), error.c_str());
+    return false;
+  }
+  grids.push_back(std::move(param));
+  return true;
+}
+
+// Matches "--key=value" and returns a pointer to value, or nullptr.
+const char* flag(const std::string& arg, const char* key) {
+  std::string prefix = std::string("--") + key + "=";
+  if (arg.compare(0, prefix.size(), prefix) != 0) return nullptr;
+  return arg.c_str() + prefix.size();
+}
+
+void print_results(const std::vector<lab::Result>& results) {
+  for (const auto& r : results) {
+    std::printf("%-40s %12llu iters %12.2f ns/op  p50 %10.2f  p99 %10.2f\n",
+                r.name.c_str(), static_cast<unsigned long long>(r.iterations),
+                r.ns_per_op, r.p50_ns, r.p99_ns);
+  }
+  std::fflush(stdout);
+}
+
+bool write_output(const std::string& path,
+                  const std::vector<lab::Result>& results) {
+  std::ofstream out(path);
+  if (!out) {
+    std::fprintf(stderr, "error: cannot open %s\n", path.c_str());
+    return false;
+  }
+  lab::write_results(out, results);
+  return static_cast<bool>(out);
+}
+
+// True if `row` is a grid point of the benchmark named `bench`.
+bool is_point_of(const std::string& row, const std::string& bench) {
+  return row.compare(0, bench.size(), bench) == 0 &&
+         (row.size() == bench.size() || row[bench.size()] == '/');
+}
+
+// --watch: reruns the benchmarks of each plugin that is rebuilt, replacing
+// their rows in the results, until interrupted. Inputs kept with
+// State::resident stay in this process across reloads.
+int watch_plugins(lab::PluginHost& plugins, lab::Registry& registry,
+                  const lab::RunnerOptions& opts,
+                  std::vector<lab::Result>& results) {
+  std::fprintf(stderr, "watching plugins for rebuilds; ^C to stop\n");
+  for (;;) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(250));
+    for (const auto& path : plugins.reload_changed()) {
+      std::vector<std::string> names = plugins.benchmarks_of(path);
+      std::fprintf(stderr, "reloaded %s (%zu benchmarks)\n", path.c_str(),
+                   names.size());
+      lab::Registry changed;
+      for (const auto& bench : registry.benchmarks()) {
+        if (std::find(names.begin(), names.end(), bench.name) != names.end()) {
+          changed.add(bench.name, bench.fn, bench.params);
+        }
+      }
+      std::vector<lab::Result> fresh = lab::run_all(changed, opts);
+      print_results(fresh);
+      std::erase_if(results, [&](const lab::Result& r) {
+        return std::any_of(names.begin(), names.end(), [&](const auto& n) {
+          return is_point_of(r.name, n);
+        });
+      });
+      results.insert(results.end(), fresh.begin(), fresh.end());
+      if (!write_output(opts.output, results)) return 1;
+    }
+  }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  lab::RunnerOptions opts;
+  std::vector<std::string> plugin_dirs;
+  std::string archive;
+  lab::RunInfo run_info;
+  bool list = false;
+  bool check = true;
+  bool trace = false;
+  bool isolate = false;
+  bool watch = false;
+  bool calibrate = false;
+  bool calibrate_only = false;
+  std::string trace_path;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (const char* v = flag(arg, "filter")) {
+      opts.filter = v;
+    } else if (const char* v = flag(arg, "warmup")) {
+      opts.warmup_seconds = std::atof(v);
+    } else if (const char* v = flag(arg, "min-time")) {
+      opts.min_seconds = std::atof(v);
+    } else if (const char* v = flag(arg, "samples")) {
+      opts.samples = std::atoi(v);
+    } else if (const char* v = flag(arg, "cpu")) {
+      opts.cpu = std::atoi(v);
+    } else if (const char* v = flag(arg, "jobs")) {
+      opts.jobs = std::atoi(v);
+    } else if (const char* v = flag(arg, "threads")) {
+      if (!add_grid(opts.grids, "threads", v)) return 2;
+    } else if (const char* v = flag(arg, "size")) {
+      if (!add_grid(opts.grids, "size", v)) return 2;
+    } else if (const char* v = flag(arg, "param")) {
+      if (!add_grid(opts.grids, "", v)) return 2;
+    } else if (const char* v = flag(arg, "out")) {
+      opts.output = v;
+    } else if (const char* v = flag(arg, "archive")) {
+      archive = v;
+    } else if (const char* v = flag(arg, "commit")) {
+      run_info.commit = v;
+    } else if (const char* v = flag(arg, "trace")) {
+      trace = true;
+      trace_path = v;
+    } else if (arg == "--trace") {
+      trace = true;
+    } else if (const char* v = flag(arg, "plugins")) {
+      plugin_dirs.push_back(v);
+    } else if (arg == "--perf") {
+      opts.perf_counters = true;
+    } else if (arg == "--no-pin") {
+      opts.pin = false;
+    } else if (const char* v = flag(arg, "shard")) {
+      if (std::sscanf(v, "%d/%d", &opts.shard, &opts.shards) != 2 ||
+          opts.shards < 1 || opts.shard < 0 || opts.shard >= opts.shards) {
+        std::fprintf(stderr, "error: --shard expects I/N with 0 <= I < N\n");
+        return 2;
+      }
+    } else if (arg == "--fingerprint") {
+      std::string description = lab::hardware_description();
+      std::printf("%s\t%s\n", lab::hardware_fingerprint(description).c_str(),
+                  description.c_str());
+      return 0;
+    } else if (arg == "--calibrate") {
+      calibrate = true;
+    } else if (const char* v = flag(arg, "calibrate")) {
+      if (std::string(v) != "only") {
+        usage(argv[0]);
+        return 2;
+      }
+      calibrate = calibrate_only = true;
+    } else if (arg == "--watch") {
+      watch = true;
+    } else if (arg == "--isolate") {
+      isolate = true;
+    } else if (arg == "--drop-caches") {
+      opts.drop_caches = true;
+    } else if (arg == "--no-latency") {
+      opts.latency = false;
+    } else if (arg == "--no-check") {
+      check = false;
+    } else if (arg == "--list") {
+      list = true;
+    } else {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+
+  if (opts.drop_caches && opts.jobs > 1) {
+    std::fprintf(stderr, "error: --drop-caches empties the page cache of "
+                 "the whole host under the other jobs; not with --jobs\n");
+    return 2;
+  }
+  if (watch && plugin_dirs.empty()) {
+    std::fprintf(stderr, "error: --watch reloads plugins; give --plugins\n");
+    return 2;
+  }
+
+  auto& registry = lab::Registry::global();
+  lab::PluginHost plugins(registry);
+  for (const auto& dir : plugin_dirs) plugins.load_directory(dir);
+
+  if (list) {
+    std::vector<lab::Benchmark> all = registry.benchmarks();
+    if (calibrate) {
+      const auto& baselines = lab::calibration_registry().benchmarks();
+      all.insert(all.begin(), baselines.begin(), baselines.end());
+    }
+    for (const auto& bench : all) {
+      std::printf("%s", bench.name.c_str());
+      for (const auto& param : bench.params) {
+        std::printf(" %s(%zu)", param.name.c_str(), param.values.size());
+      }
+      std::printf("\n");
+    }
+    return 0;
+  }
+
+  // Never time a kernel that computes the wrong answer.
+  if (check) {
+    lab::TestOptions test_opts;
+    test_opts.jobs = lab::Topology::detect().cpu_count();
+    int failed = 0;
+    for (const auto& r : lab::run_tests(lab::TestRegistry::global(),
+                                        test_opts)) {
+      if (r.passed) continue;
+      ++failed;
+      std::fprintf(stderr, "FAIL %s\n", r.name.c_str());
+      for (const auto& f : r.failures) {
+        std::fprintf(stderr, "     %s\n", f.c_str());
+      }
+    }
+    if (failed != 0) {
+      std::fprintf(stderr, "error: %d correctness test(s) failed; not "
+                   "benchmarking (see lab_test, or pass --no-check)\n",
+                   failed);
+      return 1;
+    }
+  }
+
+  // Isolation prefers a CPU the kernel keeps other tasks off, then
+  // reports whatever else on the host will add noise.
+  if (isolate) {
+    opts.pin = true;
+    auto isolated = lab::HostState::read(0).isolated;
+    if (opts.cpu < 0 && !isolated.empty()) opts.cpu = isolated.front();
+  }
+  int pinned = -1;
+  if (opts.pin) {
+    pinned = lab::pin_thread(opts.cpu);
+    if (pinned < 0) {
+      std::fprintf(stderr, "warning: could not pin to cpu %d\n", opts.cpu);
+    } else {
+      std::fprintf(stderr, "pinned to cpu %d\n", pinned);
+    }
+  }
+  if (isolate) {
+    if (opts.jobs > 1) {
+      std::fprintf(stderr, "warning: --isolate with --jobs: workers run on "
+                   "cpus that are not isolated\n");
+    }
+    if (pinned >= 0) {
+      for (const auto& w :
+           lab::host_warnings(lab::HostState::read(pinned), pinned)) {
+        std::fprintf(stderr, "warning: %s\n", w.c_str());
+      }
+    }
+    std::fprintf(stderr, "host noise %.2f%%\n", 100 * lab::measure_noise());
+  }
+
+  // Baselines of the whole machine: every one of them, unsharded, one at a
+  // time, whatever subset of the suite this run is for.
+  std::vector<lab::Result> results;
+  if (calibrate) {
+    lab::RunnerOptions calibration = opts;
+    calibration.filter.clear();
+    calibration.grids.clear();
+    calibration.jobs = 1;
+    calibration.shard = 0;
+    calibration.shards = 1;
+    results = lab::run_all(lab::calibration_registry(), calibration);
+  }
+
+  if (trace) lab::trace::start();
+  if (!calibrate_only) {
+    auto rows = lab::run_all(registry, opts);
+    results.insert(results.end(), rows.begin(), rows.end());
+  }
+  if (trace) {
+    lab::trace::stop();
+    // Next to the results unless given a path.
+    if (trace_path.empty()) {
+      trace_path =
+          (std::filesystem::path(opts.output).parent_path() / "trace.json")
+              .string();
+    }
+    std::string error;
+    if (!lab::trace::write_json(trace_path, &error)) {
+      std::fprintf(stderr, "error: --trace: %s\n", error.c_str());
+      return 1;
+    }
+    std::fprintf(stderr, "trace written to %s\n", trace_path.c_str());
+  }
+  print_results(results);
+  if (!write_output(opts.output, results)) return 1;
+
+  if (!archive.empty()) {
+    std::string error;
+    if (!lab::append_run(archive, run_info, results, &error)) {
+      std::fprintf(stderr, "error: --archive: %s\n", error.c_str());
+      return 1;
+    }
+  }
+  return watch ? watch_plugins(plugins, registry, opts, results) : 0;
+}
@@ -0,0 +1,127 @@
+#include "lab/numa.hpp"
+
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+
+#include "lab/pages.hpp"
+#include "lab/topology.hpp"
+
+namespace lab {
+
+namespace {
+
+// From <linux/mempolicy.h>; called through syscall(2) so lab does not
+// need libnuma.
+constexpr int kMpolDefault = 0;
+constexpr int kMpolBind = 2;
+constexpr int kMpolInterleave = 3;
+constexpr int kMaxNodes = 1024;
+constexpr std::size_t kMaskWords = kMaxNodes / (8 * sizeof(unsigned long));
+
+bool numa_error(std::string* error, std::string message) {
+  if (error != nullptr) *error = std::move(message);
+  return false;
+}
+
+std::size_t round_to_pages(std::size_t bytes) {
+  std::size_t page = page_size();
+  return (bytes + page - 1) / page * page;
+}
+
+}  // namespace
+
+NumaPolicy NumaPolicy::interleave(std::vector<int> nodes) {
+  return {kInterleave, std::move(nodes)};
+}
+
+std::vector<int> memory_nodes() {
+  std::ifstream in("/sys/devices/system/node/has_memory");
+  std::string list;
+  std::getline(in, list);
+  std::vector<int> nodes = parse_cpu_list(list);
+  if (nodes.empty()) nodes.push_back(0);
+  return nodes;
+}
+
+int current_node() {
+  unsigned cpu = 0, node = 0;
+  if (syscall(SYS_getcpu, &cpu, &node, nullptr) != 0) return -1;
+  return static_cast<int>(node);
+}
+
+int node_of_page(const void* p) {
+  // move_pages(2) without targets only reports where each page is.
+  void* pages[1] = {const_cast<void*>(p)};
+  int status[1] = {-1};
+  if (syscall(SYS_move_pages, 0, 1, pages, nullptr, status, 0) != 0) {
+    return -1;
+  }
+  return status[0] >= 0 ? status[0] : -1;
+}
+
+bool set_numa_policy(void* p, std::size_t bytes, const NumaPolicy& policy,
+                     std::string* error) {
+  unsigned long mask[kMaskWords] = {};
+  int mode = kMpolDefault;
+  if (policy.mode != NumaPolicy::kLocal) {
+    mode = policy.mode == NumaPolicy::kBind ? kMpolBind : kMpolInterleave;
+    std::vector<int> nodes = policy.nodes;
+    if (nodes.empty()) nodes = memory_nodes();
+    for (int node : nodes) {
+      if (node < 0 || node >= kMaxNodes) {
+        return numa_error(error, "no NUMA node " + std::to_string(node));
+      }
+      mask[node / (8 * sizeof(unsigned long))] |=
+          1ul << (node % (8 * sizeof(unsigned long)));
+    }
+  }
+  if (syscall(SYS_mbind, p, bytes, mode, mode == kMpolDefault ? nullptr : mask,
+              mode == kMpolDefault ? 0 : kMaxNodes + 1, 0) != 0) {
+    // Kernels built without NUMA have nothing to set for the default.
+    if (errno == ENOSYS && mode == kMpolDefault) return true;
+    return numa_error(error, std::string("mbind: ") + std::strerror(errno));
+  }
+  return true;
+}
+
+void* NumaResource::do_allocate(std::size_t bytes, std::size_t align) {
+  if (align > page_size()) throw std::bad_alloc();
+  std::size_t size = round_to_pages(bytes == 0 ? 1 : bytes);
+  void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (p == MAP_FAILED) throw std::bad_alloc();
+  if (!set_numa_policy(p, size, policy_)) {
+    munmap(p, size);
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void NumaResource::do_deallocate(void* p, std::size_t bytes, std::size_t) {
+  munmap(p, round_to_pages(bytes == 0 ? 1 : bytes));
+}
+
+NumaResource* numa_resource(const NumaPolicy& policy) {
+  static std::mutex mu;
+  // Never destroyed: arenas with static storage may still use them.
+  static auto* resources =
+      new std::map<std::pair<int, std::vector<int>>,
+                   std::unique_ptr<NumaResource>>;
+  std::lock_guard lock(mu);
+  auto& slot = (*resources)[{policy.mode, policy.nodes}];
+  if (!slot) slot = std::make_unique<NumaResource>(policy);
+  return slot.get();
+}
+
+}  // namespace lab
@@ -0,0 +1,150 @@
+#include "lab/pages.hpp"
+
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+#ifndef MADV_POPULATE_READ
+#define MADV_POPULATE_READ 22  // Linux 5.14
+#define MADV_POPULATE_WRITE 23
+#endif
+
+namespace lab {
+
+namespace {
+
+bool fail_errno(std::string* error, const std::string& what) {
+  if (error != nullptr) *error = what + ": " + std::strerror(errno);
+  return false;
+}
+
+std::size_t mapped_length(std::size_t bytes, const PageOptions& options) {
+  std::size_t unit = options.hugetlb ? kHugePageSize : page_size();
+  if (bytes == 0) bytes = 1;
+  return (bytes + unit - 1) / unit * unit;
+}
+
+// `length` bytes at a kHugePageSize boundary, as THP needs.
+void* map_aligned(std::size_t length, int flags) {
+  std::size_t span = length + kHugePageSize;
+  void* raw = ::mmap(nullptr, span, PROT_READ | PROT_WRITE, flags, -1, 0);
+  if (raw == MAP_FAILED) return raw;
+  auto addr = reinterpret_cast<std::uintptr_t>(raw);
+  auto aligned = (addr + kHugePageSize - 1) & ~(kHugePageSize - 1);
+  if (aligned > addr) ::munmap(raw, aligned - addr);
+  ::munmap(reinterpret_cast<void*>(aligned + length),
+           addr + span - aligned - length);
+  return reinterpret_cast<void*>(aligned);
+}
+
+// Allocates every page of fresh anonymous memory. Reading would only map
+// the shared zero page.
+void populate_write(void* p, std::size_t length) {
+  if (::madvise(p, length, MADV_POPULATE_WRITE) == 0) return;
+  auto* c = static_cast<volatile char*>(p);
+  for (std::size_t i = 0; i < length; i += page_size()) c[i] = 0;
+}
+
+bool lock_pages(const void* p, std::size_t bytes, std::string* error) {
+  if (::mlock(p, bytes) == 0) return true;
+  fail_errno(error, "mlock");
+  if (error != nullptr) *error += " (see ulimit -l)";
+  return false;
+}
+
+}  // namespace
+
+std::size_t page_size() {
+  static const auto size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+  return size;
+}
+
+bool map_pages(std::size_t bytes, const PageOptions& options,
+               PageMapping& out, std::string* error) {
+  out = {};
+  std::size_t length = mapped_length(bytes, options);
+  int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+  if (options.populate) flags |= MAP_POPULATE;
+  void* p = MAP_FAILED;
+  if (options.hugetlb) {
+    p = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, flags | MAP_HUGETLB,
+               -1, 0);
+    out.huge = p != MAP_FAILED;
+  }
+  if (p == MAP_FAILED && options.thp) {
+    // The advice must come before the first fault, so populate after it.
+    p = map_aligned(length, flags & ~MAP_POPULATE);
+    if (p == MAP_FAILED) return fail_errno(error, "mmap");
+    ::madvise(p, length, MADV_HUGEPAGE);
+    if (options.populate) populate_write(p, length);
+  }
+  if (p == MAP_FAILED) {
+    p = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, flags, -1, 0);
+    if (p == MAP_FAILED) return fail_errno(error, "mmap");
+  }
+  if (options.lock && !lock_pages(p, length, error)) {
+    ::munmap(p, length);
+    return false;
+  }
+  out.data = p;
+  out.bytes = length;
+  return true;
+}
+
+void unmap_pages(const PageMapping& mapping) {
+  if (mapping.data != nullptr) ::munmap(mapping.data, mapping.bytes);
+}
+
+bool prefault(const void* p, std::size_t bytes, const PageOptions& options,
+              std::string* error) {
+  if (bytes == 0) return true;
+  if (options.populate &&
+      ::madvise(const_cast<void*>(p), bytes, MADV_POPULATE_READ) != 0) {
+    // Older kernels: read one byte of every page instead.
+    const volatile char* c = static_cast<const volatile char*>(p);
+    for (std::size_t i = 0; i < bytes; i += page_size()) (void)c[i];
+  }
+  return !options.lock || lock_pages(p, bytes, error);
+}
+
+void* PageResource::do_allocate(std::size_t bytes, std::size_t align) {
+  PageMapping mapping;
+  if (align > page_size() || !map_pages(bytes, options_, mapping)) {
+    throw std::bad_alloc();
+  }
+  return mapping.data;
+}
+
+void PageResource::do_deallocate(void* p, std::size_t bytes, std::size_t) {
+  ::munmap(p, mapped_length(bytes, options_));
+}
+
+PageResource* page_resource(const PageOptions& options) {
+  static std::mutex mu;
+  // Never destroyed: arenas with static storage may still use them.
+  static auto* resources = new std::vector<std::unique_ptr<PageResource>>;
+  std::lock_guard lock(mu);
+  for (const auto& r : *resources) {
+    if (r->options() == options) return r.get();
+  }
+  resources->push_back(std::make_unique<PageResource>(options));
+  return resources->back().get();
+}
+
+PageFaults page_faults(bool thread) {
+  rusage usage{};
+  ::getrusage(thread ? RUSAGE_THREAD : RUSAGE_SELF, &usage);
+  return {static_cast<std::uint64_t>(usage.ru_minflt),
+          static_cast<std::uint64_t>(usage.ru_majflt)};
+}
+
+}  // namespace lab
@@ -0,0 +1,120 @@
+#include "lab/params.hpp"
+
+#include <charconv>
+#include <cstdio>
+#include <cstdlib>
+
+namespace lab {
+
+namespace {
+
+bool parse_value(std::string_view text, std::int64_t& out) {
+  const char* first = text.data();
+  const char* last = text.data() + text.size();
+  auto [ptr, ec] = std::from_chars(first, last, out);
+  if (ec != std::errc() || ptr == first) return false;
+  if (ptr == last) return true;
+  if (ptr + 1 != last) return false;
+  int shift = 0;
+  switch (*ptr) {
+    case 'K': shift = 10; break;
+    case 'M': shift = 20; break;
+    case 'G': shift = 30; break;
+    case 'T': shift = 40; break;
+    default: return false;
+  }
+  out <<= shift;
+  return true;
+}
+
+bool bad_item(std::string* error, std::string_view item) {
+  if (error != nullptr) *error = "bad grid item '" + std::string(item) + "'";
+  return false;
+}
+
+}  // namespace
+
+bool parse_grid(std::string_view spec, std::vector<std::int64_t>& out,
+                std::string* error) {
+  if (spec.empty()) return bad_item(error, spec);
+  while (!spec.empty()) {
+    auto comma = spec.find(',');
+    std::string_view item = spec.substr(0, comma);
+    spec = comma == std::string_view::npos ? std::string_view()
+                                           : spec.substr(comma + 1);
+
+    auto dots = item.find("..");
+    if (dots == std::string_view::npos) {
+      std::int64_t v;
+      if (!parse_value(item, v)) return bad_item(error, item);
+      out.push_back(v);
+      continue;
+    }
+
+    std::string_view hi_text = item.substr(dots + 2);
+    char op = 'x';
+    std::int64_t step = 2;
+    if (auto colon = hi_text.find(':'); colon != std::string_view::npos) {
+      std::string_view step_text = hi_text.substr(colon + 1);
+      hi_text = hi_text.substr(0, colon);
+      if (step_text.empty() || (step_text[0] != 'x' && step_text[0] != '+')) {
+        return bad_item(error, item);
+      }
+      op = step_text[0];
+      if (!parse_value(step_text.substr(1), step)) return bad_item(error, item);
+    }
+    std::int64_t lo, hi;
+    if (!parse_value(item.substr(0, dots), lo) || !parse_value(hi_text, hi) ||
+        lo > hi) {
+      return bad_item(error, item);
+    }
+    if (op == 'x' ? (step < 2 || lo <= 0) : step < 1) {
+      return bad_item(error, item);
+    }
+    for (std::int64_t v = lo; v <= hi;) {
+      out.push_back(v);
+      if (op == 'x' ? v > hi / step : v > hi - step) break;
+      v = op == 'x' ? v * step : v + step;
+    }
+  }
+  return true;
+}
+
+std::vector<std::int64_t> grid(std::string_view spec) {
+  std::vector<std::int64_t> values;
+  std::string error;
+  if (!parse_grid(spec, values, &error)) {
+    std::fprintf(stderr, "fatal: %s in grid '%.*s'\n", error.c_str(),
+                 static_cast<int>(spec.size()), spec.data());
+    std::abort();
+  }
+  return values;
+}
+
+std::vector<ParamValues> expand_grid(const std::vector<Param>& params) {
+  std::vector<ParamValues> points(1);
+  for (const auto& param : params) {
+    std::vector<ParamValues> next;
+    for (const auto& point : points) {
+      for (std::int64_t v : param.values) {
+        next.push_back(point);
+        next.back().emplace_back(param.name, v);
+      }
+    }
+    points = std::move(next);
+  }
+  return points;
+}
+
+std::string point_name(const std::string& base, const ParamValues& point) {
+  std::string name = base;
+  for (const auto& [param, value] : point) {
+    name += '/';
+    name += param;
+    name += ':';
+    name += std::to_string(value);
+  }
+  return name;
+}
+
+}  // namespace lab
@@ -0,0 +1,142 @@
+#include "lab/perf_counters.hpp"
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cstring>
+
+namespace lab {
+
+namespace {
+
+struct EventSpec {
+  const char* name;
+  std::uint32_t type;
+  std::uint64_t config;
+};
+
+constexpr std::uint64_t cache_event(std::uint64_t cache, std::uint64_t op,
+                                    std::uint64_t result) {
+  return cache | (op << 8) | (result << 16);
+}
+
+// Two groups of three fit the four general-purpose counters of most
+// x86 and Arm cores, with cycles/instructions on fixed counters.
+const EventSpec kGroups[][3] = {
+    {
+        {"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        {"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        {"branch_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    },
+    {
+        {"l1d_misses", PERF_TYPE_HW_CACHE,
+         cache_event(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ,
+                     PERF_COUNT_HW_CACHE_RESULT_MISS)},
+        {"llc_misses", PERF_TYPE_HW_CACHE,
+         cache_event(PERF_COUNT_HW_CACHE_LL, PERF_COUNT_HW_CACHE_OP_READ,
+                     PERF_COUNT_HW_CACHE_RESULT_MISS)},
+        {"dtlb_misses", PERF_TYPE_HW_CACHE,
+         cache_event(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_OP_READ,
+                     PERF_COUNT_HW_CACHE_RESULT_MISS)},
+    },
+};
+
+int open_event(const EventSpec& spec, int group_fd) {
+  perf_event_attr attr;
+  std::memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = spec.type;
+  attr.config = spec.config;
+  attr.disabled = group_fd == -1 ? 1 : 0;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                     PERF_FORMAT_TOTAL_TIME_RUNNING;
+  return static_cast<int>(
+      syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0));
+}
+
+}  // namespace
+
+PerfCounters::PerfCounters() {
+  for (const auto& group : kGroups) {
+    int leader = -1;
+    int index = static_cast<int>(leaders_.size());
+    for (const auto& spec : group) {
+      int fd = open_event(spec, leader);
+      if (fd < 0) {
+        missing_.push_back(spec.name);
+        continue;
+      }
+      if (leader == -1) {
+        leader = fd;
+        leaders_.push_back(fd);
+      }
+      events_.push_back({spec.name, fd, index});
+    }
+  }
+}
+
+PerfCounters::~PerfCounters() {
+  for (const auto& e : events_) close(e.fd);
+}
+
+void PerfCounters::reset() {
+  for (int fd : leaders_) {
+    ioctl(fd, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+  }
+}
+
+void PerfCounters::start() {
+  for (int fd : leaders_) {
+    ioctl(fd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  }
+}
+
+void PerfCounters::stop() {
+  for (int fd : leaders_) {
+    ioctl(fd, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+  }
+}
+
+std::vector<std::pair<std::string, double>> PerfCounters::read() const {
+  std::vector<std::pair<std::string, double>> counts;
+  for (std::size_t g = 0; g < leaders_.size(); ++g) {
+    // nr, time_enabled, time_running, value[nr]
+    std::uint64_t buf[3 + 8] = {};
+    if (::read(leaders_[g], buf, sizeof(buf)) < 0) continue;
+    double scale = buf[2] != 0 ? static_cast<double>(buf[1]) /
+                                     static_cast<double>(buf[2])
+                               : 0;
+    std::uint64_t i = 0;
+    for (const auto& e : events_) {
+      if (e.group != static_cast<int>(g)) continue;
+      if (i < buf[0]) {
+        counts.emplace_back(e.name, static_cast<double>(buf[3 + i]) * scale);
+      }
+      ++i;
+    }
+  }
+  return counts;
+}
+
+void append_perf_columns(
+    const std::vector<std::pair<std::string, double>>& counts,
+    std::uint64_t iterations,
+    std::vector<std::pair<std::string, double>>& out) {
+  double n = static_cast<double>(iterations == 0 ? 1 : iterations);
+  double cycles = 0;
+  double instructions = 0;
+  for (const auto& [name, count] : counts) {
+    out.emplace_back(name + "_per_op", count / n);
+    if (name == "cycles") cycles = count;
+    if (name == "instructions") instructions = count;
+  }
+  if (cycles > 0 && instructions > 0) {
+    out.emplace_back("ipc", instructions / cycles);
+  }
+}
+
+}  // namespace lab
@@ -0,0 +1,88 @@
+// Linked into every experiment plugin. Exposes the plugin's own Registry,
+// filled by LAB_BENCH as usual, through the C ABI in lab/plugin.h.
+#include <chrono>
+#include <cstdint>
+#include <new>
+#include <string>
+#include <utility>
+
+#include "lab/bench.hpp"
+#include "lab/plugin.h"
+
+namespace {
+
+// Forwards the plugin-side State's timed regions to the host's probe.
+class HostProbe : public lab::Probe {
+ public:
+  explicit HostProbe(lab_run* run) : run_(run) {}
+  void start() override { run_->probe_start(run_); }
+  void stop() override { run_->probe_stop(run_); }
+
+ private:
+  lab_run* run_;
+};
+
+// Keeps the plugin's inputs in the host, where they survive a reload.
+class HostResident : public lab::Resident {
+ public:
+  explicit HostResident(lab_run* run) : run_(run) {}
+  void* get(const std::string& key, std::size_t bytes, Init init,
+            void* ctx) override {
+    void* data = run_->resident(run_, key.c_str(), bytes, init, ctx);
+    if (data == nullptr) throw std::bad_alloc();
+    return data;
+  }
+
+ private:
+  lab_run* run_;
+};
+
+void trampoline(lab_run* run, void* user) {
+  const auto* bench = static_cast<const lab::Benchmark*>(user);
+  lab::ParamValues params;
+  if (LAB_RUN_HAS(run, param_values)) {
+    for (std::uint32_t i = 0; i < run->param_count; ++i) {
+      params.emplace_back(run->param_names[i], run->param_values[i]);
+    }
+  }
+  lab::State state(run->iterations, std::move(params));
+  HostProbe probe(run);
+  if (LAB_RUN_HAS(run, probe_stop) && run->probe_start != nullptr) {
+    state.set_probe(&probe);
+  }
+  HostResident resident(run);
+  if (LAB_RUN_HAS(run, resident) && run->resident != nullptr) {
+    state.set_resident_store(&resident);
+  }
+  bool latency = LAB_RUN_HAS(run, merge_latency) && run->merge_latency;
+  if (latency && run->time_each_iteration != 0) state.time_each_iteration();
+  bench->fn(state);
+  if (state.running()) state.pause_timing();
+  run->elapsed_ns = static_cast<std::uint64_t>(state.elapsed().count());
+  run->bytes_per_op = state.bytes_per_op();
+  for (const auto& [name, value] : state.counters()) {
+    run->set_counter(run, name.c_str(), value);
+  }
+  if (latency && !state.latency().empty()) {
+    run->merge_latency(run, state.latency().serialize().c_str());
+  }
+}
+
+}  // namespace
+
+extern "C" __attribute__((visibility("default"))) int
+lab_experiment_register(const lab_host* host) {
+  if (host->abi_version < 1) return 1;
+  for (const auto& bench : lab::Registry::global().benchmarks()) {
+    // A host without parameter support could only run the defaults under
+    // the wrong name; skip such benchmarks rather than mislabel them.
+    if (!bench.params.empty() && host->abi_version < 2) continue;
+    host->add_benchmark(host->ctx, bench.name.c_str(), trampoline,
+                        const_cast<lab::Benchmark*>(&bench));
+    for (const auto& param : bench.params) {
+      host->add_param(host->ctx, param.name.c_str(), param.values.data(),
+                      static_cast<std::uint32_t>(param.values.size()));
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,235 @@
+#include "lab/plugin_host.hpp"
+
+#include <dlfcn.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "lab/histogram.hpp"
+#include "lab/plugin.h"
+#include "lab/topology.hpp"
+
+namespace lab {
+
+namespace {
+
+using RegisterFn = int (*)(const lab_host*);
+
+void set_counter(lab_run* run, const char* name, double value) {
+  static_cast<State*>(run->host_ctx)->set_counter(name, value);
+}
+
+void probe_start(lab_run* run) {
+  static_cast<State*>(run->host_ctx)->probe()->start();
+}
+
+void probe_stop(lab_run* run) {
+  static_cast<State*>(run->host_ctx)->probe()->stop();
+}
+
+void* resident(lab_run* run, const char* key, std::uint64_t bytes,
+               lab_resident_init init, void* ctx) {
+  try {
+    return static_cast<State*>(run->host_ctx)
+        ->resident_store()
+        .get(key, bytes, init, ctx);
+  } catch (const std::bad_alloc&) {
+    return nullptr;
+  }
+}
+
+void merge_latency(lab_run* run, const char* histogram) {
+  Histogram h;
+  if (Histogram::deserialize(histogram, h)) {
+    static_cast<State*>(run->host_ctx)->latency().merge(h);
+  }
+}
+
+void add_benchmark(void* ctx, const char* name, lab_bench_fn fn,
+                   void* user) {
+  static_cast<Registry*>(ctx)->add(name, [fn, user](State& state) {
+    lab_run run{};
+    run.size = sizeof(run);
+    run.iterations = state.iterations();
+    run.host_ctx = &state;
+    run.set_counter = set_counter;
+    run.resident = resident;
+    run.time_each_iteration = state.times_each_iteration() ? 1 : 0;
+    run.merge_latency = merge_latency;
+    if (state.probe() != nullptr) {
+      run.probe_start = probe_start;
+      run.probe_stop = probe_stop;
+    }
+    std::vector<const char*> names;
+    std::vector<std::int64_t> values;
+    for (const auto& [name, value] : state.params()) {
+      names.push_back(name.c_str());
+      values.push_back(value);
+    }
+    run.param_count = static_cast<std::uint32_t>(names.size());
+    run.param_names = names.data();
+    run.param_values = values.data();
+    fn(&run, user);
+    state.add_elapsed(std::chrono::nanoseconds(run.elapsed_ns));
+    state.set_bytes_per_op(run.bytes_per_op);
+  });
+}
+
+void add_param(void* ctx, const char* name, const std::int64_t* values,
+               std::uint32_t count) {
+  auto& registry = *static_cast<Registry*>(ctx);
+  registry.add_param(Param{name, {values, values + count}});
+}
+
+// Moves the benchmarks of `from` to the end of `to`, returning their names.
+std::vector<std::string> adopt(Registry& from, Registry& to) {
+  std::vector<std::string> names;
+  for (const auto& bench : from.benchmarks()) {
+    names.push_back(bench.name);
+    to.add(bench.name, bench.fn, bench.params);
+  }
+  return names;
+}
+
+}  // namespace
+
+PluginHost::~PluginHost() {
+  for (const auto& plugin : plugins_) dlclose(plugin.handle);
+}
+
+bool PluginHost::stamp(const std::string& path, Stamp& out) {
+  std::error_code ec;
+  out.mtime = std::filesystem::last_write_time(path, ec);
+  if (ec) return false;
+  out.size = std::filesystem::file_size(path, ec);
+  return !ec;
+}
+
+bool PluginHost::open(const std::string& file, const std::string& path,
+                      void*& handle, Registry& into) {
+  // Static initialisers run here, and a reload may come after lab_bench
+  // pinned this thread; see with_startup_affinity().
+  with_startup_affinity(
+      [&] { handle = dlopen(file.c_str(), RTLD_NOW | RTLD_LOCAL); });
+  if (handle == nullptr) {
+    error_ = dlerror();
+    return false;
+  }
+  auto reg = reinterpret_cast<RegisterFn>(
+      dlsym(handle, "lab_experiment_register"));
+  if (reg == nullptr) {
+    error_ = path + ": no lab_experiment_register symbol";
+    dlclose(handle);
+    return false;
+  }
+  lab_host host{LAB_PLUGIN_ABI_VERSION, &into, add_benchmark, add_param};
+  if (int rc = reg(&host); rc != 0) {
+    error_ = path + ": lab_experiment_register returned " +
+             std::to_string(rc);
+    dlclose(handle);
+    return false;
+  }
+  return true;
+}
+
+bool PluginHost::load(const std::string& path) {
+  Plugin plugin;
+  plugin.path = path;
+  stamp(path, plugin.loaded);
+  plugin.seen = plugin.loaded;
+  Registry fresh;
+  if (!open(path, path, plugin.handle, fresh)) return false;
+  plugin.benchmarks = adopt(fresh, registry_);
+  plugins_.push_back(std::move(plugin));
+  return true;
+}
+
+std::vector<std::string> PluginHost::reload_changed() {
+  namespace fs = std::filesystem;
+  std::vector<std::string> reloaded;
+  for (auto& plugin : plugins_) {
+    // A file missing or changed since the last call is still being built.
+    Stamp now;
+    if (!stamp(plugin.path, now) || now == plugin.loaded) continue;
+    if (!(now == plugin.seen)) {
+      plugin.seen = now;
+      continue;
+    }
+    plugin.loaded = now;
+
+    // Load a private copy: the loader hands back the image it already has
+    // for a path that is still open, and the next build may overwrite the
+    // file while it is mapped.
+    fs::path copy = fs::temp_directory_path() /
+                    ("lab_plugin_" + std::to_string(::getpid()) + "_" +
+                     std::to_string(++generation_) + "_" +
+                     fs::path(plugin.path).filename().string());
+    std::error_code ec;
+    fs::copy_file(plugin.path, copy, fs::copy_options::overwrite_existing,
+                  ec);
+    if (ec) {
+      std::fprintf(stderr, "error: %s: %s\n", plugin.path.c_str(),
+                   ec.message().c_str());
+      continue;
+    }
+    Registry fresh;
+    void* handle = nullptr;
+    bool opened = open(copy.string(), plugin.path, handle, fresh);
+    fs::remove(copy, ec);
+    if (!opened) {
+      std::fprintf(stderr, "error: %s\n", error_.c_str());
+      continue;
+    }
+
+    // The old benchmarks call into the old image; drop them before it goes.
+    for (const auto& name : plugin.benchmarks) registry_.remove(name);
+    dlclose(plugin.handle);
+    plugin.handle = handle;
+    plugin.benchmarks = adopt(fresh, registry_);
+    reloaded.push_back(plugin.path);
+  }
+  return reloaded;
+}
+
+std::vector<std::string> PluginHost::benchmarks_of(
+    const std::string& path) const {
+  for (const auto& plugin : plugins_) {
+    if (plugin.path == path) return plugin.benchmarks;
+  }
+  return {};
+}
+
+int PluginHost::load_directory(const std::string& dir) {
+  namespace fs = std::filesystem;
+  std::vector<fs::path> paths;
+  std::error_code ec;
+  for (const auto& entry : fs::directory_iterator(dir, ec)) {
+    if (entry.is_regular_file() && entry.path().extension() == ".so") {
+      paths.push_back(entry.path());
+    }
+  }
+  if (ec) {
+    std::fprintf(stderr, "error: %s: %s\n", dir.c_str(),
+                 ec.message().c_str());
+    return 0;
+  }
+  std::sort(paths.begin(), paths.end());
+
+  int loaded = 0;
+  for (const auto& path : paths) {
+    if (load(path.string())) {
+      ++loaded;
+    } else {
+      std::fprintf(stderr, "error: %s\n", error_.c_str());
+    }
+  }
+  return loaded;
+}
+
+}  // namespace lab
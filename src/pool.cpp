@@ -0,0 +1,41 @@
+#include "lab/pool.hpp"
+
+namespace lab {
+
+Pool::Pool(std::pmr::memory_resource* upstream) : upstream_(upstream) {}
+
+Pool::~Pool() { release(); }
+
+void* Pool::refill(int c) {
+  // Slabs are aligned to the largest class so every block is naturally
+  // aligned to its own size. The slab header takes the first block.
+  auto* slab = static_cast<Slab*>(upstream_->allocate(kSlabSize, kMaxClass));
+  slab->next = slab_list_;
+  slab_list_ = slab;
+  ++slabs_;
+
+  std::size_t size = kMinClass << c;
+  char* base = reinterpret_cast<char*>(slab);
+  std::size_t first = size < sizeof(Slab) ? sizeof(Slab) : size;
+  FreeNode* head = nullptr;
+  for (std::size_t off = kSlabSize - size; off > first; off -= size) {
+    auto* node = reinterpret_cast<FreeNode*>(base + off);
+    node->next = head;
+    head = node;
+  }
+  free_[c] = head;
+  return base + first;
+}
+
+void Pool::release() {
+  for (Slab* s = slab_list_; s != nullptr;) {
+    Slab* next = s->next;
+    upstream_->deallocate(s, kSlabSize, kMaxClass);
+    s = next;
+  }
+  slab_list_ = nullptr;
+  slabs_ = 0;
+  for (auto& head : free_) head = nullptr;
+}
+
+}  // namespace lab
@@ -0,0 +1,282 @@
+#include "lab/probe.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <memory>
+
+#include "lab/histogram.hpp"
+#include "lab/perf_counters.hpp"
+#include "lab/trace.hpp"
+
+namespace lab::probe {
+
+namespace {
+
+using Counts = std::vector<std::pair<std::string, double>>;
+
+// One thread's share of a Latency. Slots outlive their threads, so values
+// recorded just before a thread exits are still drained, and are handed
+// to the next thread that needs one.
+struct Slot {
+  std::mutex mu;
+  Histogram histogram;
+  bool owned = true;  // by a live thread; guarded by Registry::mu
+};
+
+struct Entry {
+  std::unique_ptr<Latency> latency;
+  std::vector<std::unique_ptr<Slot>> slots;
+};
+
+struct CountedThread {
+  PerfCounters counters;
+  Counts last;  // at the previous drain
+};
+
+// Never destroyed: threads may still record during exit.
+struct Registry {
+  std::mutex mu;
+  std::map<std::string, std::size_t, std::less<>> index;
+  std::vector<Entry> entries;
+  std::vector<CountedThread*> counted;
+  Counts retired;  // of counted threads that exited since the last drain
+
+  std::mutex drain_mu;  // held through drain(), taken before mu
+  std::chrono::steady_clock::time_point last_drain =
+      std::chrono::steady_clock::now();
+};
+
+Registry& registry() {
+  static Registry* r = new Registry;
+  return *r;
+}
+
+// Adds now - before (or all of now) to `into`, by event name.
+void add_counts(Counts& into, const Counts& now, const Counts* before) {
+  for (const auto& [name, count] : now) {
+    double base = 0;
+    if (before != nullptr) {
+      for (const auto& [n, c] : *before) {
+        if (n == name) base = c;
+      }
+    }
+    auto it = std::find_if(into.begin(), into.end(),
+                           [&](const auto& p) { return p.first == name; });
+    if (it == into.end()) {
+      into.emplace_back(name, count - base);
+    } else {
+      it->second += count - base;
+    }
+  }
+}
+
+// The calling thread's slots by Latency index, released when it exits.
+struct ThreadSlots {
+  std::vector<Slot*> slots;
+  ~ThreadSlots() {
+    Registry& r = registry();
+    std::lock_guard lock(r.mu);
+    for (Slot* s : slots) {
+      if (s != nullptr) s->owned = false;
+    }
+  }
+};
+
+thread_local ThreadSlots thread_slots;
+
+// Folds the calling thread's final counts into Registry::retired when it
+// exits.
+struct ThreadCounters {
+  std::unique_ptr<CountedThread> counted;
+  ~ThreadCounters() {
+    if (counted == nullptr) return;
+    Registry& r = registry();
+    std::lock_guard lock(r.mu);
+    add_counts(r.retired, counted->counters.read(), &counted->last);
+    r.counted.erase(
+        std::find(r.counted.begin(), r.counted.end(), counted.get()));
+  }
+};
+
+thread_local ThreadCounters thread_counters;
+
+Slot* acquire_slot(std::size_t index) {
+  Registry& r = registry();
+  std::lock_guard lock(r.mu);
+  auto& slots = r.entries[index].slots;
+  for (auto& s : slots) {
+    if (!s->owned) {
+      s->owned = true;
+      return s.get();
+    }
+  }
+  slots.push_back(std::make_unique<Slot>());
+  return slots.back().get();
+}
+
+Result latency_row(std::string name, const Histogram& h, double seconds) {
+  Result row;
+  row.name = std::move(name);
+  row.iterations = h.count();
+  row.ns_per_op = h.mean();
+  row.p50_ns = static_cast<double>(h.percentile(0.5));
+  row.p99_ns = static_cast<double>(h.percentile(0.99));
+  set_latency(row, h);
+  row.set_counter("per_s", static_cast<double>(h.count()) / seconds);
+  return row;
+}
+
+}  // namespace
+
+void Latency::record(std::uint64_t ns) {
+  auto& slots = thread_slots.slots;
+  if (index_ >= slots.size()) slots.resize(index_ + 1, nullptr);
+  Slot* s = slots[index_];
+  if (s == nullptr) s = slots[index_] = acquire_slot(index_);
+  std::lock_guard lock(s->mu);
+  s->histogram.record(ns);
+}
+
+Latency& latency(std::string_view name) {
+  Registry& r = registry();
+  std::lock_guard lock(r.mu);
+  if (auto it = r.index.find(name); it != r.index.end()) {
+    return *r.entries[it->second].latency;
+  }
+  std::size_t index = r.entries.size();
+  r.entries.push_back(
+      {std::unique_ptr<Latency>(new Latency(std::string(name), index)), {}});
+  r.index.emplace(std::string(name), index);
+  return *r.entries.back().latency;
+}
+
+bool count_thread() {
+  if (thread_counters.counted != nullptr) return true;
+  auto counted = std::make_unique<CountedThread>();
+  if (!counted->counters.available()) return false;
+  counted->counters.reset();
+  counted->counters.start();
+  counted->last = counted->counters.read();
+  Registry& r = registry();
+  std::lock_guard lock(r.mu);
+  r.counted.push_back(counted.get());
+  thread_counters.counted = std::move(counted);
+  return true;
+}
+
+std::vector<Result> drain() {
+  Registry& r = registry();
+  std::lock_guard drain_lock(r.drain_mu);
+  auto now = std::chrono::steady_clock::now();
+  double seconds = std::max(
+      std::chrono::duration<double>(now - r.last_drain).count(), 1e-9);
+  r.last_drain = now;
+
+  std::vector<Result> rows;
+  Counts perf;
+  std::size_t perf_threads = 0;
+  {
+    std::lock_guard lock(r.mu);
+    for (const Entry& e : r.entries) {
+      Histogram merged;
+      for (const auto& s : e.slots) {
+        std::lock_guard slot_lock(s->mu);
+        merged.merge(s->histogram);
+        s->histogram.clear();
+      }
+      if (!merged.empty()) {
+        rows.push_back(
+            latency_row("latency/" + e.latency->name(), merged, seconds));
+      }
+    }
+    perf = std::move(r.retired);
+    r.retired.clear();
+    for (CountedThread* c : r.counted) {
+      Counts counts = c->counters.read();
+      add_counts(perf, counts, &c->last);
+      c->last = std::move(counts);
+    }
+    perf_threads = r.counted.size();
+  }
+
+  std::map<std::uint32_t, Histogram> scopes;
+  trace::drain([&](std::uint32_t name, std::uint64_t ns) {
+    scopes[name].record(ns);
+  });
+  for (const auto& [name, h] : scopes) {
+    rows.push_back(latency_row("trace/" + trace::name_of(name), h, seconds));
+  }
+
+  if (!perf.empty()) {
+    Result row;
+    row.name = "perf";
+    row.iterations = perf_threads;
+    double cycles = 0, instructions = 0;
+    for (const auto& [name, count] : perf) {
+      row.set_counter(name + "_per_s", count / seconds);
+      if (name == "cycles") cycles = count;
+      if (name == "instructions") instructions = count;
+    }
+    if (cycles > 0 && instructions > 0) {
+      row.set_counter("ipc", instructions / cycles);
+    }
+    rows.push_back(std::move(row));
+  }
+  return rows;
+}
+
+Sidecar::Sidecar(SidecarOptions opts) : opts_(std::move(opts)) {
+  thread_ = std::thread([this] {
+    std::unique_lock lock(mu_);
+    auto stopping = [this] { return stopping_; };
+    while (!wake_.wait_for(lock, opts_.interval, stopping)) {
+      lock.unlock();
+      flush();
+      lock.lock();
+    }
+  });
+}
+
+Sidecar::~Sidecar() {
+  {
+    std::lock_guard lock(mu_);
+    stopping_ = true;
+  }
+  wake_.notify_all();
+  thread_.join();
+  flush();
+}
+
+void Sidecar::flush() {
+  std::vector<Result> rows = drain();
+  if (rows.empty()) return;
+  RunInfo info = opts_.info;
+  info.timestamp = 0;
+  std::string error;
+  bool ok = append_run(opts_.archive, info, rows, &error);
+  std::lock_guard lock(mu_);
+  if (ok) {
+    ++appended_;
+  } else {
+    ++failures_;
+    last_error_ = std::move(error);
+  }
+}
+
+std::uint64_t Sidecar::appended() const {
+  std::lock_guard lock(mu_);
+  return appended_;
+}
+
+std::uint64_t Sidecar::failures() const {
+  std::lock_guard lock(mu_);
+  return failures_;
+}
+
+std::string Sidecar::last_error() const {
+  std::lock_guard lock(mu_);
+  return last_error_;
+}
+
+}  // namespace lab::probe
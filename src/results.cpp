@@ -0,0 +1,238 @@
+#include "lab/results.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <istream>
+#include <ostream>
+#include <sstream>
+#include <unordered_map>
+
+#include "lab/histogram.hpp"
+#include "lab/stats.hpp"
+
+namespace lab {
+
+const double* Result::counter(const std::string& name) const {
+  for (const auto& [n, v] : counters) {
+    if (n == name) return &v;
+  }
+  return nullptr;
+}
+
+void Result::set_counter(const std::string& name, double value) {
+  for (auto& [n, v] : counters) {
+    if (n == name) {
+      v = value;
+      return;
+    }
+  }
+  counters.emplace_back(name, value);
+}
+
+void set_latency(Result& result, const Histogram& h) {
+  for (auto [name, q] : {std::pair{"lat_p50_ns", 0.50},
+                         {"lat_p90_ns", 0.90},
+                         {"lat_p99_ns", 0.99},
+                         {"lat_p999_ns", 0.999}}) {
+    result.set_counter(name, static_cast<double>(h.percentile(q)));
+  }
+  result.set_counter("lat_max_ns", static_cast<double>(h.max()));
+  result.latency = h.serialize();
+}
+
+std::vector<Result> merge_results(const std::vector<Result>& rows) {
+  std::vector<std::vector<const Result*>> groups;
+  std::unordered_map<std::string, std::size_t> index;
+  for (const auto& r : rows) {
+    auto [it, inserted] = index.try_emplace(r.name, groups.size());
+    if (inserted) groups.emplace_back();
+    groups[it->second].push_back(&r);
+  }
+
+  std::vector<Result> merged;
+  merged.reserve(groups.size());
+  for (const auto& group : groups) {
+    Result m = *group.front();
+    if (group.size() == 1) {
+      merged.push_back(std::move(m));
+      continue;
+    }
+    m.iterations = 0;
+    m.samples.clear();
+    m.counters.clear();
+    double time = 0;
+    double total = 0;
+    std::vector<std::pair<std::string, double>> weighted;  // sum of v * n
+    std::vector<double> weights;
+    Histogram latency;
+    for (const Result* r : group) {
+      auto n = static_cast<double>(std::max<std::uint64_t>(r->iterations, 1));
+      m.iterations += r->iterations;
+      time += r->ns_per_op * n;
+      total += n;
+      m.samples.insert(m.samples.end(), r->samples.begin(), r->samples.end());
+      for (const auto& [name, value] : r->counters) {
+        auto it = std::find_if(weighted.begin(), weighted.end(),
+                               [&](const auto& c) { return c.first == name; });
+        if (it == weighted.end()) {
+          weighted.emplace_back(name, 0);
+          weights.push_back(0);
+          it = weighted.end() - 1;
+        }
+        it->second += value * n;
+        weights[static_cast<std::size_t>(it - weighted.begin())] += n;
+      }
+      Histogram h;
+      if (!r->latency.empty() && Histogram::deserialize(r->latency, h)) {
+        latency.merge(h);
+      }
+    }
+    m.ns_per_op = time / total;
+    for (std::size_t i = 0; i < weighted.size(); ++i) {
+      m.counters.emplace_back(weighted[i].first,
+                              weighted[i].second / weights[i]);
+    }
+    if (!m.samples.empty()) {
+      std::vector<double> sorted = m.samples;
+      m.p50_ns = percentile(sorted, 0.50);
+      m.p99_ns = percentile(sorted, 0.99);
+    }
+    m.latency.clear();
+    if (!latency.empty()) set_latency(m, latency);
+    merged.push_back(std::move(m));
+  }
+  return merged;
+}
+
+namespace {
+
+// Integral values (parameters, counts) print exactly; others keep nine
+// significant digits, enough to round-trip sample timings.
+void write_number(std::ostream& out, double v) {
+  char buf[32];
+  if (v == std::floor(v) && std::fabs(v) < 9.007199254740992e15) {
+    std::snprintf(buf, sizeof(buf), "%.0f", v);
+  } else {
+    std::snprintf(buf, sizeof(buf), "%.9g", v);
+  }
+  out << buf;
+}
+
+}  // namespace
+
+void write_results(std::ostream& out, const std::vector<Result>& results) {
+  std::vector<std::string> extra;
+  for (const auto& r : results) {
+    for (const auto& [name, value] : r.counters) {
+      if (std::find(extra.begin(), extra.end(), name) == extra.end()) {
+        extra.push_back(name);
+      }
+    }
+  }
+
+  bool latency = std::any_of(results.begin(), results.end(),
+                             [](const Result& r) { return !r.latency.empty(); });
+
+  out << "name\titerations\tns_per_op\tp50_ns\tp99_ns\tbytes_per_op";
+  for (const auto& name : extra) out << '\t' << name;
+  out << "\tsamples" << (latency ? "\tlatency\n" : "\n");
+
+  for (const auto& r : results) {
+    out << r.name << '\t' << r.iterations;
+    for (double v : {r.ns_per_op, r.p50_ns, r.p99_ns, r.bytes_per_op}) {
+      out << '\t';
+      write_number(out, v);
+    }
+    for (const auto& name : extra) {
+      out << '\t';
+      if (const double* v = r.counter(name)) {
+        write_number(out, *v);
+      } else {
+        out << '-';
+      }
+    }
+    out << '\t';
+    if (r.samples.empty()) out << '-';
+    for (std::size_t i = 0; i < r.samples.size(); ++i) {
+      if (i != 0) out << ',';
+      write_number(out, r.samples[i]);
+    }
+    if (latency) out << '\t' << (r.latency.empty() ? "-" : r.latency);
+    out << '\n';
+  }
+}
+
+namespace {
+
+std::vector<std::string> split(const std::string& line, char sep) {
+  std::vector<std::string> fields;
+  std::string field;
+  std::istringstream stream(line);
+  while (std::getline(stream, field, sep)) fields.push_back(field);
+  return fields;
+}
+
+bool fail(std::string* error, std::string message) {
+  if (error != nullptr) *error = std::move(message);
+  return false;
+}
+
+}  // namespace
+
+bool read_results(std::istream& in, std::vector<Result>& results,
+                  std::string* error) {
+  std::string line;
+  if (!std::getline(in, line)) return fail(error, "missing header");
+  std::vector<std::string> header = split(line, '\t');
+  if (header.empty() || header[0] != "name") {
+    return fail(error, "header does not start with 'name'");
+  }
+
+  int lineno = 1;
+  while (std::getline(in, line)) {
+    ++lineno;
+    if (line.empty()) continue;
+    std::vector<std::string> fields = split(line, '\t');
+    if (fields.size() != header.size()) {
+      return fail(error, "line " + std::to_string(lineno) + ": expected " +
+                             std::to_string(header.size()) + " fields");
+    }
+    Result r;
+    r.name = fields[0];
+    for (std::size_t i = 1; i < fields.size(); ++i) {
+      const std::string& col = header[i];
+      const std::string& cell = fields[i];
+      if (cell == "-") continue;
+      if (col == "samples") {
+        for (const auto& s : split(cell, ',')) {
+          r.samples.push_back(std::strtod(s.c_str(), nullptr));
+        }
+        continue;
+      }
+      if (col == "latency") {
+        r.latency = cell;
+        continue;
+      }
+      double v = std::strtod(cell.c_str(), nullptr);
+      if (col == "iterations") {
+        r.iterations = std::strtoull(cell.c_str(), nullptr, 10);
+      } else if (col == "ns_per_op") {
+        r.ns_per_op = v;
+      } else if (col == "p50_ns") {
+        r.p50_ns = v;
+      } else if (col == "p99_ns") {
+        r.p99_ns = v;
+      } else if (col == "bytes_per_op") {
+        r.bytes_per_op = v;
+      } else {
+        r.counters.emplace_back(col, v);
+      }
+    }
+    results.push_back(std::move(r));
+  }
+  return true;
+}
+
+}  // namespace lab
@@ -0,0 +1,343 @@
+#include "lab/runner.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <regex>
+
+#include "lab/alloc_counter.hpp"
+#include "lab/dataset.hpp"
+#include "lab/histogram.hpp"
+#include "lab/isolation.hpp"
+#include "lab/pages.hpp"
+#include "lab/params.hpp"
+#include "lab/scheduler.hpp"
+#include "lab/stats.hpp"
+#include "lab/trace.hpp"
+
+namespace lab {
+
+Registry& Registry::global() {
+  static Registry registry;
+  return registry;
+}
+
+void Registry::add(std::string name, BenchFn fn, std::vector<Param> params) {
+  benchmarks_.push_back({std::move(name), std::move(fn), std::move(params)});
+}
+
+bool Registry::remove(std::string_view name) {
+  return std::erase_if(benchmarks_, [&](const Benchmark& b) {
+           return b.name == name;
+         }) != 0;
+}
+
+namespace {
+
+State run_once(const Benchmark& bench, const ParamValues& params,
+               std::uint64_t iterations, Probe* probe = nullptr) {
+  State state(iterations, params);
+  state.set_probe(probe);
+  bench.fn(state);
+  if (state.running()) state.pause_timing();
+  return state;
+}
+
+// Runs several probes around the same timed regions. The last probe
+// added sits closest to the timed code.
+class ProbeChain : public Probe {
+ public:
+  void add(Probe* probe) { probes_.push_back(probe); }
+  bool empty() const { return probes_.empty(); }
+
+  void start() override {
+    for (Probe* p : probes_) p->start();
+  }
+  void stop() override {
+    for (auto it = probes_.rbegin(); it != probes_.rend(); ++it) {
+      (*it)->stop();
+    }
+  }
+
+ private:
+  std::vector<Probe*> probes_;
+};
+
+// Page faults taken inside the timed regions. Concurrent jobs share the
+// process counts, so with --jobs only the benchmark's own thread counts.
+class FaultProbe : public Probe {
+ public:
+  explicit FaultProbe(bool thread) : thread_(thread) {}
+
+  void start() override { begin_ = page_faults(thread_); }
+  void stop() override {
+    PageFaults end = page_faults(thread_);
+    total_.minor += end.minor - begin_.minor;
+    total_.major += end.major - begin_.major;
+  }
+  const PageFaults& total() const { return total_; }
+
+ private:
+  bool thread_;
+  PageFaults begin_;
+  PageFaults total_;
+};
+
+double seconds(std::chrono::nanoseconds ns) {
+  return std::chrono::duration<double>(ns).count();
+}
+
+// Grows the iteration count until a single run takes at least `target`
+// seconds and returns the resulting ns/op estimate.
+double estimate_ns_per_op(const Benchmark& bench, const ParamValues& params,
+                          double target) {
+  LAB_TRACE_SCOPE("calibrate");
+  std::uint64_t n = 1;
+  for (;;) {
+    State state = run_once(bench, params, n);
+    double took = seconds(state.elapsed());
+    if (took >= target || n >= (std::uint64_t{1} << 40)) {
+      return std::max(1.0, took * 1e9 / static_cast<double>(n));
+    }
+    // Aim past the target so that fast benchmarks converge quickly.
+    double scale = took > 0 ? 1.4 * target / took : 10.0;
+    n = static_cast<std::uint64_t>(
+        std::clamp(scale, 2.0, 10.0) * static_cast<double>(n));
+  }
+}
+
+// Iterations of the latency pass: enough for a stable p99.9.
+constexpr std::uint64_t kLatencyIterations = 1 << 16;
+
+}  // namespace
+
+Result run_benchmark(const Benchmark& bench, const ParamValues& params,
+                     const RunnerOptions& opts, PerfCounters* perf) {
+  Result result;
+  result.name = point_name(bench.name, params);
+#if LAB_TRACE_ENABLED
+  trace::Scope point_scope(trace::enabled() ? trace::intern(result.name) : 0);
+#endif
+
+  // Right before each timed run, outside it: calibration warms the caches
+  // again, so dropping them once per point left no sample cold.
+  auto cold_start = [&] {
+    if (!opts.drop_caches) return;
+    std::string error;
+    static std::atomic<bool> warned{false};
+    if (!drop_caches(&error) && !warned.exchange(true)) {
+      std::fprintf(stderr, "warning: --drop-caches: %s\n", error.c_str());
+    }
+  };
+  double noise = measure_noise();
+
+  int samples = std::max(1, opts.samples);
+  double ns_per_op = estimate_ns_per_op(bench, params, opts.warmup_seconds);
+
+  double per_sample = opts.min_seconds / samples;
+  auto iterations = static_cast<std::uint64_t>(
+      std::max(1.0, per_sample * 1e9 / ns_per_op));
+
+  result.samples.reserve(samples);
+  AllocProbe allocs;
+  FaultProbe faults(opts.jobs > 1);
+  ProbeChain probes;
+  probes.add(&faults);
+  if (alloc_counting_enabled()) probes.add(&allocs);
+  if (perf != nullptr) {
+    perf->reset();
+    probes.add(perf);
+  }
+  Probe* probe = probes.empty() ? nullptr : &probes;
+
+  std::chrono::nanoseconds total{0};
+  Histogram latency;
+  for (int i = 0; i < samples; ++i) {
+    LAB_TRACE_SCOPE("sample");
+    cold_start();
+    State state = run_once(bench, params, iterations, probe);
+    total += state.elapsed();
+    latency.merge(state.latency());
+    result.iterations += iterations;
+    result.samples.push_back(static_cast<double>(state.elapsed().count()) /
+                             static_cast<double>(iterations));
+    if (i + 1 == samples) {
+      result.bytes_per_op = state.bytes_per_op();
+      for (const auto& [name, value] : params) {
+        result.counters.emplace_back(name, static_cast<double>(value));
+      }
+      for (const auto& c : state.counters()) result.counters.push_back(c);
+    }
+  }
+  result.ns_per_op = static_cast<double>(total.count()) /
+                     static_cast<double>(result.iterations);
+  if (alloc_counting_enabled()) {
+    auto n = static_cast<double>(result.iterations);
+    result.counters.emplace_back(
+        "allocs_per_op", static_cast<double>(allocs.total().allocs) / n);
+    result.counters.emplace_back(
+        "alloc_bytes_per_op", static_cast<double>(allocs.total().bytes) / n);
+  }
+  if (perf != nullptr) {
+    append_perf_columns(perf->read(), result.iterations, result.counters);
+  }
+  {
+    auto n = static_cast<double>(result.iterations);
+    result.counters.emplace_back(
+        "minor_faults_per_op", static_cast<double>(faults.total().minor) / n);
+    result.counters.emplace_back(
+        "major_faults_per_op", static_cast<double>(faults.total().major) / n);
+  }
+  if (latency.empty() && opts.latency) {
+    LAB_TRACE_SCOPE("latency");
+    State state(std::min(iterations, kLatencyIterations), params);
+    state.time_each_iteration();
+    cold_start();
+    bench.fn(state);
+    if (state.running()) state.pause_timing();
+    latency.merge(state.latency());
+  }
+  if (!latency.empty()) set_latency(result, latency);
+  result.counters.emplace_back("noise", noise);
+  std::vector<double> sorted = result.samples;
+  result.p50_ns = percentile(sorted, 0.50);
+  result.p99_ns = percentile(sorted, 0.99);
+  return result;
+}
+
+namespace {
+
+struct Point {
+  const Benchmark* bench;
+  ParamValues params;
+};
+
+// Grid points of every benchmark whose point name matches the filter,
+// restricted to opts.shard.
+std::vector<Point> select_points(const Registry& registry,
+                                 const RunnerOptions& opts) {
+  std::regex filter(opts.filter.empty() ? ".*" : opts.filter);
+  std::vector<Point> points;
+  for (const auto& bench : registry.benchmarks()) {
+    std::vector<Param> params = bench.params;
+    for (auto& param : params) {
+      for (const auto& grid : opts.grids) {
+        if (grid.name == param.name) param.values = grid.values;
+      }
+    }
+    for (auto& point : expand_grid(params)) {
+      if (std::regex_search(point_name(bench.name, point), filter)) {
+        points.push_back({&bench, std::move(point)});
+      }
+    }
+  }
+  // Hosts of a farm may register different points from the same build
+  // (thread grids follow the CPU count, unsupported backends are left
+  // out), so a point's shard follows from its name, not its position.
+  // The name leaves out "threads", which keeps a scaling curve and the
+  // base of its speedup column on one host.
+  if (opts.shards > 1) {
+    std::erase_if(points, [&](const Point& p) {
+      ParamValues key;
+      for (const auto& param : p.params) {
+        if (param.first != "threads") key.push_back(param);
+      }
+      std::string name = point_name(p.bench->name, key);
+      std::uint64_t h = dataset::xxh64(name.data(), name.size());
+      return h % static_cast<std::uint64_t>(opts.shards) !=
+             static_cast<std::uint64_t>(opts.shard);
+    });
+  }
+  return points;
+}
+
+// For points with a "threads" parameter, adds speedup over the smallest
+// thread count with otherwise equal parameters, and parallel efficiency
+// (speedup divided by the thread ratio).
+void add_scaling_columns(const std::vector<Point>& points,
+                         std::vector<Result>& results) {
+  auto threads_of = [](const ParamValues& params) -> std::int64_t {
+    for (const auto& [name, value] : params) {
+      if (name == "threads") return value;
+    }
+    return 0;
+  };
+  auto same_except_threads = [](const Point& a, const Point& b) {
+    if (a.bench != b.bench || a.params.size() != b.params.size()) {
+      return false;
+    }
+    for (std::size_t i = 0; i < a.params.size(); ++i) {
+      if (a.params[i].first != "threads" && a.params[i] != b.params[i]) {
+        return false;
+      }
+    }
+    return true;
+  };
+
+  for (std::size_t i = 0; i < points.size(); ++i) {
+    std::int64_t threads = threads_of(points[i].params);
+    if (threads <= 0) continue;
+    std::size_t base = i;
+    for (std::size_t j = 0; j < points.size(); ++j) {
+      if (same_except_threads(points[i], points[j]) &&
+          threads_of(points[j].params) < threads_of(points[base].params)) {
+        base = j;
+      }
+    }
+    double speedup = results[base].ns_per_op / results[i].ns_per_op;
+    double ratio = static_cast<double>(threads) /
+                   static_cast<double>(threads_of(points[base].params));
+    results[i].counters.emplace_back("speedup", speedup);
+    results[i].counters.emplace_back("efficiency", speedup / ratio);
+  }
+}
+
+}  // namespace
+
+std::vector<Result> run_all(const Registry& registry,
+                            const RunnerOptions& opts) {
+  std::vector<Point> selected = select_points(registry, opts);
+
+  if (opts.perf_counters) {
+    PerfCounters probe;
+    for (const auto& name : probe.missing()) {
+      std::fprintf(stderr, "warning: perf event %s unavailable\n",
+                   name.c_str());
+    }
+  }
+  // Counters belong to the thread that opened them, so each worker
+  // opens its own on first use.
+  auto thread_perf = [&]() -> PerfCounters* {
+    if (!opts.perf_counters) return nullptr;
+    thread_local std::unique_ptr<PerfCounters> perf = [] {
+      auto p = std::make_unique<PerfCounters>();
+      return p->available() ? std::move(p) : nullptr;
+    }();
+    return perf.get();
+  };
+
+  std::vector<Result> results(selected.size());
+  auto run_range = [&](std::size_t lo, std::size_t hi) {
+    for (std::size_t i = lo; i < hi; ++i) {
+      results[i] = run_benchmark(*selected[i].bench, selected[i].params, opts,
+                                 thread_perf());
+    }
+  };
+  if (opts.jobs > 1 && selected.size() > 1) {
+    if (opts.jobs > Topology::detect().cpu_count()) {
+      std::fprintf(stderr, "warning: --jobs=%d exceeds usable CPUs; "
+                   "concurrent benchmarks will share cores\n", opts.jobs);
+    }
+    Scheduler pool({.threads = opts.jobs, .pin = opts.pin});
+    pool.parallel_for(0, selected.size(), run_range, 1);
+  } else {
+    run_range(0, selected.size());
+  }
+  add_scaling_columns(selected, results);
+  return results;
+}
+
+}  // namespace lab
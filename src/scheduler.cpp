@@ -0,0 +1,259 @@
+#include "lab/scheduler.hpp"
+
+#include <sched.h>
+
+#include <algorithm>
+
+#include "lab/cpu.hpp"
+#include "lab/topology.hpp"
+
+namespace lab {
+
+// A contiguous run of chunks [lo, hi) of one job. Executing a task splits
+// off its upper half onto the local deque until a single chunk is left.
+struct Scheduler::Task {
+  Job* job;
+  std::size_t lo;
+  std::size_t hi;
+};
+
+struct Scheduler::Job {
+  void (*fn)(void*, std::size_t);
+  void* ctx;
+  std::atomic<std::size_t> remaining;
+  // Splitting n chunks creates at most n tasks, so they are preallocated.
+  std::unique_ptr<Task[]> tasks;
+  std::atomic<std::size_t> next_task{0};
+  bool detached = false;  // spawned: nobody waits, fn frees the job
+};
+
+struct Scheduler::Spawned {
+  Job job;
+  Task task;
+  std::function<void()> fn;
+
+  static void call(void* p, std::size_t) {
+    auto* self = static_cast<Spawned*>(p);
+    self->fn();
+    delete self;
+  }
+};
+
+struct Scheduler::Worker {
+  ChaseLevDeque<Task*> deque;
+  std::uint64_t rng;
+  std::atomic<Task*> mailbox{nullptr};  // run_pinned's task for this worker
+};
+
+namespace {
+
+thread_local const Scheduler* tls_scheduler = nullptr;
+thread_local int tls_index = -1;
+
+std::uint64_t xorshift(std::uint64_t& s) {
+  s ^= s << 13;
+  s ^= s >> 7;
+  s ^= s << 17;
+  return s;
+}
+
+}  // namespace
+
+Scheduler::Scheduler(Options opts) {
+  Topology topo = Topology::detect();
+  int n = opts.threads > 0 ? opts.threads : std::max(1, topo.cpu_count());
+
+  // Place worker 0 (the caller) on the CPU it is already running on.
+  std::vector<int> order = topo.pick(topo.cpu_count(), opts.spread);
+  auto here = std::find(order.begin(), order.end(), sched_getcpu());
+  if (here != order.end()) std::rotate(order.begin(), here, order.end());
+  for (int i = 0; i < n; ++i) {
+    cpus_.push_back(opts.pin && !order.empty()
+                        ? order[static_cast<std::size_t>(i) % order.size()]
+                        : -1);
+  }
+
+  for (int i = 0; i < n; ++i) {
+    auto w = std::make_unique<Worker>();
+    w->rng = 0x9e3779b97f4a7c15ull * static_cast<std::uint64_t>(i + 1);
+    workers_.push_back(std::move(w));
+  }
+  for (int i = 1; i < n; ++i) {
+    threads_.emplace_back([this, i] {
+      if (cpus_[i] >= 0) pin_thread(cpus_[i]);
+      worker_main(i);
+    });
+  }
+}
+
+Scheduler::~Scheduler() {
+  stop_.store(true);
+  epoch_.fetch_add(1);
+  epoch_.notify_all();
+  for (auto& t : threads_) t.join();
+  Task* task;
+  while (inject_.try_pop(task)) task->job->fn(task->job->ctx, task->lo);
+}
+
+int Scheduler::current_worker() const {
+  return tls_scheduler == this ? tls_index : -1;
+}
+
+void Scheduler::push(Worker& self, Task* task) {
+  self.deque.push(task);
+  wake();
+}
+
+void Scheduler::wake() {
+  // Pairs with the seq_cst increment in worker_main: either a sleeper is
+  // counted here and woken, or it rechecks the deques and sees the task.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (sleepers_.load(std::memory_order_relaxed) > 0) {
+    epoch_.fetch_add(1, std::memory_order_release);
+    epoch_.notify_all();
+  }
+}
+
+void Scheduler::spawn(std::function<void()> f) {
+  if (threads_.empty()) {
+    f();
+    return;
+  }
+  auto* s = new Spawned{{}, {}, std::move(f)};
+  s->job.fn = &Spawned::call;
+  s->job.ctx = s;
+  s->job.detached = true;
+  s->task = {&s->job, 0, 1};
+  if (!inject_.try_push(&s->task)) {
+    Spawned::call(s, 0);
+    return;
+  }
+  wake();
+}
+
+bool Scheduler::find_task(Worker& self, Task*& task) {
+  if (self.mailbox.load(std::memory_order_relaxed) != nullptr) {
+    task = self.mailbox.exchange(nullptr, std::memory_order_acquire);
+    if (task != nullptr) return true;
+  }
+  if (self.deque.pop(task)) return true;
+  if (inject_.try_pop(task)) return true;
+  std::size_t n = workers_.size();
+  if (n == 1) return false;
+  std::size_t start = xorshift(self.rng) % n;
+  for (std::size_t k = 0; k < n; ++k) {
+    Worker& victim = *workers_[(start + k) % n];
+    if (&victim != &self && victim.deque.steal(task)) return true;
+  }
+  return false;
+}
+
+void Scheduler::execute(Worker& self, Task* task) {
+  Job* job = task->job;
+  std::size_t lo = task->lo;
+  std::size_t hi = task->hi;
+  while (hi - lo > 1) {
+    std::size_t mid = lo + (hi - lo) / 2;
+    Task* right = &job->tasks[job->next_task.fetch_add(1)];
+    *right = {job, mid, hi};
+    push(self, right);
+    hi = mid;
+  }
+  bool detached = job->detached;
+  job->fn(job->ctx, lo);
+  if (!detached) job->remaining.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+void Scheduler::worker_main(int index) {
+  tls_scheduler = this;
+  tls_index = index;
+  Worker& self = *workers_[index];
+  while (!stop_.load(std::memory_order_relaxed)) {
+    Task* task;
+    bool found = find_task(self, task);
+    for (int spin = 0; !found && spin < 256; ++spin) {
+      cpu_relax();
+      found = find_task(self, task);
+    }
+    if (found) {
+      execute(self, task);
+      continue;
+    }
+    std::uint64_t seen = epoch_.load(std::memory_order_acquire);
+    sleepers_.fetch_add(1, std::memory_order_seq_cst);
+    if (find_task(self, task)) {
+      sleepers_.fetch_sub(1);
+      execute(self, task);
+      continue;
+    }
+    if (!stop_.load()) epoch_.wait(seen, std::memory_order_acquire);
+    sleepers_.fetch_sub(1);
+  }
+}
+
+void Scheduler::run_chunks(std::size_t chunks, void (*fn)(void*, std::size_t),
+                           void* ctx) {
+  if (chunks == 0) return;
+  if (workers_.size() == 1 || chunks == 1) {
+    for (std::size_t i = 0; i < chunks; ++i) fn(ctx, i);
+    return;
+  }
+
+  // Outside callers borrow worker 0 for the duration of the call.
+  std::unique_lock<std::mutex> lock;
+  const Scheduler* saved_scheduler = tls_scheduler;
+  int saved_index = tls_index;
+  int index = current_worker();
+  if (index < 0) {
+    lock = std::unique_lock<std::mutex>(external_);
+    tls_scheduler = this;
+    tls_index = index = 0;
+  }
+  Worker& self = *workers_[index];
+
+  Job job{fn, ctx, {chunks}, std::make_unique<Task[]>(chunks)};
+  job.next_task.store(1, std::memory_order_relaxed);
+  job.tasks[0] = {&job, 0, chunks};
+  execute(self, &job.tasks[0]);
+  while (job.remaining.load(std::memory_order_acquire) != 0) {
+    Task* task;
+    if (find_task(self, task)) {
+      execute(self, task);
+    } else {
+      cpu_relax();
+    }
+  }
+
+  tls_scheduler = saved_scheduler;
+  tls_index = saved_index;
+}
+
+void Scheduler::run_pinned(void (*fn)(void*, std::size_t), void* ctx) {
+  std::size_t n = workers_.size();
+  if (n == 1) {
+    fn(ctx, 0);
+    return;
+  }
+  std::lock_guard lock(external_);
+  const Scheduler* saved_scheduler = tls_scheduler;
+  int saved_index = tls_index;
+  tls_scheduler = this;
+  tls_index = 0;
+
+  // One single-chunk task per worker, posted where only it will look.
+  Job job{fn, ctx, {n}, std::make_unique<Task[]>(n)};
+  for (std::size_t i = 0; i < n; ++i) job.tasks[i] = {&job, i, i + 1};
+  for (std::size_t i = 1; i < n; ++i) {
+    workers_[i]->mailbox.store(&job.tasks[i], std::memory_order_release);
+  }
+  epoch_.fetch_add(1, std::memory_order_release);
+  epoch_.notify_all();
+  Worker& self = *workers_[0];
+  execute(self, &job.tasks[0]);
+  while (job.remaining.load(std::memory_order_acquire) != 0) cpu_relax();
+
+  tls_scheduler = saved_scheduler;
+  tls_index = saved_index;
+}
+
+}  // namespace lab
@@ -0,0 +1,188 @@
+// AVX2 + FMA variants (x86-64-v3). Compiled with -mavx2 -mfma.
+#include <immintrin.h>
+
+#include "variants.hpp"
+
+namespace lab::simd::detail {
+namespace {
+
+std::uint64_t sum_u32(const std::uint32_t* data, std::size_t n) {
+  const __m256i zero = _mm256_setzero_si256();
+  __m256i acc0 = zero, acc1 = zero;
+  std::size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+    acc0 = _mm256_add_epi64(acc0, _mm256_unpacklo_epi32(v, zero));
+    acc1 = _mm256_add_epi64(acc1, _mm256_unpackhi_epi32(v, zero));
+  }
+  __m256i acc = _mm256_add_epi64(acc0, acc1);
+  __m128i half = _mm_add_epi64(_mm256_castsi256_si128(acc),
+                               _mm256_extracti128_si256(acc, 1));
+  std::uint64_t sum = static_cast<std::uint64_t>(_mm_cvtsi128_si64(half)) +
+                      static_cast<std::uint64_t>(_mm_extract_epi64(half, 1));
+  return sum + scalar_sum_u32(data + i, n - i);
+}
+
+// Four accumulators cover the FMA latency on current cores.
+float dot_f32(const float* a, const float* b, std::size_t n) {
+  __m256 acc[4] = {_mm256_setzero_ps(), _mm256_setzero_ps(),
+                   _mm256_setzero_ps(), _mm256_setzero_ps()};
+  std::size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    for (int k = 0; k < 4; ++k) {
+      acc[k] = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8 * k),
+                               _mm256_loadu_ps(b + i + 8 * k), acc[k]);
+    }
+  }
+  for (; i + 8 <= n; i += 8) {
+    acc[0] = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i),
+                             acc[0]);
+  }
+  __m256 sum8 = _mm256_add_ps(_mm256_add_ps(acc[0], acc[1]),
+                              _mm256_add_ps(acc[2], acc[3]));
+  __m128 sum4 = _mm_add_ps(_mm256_castps256_ps128(sum8),
+                           _mm256_extractf128_ps(sum8, 1));
+  sum4 = _mm_add_ps(sum4, _mm_movehl_ps(sum4, sum4));
+  sum4 = _mm_add_ss(sum4, _mm_shuffle_ps(sum4, sum4, 1));
+  return _mm_cvtss_f32(sum4) + scalar_dot_f32(a + i, b + i, n - i);
+}
+
+std::size_t find_byte(const std::uint8_t* data, std::size_t n,
+                      std::uint8_t byte) {
+  const __m256i needle = _mm256_set1_epi8(static_cast<char>(byte));
+  std::size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+    auto mask = static_cast<unsigned>(
+        _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, needle)));
+    if (mask != 0) return i + static_cast<std::size_t>(__builtin_ctz(mask));
+  }
+  return i + scalar_find_byte(data + i, n - i, byte);
+}
+
+// Scans each 128-bit lane, carries the low lane's total into the high
+// lane, then adds the running total.
+void prefix_sum_u32(std::uint32_t* data, std::size_t n) {
+  const __m256i last = _mm256_set1_epi32(7);
+  __m256i carry = _mm256_setzero_si256();
+  std::size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    auto* p = reinterpret_cast<__m256i*>(data + i);
+    __m256i v = _mm256_loadu_si256(p);
+    v = _mm256_add_epi32(v, _mm256_slli_si256(v, 4));
+    v = _mm256_add_epi32(v, _mm256_slli_si256(v, 8));
+    __m256i lane_totals = _mm256_shuffle_epi32(v, 0xff);
+    v = _mm256_add_epi32(v, _mm256_permute2x128_si256(lane_totals,
+                                                      lane_totals, 0x08));
+    v = _mm256_add_epi32(v, carry);
+    _mm256_storeu_si256(p, v);
+    carry = _mm256_permutevar8x32_epi32(v, last);
+  }
+  if (i < n) {
+    data[i] += static_cast<std::uint32_t>(
+        _mm_cvtsi128_si32(_mm256_castsi256_si128(carry)));
+    scalar_prefix_sum_u32(data + i, n - i);
+  }
+}
+
+std::size_t hex_encode(const std::uint8_t* in, std::size_t n, char* out) {
+  const __m256i digits = _mm256_broadcastsi128_si256(
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(kHexDigits)));
+  const __m256i low_nibble = _mm256_set1_epi8(0x0f);
+  std::size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+    __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), low_nibble);
+    __m256i lo = _mm256_and_si256(v, low_nibble);
+    hi = _mm256_shuffle_epi8(digits, hi);
+    lo = _mm256_shuffle_epi8(digits, lo);
+    // Unpacks work per lane; reorder the lanes back to input order.
+    __m256i a = _mm256_unpacklo_epi8(hi, lo);
+    __m256i b = _mm256_unpackhi_epi8(hi, lo);
+    auto* o = reinterpret_cast<__m256i*>(out + 2 * i);
+    _mm256_storeu_si256(o, _mm256_permute2x128_si256(a, b, 0x20));
+    _mm256_storeu_si256(o + 1, _mm256_permute2x128_si256(a, b, 0x31));
+  }
+  scalar_hex_encode(in + i, n - i, out + 2 * i);
+  return 2 * n;
+}
+
+// Base64 after Muła and Lemire, "Faster Base64 Encoding and Decoding
+// using AVX2 Instructions": 24 input bytes become 32 six-bit indices via
+// one shuffle and two multiplies, which a small offset table maps to
+// ASCII.
+__m256i base64_indices(__m256i in) {
+  in = _mm256_shuffle_epi8(
+      in, _mm256_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1,
+                          14, 15, 13, 14, 11, 12, 10, 11, 8, 9, 7, 8, 5, 6, 4,
+                          5));
+  __m256i t0 = _mm256_and_si256(in, _mm256_set1_epi32(0x0fc0fc00));
+  __m256i t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+  __m256i t2 = _mm256_and_si256(in, _mm256_set1_epi32(0x003f03f0));
+  __m256i t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+  return _mm256_or_si256(t1, t3);
+}
+
+__m256i base64_ascii(__m256i indices) {
+  const __m256i offsets = _mm256_setr_epi8(
+      65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -19, -16, 0, 0,
+      65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -19, -16, 0, 0);
+  __m256i slot = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+  __m256i lower = _mm256_cmpgt_epi8(indices, _mm256_set1_epi8(25));
+  slot = _mm256_sub_epi8(slot, lower);
+  return _mm256_add_epi8(indices, _mm256_shuffle_epi8(offsets, slot));
+}
+
+std::size_t base64_encode(const std::uint8_t* in, std::size_t n, char* out) {
+  // Each load starts 4 bytes before the group so that both lanes can
+  // pick their 12 bytes; encode the first two groups in scalar to make
+  // that read stay inside the input.
+  if (n < 6 + 28) return scalar_base64_encode(in, n, out);
+  scalar_base64_encode(in, 6, out);
+  std::size_t i = 6;
+  char* o = out + 8;
+  for (; i + 28 <= n; i += 24, o += 32) {
+    __m256i v = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(in + i - 4));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(o),
+                        base64_ascii(base64_indices(v)));
+  }
+  o += scalar_base64_encode(in + i, n - i, o);
+  return static_cast<std::size_t>(o - out);
+}
+
+// As in SSE4.2: element 0 in scalar, then predecessors one element back.
+std::uint32_t delta_encode_u32(const std::uint32_t* in, std::size_t n,
+                               std::uint32_t prev, std::uint32_t* out) {
+  if (n == 0) return 0;
+  std::uint32_t bits = scalar_delta_encode_u32(in, 1, prev, out);
+  __m256i acc = _mm256_setzero_si256();
+  std::size_t i = 1;
+  for (; i + 8 <= n; i += 8) {
+    __m256i d = _mm256_sub_epi32(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i)),
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i - 1)));
+    __m256i z =
+        _mm256_xor_si256(_mm256_slli_epi32(d, 1), _mm256_srai_epi32(d, 31));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), z);
+    acc = _mm256_or_si256(acc, z);
+  }
+  __m128i half = _mm_or_si128(_mm256_castsi256_si128(acc),
+                              _mm256_extracti128_si256(acc, 1));
+  half = _mm_or_si128(half, _mm_shuffle_epi32(half, 0x4e));
+  half = _mm_or_si128(half, _mm_shuffle_epi32(half, 0xb1));
+  bits |= static_cast<std::uint32_t>(_mm_cvtsi128_si32(half));
+  return bits | scalar_delta_encode_u32(in + i, n - i, in[i - 1], out + i);
+}
+
+}  // namespace
+
+const Kernels& avx2_kernels() {
+  static const Kernels k{Isa::avx2,  sum_u32,        dot_f32,
+                         find_byte,  prefix_sum_u32, scalar_histogram_u8,
+                         hex_encode, base64_encode,  delta_encode_u32,
+                         scalar_sort_block_u64};
+  return k;
+}
+
+}  // namespace lab::simd::detail
@@ -0,0 +1,206 @@
+// AVX-512 F/BW variants (x86-64-v4). Compiled with -mavx512f -mavx512bw.
+// Kernels that gain nothing over AVX2 at this width reuse the AVX2 table.
+#include <immintrin.h>
+
+#include <algorithm>
+#include <utility>
+
+// GCC 12's reduce intrinsics read _mm512_undefined_* values and trip its
+// own uninitialized-use warnings when inlined.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+#include "variants.hpp"
+
+namespace lab::simd::detail {
+namespace {
+
+std::uint64_t sum_u32(const std::uint32_t* data, std::size_t n) {
+  __m512i acc0 = _mm512_setzero_si512(), acc1 = _mm512_setzero_si512();
+  std::size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m512i v = _mm512_loadu_si512(data + i);
+    acc0 = _mm512_add_epi64(acc0,
+                            _mm512_cvtepu32_epi64(_mm512_castsi512_si256(v)));
+    acc1 = _mm512_add_epi64(
+        acc1, _mm512_cvtepu32_epi64(_mm512_extracti64x4_epi64(v, 1)));
+  }
+  auto sum = static_cast<std::uint64_t>(
+      _mm512_reduce_add_epi64(_mm512_add_epi64(acc0, acc1)));
+  return sum + scalar_sum_u32(data + i, n - i);
+}
+
+float dot_f32(const float* a, const float* b, std::size_t n) {
+  __m512 acc[4] = {_mm512_setzero_ps(), _mm512_setzero_ps(),
+                   _mm512_setzero_ps(), _mm512_setzero_ps()};
+  std::size_t i = 0;
+  for (; i + 64 <= n; i += 64) {
+    for (int k = 0; k < 4; ++k) {
+      acc[k] = _mm512_fmadd_ps(_mm512_loadu_ps(a + i + 16 * k),
+                               _mm512_loadu_ps(b + i + 16 * k), acc[k]);
+    }
+  }
+  // The tail is one masked pass instead of a scalar loop.
+  for (; i < n; i += 16) {
+    auto mask = static_cast<__mmask16>(
+        n - i >= 16 ? 0xffff : (1u << (n - i)) - 1);
+    acc[0] = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, a + i),
+                             _mm512_maskz_loadu_ps(mask, b + i), acc[0]);
+  }
+  return _mm512_reduce_add_ps(
+      _mm512_add_ps(_mm512_add_ps(acc[0], acc[1]),
+                    _mm512_add_ps(acc[2], acc[3])));
+}
+
+std::size_t find_byte(const std::uint8_t* data, std::size_t n,
+                      std::uint8_t byte) {
+  const __m512i needle = _mm512_set1_epi8(static_cast<char>(byte));
+  std::size_t i = 0;
+  for (; i + 64 <= n; i += 64) {
+    __mmask64 mask = _mm512_cmpeq_epi8_mask(_mm512_loadu_si512(data + i),
+                                            needle);
+    if (mask != 0) return i + static_cast<std::size_t>(__builtin_ctzll(mask));
+  }
+  if (i < n) {
+    __mmask64 valid = (1ull << (n - i)) - 1;
+    __mmask64 mask = _mm512_mask_cmpeq_epi8_mask(
+        valid, _mm512_maskz_loadu_epi8(valid, data + i), needle);
+    if (mask != 0) return i + static_cast<std::size_t>(__builtin_ctzll(mask));
+  }
+  return n;
+}
+
+// Element 0 in scalar, then predecessors one element back; the tail is
+// one masked pass.
+std::uint32_t delta_encode_u32(const std::uint32_t* in, std::size_t n,
+                               std::uint32_t prev, std::uint32_t* out) {
+  if (n == 0) return 0;
+  std::uint32_t bits = scalar_delta_encode_u32(in, 1, prev, out);
+  __m512i acc = _mm512_setzero_si512();
+  for (std::size_t i = 1; i < n; i += 16) {
+    auto mask = static_cast<__mmask16>(
+        n - i >= 16 ? 0xffff : (1u << (n - i)) - 1);
+    __m512i d = _mm512_sub_epi32(_mm512_maskz_loadu_epi32(mask, in + i),
+                                 _mm512_maskz_loadu_epi32(mask, in + i - 1));
+    __m512i z =
+        _mm512_xor_si512(_mm512_slli_epi32(d, 1), _mm512_srai_epi32(d, 31));
+    _mm512_mask_storeu_epi32(out + i, mask, z);
+    acc = _mm512_or_si512(acc, z);
+  }
+  return bits | static_cast<std::uint32_t>(_mm512_reduce_or_epi32(acc));
+}
+
+// ---- sort_block_u64: a bitonic network over eight registers ----------
+
+void compare_swap(__m512i& a, __m512i& b) {
+  __m512i lo = _mm512_min_epu64(a, b);
+  b = _mm512_max_epu64(a, b);
+  a = lo;
+}
+
+// One compare-exchange between the lanes `lanes` apart, from
+// `partners`, keeping the larger value in the lanes of `upper`.
+__m512i exchange_lanes(__m512i v, __m512i partners, __mmask8 upper) {
+  __m512i p = _mm512_permutexvar_epi64(partners, v);
+  return _mm512_mask_blend_epi64(upper, _mm512_min_epu64(v, p),
+                                 _mm512_max_epu64(v, p));
+}
+
+// Sorts a register that holds a bitonic sequence.
+__m512i merge_lanes(__m512i v) {
+  v = exchange_lanes(v, _mm512_set_epi64(3, 2, 1, 0, 7, 6, 5, 4), 0xf0);
+  v = exchange_lanes(v, _mm512_set_epi64(5, 4, 7, 6, 1, 0, 3, 2), 0xcc);
+  return exchange_lanes(v, _mm512_set_epi64(6, 7, 4, 5, 2, 3, 0, 1), 0xaa);
+}
+
+// Sorts k registers that together hold a bitonic sequence: half-cleaners
+// across registers, then within each.
+void merge_bitonic(__m512i* v, int k) {
+  for (int d = k / 2; d > 0; d /= 2) {
+    for (int i = 0; i < k; ++i) {
+      if ((i & d) == 0) compare_swap(v[i], v[i + d]);
+    }
+  }
+  for (int i = 0; i < k; ++i) v[i] = merge_lanes(v[i]);
+}
+
+// Merges the sorted runs a and b of k registers each: reversing b makes
+// a + b bitonic, and one compare-exchange splits it into two bitonic
+// halves, every value of a below every value of b.
+void merge_runs(__m512i* a, __m512i* b, int k) {
+  const __m512i reverse = _mm512_set_epi64(0, 1, 2, 3, 4, 5, 6, 7);
+  for (int i = 0; i < k / 2; ++i) std::swap(b[i], b[k - 1 - i]);
+  for (int i = 0; i < k; ++i) b[i] = _mm512_permutexvar_epi64(reverse, b[i]);
+  for (int i = 0; i < k; ++i) compare_swap(a[i], b[i]);
+  merge_bitonic(a, k);
+  merge_bitonic(b, k);
+}
+
+// 8x8 transpose, so that the sorted columns become sorted registers.
+void transpose(__m512i* v) {
+  __m512i a[8], b[8];
+  for (int i = 0; i < 8; i += 2) {
+    a[i] = _mm512_unpacklo_epi64(v[i], v[i + 1]);
+    a[i + 1] = _mm512_unpackhi_epi64(v[i], v[i + 1]);
+  }
+  const __m512i even = _mm512_set_epi64(13, 12, 5, 4, 9, 8, 1, 0);
+  const __m512i odd = _mm512_set_epi64(15, 14, 7, 6, 11, 10, 3, 2);
+  for (int i : {0, 1, 4, 5}) {
+    b[i] = _mm512_permutex2var_epi64(a[i], even, a[i + 2]);
+    b[i + 2] = _mm512_permutex2var_epi64(a[i], odd, a[i + 2]);
+  }
+  const __m512i low = _mm512_set_epi64(11, 10, 9, 8, 3, 2, 1, 0);
+  const __m512i high = _mm512_set_epi64(15, 14, 13, 12, 7, 6, 5, 4);
+  for (int i = 0; i < 4; ++i) {
+    v[i] = _mm512_permutex2var_epi64(b[i], low, b[i + 4]);
+    v[i + 4] = _mm512_permutex2var_epi64(b[i], high, b[i + 4]);
+  }
+}
+
+// Pads to 64 values with the maximum, sorts each lane across the eight
+// registers (Batcher's 19-comparator network), transposes, and merges
+// the eight sorted registers pairwise into one run.
+void sort_block_u64(std::uint64_t* data, std::size_t n) {
+  constexpr int kPairs[19][2] = {{0, 1}, {2, 3}, {4, 5}, {6, 7}, {0, 2},
+                                 {1, 3}, {4, 6}, {5, 7}, {1, 2}, {5, 6},
+                                 {0, 4}, {1, 5}, {2, 6}, {3, 7}, {2, 4},
+                                 {3, 5}, {1, 2}, {3, 4}, {5, 6}};
+  const __m512i pad = _mm512_set1_epi64(-1);
+  __mmask8 masks[8];
+  __m512i v[8];
+  for (std::size_t r = 0; r < 8; ++r) {
+    std::size_t lo = r * 8;
+    std::size_t count = n > lo ? std::min<std::size_t>(n - lo, 8) : 0;
+    masks[r] = static_cast<__mmask8>((1u << count) - 1);
+    v[r] = _mm512_mask_loadu_epi64(pad, masks[r], data + lo);
+  }
+  for (const auto& p : kPairs) compare_swap(v[p[0]], v[p[1]]);
+  transpose(v);
+  for (int k = 1; k < 8; k *= 2) {
+    for (int i = 0; i < 8; i += 2 * k) merge_runs(v + i, v + i + k, k);
+  }
+  for (std::size_t r = 0; r < 8; ++r) {
+    _mm512_mask_storeu_epi64(data + r * 8, masks[r], v[r]);
+  }
+}
+
+}  // namespace
+
+const Kernels& avx512_kernels() {
+  const Kernels& avx2 = avx2_kernels();
+  static const Kernels k{Isa::avx512,
+                         sum_u32,
+                         dot_f32,
+                         find_byte,
+                         avx2.prefix_sum_u32,
+                         scalar_histogram_u8,
+                         avx2.hex_encode,
+                         avx2.base64_encode,
+                         delta_encode_u32,
+                         sort_block_u64};
+  return k;
+}
+
+}  // namespace lab::simd::detail
@@ -0,0 +1,268 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+
+#include "variants.hpp"
+
+#if defined(__aarch64__) && defined(__linux__)
+#include <asm/hwcap.h>
+#include <sys/auxv.h>
+#endif
+
+namespace lab::simd {
+
+const char* isa_name(Isa isa) {
+  switch (isa) {
+    case Isa::scalar: return "scalar";
+    case Isa::sse42: return "sse42";
+    case Isa::avx2: return "avx2";
+    case Isa::avx512: return "avx512";
+    case Isa::neon: return "neon";
+  }
+  return "?";
+}
+
+bool parse_isa(const std::string& name, Isa& out) {
+  for (Isa isa : kAllIsas) {
+    if (name == isa_name(isa)) {
+      out = isa;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool isa_supported(Isa isa) {
+  switch (isa) {
+    case Isa::scalar:
+      return true;
+#if defined(__x86_64__) || defined(__i386__)
+    // __builtin_cpu_supports also checks that the OS saves the wider
+    // register state (XCR0), not just the cpuid bits.
+    case Isa::sse42:
+      __builtin_cpu_init();
+      return __builtin_cpu_supports("sse4.2");
+    case Isa::avx2:
+      __builtin_cpu_init();
+      return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    case Isa::avx512:
+      __builtin_cpu_init();
+      return __builtin_cpu_supports("avx512f") &&
+             __builtin_cpu_supports("avx512bw");
+#endif
+#if defined(__aarch64__)
+    case Isa::neon:
+#if defined(__linux__)
+      return (getauxval(AT_HWCAP) & HWCAP_ASIMD) != 0;
+#else
+      return true;
+#endif
+#endif
+    default:
+      return false;
+  }
+}
+
+const Kernels* kernels(Isa isa) {
+  if (!isa_supported(isa)) return nullptr;
+  switch (isa) {
+    case Isa::scalar: return &detail::scalar_kernels();
+#if defined(__x86_64__) || defined(__i386__)
+    case Isa::sse42: return &detail::sse42_kernels();
+    case Isa::avx2: return &detail::avx2_kernels();
+    case Isa::avx512: return &detail::avx512_kernels();
+#endif
+#if defined(__aarch64__)
+    case Isa::neon: return &detail::neon_kernels();
+#endif
+    default: return nullptr;
+  }
+}
+
+namespace {
+
+const Kernels& pick() {
+  if (const char* env = std::getenv("LAB_SIMD"); env && *env) {
+    Isa isa;
+    if (!parse_isa(env, isa)) {
+      std::fprintf(stderr, "warning: LAB_SIMD=%s is not a known ISA\n", env);
+    } else if (const Kernels* k = kernels(isa)) {
+      return *k;
+    } else {
+      std::fprintf(stderr, "warning: LAB_SIMD=%s is not available here\n",
+                   env);
+    }
+  }
+  for (Isa isa : {Isa::avx512, Isa::avx2, Isa::sse42, Isa::neon}) {
+    if (const Kernels* k = kernels(isa)) return *k;
+  }
+  return detail::scalar_kernels();
+}
+
+// splitmix64, so that failures reproduce.
+struct Rng {
+  std::uint64_t state;
+  std::uint64_t next() {
+    std::uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+  }
+};
+
+bool fail(std::string* error, Isa isa, const char* kernel, std::size_t n,
+          std::size_t offset) {
+  if (error != nullptr) {
+    char buf[128];
+    std::snprintf(buf, sizeof buf, "%s %s differs from scalar at n=%zu "
+                  "offset=%zu", isa_name(isa), kernel, n, offset);
+    *error = buf;
+  }
+  return false;
+}
+
+}  // namespace
+
+const Kernels& active() {
+  static const Kernels& chosen = pick();
+  return chosen;
+}
+
+bool cross_check(Isa isa, std::string* error) {
+  const Kernels* k = kernels(isa);
+  if (k == nullptr) {
+    if (error != nullptr) {
+      *error = std::string(isa_name(isa)) + " is not available";
+    }
+    return false;
+  }
+  const Kernels& ref = detail::scalar_kernels();
+
+  // Every length up to a few vector widths, then some larger odd ones.
+  std::vector<std::size_t> lengths;
+  for (std::size_t n = 0; n <= 200; ++n) lengths.push_back(n);
+  for (std::size_t n : {255, 256, 257, 1000, 4099, 65537}) {
+    lengths.push_back(n);
+  }
+
+  Rng rng{42};
+  constexpr std::size_t kPad = 4;  // room to misalign the start
+  for (std::size_t n : lengths) {
+    for (std::size_t off = 0; off < kPad; ++off) {
+      std::vector<std::uint32_t> words(n + kPad);
+      for (auto& w : words) w = static_cast<std::uint32_t>(rng.next());
+      const std::uint32_t* w = words.data() + off;
+      if (k->sum_u32(w, n) != ref.sum_u32(w, n)) {
+        return fail(error, isa, "sum_u32", n, off);
+      }
+
+      std::vector<std::uint32_t> a(w, w + n), b(w, w + n);
+      k->prefix_sum_u32(a.data(), n);
+      ref.prefix_sum_u32(b.data(), n);
+      if (a != b) return fail(error, isa, "prefix_sum_u32", n, off);
+
+      // Wide deltas between the random words, narrow ones along a
+      // running sum of small steps.
+      std::vector<std::uint32_t> narrow(n);
+      for (std::size_t i = 0; i < n; ++i) {
+        narrow[i] = (i > 0 ? narrow[i - 1] : 0) + w[i] % 64;
+      }
+      for (const std::uint32_t* in : {w, std::as_const(narrow).data()}) {
+        auto prev = static_cast<std::uint32_t>(rng.next());
+        std::vector<std::uint32_t> d(n), d_ref(n);
+        if (k->delta_encode_u32(in, n, prev, d.data()) !=
+                ref.delta_encode_u32(in, n, prev, d_ref.data()) ||
+            d != d_ref) {
+          return fail(error, isa, "delta_encode_u32", n, off);
+        }
+      }
+
+      // Distinct keys, then many duplicates including the all-ones key
+      // the vector network pads with.
+      if (n <= kSortBlock) {
+        for (std::uint64_t mask : {~std::uint64_t{0}, std::uint64_t{7}}) {
+          std::vector<std::uint64_t> keys(n);
+          for (auto& key : keys) {
+            key = rng.next() & mask;
+            if (key == 7) key = ~std::uint64_t{0};
+          }
+          std::vector<std::uint64_t> keys_ref = keys;
+          k->sort_block_u64(keys.data(), n);
+          ref.sort_block_u64(keys_ref.data(), n);
+          if (keys != keys_ref) {
+            return fail(error, isa, "sort_block_u64", n, off);
+          }
+        }
+      }
+
+      // Compare against a double reference with a rounding-error bound
+      // for float accumulation.
+      std::vector<float> x(n + kPad), y(n + kPad);
+      for (std::size_t i = 0; i < x.size(); ++i) {
+        x[i] = static_cast<float>(static_cast<std::int32_t>(rng.next())) *
+               0x1p-31f;
+        y[i] = static_cast<float>(static_cast<std::int32_t>(rng.next())) *
+               0x1p-31f;
+      }
+      double exact = 0, magnitude = 0;
+      for (std::size_t i = 0; i < n; ++i) {
+        exact += double{x[off + i]} * y[off + i];
+        magnitude += std::fabs(double{x[off + i]} * y[off + i]);
+      }
+      double got = k->dot_f32(x.data() + off, y.data() + off, n);
+      double tolerance = 2.0 * static_cast<double>(n + 1) * 0x1p-24 *
+                         magnitude + 1e-30;
+      if (std::fabs(got - exact) > tolerance) {
+        return fail(error, isa, "dot_f32", n, off);
+      }
+
+      std::vector<std::uint8_t> bytes(n + kPad);
+      for (auto& v : bytes) v = static_cast<std::uint8_t>(rng.next());
+      const std::uint8_t* p = bytes.data() + off;
+
+      std::string hex(2 * n, '\0'), hex_ref(2 * n, '\0');
+      if (k->hex_encode(p, n, hex.data()) != 2 * n ||
+          (ref.hex_encode(p, n, hex_ref.data()), hex != hex_ref)) {
+        return fail(error, isa, "hex_encode", n, off);
+      }
+      std::string b64(base64_size(n), '\0'), b64_ref(base64_size(n), '\0');
+      if (k->base64_encode(p, n, b64.data()) != base64_size(n) ||
+          (ref.base64_encode(p, n, b64_ref.data()), b64 != b64_ref)) {
+        return fail(error, isa, "base64_encode", n, off);
+      }
+
+      std::uint64_t counts[256], counts_ref[256];
+      for (int v = 0; v < 256; ++v) counts[v] = counts_ref[v] = v;
+      k->histogram_u8(p, n, counts);
+      ref.histogram_u8(p, n, counts_ref);
+      if (!std::equal(counts, counts + 256, counts_ref)) {
+        return fail(error, isa, "histogram_u8", n, off);
+      }
+
+      // Needle absent, then planted at the start, the end and a random
+      // position (earlier hits may come from the random bytes).
+      const std::uint8_t needle = 0x5a;
+      auto* q = bytes.data() + off;
+      for (std::size_t i = 0; i < n; ++i) {
+        if (q[i] == needle) q[i] = 0;
+      }
+      if (k->find_byte(q, n, needle) != n) {
+        return fail(error, isa, "find_byte", n, off);
+      }
+      if (n > 0) {
+        for (std::size_t pos : {n - 1, rng.next() % n, std::size_t{0}}) {
+          q[pos] = needle;
+          if (k->find_byte(q, n, needle) != ref.find_byte(q, n, needle)) {
+            return fail(error, isa, "find_byte", n, off);
+          }
+        }
+      }
+    }
+  }
+  return true;
+}
+
+}  // namespace lab::simd
@@ -0,0 +1,79 @@
+// NEON (ASIMD) variants for aarch64, where NEON is part of the baseline.
+#include <arm_neon.h>
+
+#include "variants.hpp"
+
+namespace lab::simd::detail {
+namespace {
+
+std::uint64_t sum_u32(const std::uint32_t* data, std::size_t n) {
+  uint64x2_t acc0 = vdupq_n_u64(0), acc1 = vdupq_n_u64(0);
+  std::size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    acc0 = vpadalq_u32(acc0, vld1q_u32(data + i));
+    acc1 = vpadalq_u32(acc1, vld1q_u32(data + i + 4));
+  }
+  return vaddvq_u64(vaddq_u64(acc0, acc1)) +
+         scalar_sum_u32(data + i, n - i);
+}
+
+float dot_f32(const float* a, const float* b, std::size_t n) {
+  float32x4_t acc[4] = {vdupq_n_f32(0), vdupq_n_f32(0), vdupq_n_f32(0),
+                        vdupq_n_f32(0)};
+  std::size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    for (int k = 0; k < 4; ++k) {
+      acc[k] = vfmaq_f32(acc[k], vld1q_f32(a + i + 4 * k),
+                         vld1q_f32(b + i + 4 * k));
+    }
+  }
+  float32x4_t sum = vaddq_f32(vaddq_f32(acc[0], acc[1]),
+                              vaddq_f32(acc[2], acc[3]));
+  return vaddvq_f32(sum) + scalar_dot_f32(a + i, b + i, n - i);
+}
+
+// NEON has no movemask; narrowing the compare result by 4 bits per byte
+// gives a 64-bit mask with one nibble per input byte.
+std::size_t find_byte(const std::uint8_t* data, std::size_t n,
+                      std::uint8_t byte) {
+  const uint8x16_t needle = vdupq_n_u8(byte);
+  std::size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    uint8x16_t eq = vceqq_u8(vld1q_u8(data + i), needle);
+    std::uint64_t mask = vget_lane_u64(
+        vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(eq), 4)), 0);
+    if (mask != 0) {
+      return i + static_cast<std::size_t>(__builtin_ctzll(mask)) / 4;
+    }
+  }
+  return i + scalar_find_byte(data + i, n - i, byte);
+}
+
+std::size_t hex_encode(const std::uint8_t* in, std::size_t n, char* out) {
+  const uint8x16_t digits =
+      vld1q_u8(reinterpret_cast<const std::uint8_t*>(kHexDigits));
+  const uint8x16_t low_nibble = vdupq_n_u8(0x0f);
+  std::size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    uint8x16_t v = vld1q_u8(in + i);
+    uint8x16x2_t pair;
+    pair.val[0] = vqtbl1q_u8(digits, vshrq_n_u8(v, 4));
+    pair.val[1] = vqtbl1q_u8(digits, vandq_u8(v, low_nibble));
+    vst2q_u8(reinterpret_cast<std::uint8_t*>(out + 2 * i), pair);
+  }
+  scalar_hex_encode(in + i, n - i, out + 2 * i);
+  return 2 * n;
+}
+
+}  // namespace
+
+const Kernels& neon_kernels() {
+  static const Kernels k{Isa::neon,  sum_u32,
+                         dot_f32,    find_byte,
+                         scalar_prefix_sum_u32, scalar_histogram_u8,
+                         hex_encode, scalar_base64_encode,
+                         scalar_delta_encode_u32, scalar_sort_block_u64};
+  return k;
+}
+
+}  // namespace lab::simd::detail
@@ -0,0 +1,122 @@
+// Reference kernels. Built with auto-vectorisation off, so the scalar
+// column in the benchmarks is what the vector variants are measured
+// against rather than the compiler's own vectorised loop.
+#include "variants.hpp"
+
+namespace lab::simd::detail {
+
+std::uint64_t scalar_sum_u32(const std::uint32_t* data, std::size_t n) {
+  std::uint64_t sum = 0;
+  for (std::size_t i = 0; i < n; ++i) sum += data[i];
+  return sum;
+}
+
+float scalar_dot_f32(const float* a, const float* b, std::size_t n) {
+  float sum = 0;
+  for (std::size_t i = 0; i < n; ++i) sum += a[i] * b[i];
+  return sum;
+}
+
+std::size_t scalar_find_byte(const std::uint8_t* data, std::size_t n,
+                             std::uint8_t byte) {
+  for (std::size_t i = 0; i < n; ++i) {
+    if (data[i] == byte) return i;
+  }
+  return n;
+}
+
+void scalar_prefix_sum_u32(std::uint32_t* data, std::size_t n) {
+  std::uint32_t sum = 0;
+  for (std::size_t i = 0; i < n; ++i) {
+    sum += data[i];
+    data[i] = sum;
+  }
+}
+
+// Four sub-histograms so that runs of equal bytes do not serialise on a
+// single counter's store-to-load dependency.
+void scalar_histogram_u8(const std::uint8_t* data, std::size_t n,
+                         std::uint64_t counts[256]) {
+  std::uint32_t sub[4][256] = {};
+  std::size_t i = 0;
+  while (i < n) {
+    // Flush before the 32-bit counters could overflow.
+    std::size_t end = n - i > (std::size_t{1} << 30) ? i + (std::size_t{1} << 30)
+                                                     : n;
+    for (; i + 4 <= end; i += 4) {
+      ++sub[0][data[i]];
+      ++sub[1][data[i + 1]];
+      ++sub[2][data[i + 2]];
+      ++sub[3][data[i + 3]];
+    }
+    for (; i < end; ++i) ++sub[0][data[i]];
+    for (int v = 0; v < 256; ++v) {
+      counts[v] += std::uint64_t{sub[0][v]} + sub[1][v] + sub[2][v] + sub[3][v];
+      sub[0][v] = sub[1][v] = sub[2][v] = sub[3][v] = 0;
+    }
+  }
+}
+
+std::size_t scalar_hex_encode(const std::uint8_t* in, std::size_t n,
+                              char* out) {
+  for (std::size_t i = 0; i < n; ++i) {
+    out[2 * i] = kHexDigits[in[i] >> 4];
+    out[2 * i + 1] = kHexDigits[in[i] & 0xf];
+  }
+  return 2 * n;
+}
+
+std::size_t scalar_base64_encode(const std::uint8_t* in, std::size_t n,
+                                 char* out) {
+  char* o = out;
+  std::size_t i = 0;
+  for (; i + 3 <= n; i += 3) {
+    std::uint32_t w = (std::uint32_t{in[i]} << 16) |
+                      (std::uint32_t{in[i + 1]} << 8) | in[i + 2];
+    *o++ = kBase64Digits[(w >> 18) & 63];
+    *o++ = kBase64Digits[(w >> 12) & 63];
+    *o++ = kBase64Digits[(w >> 6) & 63];
+    *o++ = kBase64Digits[w & 63];
+  }
+  if (i < n) {
+    std::uint32_t w = std::uint32_t{in[i]} << 16;
+    if (i + 1 < n) w |= std::uint32_t{in[i + 1]} << 8;
+    *o++ = kBase64Digits[(w >> 18) & 63];
+    *o++ = kBase64Digits[(w >> 12) & 63];
+    *o++ = i + 1 < n ? kBase64Digits[(w >> 6) & 63] : '=';
+    *o++ = '=';
+  }
+  return static_cast<std::size_t>(o - out);
+}
+
+std::uint32_t scalar_delta_encode_u32(const std::uint32_t* in, std::size_t n,
+                                      std::uint32_t prev, std::uint32_t* out) {
+  std::uint32_t bits = 0;
+  for (std::size_t i = 0; i < n; ++i) {
+    std::uint32_t d = in[i] - prev;
+    prev = in[i];
+    out[i] = (d << 1) ^ (0 - (d >> 31));
+    bits |= out[i];
+  }
+  return bits;
+}
+
+void scalar_sort_block_u64(std::uint64_t* data, std::size_t n) {
+  for (std::size_t i = 1; i < n; ++i) {
+    std::uint64_t v = data[i];
+    std::size_t j = i;
+    for (; j > 0 && data[j - 1] > v; --j) data[j] = data[j - 1];
+    data[j] = v;
+  }
+}
+
+const Kernels& scalar_kernels() {
+  static const Kernels k{Isa::scalar,           scalar_sum_u32,
+                         scalar_dot_f32,        scalar_find_byte,
+                         scalar_prefix_sum_u32, scalar_histogram_u8,
+                         scalar_hex_encode,     scalar_base64_encode,
+                         scalar_delta_encode_u32, scalar_sort_block_u64};
+  return k;
+}
+
+}  // namespace lab::simd::detail
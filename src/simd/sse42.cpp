@@ -0,0 +1,121 @@
+// SSE4.2 variants (x86-64-v2). Compiled with -msse4.2.
+#include <nmmintrin.h>
+
+#include "variants.hpp"
+
+namespace lab::simd::detail {
+namespace {
+
+std::uint64_t sum_u32(const std::uint32_t* data, std::size_t n) {
+  const __m128i zero = _mm_setzero_si128();
+  __m128i acc0 = zero, acc1 = zero;
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+    acc0 = _mm_add_epi64(acc0, _mm_unpacklo_epi32(v, zero));
+    acc1 = _mm_add_epi64(acc1, _mm_unpackhi_epi32(v, zero));
+  }
+  __m128i acc = _mm_add_epi64(acc0, acc1);
+  std::uint64_t sum = static_cast<std::uint64_t>(_mm_cvtsi128_si64(acc)) +
+                      static_cast<std::uint64_t>(_mm_extract_epi64(acc, 1));
+  return sum + scalar_sum_u32(data + i, n - i);
+}
+
+float dot_f32(const float* a, const float* b, std::size_t n) {
+  __m128 acc0 = _mm_setzero_ps(), acc1 = _mm_setzero_ps();
+  std::size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4),
+                                       _mm_loadu_ps(b + i + 4)));
+  }
+  __m128 acc = _mm_add_ps(acc0, acc1);
+  acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+  acc = _mm_add_ss(acc, _mm_shuffle_ps(acc, acc, 1));
+  return _mm_cvtss_f32(acc) + scalar_dot_f32(a + i, b + i, n - i);
+}
+
+std::size_t find_byte(const std::uint8_t* data, std::size_t n,
+                      std::uint8_t byte) {
+  const __m128i needle = _mm_set1_epi8(static_cast<char>(byte));
+  std::size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+    int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(v, needle));
+    if (mask != 0) return i + static_cast<std::size_t>(__builtin_ctz(mask));
+  }
+  return i + scalar_find_byte(data + i, n - i, byte);
+}
+
+// Log-step scan within a register, then add the running total.
+void prefix_sum_u32(std::uint32_t* data, std::size_t n) {
+  __m128i carry = _mm_setzero_si128();
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    auto* p = reinterpret_cast<__m128i*>(data + i);
+    __m128i v = _mm_loadu_si128(p);
+    v = _mm_add_epi32(v, _mm_slli_si128(v, 4));
+    v = _mm_add_epi32(v, _mm_slli_si128(v, 8));
+    v = _mm_add_epi32(v, carry);
+    _mm_storeu_si128(p, v);
+    carry = _mm_shuffle_epi32(v, 0xff);
+  }
+  if (i < n) {
+    data[i] += static_cast<std::uint32_t>(_mm_cvtsi128_si32(carry));
+    scalar_prefix_sum_u32(data + i, n - i);
+  }
+}
+
+// Nibbles index a 16-entry digit table through pshufb.
+std::size_t hex_encode(const std::uint8_t* in, std::size_t n, char* out) {
+  const __m128i digits = _mm_loadu_si128(
+      reinterpret_cast<const __m128i*>(kHexDigits));
+  const __m128i low_nibble = _mm_set1_epi8(0x0f);
+  std::size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+    __m128i hi = _mm_and_si128(_mm_srli_epi16(v, 4), low_nibble);
+    __m128i lo = _mm_and_si128(v, low_nibble);
+    hi = _mm_shuffle_epi8(digits, hi);
+    lo = _mm_shuffle_epi8(digits, lo);
+    auto* o = reinterpret_cast<__m128i*>(out + 2 * i);
+    _mm_storeu_si128(o, _mm_unpacklo_epi8(hi, lo));
+    _mm_storeu_si128(o + 1, _mm_unpackhi_epi8(hi, lo));
+  }
+  scalar_hex_encode(in + i, n - i, out + 2 * i);
+  return 2 * n;
+}
+
+// Element 0 in scalar, so that every later vector of predecessors is an
+// unaligned load one element back.
+std::uint32_t delta_encode_u32(const std::uint32_t* in, std::size_t n,
+                               std::uint32_t prev, std::uint32_t* out) {
+  if (n == 0) return 0;
+  std::uint32_t bits = scalar_delta_encode_u32(in, 1, prev, out);
+  __m128i acc = _mm_setzero_si128();
+  std::size_t i = 1;
+  for (; i + 4 <= n; i += 4) {
+    __m128i d = _mm_sub_epi32(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i)),
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i - 1)));
+    __m128i z = _mm_xor_si128(_mm_slli_epi32(d, 1), _mm_srai_epi32(d, 31));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), z);
+    acc = _mm_or_si128(acc, z);
+  }
+  acc = _mm_or_si128(acc, _mm_shuffle_epi32(acc, 0x4e));
+  acc = _mm_or_si128(acc, _mm_shuffle_epi32(acc, 0xb1));
+  bits |= static_cast<std::uint32_t>(_mm_cvtsi128_si32(acc));
+  return bits | scalar_delta_encode_u32(in + i, n - i, in[i - 1], out + i);
+}
+
+}  // namespace
+
+const Kernels& sse42_kernels() {
+  static const Kernels k{Isa::sse42,    sum_u32,        dot_f32,
+                         find_byte,     prefix_sum_u32, scalar_histogram_u8,
+                         hex_encode,    scalar_base64_encode,
+                         delta_encode_u32, scalar_sort_block_u64};
+  return k;
+}
+
+}  // namespace lab::simd::detail
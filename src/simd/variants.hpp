@@ -0,0 +1,43 @@
+// Per-ISA kernel tables. Each variant lives in its own translation unit
+// compiled with that ISA's target flags, so nothing outside it may be
+// inlined into baseline code.
+#pragma once
+
+#include "lab/simd.hpp"
+
+namespace lab::simd::detail {
+
+const Kernels& scalar_kernels();
+
+#if defined(__x86_64__) || defined(__i386__)
+const Kernels& sse42_kernels();
+const Kernels& avx2_kernels();
+const Kernels& avx512_kernels();
+#endif
+
+#if defined(__aarch64__)
+const Kernels& neon_kernels();
+#endif
+
+// Scalar implementations, shared by variants that only vectorise some
+// of the kernels and used for their loop tails.
+std::uint64_t scalar_sum_u32(const std::uint32_t* data, std::size_t n);
+float scalar_dot_f32(const float* a, const float* b, std::size_t n);
+std::size_t scalar_find_byte(const std::uint8_t* data, std::size_t n,
+                             std::uint8_t byte);
+void scalar_prefix_sum_u32(std::uint32_t* data, std::size_t n);
+void scalar_histogram_u8(const std::uint8_t* data, std::size_t n,
+                         std::uint64_t counts[256]);
+std::size_t scalar_hex_encode(const std::uint8_t* in, std::size_t n,
+                              char* out);
+std::size_t scalar_base64_encode(const std::uint8_t* in, std::size_t n,
+                                 char* out);
+std::uint32_t scalar_delta_encode_u32(const std::uint32_t* in, std::size_t n,
+                                      std::uint32_t prev, std::uint32_t* out);
+void scalar_sort_block_u64(std::uint64_t* data, std::size_t n);
+
+inline constexpr char kHexDigits[] = "0123456789abcdef";
+inline constexpr char kBase64Digits[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+}  // namespace lab::simd::detail
@@ -0,0 +1,490 @@
+#include "lab/sort.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <utility>
+#include <vector>
+
+#include "lab/scheduler.hpp"
+#include "lab/simd.hpp"
+
+namespace lab::sort {
+
+namespace {
+
+using Key = std::uint64_t;
+
+// ---- pdqsort ---------------------------------------------------------
+//
+// A port of Orson Peters' reference implementation (pdqsort.h, zlib
+// licence) specialised to unsigned keys, which are always safe to move
+// branchlessly.
+
+constexpr std::ptrdiff_t kInsertionSort = 24;
+constexpr std::ptrdiff_t kNinther = 128;
+constexpr std::ptrdiff_t kPartialInsertionLimit = 8;
+constexpr std::size_t kPartitionBlock = 64;
+
+void insertion_sort(Key* begin, Key* end) {
+  if (begin == end) return;
+  for (Key* cur = begin + 1; cur != end; ++cur) {
+    Key v = *cur;
+    Key* sift = cur;
+    for (; sift != begin && v < sift[-1]; --sift) *sift = sift[-1];
+    *sift = v;
+  }
+}
+
+// Needs a key no larger than any in [begin, end) at begin[-1].
+void unguarded_insertion_sort(Key* begin, Key* end) {
+  if (begin == end) return;
+  for (Key* cur = begin + 1; cur != end; ++cur) {
+    Key v = *cur;
+    Key* sift = cur;
+    for (; v < sift[-1]; --sift) *sift = sift[-1];
+    *sift = v;
+  }
+}
+
+// Insertion sort that gives up after moving kPartialInsertionLimit keys;
+// true if it finished.
+bool partial_insertion_sort(Key* begin, Key* end) {
+  if (begin == end) return true;
+  std::ptrdiff_t moved = 0;
+  for (Key* cur = begin + 1; cur != end; ++cur) {
+    Key v = *cur;
+    Key* sift = cur;
+    for (; sift != begin && v < sift[-1]; --sift) *sift = sift[-1];
+    *sift = v;
+    moved += cur - sift;
+    if (moved > kPartialInsertionLimit) return false;
+  }
+  return true;
+}
+
+void sort2(Key* a, Key* b) {
+  if (*b < *a) std::swap(*a, *b);
+}
+
+void sort3(Key* a, Key* b, Key* c) {
+  sort2(a, b);
+  sort2(b, c);
+  sort2(a, b);
+}
+
+// Moves the keys at offsets_l from `first` and at offsets_r back from
+// `last` across. A cyclic move when the counts differ; swaps otherwise,
+// which descending input needs for pdqsort to stay linear on it.
+void swap_offsets(Key* first, Key* last, const unsigned char* offsets_l,
+                  const unsigned char* offsets_r, std::size_t num,
+                  bool use_swaps) {
+  if (use_swaps) {
+    for (std::size_t i = 0; i < num; ++i) {
+      std::swap(first[offsets_l[i]], *(last - offsets_r[i]));
+    }
+  } else if (num > 0) {
+    Key* l = first + offsets_l[0];
+    Key* r = last - offsets_r[0];
+    Key tmp = *l;
+    *l = *r;
+    for (std::size_t i = 1; i < num; ++i) {
+      l = first + offsets_l[i];
+      *r = *l;
+      r = last - offsets_r[i];
+      *l = *r;
+    }
+    *r = tmp;
+  }
+}
+
+// Partitions [begin, end) around *begin, keys equal to the pivot going
+// right: BlockQuicksort (Edelkamp and Weiss), which records the offsets
+// of misplaced keys a block at a time with branch-free increments and
+// then swaps them. Returns the pivot's position and whether the range was
+// already partitioned. Needs a median-of-3 pivot, so that a key not less
+// than it exists to stop the first scan.
+std::pair<Key*, bool> partition_right_branchless(Key* begin, Key* end) {
+  const Key pivot = *begin;
+  Key* first = begin;
+  Key* last = end;
+  while (*++first < pivot) {}
+  if (first - 1 == begin) {
+    while (first < last && !(*--last < pivot)) {}
+  } else {
+    while (!(*--last < pivot)) {}
+  }
+
+  bool already_partitioned = first >= last;
+  if (!already_partitioned) {
+    std::swap(*first, *last);
+    ++first;
+
+    alignas(64) unsigned char offsets_l[kPartitionBlock];
+    alignas(64) unsigned char offsets_r[kPartitionBlock];
+    Key* offsets_l_base = first;
+    Key* offsets_r_base = last;
+    std::size_t num_l = 0, num_r = 0, start_l = 0, start_r = 0;
+    while (first < last) {
+      // Split what is left between the blocks that need refilling.
+      auto unknown = static_cast<std::size_t>(last - first);
+      std::size_t left_split =
+          num_l == 0 ? (num_r == 0 ? unknown / 2 : unknown) : 0;
+      std::size_t right_split = num_r == 0 ? unknown - left_split : 0;
+
+      std::size_t left = std::min(left_split, kPartitionBlock);
+      for (std::size_t i = 0; i < left; ++i) {
+        offsets_l[num_l] = static_cast<unsigned char>(i);
+        num_l += !(*first < pivot);
+        ++first;
+      }
+      std::size_t right = std::min(right_split, kPartitionBlock);
+      for (std::size_t i = 1; i <= right; ++i) {
+        offsets_r[num_r] = static_cast<unsigned char>(i);
+        num_r += *--last < pivot;
+      }
+
+      std::size_t num = std::min(num_l, num_r);
+      swap_offsets(offsets_l_base, offsets_r_base, offsets_l + start_l,
+                   offsets_r + start_r, num, num_l == num_r);
+      num_l -= num;
+      num_r -= num;
+      start_l += num;
+      start_r += num;
+      if (num_l == 0) {
+        start_l = 0;
+        offsets_l_base = first;
+      }
+      if (num_r == 0) {
+        start_r = 0;
+        offsets_r_base = last;
+      }
+    }
+
+    // One side may still hold misplaced keys; move them to the boundary.
+    if (num_l > 0) {
+      while (num_l-- > 0) {
+        std::swap(offsets_l_base[offsets_l[start_l + num_l]], *--last);
+      }
+      first = last;
+    }
+    if (num_r > 0) {
+      while (num_r-- > 0) {
+        std::swap(*(offsets_r_base - offsets_r[start_r + num_r]), *first);
+        ++first;
+      }
+      last = first;
+    }
+  }
+
+  Key* pivot_pos = first - 1;
+  *begin = *pivot_pos;
+  *pivot_pos = pivot;
+  return {pivot_pos, already_partitioned};
+}
+
+// Partitions around *begin with keys equal to the pivot going left. Used
+// when the pivot equals the key just before the range, so the left part
+// is all equal keys and needs no further sorting.
+Key* partition_left(Key* begin, Key* end) {
+  const Key pivot = *begin;
+  Key* first = begin;
+  Key* last = end;
+  while (pivot < *--last) {}
+  if (last + 1 == end) {
+    while (first < last && !(pivot < *++first)) {}
+  } else {
+    while (!(pivot < *++first)) {}
+  }
+  while (first < last) {
+    std::swap(*first, *last);
+    while (pivot < *--last) {}
+    while (!(pivot < *++first)) {}
+  }
+  *begin = *last;
+  *last = pivot;
+  return last;
+}
+
+void pdqsort_loop(Key* begin, Key* end, int bad_allowed, bool leftmost) {
+  while (true) {
+    std::ptrdiff_t size = end - begin;
+    if (size < kInsertionSort) {
+      if (leftmost) {
+        insertion_sort(begin, end);
+      } else {
+        unguarded_insertion_sort(begin, end);
+      }
+      return;
+    }
+
+    // Median of 3, or Tukey's ninther on larger ranges.
+    std::ptrdiff_t s2 = size / 2;
+    if (size > kNinther) {
+      sort3(begin, begin + s2, end - 1);
+      sort3(begin + 1, begin + (s2 - 1), end - 2);
+      sort3(begin + 2, begin + (s2 + 1), end - 3);
+      sort3(begin + (s2 - 1), begin + s2, begin + (s2 + 1));
+      std::swap(*begin, begin[s2]);
+    } else {
+      sort3(begin + s2, begin, end - 1);
+    }
+
+    // begin[-1] closes the left part of the previous partition, so no key
+    // here is smaller; a pivot equal to it means many duplicates.
+    if (!leftmost && !(begin[-1] < *begin)) {
+      begin = partition_left(begin, end) + 1;
+      continue;
+    }
+
+    auto [pivot_pos, already_partitioned] =
+        partition_right_branchless(begin, end);
+    std::ptrdiff_t l_size = pivot_pos - begin;
+    std::ptrdiff_t r_size = end - (pivot_pos + 1);
+    bool highly_unbalanced = l_size < size / 8 || r_size < size / 8;
+
+    if (highly_unbalanced) {
+      // Too many bad partitions: heapsort keeps the bound O(n log n).
+      if (--bad_allowed == 0) {
+        std::make_heap(begin, end);
+        std::sort_heap(begin, end);
+        return;
+      }
+      // Otherwise shuffle a few keys to break the pattern.
+      if (l_size >= kInsertionSort) {
+        std::swap(begin[0], begin[l_size / 4]);
+        std::swap(pivot_pos[-1], pivot_pos[-l_size / 4]);
+        if (l_size > kNinther) {
+          std::swap(begin[1], begin[l_size / 4 + 1]);
+          std::swap(begin[2], begin[l_size / 4 + 2]);
+          std::swap(pivot_pos[-2], pivot_pos[-(l_size / 4 + 1)]);
+          std::swap(pivot_pos[-3], pivot_pos[-(l_size / 4 + 2)]);
+        }
+      }
+      if (r_size >= kInsertionSort) {
+        std::swap(pivot_pos[1], pivot_pos[1 + r_size / 4]);
+        std::swap(end[-1], end[-r_size / 4]);
+        if (r_size > kNinther) {
+          std::swap(pivot_pos[2], pivot_pos[2 + r_size / 4]);
+          std::swap(pivot_pos[3], pivot_pos[3 + r_size / 4]);
+          std::swap(end[-2], end[-(1 + r_size / 4)]);
+          std::swap(end[-3], end[-(2 + r_size / 4)]);
+        }
+      }
+    } else if (already_partitioned &&
+               partial_insertion_sort(begin, pivot_pos) &&
+               partial_insertion_sort(pivot_pos + 1, end)) {
+      // A balanced pivot on an already partitioned range: probably
+      // sorted, and insertion sort confirmed it cheaply.
+      return;
+    }
+
+    // Recurse into the left part, loop on the right.
+    pdqsort_loop(begin, pivot_pos, bad_allowed, leftmost);
+    begin = pivot_pos + 1;
+    leftmost = false;
+  }
+}
+
+// ---- radix sorts -----------------------------------------------------
+
+constexpr int kDigits = 8;
+constexpr std::size_t kRadix = 256;
+// Buckets smaller than this go to pdqsort in the MSD sort: a radix pass
+// costs two sweeps over 256 counters, which small buckets cannot repay.
+constexpr std::size_t kRadixSmall = 128;
+
+std::size_t digit(Key key, int shift) {
+  return static_cast<std::size_t>(key >> shift) & (kRadix - 1);
+}
+
+void radix_msd(Key* data, std::size_t n, int shift) {
+  std::size_t count[kRadix];
+  while (true) {
+    if (n < kRadixSmall) {
+      pdqsort(data, n);
+      return;
+    }
+    std::fill(count, count + kRadix, 0);
+    for (std::size_t i = 0; i < n; ++i) ++count[digit(data[i], shift)];
+    // One bucket: nothing to move at this digit.
+    if (count[digit(data[0], shift)] != n) break;
+    if (shift == 0) return;
+    shift -= kDigits;
+  }
+
+  std::size_t head[kRadix], tail[kRadix];
+  std::size_t sum = 0;
+  for (std::size_t d = 0; d < kRadix; ++d) {
+    head[d] = sum;
+    sum += count[d];
+    tail[d] = sum;
+  }
+  // Cycle leader permutation: each key is carried to its bucket, taking
+  // the key found there onward, until a key for this bucket turns up.
+  for (std::size_t d = 0; d < kRadix; ++d) {
+    while (head[d] < tail[d]) {
+      Key v = data[head[d]];
+      std::size_t b = digit(v, shift);
+      while (b != d) {
+        std::swap(v, data[head[b]++]);
+        b = digit(v, shift);
+      }
+      data[head[d]++] = v;
+    }
+  }
+  if (shift == 0) return;
+  std::size_t begin = 0;
+  for (std::size_t d = 0; d < kRadix; ++d) {
+    if (count[d] > 1) radix_msd(data + begin, count[d], shift - kDigits);
+    begin += count[d];
+  }
+}
+
+// ---- sample sort -----------------------------------------------------
+
+constexpr std::size_t kSampleSortMin = std::size_t{1} << 16;
+constexpr std::size_t kOversample = 16;
+constexpr std::size_t kMaxBuckets = 256;
+
+// Index of the first splitter greater than `key`, by bisection over a
+// power-of-two count of buckets (buckets - 1 splitters), without
+// branches.
+std::size_t bucket_of(const Key* splitters, std::size_t buckets, Key key) {
+  std::size_t b = 0;
+  for (std::size_t step = buckets / 2; step > 0; step /= 2) {
+    b += (splitters[b + step - 1] <= key) * step;
+  }
+  return b;
+}
+
+}  // namespace
+
+void pdqsort(std::uint64_t* data, std::size_t n) {
+  if (n < 2) return;
+  pdqsort_loop(data, data + n, std::bit_width(n) - 1, true);
+}
+
+void radix_sort_lsd(std::uint64_t* data, std::size_t n,
+                    std::uint64_t* scratch) {
+  if (n < 2) return;
+  // Every digit's histogram in one read of the input.
+  static_assert(kDigits * 8 == 64);
+  std::size_t counts[8][kRadix] = {};
+  for (std::size_t i = 0; i < n; ++i) {
+    for (int p = 0; p < 8; ++p) ++counts[p][digit(data[i], p * kDigits)];
+  }
+  Key* from = data;
+  Key* to = scratch;
+  for (int p = 0; p < 8; ++p) {
+    std::size_t* count = counts[p];
+    int shift = p * kDigits;
+    if (count[digit(data[0], shift)] == n) continue;
+    std::size_t sum = 0;
+    for (std::size_t d = 0; d < kRadix; ++d) {
+      sum += std::exchange(count[d], sum);
+    }
+    for (std::size_t i = 0; i < n; ++i) {
+      Key v = from[i];
+      to[count[digit(v, shift)]++] = v;
+    }
+    std::swap(from, to);
+  }
+  if (from != data) std::copy(from, from + n, data);
+}
+
+void radix_sort_msd(std::uint64_t* data, std::size_t n) {
+  radix_msd(data, n, 64 - kDigits);
+}
+
+void block_merge_sort(std::uint64_t* data, std::size_t n,
+                      std::uint64_t* scratch) {
+  for (std::size_t i = 0; i < n; i += simd::kSortBlock) {
+    simd::sort_block_u64(data + i, std::min(simd::kSortBlock, n - i));
+  }
+  Key* from = data;
+  Key* to = scratch;
+  for (std::size_t width = simd::kSortBlock; width < n; width *= 2) {
+    for (std::size_t lo = 0; lo < n; lo += 2 * width) {
+      std::size_t mid = std::min(lo + width, n);
+      std::size_t hi = std::min(lo + 2 * width, n);
+      std::merge(from + lo, from + mid, from + mid, from + hi, to + lo);
+    }
+    std::swap(from, to);
+  }
+  if (from != data) std::copy(from, from + n, data);
+}
+
+void sample_sort(Scheduler& pool, std::uint64_t* data, std::size_t n,
+                 std::uint64_t* scratch) {
+  const auto workers = static_cast<std::size_t>(pool.size());
+  if (workers < 2 || n < kSampleSortMin) {
+    pdqsort(data, n);
+    return;
+  }
+
+  // Eight buckets per worker leave room for stealing to even out their
+  // sizes; the sample's fixed seed keeps runs comparable.
+  const std::size_t buckets = std::min(std::bit_ceil(workers * 8),
+                                       kMaxBuckets);
+  std::vector<Key> sample(buckets * kOversample);
+  std::uint64_t rng = 0x9e3779b97f4a7c15ull;
+  for (Key& s : sample) {
+    rng = rng * 6364136223846793005ull + 1442695040888963407ull;
+    s = data[(rng >> 32) % n];
+  }
+  pdqsort(sample.data(), sample.size());
+  std::vector<Key> splitters(buckets - 1);
+  for (std::size_t i = 0; i + 1 < buckets; ++i) {
+    splitters[i] = sample[(i + 1) * kOversample];
+  }
+
+  // Count per chunk, then lay the buckets out contiguously with each
+  // chunk's part of a bucket at a fixed offset, so the scatter needs no
+  // synchronisation.
+  const std::size_t chunks = workers * 4;
+  std::vector<std::size_t> offsets(chunks * buckets);
+  auto chunk_range = [&](std::size_t c) {
+    return std::pair{n * c / chunks, n * (c + 1) / chunks};
+  };
+  pool.parallel_for(0, chunks, [&](std::size_t lo, std::size_t hi) {
+    for (std::size_t c = lo; c < hi; ++c) {
+      std::size_t* count = offsets.data() + c * buckets;
+      auto [begin, end] = chunk_range(c);
+      for (std::size_t i = begin; i < end; ++i) {
+        ++count[bucket_of(splitters.data(), buckets, data[i])];
+      }
+    }
+  }, 1);
+  std::vector<std::size_t> bucket_begin(buckets + 1);
+  std::size_t sum = 0;
+  for (std::size_t b = 0; b < buckets; ++b) {
+    bucket_begin[b] = sum;
+    for (std::size_t c = 0; c < chunks; ++c) {
+      sum += std::exchange(offsets[c * buckets + b], sum);
+    }
+  }
+  bucket_begin[buckets] = sum;
+
+  pool.parallel_for(0, chunks, [&](std::size_t lo, std::size_t hi) {
+    for (std::size_t c = lo; c < hi; ++c) {
+      std::size_t* offset = offsets.data() + c * buckets;
+      auto [begin, end] = chunk_range(c);
+      for (std::size_t i = begin; i < end; ++i) {
+        Key v = data[i];
+        scratch[offset[bucket_of(splitters.data(), buckets, v)]++] = v;
+      }
+    }
+  }, 1);
+
+  // Each bucket is copied back and sorted by the same task, while it is
+  // still in that worker's cache.
+  pool.parallel_for(0, buckets, [&](std::size_t lo, std::size_t hi) {
+    for (std::size_t b = lo; b < hi; ++b) {
+      std::size_t begin = bucket_begin[b], end = bucket_begin[b + 1];
+      std::copy(scratch + begin, scratch + end, data + begin);
+      pdqsort(data + begin, end - begin);
+    }
+  }, 1);
+}
+
+}  // namespace lab::sort
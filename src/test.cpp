@@ -0,0 +1,355 @@
+#include "lab/test.hpp"
+
+#include <poll.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <ostream>
+#include <regex>
+
+namespace lab {
+
+void TestContext::fail(const char* file, int line, std::string message) {
+  if (*file == '\0') {
+    failures_.push_back(std::move(message));
+    return;
+  }
+  const char* base = std::strrchr(file, '/');
+  failures_.push_back(std::string(base != nullptr ? base + 1 : file) + ":" +
+                      std::to_string(line) + ": " + std::move(message));
+}
+
+TestRegistry& TestRegistry::global() {
+  static TestRegistry registry;
+  return registry;
+}
+
+bool parse_shard(const std::string& spec, int& index, int& count) {
+  char* end = nullptr;
+  long i = std::strtol(spec.c_str(), &end, 10);
+  if (end == spec.c_str() || *end != '/') return false;
+  const char* rest = end + 1;
+  long n = std::strtol(rest, &end, 10);
+  if (end == rest || *end != '\0' || n < 1 || i < 0 || i >= n) return false;
+  index = static_cast<int>(i);
+  count = static_cast<int>(n);
+  return true;
+}
+
+namespace {
+
+TestResult run_one(const Test& test) {
+  TestResult result;
+  result.name = test.name;
+  TestContext context;
+  auto start = std::chrono::steady_clock::now();
+  try {
+    test.fn(context);
+  } catch (const std::exception& e) {
+    context.fail("", 0, std::string("uncaught exception: ") + e.what());
+  } catch (...) {
+    context.fail("", 0, "uncaught exception");
+  }
+  result.seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+  result.failures = context.failures();
+  result.passed = result.failures.empty();
+  return result;
+}
+
+// A forked worker reports over a pipe, one line per event:
+//   S <index>                                  test started
+//   R <index> <passed> <seconds> <failures>    test finished
+// with tab separators and failures joined by \x1f.
+void write_line(int fd, const std::string& line) {
+  const char* p = line.data();
+  std::size_t left = line.size();
+  while (left > 0) {
+    ssize_t n = ::write(fd, p, left);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      return;
+    }
+    p += n;
+    left -= static_cast<std::size_t>(n);
+  }
+}
+
+std::string flatten(std::string s) {
+  for (char& c : s) {
+    if (c == '\n' || c == '\t' || c == '\x1f') c = ' ';
+  }
+  return s;
+}
+
+[[noreturn]] void worker(const std::vector<const Test*>& tests,
+                         const std::vector<std::size_t>& mine, int fd) {
+  for (std::size_t index : mine) {
+    write_line(fd, "S\t" + std::to_string(index) + "\n");
+    TestResult r = run_one(*tests[index]);
+    std::string line = "R\t" + std::to_string(index) + "\t" +
+                       (r.passed ? "1" : "0") + "\t" +
+                       std::to_string(r.seconds) + "\t";
+    for (std::size_t i = 0; i < r.failures.size(); ++i) {
+      if (i != 0) line += '\x1f';
+      line += flatten(r.failures[i]);
+    }
+    write_line(fd, line + "\n");
+  }
+  ::_exit(0);
+}
+
+struct Worker {
+  pid_t pid = -1;
+  int fd = -1;
+  std::string buffer;
+  std::ptrdiff_t running = -1;  // index of the test it last started
+};
+
+void parse_line(const std::string& line, Worker& w,
+                std::vector<TestResult>& results, std::vector<bool>& done) {
+  std::vector<std::string> fields;
+  std::size_t start = 0;
+  for (;;) {
+    std::size_t tab = line.find('\t', start);
+    fields.push_back(line.substr(start, tab - start));
+    if (tab == std::string::npos) break;
+    start = tab + 1;
+  }
+  if (fields.size() < 2) return;
+  auto index = static_cast<std::size_t>(std::strtoull(fields[1].c_str(),
+                                                      nullptr, 10));
+  if (index >= results.size()) return;
+  if (fields[0] == "S") {
+    w.running = static_cast<std::ptrdiff_t>(index);
+  } else if (fields[0] == "R" && fields.size() == 5) {
+    TestResult& r = results[index];
+    r.passed = fields[2] == "1";
+    r.seconds = std::strtod(fields[3].c_str(), nullptr);
+    std::size_t from = 0;
+    while (!fields[4].empty() && from <= fields[4].size()) {
+      std::size_t sep = fields[4].find('\x1f', from);
+      r.failures.push_back(fields[4].substr(from, sep - from));
+      if (sep == std::string::npos) break;
+      from = sep + 1;
+    }
+    done[index] = true;
+    w.running = -1;
+  }
+}
+
+std::string describe_exit(int status) {
+  if (WIFSIGNALED(status)) {
+    int sig = WTERMSIG(status);
+    return "killed by signal " + std::to_string(sig) + " (" +
+           strsignal(sig) + ")";
+  }
+  return "exited with status " + std::to_string(WEXITSTATUS(status));
+}
+
+std::vector<TestResult> run_forked(const std::vector<const Test*>& tests,
+                                   int jobs) {
+  std::vector<TestResult> results(tests.size());
+  for (std::size_t i = 0; i < tests.size(); ++i) {
+    results[i].name = tests[i]->name;
+  }
+  std::vector<bool> done(tests.size(), false);
+
+  std::fflush(nullptr);
+  std::vector<Worker> workers(static_cast<std::size_t>(jobs));
+  for (int j = 0; j < jobs; ++j) {
+    std::vector<std::size_t> mine;
+    for (std::size_t i = static_cast<std::size_t>(j); i < tests.size();
+         i += static_cast<std::size_t>(jobs)) {
+      mine.push_back(i);
+    }
+    int fds[2];
+    if (::pipe(fds) != 0) {
+      std::perror("pipe");
+      std::exit(2);
+    }
+    pid_t pid = ::fork();
+    if (pid < 0) {
+      std::perror("fork");
+      std::exit(2);
+    }
+    if (pid == 0) {
+      ::close(fds[0]);
+      for (int k = 0; k < j; ++k) ::close(workers[k].fd);
+      worker(tests, mine, fds[1]);
+    }
+    ::close(fds[1]);
+    workers[j].pid = pid;
+    workers[j].fd = fds[0];
+  }
+
+  // Drain every pipe until all workers have closed theirs.
+  for (;;) {
+    std::vector<pollfd> fds;
+    std::vector<Worker*> owners;
+    for (auto& w : workers) {
+      if (w.fd >= 0) {
+        fds.push_back({w.fd, POLLIN, 0});
+        owners.push_back(&w);
+      }
+    }
+    if (fds.empty()) break;
+    if (::poll(fds.data(), fds.size(), -1) < 0) {
+      if (errno == EINTR) continue;
+      std::perror("poll");
+      std::exit(2);
+    }
+    for (std::size_t i = 0; i < fds.size(); ++i) {
+      if (fds[i].revents == 0) continue;
+      Worker& w = *owners[i];
+      char buf[4096];
+      ssize_t n = ::read(w.fd, buf, sizeof(buf));
+      if (n < 0 && errno == EINTR) continue;
+      if (n <= 0) {
+        ::close(w.fd);
+        w.fd = -1;
+        continue;
+      }
+      w.buffer.append(buf, static_cast<std::size_t>(n));
+      std::size_t nl;
+      while ((nl = w.buffer.find('\n')) != std::string::npos) {
+        parse_line(w.buffer.substr(0, nl), w, results, done);
+        w.buffer.erase(0, nl + 1);
+      }
+    }
+  }
+
+  for (std::size_t j = 0; j < workers.size(); ++j) {
+    int status = 0;
+    while (::waitpid(workers[j].pid, &status, 0) < 0 && errno == EINTR) {
+    }
+    bool clean = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    for (std::size_t i = j; i < tests.size(); i += workers.size()) {
+      if (done[i]) continue;
+      results[i].passed = false;
+      if (static_cast<std::ptrdiff_t>(i) == workers[j].running) {
+        results[i].failures.push_back("test process " + describe_exit(status));
+      } else {
+        results[i].failures.push_back(
+            clean ? "not reported by its test process"
+                  : "not run: an earlier test in its process crashed");
+      }
+    }
+  }
+  return results;
+}
+
+std::string json_escape(const std::string& s) {
+  std::string out;
+  for (char c : s) {
+    switch (c) {
+      case '"': out += "\\\""; break;
+      case '\\': out += "\\\\"; break;
+      case '\n': out += "\\n"; break;
+      case '\t': out += "\\t"; break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          char buf[8];
+          std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+          out += buf;
+        } else {
+          out += c;
+        }
+    }
+  }
+  return out;
+}
+
+std::string xml_escape(const std::string& s) {
+  std::string out;
+  for (char c : s) {
+    switch (c) {
+      case '<': out += "&lt;"; break;
+      case '>': out += "&gt;"; break;
+      case '&': out += "&amp;"; break;
+      case '"': out += "&quot;"; break;
+      default: out += c;
+    }
+  }
+  return out;
+}
+
+}  // namespace
+
+std::vector<TestResult> run_tests(const TestRegistry& registry,
+                                  const TestOptions& opts) {
+  std::regex filter(opts.filter.empty() ? ".*" : opts.filter);
+  std::vector<const Test*> selected;
+  int position = 0;
+  for (const auto& test : registry.tests()) {
+    if (!std::regex_search(test.name, filter)) continue;
+    if (position++ % opts.shard_count == opts.shard_index) {
+      selected.push_back(&test);
+    }
+  }
+
+  int jobs = std::min<int>(opts.jobs, static_cast<int>(selected.size()));
+  if (jobs > 1) return run_forked(selected, jobs);
+
+  std::vector<TestResult> results;
+  for (const Test* test : selected) results.push_back(run_one(*test));
+  return results;
+}
+
+void write_test_results(std::ostream& out,
+                        const std::vector<TestResult>& results,
+                        TestFormat format) {
+  char seconds[32];
+  if (format == TestFormat::json) {
+    for (const auto& r : results) {
+      std::snprintf(seconds, sizeof(seconds), "%.6f", r.seconds);
+      out << "{\"name\":\"" << json_escape(r.name) << "\",\"status\":\""
+          << (r.passed ? "pass" : "fail") << "\",\"seconds\":" << seconds
+          << ",\"failures\":[";
+      for (std::size_t i = 0; i < r.failures.size(); ++i) {
+        out << (i != 0 ? "," : "") << '"' << json_escape(r.failures[i])
+            << '"';
+      }
+      out << "]}\n";
+    }
+    return;
+  }
+
+  std::size_t failed = 0;
+  double total = 0;
+  for (const auto& r : results) {
+    failed += !r.passed;
+    total += r.seconds;
+  }
+  std::snprintf(seconds, sizeof(seconds), "%.6f", total);
+  out << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+      << "<testsuites tests=\"" << results.size() << "\" failures=\""
+      << failed << "\" time=\"" << seconds << "\">\n"
+      << "  <testsuite name=\"lab\" tests=\"" << results.size()
+      << "\" failures=\"" << failed << "\" time=\"" << seconds << "\">\n";
+  for (const auto& r : results) {
+    std::snprintf(seconds, sizeof(seconds), "%.6f", r.seconds);
+    out << "    <testcase classname=\"lab\" name=\"" << xml_escape(r.name)
+        << "\" time=\"" << seconds << "\"";
+    if (r.passed) {
+      out << "/>\n";
+      continue;
+    }
+    out << ">\n";
+    for (const auto& f : r.failures) {
+      out << "      <failure message=\"" << xml_escape(f) << "\"/>\n";
+    }
+    out << "    </testcase>\n";
+  }
+  out << "  </testsuite>\n</testsuites>\n";
+}
+
+}  // namespace lab
@@ -0,0 +1,86 @@
+// Runs the tests linked in from tests/ and writes test_output.txt.
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+
+#include "lab/test.hpp"
+#include "lab/topology.hpp"
+
+namespace {
+
+void usage(const char* argv0) {
+  std::fprintf(stderr,
+               "usage: %s [--filter=REGEX] [--list] [--shard=I/N] [--jobs=N]\n"
+               "          [--format=json|junit] [--out=PATH]\n",
+               argv0);
+}
+
+const char* flag(const std::string& arg, const char* key) {
+  std::string prefix = std::string("--") + key + "=";
+  if (arg.compare(0, prefix.size(), prefix) != 0) return nullptr;
+  return arg.c_str() + prefix.size();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  lab::TestOptions opts;
+  opts.jobs = lab::Topology::detect().cpu_count();
+  bool list = false;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (const char* v = flag(arg, "filter")) {
+      opts.filter = v;
+    } else if (const char* v = flag(arg, "shard")) {
+      if (!lab::parse_shard(v, opts.shard_index, opts.shard_count)) {
+        std::fprintf(stderr, "error: --shard expects I/N with 0 <= I < N\n");
+        return 2;
+      }
+    } else if (const char* v = flag(arg, "jobs")) {
+      opts.jobs = std::atoi(v);
+    } else if (const char* v = flag(arg, "format")) {
+      if (std::string(v) == "json") {
+        opts.format = lab::TestFormat::json;
+      } else if (std::string(v) == "junit") {
+        opts.format = lab::TestFormat::junit;
+      } else {
+        usage(argv[0]);
+        return 2;
+      }
+    } else if (const char* v = flag(arg, "out")) {
+      opts.output = v;
+    } else if (arg == "--list") {
+      list = true;
+    } else {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+
+  if (list) {
+    for (const auto& test : lab::TestRegistry::global().tests()) {
+      std::printf("%s\n", test.name.c_str());
+    }
+    return 0;
+  }
+
+  auto results = lab::run_tests(lab::TestRegistry::global(), opts);
+  int failed = 0;
+  for (const auto& r : results) {
+    std::printf("%-4s %-50s %8.3f ms\n", r.passed ? "ok" : "FAIL",
+                r.name.c_str(), r.seconds * 1e3);
+    for (const auto& f : r.failures) std::printf("     %s\n", f.c_str());
+    failed += !r.passed;
+  }
+  std::printf("%zu tests, %d failed\n", results.size(), failed);
+
+  std::ofstream out(opts.output);
+  if (!out) {
+    std::fprintf(stderr, "error: cannot open %s\n", opts.output.c_str());
+    return 2;
+  }
+  lab::write_test_results(out, results, opts.format);
+  if (!out) return 2;
+  return failed == 0 ? 0 : 1;
+}
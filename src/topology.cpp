@@ -0,0 +1,144 @@
+#include "lab/topology.hpp"
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+namespace lab {
+
+namespace {
+
+const cpu_set_t& startup_affinity() {
+  static const cpu_set_t mask = [] {
+    cpu_set_t m;
+    CPU_ZERO(&m);
+    if (sched_getaffinity(0, sizeof(m), &m) != 0) CPU_SET(0, &m);
+    return m;
+  }();
+  return mask;
+}
+
+// Read during static initialisation, before main() can pin anything.
+const cpu_set_t& startup_affinity_at_load = startup_affinity();
+
+}  // namespace
+
+int pin_thread(int cpu) {
+  startup_affinity();
+  if (cpu < 0) cpu = sched_getcpu();
+  if (cpu < 0) return -1;
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+    return -1;
+  }
+  return cpu;
+}
+
+std::vector<int> parse_cpu_list(const std::string& list) {
+  std::vector<int> cpus;
+  std::stringstream stream(list);
+  std::string range;
+  while (std::getline(stream, range, ',')) {
+    if (range.empty() || range == "\n") continue;
+    auto dash = range.find('-');
+    int lo = std::atoi(range.c_str());
+    int hi = dash == std::string::npos ? lo
+                                       : std::atoi(range.c_str() + dash + 1);
+    for (int c = lo; c <= hi; ++c) cpus.push_back(c);
+  }
+  return cpus;
+}
+
+void with_startup_affinity(const std::function<void()>& fn) {
+  cpu_set_t saved;
+  bool restore = sched_getaffinity(0, sizeof(saved), &saved) == 0;
+  const cpu_set_t& mask = startup_affinity();
+  pthread_setaffinity_np(pthread_self(), sizeof(mask), &mask);
+  fn();
+  if (restore) pthread_setaffinity_np(pthread_self(), sizeof(saved), &saved);
+}
+
+Topology Topology::detect() {
+  const cpu_set_t& allowed = startup_affinity();
+  auto usable = [&](int cpu) {
+    return cpu >= 0 && cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed);
+  };
+
+  Topology topo;
+  std::vector<int> seen;
+  for (int node = 0;; ++node) {
+    std::ifstream in("/sys/devices/system/node/node" + std::to_string(node) +
+                     "/cpulist");
+    if (!in) break;
+    std::string list;
+    std::getline(in, list);
+    std::vector<int> cpus;
+    for (int cpu : parse_cpu_list(list)) {
+      if (usable(cpu)) cpus.push_back(cpu);
+    }
+    seen.insert(seen.end(), cpus.begin(), cpus.end());
+    if (!cpus.empty()) {
+      topo.node_cpus.push_back(std::move(cpus));
+      topo.node_ids.push_back(node);
+    }
+  }
+
+  // No sysfs node info: one node with every allowed CPU.
+  if (topo.node_cpus.empty()) {
+    std::vector<int> cpus;
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+      if (usable(cpu)) cpus.push_back(cpu);
+    }
+    topo.node_cpus.push_back(std::move(cpus));
+    topo.node_ids.push_back(0);
+  }
+  return topo;
+}
+
+int Topology::cpu_count() const {
+  int n = 0;
+  for (const auto& cpus : node_cpus) n += static_cast<int>(cpus.size());
+  return n;
+}
+
+int Topology::node_of(int cpu) const {
+  for (std::size_t node = 0; node < node_cpus.size(); ++node) {
+    const auto& cpus = node_cpus[node];
+    if (std::find(cpus.begin(), cpus.end(), cpu) != cpus.end()) {
+      return static_cast<int>(node);
+    }
+  }
+  return -1;
+}
+
+std::vector<int> Topology::pick(int n, bool spread) const {
+  std::vector<int> order;
+  if (spread) {
+    for (std::size_t i = 0;; ++i) {
+      bool any = false;
+      for (const auto& cpus : node_cpus) {
+        if (i < cpus.size()) {
+          order.push_back(cpus[i]);
+          any = true;
+        }
+      }
+      if (!any) break;
+    }
+  } else {
+    for (const auto& cpus : node_cpus) {
+      order.insert(order.end(), cpus.begin(), cpus.end());
+    }
+  }
+  std::vector<int> picked;
+  if (order.empty()) return picked;
+  for (int i = 0; i < n; ++i) picked.push_back(order[i % order.size()]);
+  return picked;
+}
+
+}  // namespace lab
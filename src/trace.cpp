@@ -0,0 +1,252 @@
+#include "lab/trace.hpp"
+
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace lab::trace {
+
+namespace {
+
+struct OwnedBuffer {
+  detail::ThreadBuffer ring;
+  std::unique_ptr<detail::Slot[]> storage;
+  long tid = 0;
+  std::string thread_name;
+  // drain(): records before this index were visited, and scopes entered
+  // by then that had not been left yet.
+  std::uint64_t drained = 0;
+  std::vector<Record> open;
+};
+
+// Buffers outlive their threads so that a trace can be written after the
+// traced threads have exited. Never destroyed: detached threads may still
+// record during exit.
+struct State {
+  std::mutex mu;
+  std::unordered_map<std::string, std::uint32_t> ids;
+  std::vector<std::string> names;
+  std::vector<std::unique_ptr<OwnedBuffer>> buffers;
+  Options opts;
+  std::uint64_t start_ticks = 0;
+  std::chrono::steady_clock::time_point start_time;
+};
+
+State& state() {
+  static State* s = new State;
+  return *s;
+}
+
+std::size_t capacity(const Options& opts) {
+  std::size_t n = 1;
+  while (n < std::max<std::size_t>(opts.records_per_thread, 2)) n <<= 1;
+  return n;
+}
+
+void reset(OwnedBuffer& b, std::size_t n) {
+  b.storage = std::make_unique<detail::Slot[]>(n);
+  b.ring.records = b.storage.get();
+  b.ring.mask = n - 1;
+  b.ring.head.store(0, std::memory_order_relaxed);
+  b.drained = 0;
+  b.open.clear();
+}
+
+// Ticks become time through the rate observed since start().
+double us_per_tick(const State& s) {
+  std::uint64_t now_ticks = ticks();
+  double elapsed_us = std::chrono::duration<double, std::micro>(
+                          std::chrono::steady_clock::now() - s.start_time)
+                          .count();
+  if (now_ticks > s.start_ticks && elapsed_us > 0) {
+    return elapsed_us / static_cast<double>(now_ticks - s.start_ticks);
+  }
+  return 1e-3;
+}
+
+void set_error(std::string* error, std::string message) {
+  if (error != nullptr) *error = std::move(message);
+}
+
+void append_escaped(std::string& out, const std::string& s) {
+  for (char c : s) {
+    if (c == '"' || c == '\\') {
+      out += '\\';
+      out += c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      char buf[8];
+      std::snprintf(buf, sizeof buf, "\\u%04x", c);
+      out += buf;
+    } else {
+      out += c;
+    }
+  }
+}
+
+}  // namespace
+
+namespace detail {
+
+ThreadBuffer* register_thread() {
+  State& s = state();
+  std::lock_guard lock(s.mu);
+  if (s.buffers.size() >= s.opts.max_threads) return buffer = &overflow;
+  auto b = std::make_unique<OwnedBuffer>();
+  reset(*b, capacity(s.opts));
+  b->tid = static_cast<long>(::syscall(SYS_gettid));
+  char name[32] = {};
+  if (pthread_getname_np(pthread_self(), name, sizeof name) == 0) {
+    b->thread_name = name;
+  }
+  buffer = &b->ring;
+  s.buffers.push_back(std::move(b));
+  return buffer;
+}
+
+}  // namespace detail
+
+void start(const Options& opts) {
+  State& s = state();
+  {
+    std::lock_guard lock(s.mu);
+    s.opts = opts;
+    for (auto& b : s.buffers) reset(*b, capacity(opts));
+    s.start_time = std::chrono::steady_clock::now();
+    s.start_ticks = ticks();
+  }
+  set_enabled(true);
+}
+
+void stop() { set_enabled(false); }
+
+std::uint32_t intern(std::string_view name) {
+  State& s = state();
+  std::lock_guard lock(s.mu);
+  auto [it, inserted] = s.ids.try_emplace(
+      std::string(name), static_cast<std::uint32_t>(s.names.size()));
+  if (inserted) s.names.push_back(it->first);
+  return it->second;
+}
+
+bool write_json(const std::string& path, std::string* error) {
+  State& s = state();
+  std::lock_guard lock(s.mu);
+
+  const double us = us_per_tick(s);
+
+  std::string out = "{\"traceEvents\":[\n";
+  bool first = true;
+  auto separate = [&] {
+    if (!first) out += ",\n";
+    first = false;
+  };
+  int pid = static_cast<int>(::getpid());
+  char buf[128];
+  for (const auto& b : s.buffers) {
+    separate();
+    std::snprintf(buf, sizeof buf,
+                  "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,"
+                  "\"tid\":%ld,\"args\":{\"name\":\"",
+                  pid, b->tid);
+    out += buf;
+    append_escaped(out, b->thread_name);
+    out += "\"}}";
+
+    std::uint64_t head = b->ring.head.load(std::memory_order_acquire);
+    std::uint64_t size = b->ring.mask + 1;
+    std::uint64_t begin = head > size ? head - size : 0;
+    std::size_t depth = 0;
+    for (std::uint64_t i = begin; i < head; ++i) {
+      const Record r = b->ring.records[i & b->ring.mask].load();
+      // Its enter was overwritten when the ring wrapped.
+      if (r.end != 0 && depth == 0) continue;
+      depth = r.end != 0 ? depth - 1 : depth + 1;
+      double ts = r.ticks >= s.start_ticks
+                      ? static_cast<double>(r.ticks - s.start_ticks) *
+                            us
+                      : 0.0;
+      separate();
+      out += "{\"name\":\"";
+      if (r.name < s.names.size()) append_escaped(out, s.names[r.name]);
+      std::snprintf(buf, sizeof buf,
+                    "\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":%d,\"tid\":%ld}",
+                    r.end != 0 ? 'E' : 'B', ts, pid, b->tid);
+      out += buf;
+    }
+  }
+  out += "\n],\"displayTimeUnit\":\"ns\"}\n";
+
+  std::ofstream file(path, std::ios::binary);
+  file << out;
+  file.close();
+  if (!file) {
+    set_error(error, path + ": " + std::strerror(errno));
+    return false;
+  }
+  return true;
+}
+
+void drain(const std::function<void(std::uint32_t name, std::uint64_t ns)>&
+               visit) {
+  State& s = state();
+  std::lock_guard lock(s.mu);
+  const double ns_per_tick = 1e3 * us_per_tick(s);
+  std::vector<Record> copy;
+  for (const auto& b : s.buffers) {
+    const std::uint64_t size = b->ring.mask + 1;
+    std::uint64_t head = b->ring.head.load(std::memory_order_acquire);
+    std::uint64_t begin = std::max(b->drained, head > size ? head - size : 0);
+    copy.clear();
+    for (std::uint64_t i = begin; i < head; ++i) {
+      copy.push_back(b->ring.records[i & b->ring.mask].load());
+    }
+    // Pairs with the fence in record(): a slot copied above that a later
+    // record was rewriting shows up as head having moved past it, so any
+    // record at or below after - size may be torn and is skipped.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    std::uint64_t after = b->ring.head.load(std::memory_order_relaxed);
+    std::uint64_t valid = after + 1 > size ? after + 1 - size : 0;
+    std::size_t skip = valid > begin ? valid - begin : 0;
+    // Records lost since the last drain break the nesting.
+    if (begin > b->drained || skip > 0) b->open.clear();
+    b->drained = head;
+
+    for (std::size_t i = skip; i < copy.size(); ++i) {
+      const Record& r = copy[i];
+      if (r.end == 0) {
+        b->open.push_back(r);
+        continue;
+      }
+      // A leave without its enter: the enter was lost with everything
+      // older, so whatever is still open is unreliable too.
+      if (b->open.empty() || b->open.back().name != r.name) {
+        b->open.clear();
+        continue;
+      }
+      std::uint64_t entered = b->open.back().ticks;
+      b->open.pop_back();
+      std::uint64_t elapsed = r.ticks > entered ? r.ticks - entered : 0;
+      visit(r.name,
+            static_cast<std::uint64_t>(static_cast<double>(elapsed) *
+                                       ns_per_tick));
+    }
+  }
+}
+
+std::string name_of(std::uint32_t id) {
+  State& s = state();
+  std::lock_guard lock(s.mu);
+  return id < s.names.size() ? s.names[id] : std::string();
+}
+
+}  // namespace lab::trace
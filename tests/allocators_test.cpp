@@ -0,0 +1,177 @@
+#include <cstdint>
+#include <cstring>
+#include <memory_resource>
+#include <vector>
+
+#include "lab/alloc_counter.hpp"
+#include "lab/arena.hpp"
+#include "lab/bench.hpp"
+#include "lab/pool.hpp"
+#include "lab/runner.hpp"
+#include "lab/test.hpp"
+
+namespace {
+
+// Forwards to new/delete, counting what reaches it.
+class CountingResource final : public std::pmr::memory_resource {
+ public:
+  std::size_t allocs = 0;
+  std::size_t deallocs = 0;
+  std::size_t last_bytes = 0;
+
+ private:
+  void* do_allocate(std::size_t bytes, std::size_t align) override {
+    ++allocs;
+    last_bytes = bytes;
+    return std::pmr::new_delete_resource()->allocate(bytes, align);
+  }
+  void do_deallocate(void* p, std::size_t bytes, std::size_t align) override {
+    ++deallocs;
+    std::pmr::new_delete_resource()->deallocate(p, bytes, align);
+  }
+  bool do_is_equal(const memory_resource& other) const noexcept override {
+    return &other == this;
+  }
+};
+
+bool aligned(const void* p, std::size_t align) {
+  return reinterpret_cast<std::uintptr_t>(p) % align == 0;
+}
+
+LAB_TEST(arena_aligns_beyond_max_align) {
+  CountingResource upstream;
+  lab::Arena arena(4096, &upstream);
+  for (std::size_t align : {32, 64, 256, 1024}) {
+    arena.allocate(1);
+    void* p = arena.allocate(24, align);
+    LAB_CHECK(aligned(p, align));
+    std::memset(p, 1, 24);
+  }
+  // Alignment as large as the chunk size takes a chunk of its own.
+  void* big = arena.allocate(64, 4096);
+  LAB_CHECK(aligned(big, 4096));
+}
+
+LAB_TEST(arena_serves_requests_above_the_chunk_size) {
+  CountingResource upstream;
+  lab::Arena arena(4096, &upstream);
+  auto* small = static_cast<char*>(arena.allocate(16));
+  auto* big = static_cast<char*>(arena.allocate(10000));
+  LAB_REQUIRE(big != nullptr);
+  std::memset(big, 2, 10000);
+  LAB_CHECK(arena.capacity() >= 4096 + 10000);
+  LAB_CHECK_EQ(upstream.allocs, 2u);
+  small[0] = 1;
+  LAB_CHECK_EQ(big[9999], 2);
+  arena.release();
+  LAB_CHECK_EQ(upstream.deallocs, 2u);
+  LAB_CHECK_EQ(arena.capacity(), 0u);
+}
+
+LAB_TEST(arena_reset_reuses_its_chunks) {
+  CountingResource upstream;
+  lab::Arena arena(4096, &upstream);
+  auto fill = [&] {
+    for (int i = 0; i < 100; ++i) arena.allocate(100);
+  };
+  fill();
+  std::size_t chunks = upstream.allocs;
+  std::size_t used = arena.used();
+  std::size_t capacity = arena.capacity();
+  LAB_CHECK(chunks >= 3);
+  for (int round = 0; round < 3; ++round) {
+    arena.reset();
+    LAB_CHECK_EQ(arena.used(), 0u);
+    fill();
+  }
+  LAB_CHECK_EQ(upstream.allocs, chunks);
+  LAB_CHECK_EQ(arena.used(), used);
+  LAB_CHECK_EQ(arena.capacity(), capacity);
+}
+
+LAB_TEST(pool_size_class_boundaries) {
+  CountingResource upstream;
+  lab::Pool pool(&upstream);
+  // The largest class is pooled: one slab, blocks aligned to their size.
+  void* largest = pool.allocate(lab::Pool::kMaxClass);
+  LAB_CHECK_EQ(upstream.allocs, 1u);
+  LAB_CHECK_EQ(upstream.last_bytes, lab::Pool::kSlabSize);
+  LAB_CHECK(aligned(largest, lab::Pool::kMaxClass));
+  void* second = pool.allocate(lab::Pool::kMaxClass);
+  LAB_CHECK_EQ(upstream.allocs, 1u);
+  LAB_CHECK(second != largest);
+
+  // One byte more, or a stricter alignment, goes straight upstream.
+  void* over = pool.allocate(lab::Pool::kMaxClass + 1);
+  LAB_CHECK_EQ(upstream.allocs, 2u);
+  LAB_CHECK_EQ(upstream.last_bytes, lab::Pool::kMaxClass + 1);
+  pool.deallocate(over, lab::Pool::kMaxClass + 1);
+  LAB_CHECK_EQ(upstream.deallocs, 1u);
+  void* strict = pool.allocate(8, 2 * lab::Pool::kMaxClass);
+  LAB_CHECK_EQ(upstream.allocs, 3u);
+  LAB_CHECK(aligned(strict, 2 * lab::Pool::kMaxClass));
+  pool.deallocate(strict, 8, 2 * lab::Pool::kMaxClass);
+
+  // The smallest class takes requests below it.
+  void* tiny = pool.allocate(1, 1);
+  LAB_CHECK_EQ(upstream.allocs, 4u);
+  LAB_CHECK(aligned(tiny, lab::Pool::kMinClass));
+  LAB_CHECK_EQ(pool.capacity(), 2 * lab::Pool::kSlabSize);
+  pool.release();
+  LAB_CHECK_EQ(upstream.deallocs, 4u);
+}
+
+LAB_TEST(pool_reuses_freed_blocks) {
+  CountingResource upstream;
+  lab::Pool pool(&upstream);
+  void* a = pool.allocate(64);
+  void* b = pool.allocate(64);
+  LAB_CHECK(a != b);
+  pool.deallocate(a, 64);
+  LAB_CHECK_EQ(pool.allocate(64), a);
+  // 40 bytes share the 64-byte class, and its free list.
+  pool.deallocate(b, 64);
+  LAB_CHECK_EQ(pool.allocate(40), b);
+  LAB_CHECK_EQ(upstream.allocs, 1u);
+
+  lab::PoolResource resource(pool);
+  std::pmr::vector<int> v(&resource);
+  for (int i = 0; i < 1000; ++i) v.push_back(i);
+  LAB_CHECK_EQ(v[999], 999);
+  LAB_CHECK(resource == lab::PoolResource(pool));
+  lab::Pool other;
+  LAB_CHECK(resource != lab::PoolResource(other));
+}
+
+LAB_TEST(alloc_counter_reports_allocs_per_op) {
+  if (!lab::alloc_counting_enabled()) return;
+  // Two allocations per op; the ones made with timing paused do not count.
+  lab::Benchmark bench{"allocs", [](lab::State& state) {
+                         for (auto _ : state) {
+                           auto* i = new int(1);
+                           lab::do_not_optimize(i);
+                           auto* s = new char[40];
+                           lab::do_not_optimize(s);
+                           delete[] s;
+                           delete i;
+                           state.pause_timing();
+                           std::vector<int> setup(16);
+                           lab::do_not_optimize(setup);
+                           state.resume_timing();
+                         }
+                       },
+                       {}};
+  lab::RunnerOptions opts;
+  opts.warmup_seconds = 0.001;
+  opts.min_seconds = 0.005;
+  opts.samples = 2;
+  opts.latency = false;
+  lab::Result r = lab::run_benchmark(bench, {}, opts);
+  const double* allocs = r.counter("allocs_per_op");
+  const double* bytes = r.counter("alloc_bytes_per_op");
+  LAB_REQUIRE(allocs != nullptr && bytes != nullptr);
+  LAB_CHECK_EQ(*allocs, 2.0);
+  LAB_CHECK_EQ(*bytes, static_cast<double>(sizeof(int) + 40));
+}
+
+}  // namespace
@@ -0,0 +1,78 @@
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "lab/archive.hpp"
+#include "lab/test.hpp"
+
+namespace {
+
+std::string temp_path(const char* name) {
+  return "/tmp/lab_test_" + std::to_string(::getpid()) + "_" + name;
+}
+
+LAB_TEST(archive_append_and_trend) {
+  std::string path = temp_path("trend.lab");
+  std::vector<lab::Result> run(3);
+  run[0].name = "zeta";
+  run[1].name = "alpha";
+  run[2].name = "mid";
+  run[2].counters = {{"ipc", 1.5}};
+  for (int day = 0; day < 3; ++day) {
+    for (auto& r : run) r.ns_per_op = 10 + day;
+    std::string error;
+    LAB_REQUIRE(lab::append_run(
+        path, {"c" + std::to_string(day), 100 + day, "host"}, run, &error));
+  }
+
+  lab::Archive archive;
+  LAB_REQUIRE(archive.open(path));
+  LAB_CHECK_EQ(archive.size(), 3u);
+  lab::Archive::Run first = archive.run(0);
+  LAB_CHECK_EQ(first.commit(), "c0");
+  LAB_CHECK_EQ(first.host(), "host");
+  LAB_CHECK_EQ(first.rows(), 3u);
+  LAB_CHECK_EQ(first.find("alpha"), 1);
+  LAB_CHECK_EQ(first.find("zeta"), 0);
+  LAB_CHECK_EQ(first.find("nope"), -1);
+  const double* ipc = first.metric("ipc");
+  LAB_REQUIRE(ipc != nullptr);
+  LAB_CHECK(std::isnan(ipc[0]));
+  LAB_CHECK_EQ(ipc[2], 1.5);
+
+  auto points = lab::trend(archive, "mid", "ns_per_op");
+  LAB_REQUIRE(points.size() == 3);
+  LAB_CHECK_EQ(points[2].timestamp, 102);
+  LAB_CHECK_EQ(points[2].commit, "c2");
+  LAB_CHECK_EQ(points[2].value, 12.0);
+  LAB_CHECK(lab::trend(archive, "alpha", "ipc").empty());
+  std::remove(path.c_str());
+}
+
+LAB_TEST(archive_ignores_torn_tail) {
+  std::string path = temp_path("torn.lab");
+  std::vector<lab::Result> run(1);
+  run[0].name = "x";
+  LAB_REQUIRE(lab::append_run(path, {"a", 1, "h"}, run));
+  struct stat st;
+  LAB_REQUIRE(::stat(path.c_str(), &st) == 0);
+  LAB_REQUIRE(lab::append_run(path, {"b", 2, "h"}, run));
+  // Cut the second block short, as a crash mid-append would.
+  LAB_REQUIRE(::truncate(path.c_str(), st.st_size + 24) == 0);
+  lab::Archive archive;
+  LAB_REQUIRE(archive.open(path));
+  LAB_CHECK_EQ(archive.size(), 1u);
+
+  // The next append replaces the torn block rather than landing behind it.
+  LAB_REQUIRE(lab::append_run(path, {"c", 3, "h"}, run));
+  LAB_REQUIRE(archive.open(path));
+  LAB_REQUIRE(archive.size() == 2);
+  LAB_CHECK_EQ(archive.run(1).commit(), "c");
+  std::remove(path.c_str());
+}
+
+}  // namespace
@@ -0,0 +1,73 @@
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "lab/bench.hpp"
+#include "lab/test.hpp"
+
+namespace {
+
+// Records which instantiation ran.
+std::string ran;
+
+template <class T, int kN>
+void typed_value(lab::State&) {
+  ran = std::string(lab::type_name<T>()) + "," + std::to_string(kN) +
+        "," + std::to_string(sizeof(T) * kN);
+}
+
+enum class Mode : std::uint8_t { a = 3 };
+
+std::vector<std::string> names(const lab::Registry& registry) {
+  std::vector<std::string> out;
+  for (const auto& b : registry.benchmarks()) out.push_back(b.name);
+  return out;
+}
+
+LAB_TEST(type_and_value_names) {
+  LAB_CHECK_EQ(lab::type_name<float>(), "float");
+  LAB_CHECK_EQ(lab::type_name<std::string>().substr(0, 5), "std::");
+  LAB_CHECK_EQ(lab::value_name<64>(), "64");
+  LAB_CHECK_EQ(lab::value_name<-1L>(), "-1");
+  LAB_CHECK_EQ(lab::value_name<true>(), "true");
+  LAB_CHECK_EQ(lab::value_name<Mode::a>(), "3");
+}
+
+LAB_TEST(bench_template_registers_every_combination) {
+  lab::Registry registry;
+  lab::detail::add_instances(
+      registry, "typed_value",
+      []<class T, auto V>(lab::State& s) { typed_value<T, V>(s); },
+      lab::types<char, double>{}, lab::values<2, 8>{},
+      {{"size", {1, 2}}});
+  LAB_CHECK(names(registry) ==
+            (std::vector<std::string>{"typed_value<char,2>",
+                                      "typed_value<char,8>",
+                                      "typed_value<double,2>",
+                                      "typed_value<double,8>"}));
+  for (const auto& b : registry.benchmarks()) {
+    LAB_CHECK_EQ(b.params.size(), 1u);
+  }
+  lab::State state(1);
+  registry.benchmarks()[3].fn(state);
+  LAB_CHECK_EQ(ran, "double,8,64");
+}
+
+LAB_TEST(bench_template_single_axis) {
+  lab::Registry registry;
+  lab::detail::add_instances(
+      registry, "t", []<class T>(lab::State&) { ran = lab::type_name<T>(); },
+      lab::types<int, unsigned>{}, {});
+  lab::detail::add_instances(
+      registry, "v", []<auto V>(lab::State&) { ran = lab::value_name<V>(); },
+      lab::values<4, 16>{}, {});
+  LAB_CHECK(names(registry) == (std::vector<std::string>{
+                                   "t<int>", "t<unsigned int>", "v<4>",
+                                   "v<16>"}));
+  lab::State state(1);
+  registry.benchmarks()[3].fn(state);
+  LAB_CHECK_EQ(ran, "16");
+  LAB_CHECK(registry.benchmarks()[0].params.empty());
+}
+
+}  // namespace
@@ -0,0 +1,95 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "lab/bitpack.hpp"
+#include "lab/test.hpp"
+
+namespace {
+
+namespace bitpack = lab::bitpack;
+
+std::vector<std::byte> round_trip(lab::TestContext& lab_test_context,
+                                  const std::vector<std::byte>& in) {
+  std::vector<std::byte> packed(bitpack::bound(in.size()));
+  std::size_t size = bitpack::compress(in.data(), in.size(), packed.data());
+  LAB_CHECK_LE(size, packed.size());
+  packed.resize(size);
+  std::size_t n = 0;
+  LAB_CHECK(bitpack::decompressed_size(packed.data(), packed.size(), n));
+  LAB_CHECK_EQ(n, in.size());
+  std::vector<std::byte> out(in.size());
+  LAB_CHECK(bitpack::decompress(packed.data(), packed.size(), out.data(),
+                                out.size()));
+  LAB_CHECK(out == in);
+  return packed;
+}
+
+std::vector<std::byte> bytes_of(const std::vector<std::uint32_t>& words,
+                                std::size_t extra = 0) {
+  std::vector<std::byte> out(words.size() * 4 + extra, std::byte{0x5a});
+  std::memcpy(out.data(), words.data(), words.size() * 4);
+  return out;
+}
+
+// Every length around the block size, every width, and odd trailing bytes.
+LAB_TEST(bitpack_round_trips) {
+  std::uint64_t rng = 1;
+  auto next = [&rng] {
+    rng = rng * 6364136223846793005ull + 1442695040888963407ull;
+    return static_cast<std::uint32_t>(rng >> 32);
+  };
+  for (std::size_t n : {0, 1, 5, 127, 128, 129, 256, 1000}) {
+    for (unsigned w = 0; w <= 32; w += 4) {
+      std::vector<std::uint32_t> words(n);
+      std::uint32_t x = next();
+      for (auto& v : words) {
+        std::uint32_t step = w == 32 ? next() : next() & ((1u << w) - 1);
+        v = x += step;
+      }
+      for (std::size_t extra = 0; extra < 4; ++extra) {
+        round_trip(lab_test_context, bytes_of(words, extra));
+      }
+    }
+  }
+}
+
+LAB_TEST(bitpack_packs_small_deltas) {
+  // A counter stepping by 0..7: 4 bits per zigzag delta, an eighth of the
+  // input plus block headers.
+  std::vector<std::uint32_t> counter(64 * 1024);
+  for (std::size_t i = 1; i < counter.size(); ++i) {
+    counter[i] = counter[i - 1] + static_cast<std::uint32_t>(i * 7 % 8);
+  }
+  auto packed = round_trip(lab_test_context, bytes_of(counter));
+  LAB_CHECK_LE(packed.size(), counter.size() * 4 / 8 + counter.size() / 64);
+
+  // A constant series takes one width byte per block.
+  std::vector<std::uint32_t> flat(1024, 7);
+  LAB_CHECK_EQ(round_trip(lab_test_context, bytes_of(flat)).size(),
+               8 + 1024 / bitpack::kBlock + 16 * 4);
+}
+
+LAB_TEST(bitpack_rejects_malformed) {
+  std::vector<std::uint32_t> words(300);
+  for (std::size_t i = 0; i < words.size(); ++i) {
+    words[i] = static_cast<std::uint32_t>(i * i);
+  }
+  std::vector<std::byte> in = bytes_of(words, 2);
+  std::vector<std::byte> packed = round_trip(lab_test_context, in);
+  std::vector<std::byte> out(in.size());
+  std::size_t n = 0;
+  LAB_CHECK(!bitpack::decompressed_size(packed.data(), 7, n));
+  for (std::size_t size = 0; size < packed.size(); ++size) {
+    LAB_CHECK(!bitpack::decompress(packed.data(), size, out.data(),
+                                   out.size()));
+  }
+  LAB_CHECK(!bitpack::decompress(packed.data(), packed.size(), out.data(),
+                                 out.size() - 1));
+  packed[8] = std::byte{33};
+  LAB_CHECK(!bitpack::decompress(packed.data(), packed.size(), out.data(),
+                                 out.size()));
+}
+
+}  // namespace
@@ -0,0 +1,38 @@
+#include <string>
+
+#include "lab/calibrate.hpp"
+#include "lab/runner.hpp"
+#include "lab/test.hpp"
+
+namespace {
+
+LAB_TEST(calibrate_rows_are_named_and_run) {
+  const auto& benchmarks = lab::calibration_registry().benchmarks();
+  LAB_REQUIRE(benchmarks.size() == 7);
+  for (const auto& bench : benchmarks) {
+    LAB_CHECK_EQ(bench.name.rfind("calibrate/", 0), 0u);
+  }
+
+  // The smallest chase and TLB points, briefly: a cycle through 16 KiB
+  // or 16 blocks must stay within a few ns per load.
+  lab::RunnerOptions opts;
+  opts.warmup_seconds = 0.001;
+  opts.min_seconds = 0.005;
+  opts.samples = 3;
+  opts.latency = false;
+  opts.pin = false;
+  for (const auto& bench : benchmarks) {
+    if (bench.name != "calibrate/chase" && bench.name != "calibrate/tlb/2m") {
+      continue;
+    }
+    lab::ParamValues point{{bench.params[0].name, bench.params[0].values[0]}};
+    lab::Result r = lab::run_benchmark(bench, point, opts);
+    LAB_CHECK(r.ns_per_op > 0);
+    LAB_CHECK(r.ns_per_op < 100);
+    if (bench.name == "calibrate/tlb/2m") {
+      LAB_CHECK(r.counter("huge_pages") != nullptr);
+    }
+  }
+}
+
+}  // namespace
@@ -0,0 +1,156 @@
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "lab/dataset.hpp"
+#include "lab/test.hpp"
+
+namespace {
+
+namespace fs = std::filesystem;
+
+struct TempDir {
+  explicit TempDir(const char* name)
+      : path("/tmp/lab_test_" + std::to_string(::getpid()) + "_" + name) {
+    fs::remove_all(path);
+  }
+  ~TempDir() { fs::remove_all(path); }
+  std::string path;
+};
+
+LAB_TEST(dataset_xxh64_reference_values) {
+  LAB_CHECK_EQ(lab::dataset::xxh64("", 0), 0xef46db3751d8e999ull);
+  LAB_CHECK_EQ(lab::dataset::xxh64("a", 1), 0xd24ec4f1a98c6e5bull);
+  // Long enough for the four-lane loop and every tail.
+  std::string text(103, 'x');
+  for (std::size_t i = 0; i < text.size(); ++i) {
+    text[i] = static_cast<char>('a' + i % 26);
+  }
+  LAB_CHECK(lab::dataset::xxh64(text.data(), text.size()) !=
+            lab::dataset::xxh64(text.data(), text.size() - 1));
+}
+
+LAB_TEST(dataset_generated_once_then_mapped) {
+  TempDir dir("dataset_once");
+  int fills = 0;
+  lab::dataset::Fill fill = [&](std::uint64_t seed, std::span<std::byte> out) {
+    ++fills;
+    lab::dataset::uniform(seed, out);
+  };
+  lab::dataset::Key key{"uniform", 7, 100003};
+  std::string error;
+  lab::dataset::Dataset first;
+  LAB_REQUIRE(lab::dataset::open(key, fill, first, &error, dir.path));
+  LAB_CHECK_EQ(first.size(), 100003u);
+  LAB_CHECK(lab::dataset::verify(first));
+
+  lab::dataset::Dataset second;
+  LAB_REQUIRE(lab::dataset::open(key, fill, second, &error, dir.path));
+  LAB_CHECK_EQ(fills, 1);
+  LAB_CHECK_EQ(second.digest(), first.digest());
+  LAB_CHECK_EQ(second.path(), first.path());
+  LAB_CHECK(std::memcmp(first.data(), second.data(), first.size()) == 0);
+  LAB_CHECK_EQ(second.as<std::uint64_t>().size(), 100003u / 8);
+
+  // Another seed is another dataset.
+  lab::dataset::Dataset other;
+  LAB_REQUIRE(lab::dataset::open({"uniform", 8, 100003}, fill, other, &error,
+                                 dir.path));
+  LAB_CHECK_EQ(fills, 2);
+  LAB_CHECK(other.digest() != first.digest());
+}
+
+LAB_TEST(dataset_objects_are_content_addressed) {
+  TempDir dir("dataset_dedup");
+  auto zeros = [](std::uint64_t, std::span<std::byte> out) {
+    for (auto& b : out) b = std::byte{0};
+  };
+  lab::dataset::Dataset a, b;
+  LAB_REQUIRE(lab::dataset::open({"zeros", 1, 4096}, zeros, a, nullptr,
+                                 dir.path));
+  LAB_REQUIRE(lab::dataset::open({"zeros v2/odd.name", 2, 4096}, zeros, b,
+                                 nullptr, dir.path));
+  LAB_CHECK_EQ(a.path(), b.path());
+  std::size_t objects = 0;
+  for (const auto& e : fs::directory_iterator(dir.path + "/objects")) {
+    objects += e.path().filename().string().rfind("xxh64-", 0) == 0;
+  }
+  LAB_CHECK_EQ(objects, 1u);
+  std::size_t keys = 0;
+  for (const auto& e : fs::directory_iterator(dir.path + "/keys")) {
+    static_cast<void>(e);
+    ++keys;
+  }
+  LAB_CHECK_EQ(keys, 2u);
+}
+
+LAB_TEST(dataset_missing_object_is_regenerated) {
+  TempDir dir("dataset_missing");
+  int fills = 0;
+  auto fill = [&](std::uint64_t seed, std::span<std::byte> out) {
+    ++fills;
+    lab::dataset::uniform(seed, out);
+  };
+  std::string path;
+  {
+    lab::dataset::Dataset d;
+    LAB_REQUIRE(lab::dataset::open({"u", 1, 64}, fill, d, nullptr, dir.path));
+    path = d.path();
+  }
+  fs::remove(path);
+  lab::dataset::Dataset d;
+  LAB_REQUIRE(lab::dataset::open({"u", 1, 64}, fill, d, nullptr, dir.path));
+  LAB_CHECK_EQ(fills, 2);
+  LAB_CHECK(lab::dataset::verify(d));
+}
+
+// Prefaulted and huge-page copies read the same bytes and unmap cleanly.
+LAB_TEST(dataset_page_options) {
+  TempDir dir("dataset_pages");
+  lab::dataset::Key key{"uniform", 3, 3 << 20};
+  std::string error;
+  lab::dataset::Dataset plain;
+  LAB_REQUIRE(lab::dataset::open(key, lab::dataset::uniform, plain, &error,
+                                 dir.path));
+  for (lab::PageOptions pages :
+       {lab::PageOptions{.populate = true}, lab::PageOptions{.thp = true},
+        lab::PageOptions{.hugetlb = true}}) {
+    lab::dataset::Dataset d;
+    LAB_REQUIRE(lab::dataset::open(key, lab::dataset::uniform, d, pages,
+                                   &error, dir.path));
+    LAB_CHECK_EQ(d.size(), plain.size());
+    LAB_CHECK(std::memcmp(d.data(), plain.data(), d.size()) == 0);
+    LAB_CHECK(lab::dataset::verify(d));
+    lab::dataset::Dataset moved = std::move(d);
+    LAB_CHECK(lab::dataset::verify(moved));
+  }
+}
+
+LAB_TEST(dataset_zipf_is_skewed_and_in_range) {
+  std::vector<std::uint64_t> ranks(100000);
+  lab::dataset::zipf(1000, 0.99)(
+      3, std::as_writable_bytes(std::span<std::uint64_t>(ranks)));
+  std::vector<std::size_t> counts(1001);
+  for (auto r : ranks) {
+    LAB_REQUIRE(r >= 1 && r <= 1000);
+    ++counts[r];
+  }
+  LAB_CHECK(counts[1] > counts[2]);
+  LAB_CHECK(counts[2] > counts[10]);
+  LAB_CHECK(counts[10] > counts[500]);
+  // About 1/H(1000, 0.99) ~ 13% of draws are rank 1.
+  LAB_CHECK(counts[1] > 10000 && counts[1] < 17000);
+
+  // A pure function of the seed.
+  std::vector<std::uint64_t> again(ranks.size());
+  lab::dataset::zipf(1000, 0.99)(
+      3, std::as_writable_bytes(std::span<std::uint64_t>(again)));
+  LAB_CHECK(again == ranks);
+}
+
+}  // namespace
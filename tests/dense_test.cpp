@@ -0,0 +1,71 @@
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "lab/dense.hpp"
+#include "lab/test.hpp"
+
+namespace {
+
+// Small odd sizes, so partial tiles and uneven splits are exercised.
+std::vector<double> matrix(std::size_t rows, std::size_t cols,
+                           std::uint64_t seed) {
+  std::vector<double> m(rows * cols);
+  for (auto& v : m) {
+    seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+    v = static_cast<double>(seed >> 56);
+  }
+  return m;
+}
+
+LAB_TEST(dense_gemm_forms_agree) {
+  constexpr std::size_t m = 37, n = 70, k = 53;
+  auto a = matrix(m, k, 1), b = matrix(k, n, 2);
+  std::vector<double> want(m * n, 1.0);
+  lab::dense::gemm_naive(a.data(), b.data(), want.data(), m, n, k);
+  // Integer-valued inputs, so every summation order is exact.
+  std::vector<double> tiled(m * n, 1.0), recursive(m * n, 1.0);
+  lab::dense::gemm_tiled<16>(a.data(), b.data(), tiled.data(), m, n, k);
+  lab::dense::gemm_recursive(a.data(), b.data(), recursive.data(), m, n, k, 8);
+  LAB_CHECK(tiled == want);
+  LAB_CHECK(recursive == want);
+}
+
+LAB_TEST(dense_transpose_forms_agree) {
+  constexpr std::size_t rows = 45, cols = 71;
+  auto in = matrix(rows, cols, 3);
+  std::vector<double> want(rows * cols), tiled(rows * cols),
+      recursive(rows * cols);
+  lab::dense::transpose_naive(in.data(), want.data(), rows, cols);
+  lab::dense::transpose_tiled<8>(in.data(), tiled.data(), rows, cols);
+  lab::dense::transpose_recursive(in.data(), recursive.data(), rows, cols, 4);
+  LAB_CHECK_EQ(want[5 * rows + 3], in[3 * cols + 5]);
+  LAB_CHECK(tiled == want);
+  LAB_CHECK(recursive == want);
+}
+
+// The time-skewed forms must compute exactly the same values as the plain
+// sweep, step for step, including a final partial time block.
+template <class Stencil>
+void check_stencil(lab::TestContext& lab_test_context, Stencil stencil) {
+  for (std::size_t n : {3, 4, 19, 50}) {
+    for (std::size_t steps : {0, 1, 7, 16}) {
+      auto a = matrix(n, n, n + steps);
+      auto b = a;
+      auto want_a = a, want_b = b;
+      lab::dense::stencil_naive(want_a.data(), want_b.data(), n, steps);
+      stencil(a.data(), b.data(), n, steps);
+      const auto& want = steps % 2 == 0 ? want_a : want_b;
+      const auto& got = steps % 2 == 0 ? a : b;
+      LAB_CHECK(got == want);
+    }
+  }
+}
+
+LAB_TEST(dense_stencil_forms_agree) {
+  check_stencil(lab_test_context, lab::dense::stencil_tiled<4, double>);
+  check_stencil(lab_test_context, lab::dense::stencil_tiled<16, double>);
+  check_stencil(lab_test_context, lab::dense::stencil_recursive<double>);
+}
+
+}  // namespace
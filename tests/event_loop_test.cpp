@@ -0,0 +1,162 @@
+// lab::task and lab::EventLoop. Where the kernel refuses io_uring the
+// loop tests pass without doing anything.
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "lab/event_loop.hpp"
+#include "lab/io.hpp"
+#include "lab/scheduler.hpp"
+#include "lab/task.hpp"
+#include "lab/test.hpp"
+
+namespace {
+
+lab::task<int> add(int a, int b) { co_return a + b; }
+
+lab::task<int> sum_to(int n) {
+  int total = 0;
+  for (int i = 1; i <= n; ++i) total = co_await add(total, i);
+  co_return total;
+}
+
+lab::task<int> throws() {
+  co_await add(1, 2);
+  throw std::runtime_error("boom");
+}
+
+lab::task<> echo_server(lab::EventLoop& loop, int fd) {
+  char buf[256];
+  for (int n; (n = co_await loop.read(fd, buf, sizeof buf)) > 0;) {
+    co_await loop.write(fd, buf, static_cast<std::size_t>(n));
+  }
+  ::close(fd);
+}
+
+lab::task<> echo_client(lab::EventLoop& loop, int fd, int id, int& ok) {
+  for (int i = 0; i < 50; ++i) {
+    std::string msg = std::to_string(id) + ":" + std::to_string(i);
+    co_await loop.write(fd, msg.data(), msg.size());
+    char buf[64];
+    int n = co_await loop.read(fd, buf, sizeof buf);
+    if (n > 0 && std::string(buf, static_cast<std::size_t>(n)) == msg) ++ok;
+  }
+  ::close(fd);
+}
+
+bool make_loop(lab::EventLoop& loop, lab::TestContext& context) {
+  if (!lab::io::backend_available(lab::io::Backend::uring)) return false;
+  std::string error;
+  if (loop.init(lab::EventLoop::Options{64, 256}, &error)) return true;
+  context.fail(__FILE__, __LINE__, error);
+  return false;
+}
+
+LAB_TEST(task_chains_and_propagates_exceptions) {
+  lab::EventLoop loop;
+  if (!make_loop(loop, lab_test_context)) return;
+  LAB_CHECK_EQ(loop.run(sum_to(100)), 5050);
+  bool caught = false;
+  try {
+    loop.run(throws());
+  } catch (const std::runtime_error&) {
+    caught = true;
+  }
+  LAB_CHECK(caught);
+  LAB_CHECK_EQ(loop.live(), 0u);
+}
+
+LAB_TEST(event_loop_echoes_over_socketpairs) {
+  lab::EventLoop loop;
+  if (!make_loop(loop, lab_test_context)) return;
+  int ok = 0;
+  std::vector<lab::task<>> clients;
+  for (int id = 0; id < 8; ++id) {
+    int fds[2];
+    LAB_REQUIRE(socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) == 0);
+    loop.spawn(echo_server(loop, fds[1]));
+    clients.push_back(echo_client(loop, fds[0], id, ok));
+  }
+  loop.run(lab::when_all(std::move(clients)));
+  LAB_CHECK_EQ(ok, 8 * 50);
+  loop.run();  // servers see EOF and exit
+  LAB_CHECK_EQ(loop.live(), 0u);
+}
+
+LAB_TEST(event_loop_accepts_and_connects) {
+  lab::EventLoop loop;
+  if (!make_loop(loop, lab_test_context)) return;
+  int listener = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t len = sizeof addr;
+  LAB_REQUIRE(bind(listener, reinterpret_cast<sockaddr*>(&addr), len) == 0);
+  LAB_REQUIRE(listen(listener, 16) == 0);
+  LAB_REQUIRE(getsockname(listener, reinterpret_cast<sockaddr*>(&addr),
+                          &len) == 0);
+
+  auto server = [](lab::EventLoop& loop, int listener) -> lab::task<int> {
+    int fd = co_await loop.accept(listener);
+    if (fd < 0) co_return fd;
+    char c = 0;
+    int n = co_await loop.read(fd, &c, 1);
+    ::close(fd);
+    co_return n == 1 ? c : -1;
+  };
+  auto client = [](lab::EventLoop& loop, sockaddr_in addr) -> lab::task<> {
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (co_await loop.connect(fd, reinterpret_cast<sockaddr*>(&addr),
+                              sizeof addr) == 0) {
+      co_await loop.write(fd, "x", 1);
+    }
+    ::close(fd);
+  };
+  loop.spawn(client(loop, addr));
+  LAB_CHECK_EQ(loop.run(server(loop, listener)), 'x');
+  loop.run();
+  ::close(listener);
+}
+
+LAB_TEST(event_loop_sleeps) {
+  lab::EventLoop loop;
+  if (!make_loop(loop, lab_test_context)) return;
+  auto start = std::chrono::steady_clock::now();
+  auto nap = [](lab::EventLoop& loop) -> lab::task<int> {
+    co_return co_await loop.sleep_for(std::chrono::milliseconds(5));
+  };
+  LAB_CHECK_EQ(loop.run(nap(loop)), 0);
+  LAB_CHECK(std::chrono::steady_clock::now() - start >=
+            std::chrono::milliseconds(5));
+}
+
+LAB_TEST(event_loop_offloads_to_scheduler) {
+  lab::EventLoop loop;
+  if (!make_loop(loop, lab_test_context)) return;
+  lab::Scheduler pool({.threads = 2, .pin = false});
+  auto work = [](lab::EventLoop& loop, lab::Scheduler& pool) -> lab::task<bool> {
+    auto loop_thread = std::this_thread::get_id();
+    std::vector<lab::task<>> parts;
+    int results[16] = {};
+    for (int i = 0; i < 16; ++i) {
+      parts.push_back([](lab::EventLoop& loop, lab::Scheduler& pool,
+                         int i, int& out) -> lab::task<> {
+        out = co_await loop.offload(pool, [i] { return i * i; });
+      }(loop, pool, i, results[i]));
+    }
+    co_await lab::when_all(std::move(parts));
+    bool ok = std::this_thread::get_id() == loop_thread;
+    for (int i = 0; i < 16; ++i) ok = ok && results[i] == i * i;
+    co_return ok;
+  };
+  LAB_CHECK(loop.run(work(loop, pool)));
+}
+
+}  // namespace
@@ -0,0 +1,78 @@
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "lab/flat_map.hpp"
+#include "lab/test.hpp"
+
+namespace {
+
+// Random inserts and erases checked against std::unordered_map, with a
+// small key range so that tombstones and in-place rehashes happen.
+template <class Hash>
+void differential(lab::TestContext& lab_test_context) {
+  lab::FlatMap<std::uint32_t, std::uint32_t, Hash> flat;
+  std::unordered_map<std::uint32_t, std::uint32_t> ref;
+  std::uint64_t x = 1;
+  for (int i = 0; i < 200000; ++i) {
+    x = x * 6364136223846793005ull + 1442695040888963407ull;
+    auto key = static_cast<std::uint32_t>(x >> 33) % 5000;
+    switch ((x >> 20) % 3) {
+      case 0:
+        LAB_CHECK_EQ(flat.insert(key, i), ref.emplace(key, i).second);
+        break;
+      case 1:
+        LAB_CHECK_EQ(flat.erase(key), ref.erase(key) == 1);
+        break;
+      default: {
+        auto it = ref.find(key);
+        const std::uint32_t* v = flat.find(key);
+        LAB_REQUIRE((v != nullptr) == (it != ref.end()));
+        if (v != nullptr) LAB_CHECK_EQ(*v, it->second);
+      }
+    }
+    LAB_REQUIRE(flat.size() == ref.size());
+  }
+  std::size_t seen = 0;
+  flat.for_each([&](std::uint32_t key, std::uint32_t value) {
+    ++seen;
+    LAB_CHECK_EQ(ref.at(key), value);
+  });
+  LAB_CHECK_EQ(seen, ref.size());
+}
+
+// Everything collides into one group chain and shares one tag.
+struct ConstantHash {
+  std::size_t operator()(std::uint32_t) const { return 0; }
+};
+
+LAB_TEST(flat_map_matches_unordered_map) {
+  differential<lab::MixHash<std::uint32_t>>(lab_test_context);
+}
+
+LAB_TEST(flat_map_survives_constant_hash) {
+  lab::FlatMap<std::uint32_t, std::uint32_t, ConstantHash> flat;
+  for (std::uint32_t i = 0; i < 300; ++i) LAB_REQUIRE(flat.insert(i, i));
+  for (std::uint32_t i = 0; i < 300; i += 2) LAB_REQUIRE(flat.erase(i));
+  for (std::uint32_t i = 0; i < 300; ++i) {
+    LAB_CHECK_EQ(flat.contains(i), i % 2 == 1);
+  }
+}
+
+LAB_TEST(flat_map_owns_non_trivial_values) {
+  auto tracked = std::make_shared<int>(7);
+  {
+    lab::FlatMap<std::string, std::shared_ptr<int>> map;
+    for (int i = 0; i < 1000; ++i) map["key" + std::to_string(i)] = tracked;
+    LAB_CHECK_EQ(tracked.use_count(), 1001);
+    for (int i = 0; i < 500; ++i) map.erase("key" + std::to_string(i));
+    LAB_CHECK_EQ(tracked.use_count(), 501);
+    lab::FlatMap<std::string, std::shared_ptr<int>> moved = std::move(map);
+    LAB_CHECK_EQ(moved.size(), 500u);
+    LAB_CHECK(*moved.find("key999") == tracked);
+  }
+  LAB_CHECK_EQ(tracked.use_count(), 1);
+}
+
+}  // namespace
@@ -0,0 +1,97 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+
+#include "lab/flat.hpp"
+#include "lab/test.hpp"
+
+namespace {
+
+struct Part {
+  std::uint64_t id;
+  lab::flat::String name;
+};
+
+struct Doc {
+  std::uint32_t version;
+  lab::flat::String title;
+  lab::flat::Vector<Part> parts;
+  lab::flat::Vector<lab::flat::String> tags;
+};
+
+std::string build(lab::flat::Builder& b) {
+  b.clear();
+  auto doc = b.add<Doc>();
+  b[doc].version = 3;
+  b.set(b.field(doc, &Doc::title), "manual");
+  auto parts = b.set(b.field(doc, &Doc::parts), 3);
+  for (std::size_t i = 0; i < 3; ++i) {
+    auto part = b.element(parts, i);
+    b[part].id = 100 + i;
+    b.set(b.field(part, &Part::name), std::string(i + 1, 'a' + i));
+  }
+  auto tags = b.set(b.field(doc, &Doc::tags), 2);
+  b.set(b.element(tags, 0), "x");
+  b.set(b.element(tags, 1), "");
+  return std::string(b.finish(doc));
+}
+
+void check_doc(lab::TestContext& lab_test_context, const Doc* d) {
+  LAB_REQUIRE(d != nullptr);
+  LAB_CHECK_EQ(d->version, 3u);
+  LAB_CHECK_EQ(d->title.view(), "manual");
+  LAB_REQUIRE(d->parts.size() == 3);
+  LAB_CHECK_EQ(d->parts[2].id, 102u);
+  LAB_CHECK_EQ(d->parts[0].name.view(), "a");
+  LAB_CHECK_EQ(d->parts[2].name.view(), "ccc");
+  LAB_REQUIRE(d->tags.size() == 2);
+  LAB_CHECK_EQ(d->tags[0].view(), "x");
+  LAB_CHECK(d->tags[1].empty());
+}
+
+LAB_TEST(flat_builds_and_reads_in_place) {
+  lab::flat::Builder b;
+  std::string bytes = build(b);
+  check_doc(lab_test_context,
+            lab::flat::root<Doc>(bytes.data(), bytes.size()));
+  // Reused builders produce identical buffers.
+  LAB_CHECK(build(b) == bytes);
+}
+
+LAB_TEST(flat_reads_from_mmap) {
+  lab::flat::Builder b;
+  std::string bytes = build(b);
+  auto path = std::filesystem::temp_directory_path() /
+              ("lab_flat_test_" + std::to_string(::getpid()));
+  int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+  LAB_REQUIRE(fd >= 0);
+  bool written = ::write(fd, bytes.data(), bytes.size()) ==
+                 static_cast<ssize_t>(bytes.size());
+  void* map = written ? ::mmap(nullptr, bytes.size(), PROT_READ, MAP_PRIVATE,
+                               fd, 0)
+                      : MAP_FAILED;
+  ::close(fd);
+  std::filesystem::remove(path);
+  LAB_REQUIRE(map != MAP_FAILED);
+  check_doc(lab_test_context, lab::flat::root<Doc>(map, bytes.size()));
+  ::munmap(map, bytes.size());
+}
+
+LAB_TEST(flat_root_rejects_bad_headers) {
+  lab::flat::Builder b;
+  std::string bytes = build(b);
+  std::string error;
+  LAB_CHECK(lab::flat::root<Doc>(bytes.data(), 8, &error) == nullptr);
+  LAB_CHECK(!error.empty());
+  LAB_CHECK(lab::flat::root<Doc>(bytes.data(), bytes.size() - 1) == nullptr);
+  std::string bad = bytes;
+  bad[0] = 'X';
+  LAB_CHECK(lab::flat::root<Doc>(bad.data(), bad.size()) == nullptr);
+}
+
+}  // namespace
@@ -0,0 +1,75 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "lab/graph.hpp"
+#include "lab/test.hpp"
+
+namespace {
+
+namespace graph = lab::graph;
+
+LAB_TEST(graph_hilbert_index) {
+  // The order-1 curve, then every cell of order 4 visited exactly once,
+  // each step to a grid neighbour.
+  LAB_CHECK_EQ(graph::hilbert_index(0, 0, 1), 0u);
+  LAB_CHECK_EQ(graph::hilbert_index(0, 1, 1), 1u);
+  LAB_CHECK_EQ(graph::hilbert_index(1, 1, 1), 2u);
+  LAB_CHECK_EQ(graph::hilbert_index(1, 0, 1), 3u);
+  std::vector<std::pair<int, int>> at(256, {-1, -1});
+  for (int x = 0; x < 16; ++x) {
+    for (int y = 0; y < 16; ++y) {
+      auto d = graph::hilbert_index(x, y, 4);
+      LAB_REQUIRE(d < 256);
+      LAB_CHECK_EQ(at[d].first, -1);
+      at[d] = {x, y};
+    }
+  }
+  for (std::size_t d = 1; d < at.size(); ++d) {
+    LAB_CHECK_EQ(std::abs(at[d].first - at[d - 1].first) +
+                     std::abs(at[d].second - at[d - 1].second),
+                 1);
+  }
+}
+
+LAB_TEST(graph_geometric_is_symmetric) {
+  graph::Geometric g = graph::geometric(2000, 8, 7);
+  LAB_REQUIRE(g.csr.vertices() == 2000);
+  LAB_CHECK(g.csr.edges() > 2000 * 4);
+  for (std::uint32_t u = 0; u < g.csr.vertices(); ++u) {
+    auto list = g.csr.neighbours(u);
+    LAB_CHECK(std::is_sorted(list.begin(), list.end()));
+    for (std::uint32_t v : list) {
+      LAB_CHECK(v != u);
+      auto back = g.csr.neighbours(v);
+      LAB_CHECK(std::binary_search(back.begin(), back.end(), u));
+    }
+  }
+}
+
+// A layout renames vertices and must change nothing else.
+LAB_TEST(graph_layouts_preserve_results) {
+  graph::Geometric g = graph::geometric(3000, 10, 3);
+  auto depth = graph::bfs(g.csr, 0);
+  auto rank = graph::pagerank(g.csr, 5);
+  for (const auto& new_id :
+       {graph::degree_order(g.csr), graph::hilbert_order(g.x, g.y)}) {
+    graph::Csr p = graph::permute(g.csr, new_id);
+    LAB_REQUIRE(p.edges() == g.csr.edges());
+    auto p_depth = graph::bfs(p, new_id[0]);
+    auto p_rank = graph::pagerank(p, 5);
+    for (std::uint32_t v = 0; v < g.csr.vertices(); ++v) {
+      LAB_CHECK_EQ(p.degree(new_id[v]), g.csr.degree(v));
+      LAB_CHECK_EQ(p_depth[new_id[v]], depth[v]);
+      LAB_CHECK(std::abs(p_rank[new_id[v]] - rank[v]) < 1e-12);
+    }
+  }
+  auto by_degree = graph::degree_order(g.csr);
+  graph::Csr p = graph::permute(g.csr, by_degree);
+  for (std::uint32_t v = 1; v < p.vertices(); ++v) {
+    LAB_CHECK(p.degree(v - 1) >= p.degree(v));
+  }
+}
+
+}  // namespace
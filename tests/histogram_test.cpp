@@ -0,0 +1,124 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "lab/bench.hpp"
+#include "lab/histogram.hpp"
+#include "lab/test.hpp"
+
+namespace {
+
+LAB_TEST(histogram_small_values_are_exact) {
+  lab::Histogram h(2);
+  for (std::uint64_t v = 0; v < 100; ++v) h.record(v);
+  LAB_CHECK_EQ(h.count(), 100u);
+  LAB_CHECK_EQ(h.min(), 0u);
+  LAB_CHECK_EQ(h.max(), 99u);
+  LAB_CHECK_EQ(h.percentile(0.5), 49u);
+  LAB_CHECK_EQ(h.percentile(0.0), 0u);
+  LAB_CHECK_EQ(h.percentile(1.0), 99u);
+  LAB_CHECK_EQ(h.mean(), 49.5);
+}
+
+LAB_TEST(histogram_percentiles_within_precision) {
+  std::mt19937_64 rng(7);
+  for (int digits = 1; digits <= 4; ++digits) {
+    lab::Histogram h(digits);
+    std::vector<std::uint64_t> values;
+    for (int i = 0; i < 5000; ++i) {
+      std::uint64_t v = rng() >> (rng() % 60);
+      values.push_back(v);
+      h.record(v);
+    }
+    std::sort(values.begin(), values.end());
+    double tolerance = 1.0;
+    for (int i = 0; i < digits; ++i) tolerance /= 10;
+    for (double q : {0.1, 0.5, 0.9, 0.99, 0.999}) {
+      auto rank = static_cast<std::size_t>(std::ceil(q * values.size()));
+      auto exact = static_cast<double>(values[rank - 1]);
+      auto got = static_cast<double>(h.percentile(q));
+      LAB_CHECK(got >= exact);
+      LAB_CHECK(got <= exact * (1 + tolerance) + 1);
+    }
+    LAB_CHECK_EQ(h.max(), values.back());
+  }
+}
+
+LAB_TEST(histogram_covers_full_range) {
+  lab::Histogram h;
+  h.record(~std::uint64_t{0});
+  h.record(std::uint64_t{1} << 63);
+  LAB_CHECK_EQ(h.max(), ~std::uint64_t{0});
+  LAB_CHECK_EQ(h.percentile(1.0), ~std::uint64_t{0});
+  LAB_CHECK(h.percentile(0.5) >= std::uint64_t{1} << 63);
+}
+
+LAB_TEST(histogram_merge_matches_combined_recording) {
+  lab::Histogram a, b, both;
+  for (std::uint64_t v = 1; v < 100000; v += 7) {
+    (v % 3 == 0 ? a : b).record(v);
+    both.record(v);
+  }
+  a.merge(b);
+  LAB_CHECK_EQ(a.serialize(), both.serialize());
+
+  // Re-bucketed into the coarser histogram, within its precision.
+  lab::Histogram coarse(1);
+  coarse.merge(both);
+  LAB_CHECK_EQ(coarse.count(), both.count());
+  LAB_CHECK_EQ(coarse.max(), both.max());
+  auto p99 = static_cast<double>(both.percentile(0.99));
+  LAB_CHECK(static_cast<double>(coarse.percentile(0.99)) <= p99 * 1.2);
+  LAB_CHECK(static_cast<double>(coarse.percentile(0.99)) >= p99 * 0.8);
+}
+
+LAB_TEST(histogram_serialize_round_trip) {
+  lab::Histogram h(3);
+  for (std::uint64_t v : {5u, 5u, 1000u, 123456u, 987654321u}) h.record(v);
+  std::string blob = h.serialize();
+  LAB_CHECK(blob.find_first_of(" \t\n") == std::string::npos);
+  lab::Histogram back(1);
+  std::string error;
+  LAB_REQUIRE(lab::Histogram::deserialize(blob, back, &error));
+  LAB_CHECK_EQ(back.significant_digits(), 3);
+  LAB_CHECK_EQ(back.serialize(), blob);
+  LAB_CHECK_EQ(back.count(), 5u);
+  LAB_CHECK_EQ(back.min(), 5u);
+  LAB_CHECK_EQ(back.percentile(0.99), h.percentile(0.99));
+  LAB_CHECK_EQ(back.mean(), h.mean());
+
+  lab::Histogram empty;
+  LAB_REQUIRE(lab::Histogram::deserialize(empty.serialize(), back));
+  LAB_CHECK(back.empty());
+}
+
+LAB_TEST(histogram_deserialize_rejects_malformed) {
+  for (const char* text :
+       {"", "hdr2:3:0:0:0:", "hdr1:9:0:0:0:", "hdr1:3:1:2", "hdr1:3:0:1:1:0",
+        "hdr1:3:0:1:1:0*", "hdr1:3:0:1:1:0*0", "hdr1:3:0:1:1:0*1,",
+        "hdr1:3:0:1:1:99999999999*1", "hdr1:3:0:1:1:x*1"}) {
+    lab::Histogram h;
+    std::string error;
+    LAB_CHECK(!lab::Histogram::deserialize(text, h, &error));
+    LAB_CHECK(!error.empty());
+  }
+}
+
+LAB_TEST(state_times_each_iteration) {
+  lab::State state(1000);
+  state.time_each_iteration();
+  std::uint64_t n = 0;
+  for (auto _ : state) lab::do_not_optimize(++n);
+  LAB_CHECK_EQ(n, 1000u);
+  LAB_CHECK_EQ(state.latency().count(), 1000u);
+  LAB_CHECK(!state.running());
+
+  lab::State plain(10);
+  for (auto _ : plain) lab::do_not_optimize(++n);
+  LAB_CHECK(plain.latency().empty());
+}
+
+}  // namespace
@@ -0,0 +1,103 @@
+// Every available backend writes a file that every backend then reads
+// back intact, with a file size that leaves a partial last page.
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "lab/io.hpp"
+#include "lab/test.hpp"
+
+namespace {
+
+using lab::io::Backend;
+
+constexpr std::uint64_t kSize = 5 * 64 * 1024 + 5000;
+
+// Returns the first mismatch against write_file's pattern, or "".
+std::string verify(std::uint64_t offset, const char* data, std::size_t size) {
+  for (std::size_t i = 0; i < size; ++i) {
+    std::uint64_t at = offset + i;
+    std::size_t in_page = at % lab::io::kAlignment;
+    std::uint8_t want;
+    if (in_page < 8) {
+      std::uint64_t page = at - in_page;
+      std::memcpy(&want, reinterpret_cast<const char*>(&page) + in_page, 1);
+    } else {
+      want = lab::io::pattern_byte(in_page);
+    }
+    if (static_cast<std::uint8_t>(data[i]) != want) {
+      return "byte " + std::to_string(at) + " differs";
+    }
+  }
+  return "";
+}
+
+void round_trip(lab::TestContext& context, Backend writer) {
+  std::string path =
+      (std::filesystem::temp_directory_path() /
+       ("lab_io_test_" + std::to_string(getpid()) + "_" +
+        lab::io::backend_name(writer)))
+          .string();
+  lab::io::Options opts;
+  opts.block_size = 64 * 1024;
+  opts.queue_depth = 4;
+  std::string error;
+  lab::io::Stats stats;
+  if (!lab::io::write_file(writer, path, kSize, opts, &stats, &error)) {
+    context.fail(__FILE__, __LINE__, "write: " + error);
+    return;
+  }
+  if (stats.bytes < kSize || stats.latency_ns.size() != stats.requests) {
+    context.fail(__FILE__, __LINE__, "write: inconsistent stats");
+  }
+  for (Backend reader : lab::io::kAllBackends) {
+    if (!lab::io::backend_available(reader)) continue;
+    std::string who = std::string("read/") + lab::io::backend_name(reader);
+    std::vector<bool> seen(kSize / opts.block_size + 1);
+    std::uint64_t bytes = 0;
+    std::string mismatch;
+    auto consume = [&](std::uint64_t offset, const char* data,
+                       std::size_t size) {
+      seen[offset / opts.block_size] = true;
+      bytes += size;
+      if (mismatch.empty()) mismatch = verify(offset, data, size);
+    };
+    if (!lab::io::read_file(reader, path, opts, consume, &stats, &error)) {
+      context.fail(__FILE__, __LINE__, who + ": " + error);
+      continue;
+    }
+    if (!mismatch.empty()) context.fail(__FILE__, __LINE__, who + ": " + mismatch);
+    if (bytes != kSize || stats.bytes != kSize) {
+      context.fail(__FILE__, __LINE__, who + ": wrong byte count");
+    }
+    for (bool b : seen) {
+      if (!b) context.fail(__FILE__, __LINE__, who + ": missing block");
+    }
+  }
+  std::filesystem::remove(path);
+}
+
+const bool round_trips_registered = [] {
+  for (Backend backend : lab::io::kAllBackends) {
+    if (!lab::io::backend_available(backend)) continue;
+    lab::TestRegistry::global().add(
+        std::string("io_round_trip/") + lab::io::backend_name(backend),
+        [backend](lab::TestContext& context) { round_trip(context, backend); });
+  }
+  return true;
+}();
+
+LAB_TEST(io_rejects_unaligned_blocks) {
+  lab::io::Options opts;
+  opts.block_size = 1000;
+  std::string error;
+  LAB_CHECK(!lab::io::write_file(Backend::read, "/dev/null", 1, opts, nullptr,
+                                 &error));
+  LAB_CHECK(!error.empty());
+}
+
+}  // namespace
@@ -0,0 +1,98 @@
+#include <unistd.h>
+
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "lab/isolation.hpp"
+#include "lab/test.hpp"
+
+namespace {
+
+namespace fs = std::filesystem;
+
+// A fake sysfs CPU directory.
+class FakeSysfs {
+ public:
+  explicit FakeSysfs(const char* name)
+      : root_("/tmp/lab_test_" + std::to_string(::getpid()) + "_" + name) {
+    fs::remove_all(root_);
+    fs::create_directories(root_);
+  }
+  ~FakeSysfs() { fs::remove_all(root_); }
+
+  void write(const std::string& file, const std::string& text) {
+    fs::path path = fs::path(root_) / file;
+    fs::create_directories(path.parent_path());
+    std::ofstream(path) << text << "\n";
+  }
+  const std::string& root() const { return root_; }
+
+ private:
+  std::string root_;
+};
+
+bool mentions(const std::vector<std::string>& warnings, const char* what) {
+  for (const auto& w : warnings) {
+    if (w.find(what) != std::string::npos) return true;
+  }
+  return false;
+}
+
+LAB_TEST(isolation_noisy_host) {
+  FakeSysfs sys("noisy");
+  sys.write("isolated", "2-3");
+  sys.write("cpu1/cpufreq/scaling_governor", "powersave");
+  sys.write("intel_pstate/no_turbo", "0");
+  sys.write("smt/active", "1");
+  sys.write("cpu1/topology/thread_siblings_list", "1,5");
+
+  lab::HostState host = lab::HostState::read(1, sys.root());
+  LAB_CHECK_EQ(host.isolated.size(), 2u);
+  LAB_CHECK_EQ(host.governor, "powersave");
+  LAB_CHECK_EQ(host.turbo, 1);
+  LAB_CHECK_EQ(host.smt, 1);
+  LAB_CHECK_EQ(host.siblings.size(), 2u);
+
+  auto warnings = lab::host_warnings(host, 1);
+  LAB_CHECK_EQ(warnings.size(), 4u);
+  LAB_CHECK(mentions(warnings, "not isolated (isolated: 2,3)"));
+  LAB_CHECK(mentions(warnings, "powersave"));
+  LAB_CHECK(mentions(warnings, "turbo"));
+  LAB_CHECK(mentions(warnings, "cpus 1,5"));
+}
+
+LAB_TEST(isolation_quiet_host) {
+  FakeSysfs sys("quiet");
+  sys.write("isolated", "3");
+  sys.write("cpu3/cpufreq/scaling_governor", "performance");
+  sys.write("cpufreq/boost", "0");
+  sys.write("smt/active", "0");
+  sys.write("cpu3/topology/thread_siblings_list", "3");
+
+  lab::HostState host = lab::HostState::read(3, sys.root());
+  LAB_CHECK_EQ(host.turbo, 0);
+  LAB_CHECK(lab::host_warnings(host, 3).empty());
+}
+
+LAB_TEST(isolation_unknown_settings_are_not_warned_about) {
+  FakeSysfs sys("unknown");
+  lab::HostState host = lab::HostState::read(0, sys.root());
+  LAB_CHECK(host.governor.empty());
+  LAB_CHECK_EQ(host.turbo, -1);
+  LAB_CHECK_EQ(host.smt, -1);
+  // Only the missing isolation is reported.
+  auto warnings = lab::host_warnings(host, 0);
+  LAB_CHECK_EQ(warnings.size(), 1u);
+  LAB_CHECK(mentions(warnings, "isolcpus="));
+}
+
+LAB_TEST(isolation_noise_is_a_small_fraction) {
+  double noise = lab::measure_noise(8);
+  LAB_CHECK(std::isfinite(noise));
+  LAB_CHECK(noise >= 0);
+  LAB_CHECK(noise < 10);
+}
+
+}  // namespace
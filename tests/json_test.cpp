@@ -0,0 +1,106 @@
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "lab/json.hpp"
+#include "lab/test.hpp"
+
+namespace {
+
+LAB_TEST(json_writer_separates_and_escapes) {
+  std::string out;
+  lab::json::Writer w(out);
+  w.begin_object();
+  w.key("a");
+  w.value(1);
+  w.key("b");
+  w.begin_array();
+  w.value("x\"y\\\n\x01");
+  w.value(true);
+  w.null();
+  w.begin_object();
+  w.end_object();
+  w.end_array();
+  w.key("c");
+  w.value(-2.5);
+  w.key("d");
+  w.value(std::uint64_t{18446744073709551615u});
+  w.end_object();
+  LAB_CHECK_EQ(out,
+               "{\"a\":1,\"b\":[\"x\\\"y\\\\\\n\\u0001\",true,null,{}],"
+               "\"c\":-2.5,\"d\":18446744073709551615}");
+}
+
+LAB_TEST(json_round_trips_values) {
+  std::string out;
+  lab::json::Writer w(out);
+  w.begin_array();
+  for (double d : {0.1, 1e300, -3.0, 123456.789}) w.value(d);
+  w.value(std::int64_t{-9007199254740993});
+  w.value("snowman \xe2\x98\x83");
+  w.end_array();
+
+  lab::json::Reader r(out);
+  LAB_REQUIRE(r.begin_array());
+  for (double expected : {0.1, 1e300, -3.0, 123456.789}) {
+    double d = 0;
+    LAB_REQUIRE(r.next_element() && r.read(d));
+    LAB_CHECK_EQ(d, expected);
+  }
+  std::int64_t i = 0;
+  LAB_REQUIRE(r.next_element() && r.read(i));
+  LAB_CHECK_EQ(i, std::int64_t{-9007199254740993});
+  std::string s;
+  LAB_REQUIRE(r.next_element() && r.read(s));
+  LAB_CHECK_EQ(s, "snowman \xe2\x98\x83");
+  LAB_CHECK(!r.next_element());
+  LAB_CHECK(r.ok() && r.at_end());
+}
+
+LAB_TEST(json_reader_walks_objects_and_skips) {
+  lab::json::Reader r(
+      " { \"skip\" : {\"x\":[1,{\"y\":null}, \"s\"]}, \"n\": 42 ,"
+      "\"esc\":\"a\\u00e9\\ud83d\\ude00\\t\", \"flag\": false, \"u8\": 7 } ");
+  LAB_REQUIRE(r.begin_object());
+  int n = 0;
+  std::string esc;
+  bool flag = true;
+  std::uint8_t u8 = 0;
+  for (std::string_view key; r.next_key(key);) {
+    if (key == "n") {
+      r.read(n);
+    } else if (key == "esc") {
+      r.read(esc);
+    } else if (key == "flag") {
+      r.read(flag);
+    } else if (key == "u8") {
+      r.read(u8);
+    } else {
+      r.skip();
+    }
+  }
+  LAB_REQUIRE(r.ok());
+  LAB_CHECK(r.at_end());
+  LAB_CHECK_EQ(n, 42);
+  LAB_CHECK_EQ(esc, "a\xc3\xa9\xf0\x9f\x98\x80\t");
+  LAB_CHECK(!flag);
+  LAB_CHECK_EQ(int{u8}, 7);
+}
+
+LAB_TEST(json_reader_rejects_malformed) {
+  for (const char* text : {"{\"a\" 1}", "{\"a\":1,}", "[1 2]", "{\"a\":tru}",
+                           "[\"unterminated]", "[\"\\x\"]", "[\"\\ud800\"]",
+                           "[01x]", "{\"a\":[1,2}", "[+1]"}) {
+    lab::json::Reader r(text);
+    bool ok = r.skip();
+    LAB_CHECK(!ok || !r.at_end());
+    if (!ok) LAB_CHECK(!r.error().empty());
+  }
+  lab::json::Reader range("[300]");
+  std::uint8_t small = 0;
+  LAB_CHECK(range.begin_array() && range.next_element());
+  LAB_CHECK(!range.read(small));
+  LAB_CHECK(!range.ok());
+}
+
+}  // namespace
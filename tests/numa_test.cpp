@@ -0,0 +1,69 @@
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "lab/arena.hpp"
+#include "lab/numa.hpp"
+#include "lab/scheduler.hpp"
+#include "lab/test.hpp"
+
+namespace {
+
+LAB_TEST(numa_bound_pages_land_on_their_node) {
+  std::vector<int> nodes = lab::memory_nodes();
+  LAB_REQUIRE(!nodes.empty());
+  for (int node : nodes) {
+    lab::Arena arena(1 << 20,
+                     lab::numa_resource(lab::NumaPolicy::on_node(node)));
+    auto* p = static_cast<char*>(arena.allocate(4096));
+    p[0] = 1;
+    int where = lab::node_of_page(p);
+    // move_pages may be filtered (e.g. by seccomp); then nothing is known.
+    if (where >= 0) LAB_CHECK_EQ(where, node);
+  }
+  LAB_CHECK(lab::numa_resource(lab::NumaPolicy::on_node(nodes[0])) ==
+            lab::numa_resource(lab::NumaPolicy::on_node(nodes[0])));
+}
+
+LAB_TEST(numa_interleave_and_errors) {
+  std::pmr::memory_resource* r =
+      lab::numa_resource(lab::NumaPolicy::interleave());
+  constexpr std::size_t kBytes = 1 << 20;
+  auto* p = static_cast<std::uint64_t*>(r->allocate(kBytes, 64));
+  for (std::size_t i = 0; i < kBytes / 8; ++i) p[i] = i;
+  LAB_CHECK_EQ(p[1000], 1000u);
+  r->deallocate(p, kBytes, 64);
+
+  std::string error;
+  alignas(4096) static char page[4096];
+  LAB_CHECK(!lab::set_numa_policy(page, sizeof page,
+                                  lab::NumaPolicy::on_node(100000), &error));
+  LAB_CHECK(error.find("100000") != std::string::npos);
+}
+
+// Part i of a static loop always runs on worker i, and the parts tile the
+// range exactly.
+LAB_TEST(scheduler_parallel_for_static_owns_parts) {
+  lab::Scheduler pool({.threads = 3, .pin = false});
+  constexpr std::size_t kN = 1000;
+  std::vector<int> owner(kN, -1);
+  for (int round = 0; round < 20; ++round) {
+    std::atomic<std::size_t> seen{0};
+    pool.parallel_for_static(0, kN, [&](std::size_t lo, std::size_t hi) {
+      auto expected = static_cast<int>((lo * 3 + kN - 1) / kN);
+      LAB_CHECK_EQ(pool.current_worker(), expected);
+      for (std::size_t i = lo; i < hi; ++i) {
+        if (round == 0) owner[i] = pool.current_worker();
+        LAB_CHECK_EQ(owner[i], pool.current_worker());
+      }
+      seen += hi - lo;
+    });
+    LAB_CHECK_EQ(seen.load(), kN);
+  }
+  std::vector<double> data(kN, 0.0);
+  pool.first_touch(data.data(), data.size(), 2.5);
+  for (double v : data) LAB_CHECK_EQ(v, 2.5);
+}
+
+}  // namespace
@@ -0,0 +1,81 @@
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include "lab/arena.hpp"
+#include "lab/bench.hpp"
+#include "lab/pages.hpp"
+#include "lab/runner.hpp"
+#include "lab/test.hpp"
+
+namespace {
+
+constexpr std::size_t kBytes = std::size_t{1} << 20;
+
+LAB_TEST(pages_map_with_every_option) {
+  for (lab::PageOptions options :
+       {lab::PageOptions{}, lab::PageOptions{.hugetlb = true},
+        lab::PageOptions{.thp = true}, lab::PageOptions{.populate = true},
+        lab::PageOptions{.thp = true, .populate = true}}) {
+    lab::PageMapping m;
+    std::string error;
+    LAB_REQUIRE(lab::map_pages(kBytes + 1, options, m, &error));
+    LAB_CHECK(m.bytes > kBytes);
+    LAB_CHECK(!m.huge || m.bytes % lab::kHugePageSize == 0);
+    auto* p = static_cast<unsigned char*>(m.data);
+    LAB_CHECK_EQ(p[0] + p[kBytes], 0);
+    std::memset(p, 1, kBytes + 1);
+    lab::unmap_pages(m);
+  }
+}
+
+// Prefaulted memory takes no faults when touched; fresh memory takes up
+// to one per page.
+LAB_TEST(pages_populate_moves_faults_out) {
+  lab::PageMapping m;
+  LAB_REQUIRE(lab::map_pages(kBytes, {.populate = true}, m));
+  lab::PageFaults before = lab::page_faults(true);
+  std::memset(m.data, 1, kBytes);
+  lab::PageFaults after = lab::page_faults(true);
+  LAB_CHECK(after.minor - before.minor < 4);
+  lab::unmap_pages(m);
+
+  std::string error;
+  lab::PageMapping locked;
+  if (lab::map_pages(kBytes, {.lock = true}, locked, &error)) {
+    lab::unmap_pages(locked);
+  } else {
+    LAB_CHECK(error.find("mlock") != std::string::npos);
+  }
+}
+
+LAB_TEST(pages_arena_and_fault_columns) {
+  lab::Arena arena(lab::kHugePageSize, lab::PageOptions{.populate = true});
+  auto* p = static_cast<char*>(arena.allocate(4096));
+  p[4095] = 1;
+  LAB_CHECK(lab::page_resource({.populate = true}) ==
+            lab::page_resource({.populate = true}));
+
+  // A body that touches fresh memory every op faults every op.
+  lab::Benchmark bench{"touch", [](lab::State& state) {
+                         for (auto _ : state) {
+                           lab::PageMapping m;
+                           lab::map_pages(4 * 4096, {}, m);
+                           std::memset(m.data, 1, m.bytes);
+                           lab::unmap_pages(m);
+                         }
+                       },
+                       {}};
+  lab::RunnerOptions opts;
+  opts.warmup_seconds = 0.001;
+  opts.min_seconds = 0.005;
+  opts.samples = 2;
+  opts.latency = false;
+  lab::Result r = lab::run_benchmark(bench, {}, opts);
+  const double* minor = r.counter("minor_faults_per_op");
+  LAB_REQUIRE(minor != nullptr);
+  LAB_CHECK(*minor >= 3);
+  LAB_CHECK(r.counter("major_faults_per_op") != nullptr);
+}
+
+}  // namespace
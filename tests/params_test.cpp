@@ -0,0 +1,44 @@
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "lab/params.hpp"
+#include "lab/test.hpp"
+
+namespace {
+
+using Values = std::vector<std::int64_t>;
+
+LAB_TEST(params_grid_values_and_suffixes) {
+  LAB_CHECK(lab::grid("4096") == Values{4096});
+  LAB_CHECK(lab::grid("4K,1M,1G") == (Values{4096, 1 << 20, 1 << 30}));
+  LAB_CHECK(lab::grid("1T") == Values{std::int64_t{1} << 40});
+}
+
+LAB_TEST(params_grid_ranges) {
+  LAB_CHECK(lab::grid("1..8") == (Values{1, 2, 4, 8}));
+  LAB_CHECK(lab::grid("1..10") == (Values{1, 2, 4, 8}));
+  LAB_CHECK(lab::grid("1K..64K:x4") == (Values{1024, 4096, 16384, 65536}));
+  LAB_CHECK(lab::grid("0..100:+25") == (Values{0, 25, 50, 75, 100}));
+  LAB_CHECK(lab::grid("1,4..8") == (Values{1, 4, 8}));
+}
+
+LAB_TEST(params_grid_rejects_malformed) {
+  for (const char* spec : {"", "x", "1..", "..4", "4Q", "1..8:x1", "1,,2"}) {
+    Values out;
+    std::string error;
+    LAB_CHECK(!lab::parse_grid(spec, out, &error));
+    LAB_CHECK(!error.empty());
+  }
+}
+
+LAB_TEST(params_expand_grid_and_names) {
+  auto points = lab::expand_grid({{"a", {1, 2}}, {"b", {3, 4, 5}}});
+  LAB_REQUIRE(points.size() == 6);
+  LAB_CHECK_EQ(lab::point_name("bm", points[0]), "bm/a:1/b:3");
+  LAB_CHECK_EQ(lab::point_name("bm", points[5]), "bm/a:2/b:5");
+  LAB_CHECK_EQ(lab::expand_grid({}).size(), 1u);
+  LAB_CHECK_EQ(lab::point_name("bm", {}), "bm");
+}
+
+}  // namespace
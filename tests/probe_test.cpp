@@ -0,0 +1,121 @@
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "lab/archive.hpp"
+#include "lab/probe.hpp"
+#include "lab/test.hpp"
+#include "lab/trace.hpp"
+
+namespace {
+
+const lab::Result* find_row(const std::vector<lab::Result>& rows,
+                            const std::string& name) {
+  for (const auto& r : rows) {
+    if (r.name == name) return &r;
+  }
+  return nullptr;
+}
+
+LAB_TEST(probe_latency_rows) {
+  lab::probe::Latency& a = lab::probe::latency("probe_test/a");
+  LAB_CHECK(&lab::probe::latency("probe_test/a") == &a);
+  LAB_CHECK_EQ(a.name(), "probe_test/a");
+  lab::probe::drain();
+
+  // Four threads, each recording 1..1000 ns: rows merge their slots.
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&a] {
+      for (std::uint64_t ns = 1; ns <= 1000; ++ns) a.record(ns);
+    });
+  }
+  for (auto& t : threads) t.join();
+  auto rows = lab::probe::drain();
+  const lab::Result* row = find_row(rows, "latency/probe_test/a");
+  LAB_REQUIRE(row != nullptr);
+  LAB_CHECK_EQ(row->iterations, 4000u);
+  LAB_CHECK(row->ns_per_op > 499 && row->ns_per_op < 502);
+  LAB_CHECK(row->p50_ns >= 500 && row->p50_ns <= 501);
+  LAB_CHECK(!row->latency.empty());
+  const double* per_s = row->counter("per_s");
+  LAB_REQUIRE(per_s != nullptr);
+  LAB_CHECK(*per_s > 0);
+  LAB_CHECK(row->counter("lat_p999_ns") != nullptr);
+
+  // Drained values are gone; slots of exited threads are reused.
+  LAB_CHECK(find_row(lab::probe::drain(), "latency/probe_test/a") == nullptr);
+  std::thread([&a] { a.record(7); }).join();
+  rows = lab::probe::drain();
+  row = find_row(rows, "latency/probe_test/a");
+  LAB_REQUIRE(row != nullptr);
+  LAB_CHECK_EQ(row->iterations, 1u);
+}
+
+LAB_TEST(probe_trace_rows) {
+  lab::trace::start({.records_per_thread = 64});
+  lab::probe::drain();
+  for (int i = 0; i < 5; ++i) {
+    LAB_TRACE_SCOPE("probe_test/scope");
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+  }
+  auto rows = lab::probe::drain();
+  lab::trace::stop();
+  if (!LAB_TRACE_ENABLED) return;
+  const lab::Result* row = find_row(rows, "trace/probe_test/scope");
+  LAB_REQUIRE(row != nullptr);
+  LAB_CHECK_EQ(row->iterations, 5u);
+  // Ticks are converted to ns: each scope slept 100 us.
+  LAB_CHECK(row->p50_ns >= 90e3);
+}
+
+LAB_TEST(probe_perf_row) {
+  if (!lab::probe::count_thread()) return;  // no perf events here
+  lab::probe::drain();
+  volatile std::uint64_t sink = 0;
+  for (std::uint64_t i = 0; i < 1000000; ++i) sink = sink + i;
+  auto rows = lab::probe::drain();
+  const lab::Result* row = find_row(rows, "perf");
+  LAB_REQUIRE(row != nullptr);
+  LAB_CHECK(row->iterations >= 1);
+  const double* instructions = row->counter("instructions_per_s");
+  if (instructions != nullptr) LAB_CHECK(*instructions > 0);
+}
+
+LAB_TEST(probe_sidecar_appends_runs) {
+  std::string path = "/tmp/lab_test_" + std::to_string(::getpid()) +
+                     "_probe.lab";
+  lab::probe::Latency& b = lab::probe::latency("probe_test/sidecar");
+  {
+    lab::probe::Sidecar sidecar({.archive = path,
+                                 .interval = std::chrono::milliseconds(5),
+                                 .info = {.commit = "build-1", .host = "h"}});
+    b.record(100);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (sidecar.appended() == 0 &&
+           std::chrono::steady_clock::now() < deadline) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    LAB_CHECK(sidecar.appended() >= 1);
+    // Recorded after the last interval: the destructor's drain gets it.
+    b.record(300);
+  }
+
+  lab::Archive archive;
+  LAB_REQUIRE(archive.open(path));
+  LAB_REQUIRE(archive.size() >= 2);
+  auto points = lab::trend(archive, "latency/probe_test/sidecar", "p50_ns");
+  LAB_REQUIRE(points.size() == 2);
+  LAB_CHECK_EQ(points[0].commit, "build-1");
+  LAB_CHECK(points[0].value >= 100 && points[0].value <= 101);
+  LAB_CHECK(points[1].value >= 300 && points[1].value <= 301);
+  LAB_CHECK_EQ(archive.run(0).host(), "h");
+  std::remove(path.c_str());
+}
+
+}  // namespace
@@ -0,0 +1,209 @@
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "lab/mpmc_queue.hpp"
+#include "lab/mpsc_queue.hpp"
+#include "lab/spsc_queue.hpp"
+#include "lab/test.hpp"
+
+namespace {
+
+constexpr std::uint64_t item(std::uint64_t producer, std::uint64_t seq) {
+  return producer << 32 | seq;
+}
+
+// Counts live instances, so a test can tell that nothing leaked or was
+// destroyed twice.
+struct Tracked {
+  static inline std::atomic<int> live{0};
+  std::uint64_t value = 0;
+
+  Tracked() { live.fetch_add(1, std::memory_order_relaxed); }
+  explicit Tracked(std::uint64_t v) : value(v) {
+    live.fetch_add(1, std::memory_order_relaxed);
+  }
+  Tracked(const Tracked& other) : value(other.value) {
+    live.fetch_add(1, std::memory_order_relaxed);
+  }
+  Tracked& operator=(const Tracked&) = default;
+  ~Tracked() { live.fetch_sub(1, std::memory_order_relaxed); }
+};
+
+LAB_TEST(spsc_queue_full_empty_and_wrap) {
+  lab::SpscQueue<int> q(3);  // rounds up to 4
+  LAB_REQUIRE(q.capacity() == 4);
+  int v = -1;
+  LAB_CHECK(!q.try_pop(v));
+  // Several laps, each filling the ring exactly.
+  for (int lap = 0; lap < 5; ++lap) {
+    for (int i = 0; i < 4; ++i) LAB_CHECK(q.try_push(lap * 10 + i));
+    LAB_CHECK(!q.try_push(99));
+    for (int i = 0; i < 4; ++i) {
+      LAB_CHECK(q.try_pop(v));
+      LAB_CHECK_EQ(v, lap * 10 + i);
+    }
+    LAB_CHECK(!q.try_pop(v));
+  }
+  // Half-full pushes and pops drift the indices across the wrap.
+  for (int i = 0; i < 11; ++i) {
+    LAB_CHECK(q.try_push(i));
+    LAB_CHECK(q.try_push(i + 100));
+    LAB_CHECK(q.try_pop(v) && v == i);
+    LAB_CHECK(q.try_pop(v) && v == i + 100);
+  }
+}
+
+LAB_TEST(mpmc_queue_full_empty_and_wrap) {
+  lab::MpmcQueue<int> q(4);
+  LAB_REQUIRE(q.capacity() == 4);
+  int v = -1;
+  LAB_CHECK(!q.try_pop(v));
+  for (int lap = 0; lap < 5; ++lap) {
+    for (int i = 0; i < 4; ++i) LAB_CHECK(q.try_push(lap * 10 + i));
+    LAB_CHECK(!q.try_push(99));
+    for (int i = 0; i < 4; ++i) {
+      LAB_CHECK(q.try_pop(v));
+      LAB_CHECK_EQ(v, lap * 10 + i);
+    }
+    LAB_CHECK(!q.try_pop(v));
+  }
+  for (int i = 0; i < 3; ++i) LAB_CHECK(q.try_push(i));
+  for (int i = 0; i < 9; ++i) {
+    LAB_CHECK(q.try_push(i + 3));
+    LAB_CHECK(!q.try_push(-1));
+    LAB_CHECK(q.try_pop(v) && v == i);
+  }
+}
+
+LAB_TEST(spsc_queue_keeps_fifo_order) {
+  constexpr std::uint64_t kItems = 200000;
+  lab::SpscQueue<std::uint64_t> q(64);
+  std::thread producer([&] {
+    for (std::uint64_t i = 0; i < kItems; ++i) {
+      while (!q.try_push(i)) std::this_thread::yield();
+    }
+  });
+  std::uint64_t expected = 0, out_of_order = 0, v;
+  while (expected < kItems) {
+    if (!q.try_pop(v)) {
+      std::this_thread::yield();
+      continue;
+    }
+    out_of_order += v != expected;
+    expected = v + 1;
+  }
+  producer.join();
+  LAB_CHECK_EQ(out_of_order, 0u);
+  LAB_CHECK(!q.try_pop(v));
+}
+
+LAB_TEST(mpmc_queue_delivers_each_item_once) {
+  constexpr int kProducers = 3, kConsumers = 3;
+  constexpr std::uint64_t kPerProducer = 50000;
+  lab::MpmcQueue<std::uint64_t> q(128);
+  std::vector<std::atomic<int>> seen(kProducers * kPerProducer);
+  std::atomic<std::uint64_t> popped{0};
+  std::vector<std::thread> threads;
+  for (int p = 0; p < kProducers; ++p) {
+    threads.emplace_back([&, p] {
+      for (std::uint64_t i = 0; i < kPerProducer; ++i) {
+        while (!q.try_push(p * kPerProducer + i)) std::this_thread::yield();
+      }
+    });
+  }
+  for (int c = 0; c < kConsumers; ++c) {
+    threads.emplace_back([&] {
+      std::uint64_t v;
+      while (popped.load(std::memory_order_relaxed) < seen.size()) {
+        if (q.try_pop(v)) {
+          seen[v].fetch_add(1, std::memory_order_relaxed);
+          popped.fetch_add(1, std::memory_order_relaxed);
+        } else {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  for (auto& t : threads) t.join();
+  std::size_t wrong = 0;
+  for (const auto& s : seen) wrong += s.load() != 1;
+  LAB_CHECK_EQ(wrong, 0u);
+}
+
+LAB_TEST(mpsc_queue_keeps_per_producer_order) {
+  constexpr int kProducers = 4;
+  constexpr std::uint64_t kPerProducer = 30000;
+  lab::MpscQueue<std::uint64_t> q;
+  std::vector<std::thread> producers;
+  for (int p = 0; p < kProducers; ++p) {
+    producers.emplace_back([&, p] {
+      for (std::uint64_t i = 0; i < kPerProducer; ++i) q.push(item(p, i));
+    });
+  }
+  std::vector<std::uint64_t> next(kProducers, 0);
+  std::uint64_t received = 0, out_of_order = 0, v;
+  while (received < kProducers * kPerProducer) {
+    if (!q.try_pop(v)) {
+      std::this_thread::yield();
+      continue;
+    }
+    std::uint64_t p = v >> 32, seq = v & 0xffffffff;
+    out_of_order += seq != next[p];
+    next[p] = seq + 1;
+    ++received;
+  }
+  for (auto& t : producers) t.join();
+  LAB_CHECK_EQ(out_of_order, 0u);
+  LAB_CHECK(!q.try_pop(v));
+}
+
+LAB_TEST(mpsc_queue_rolls_over_and_frees_segments) {
+  // Tiny segments, so producers race to install new ones constantly.
+  constexpr int kProducers = 3;
+  constexpr std::uint64_t kPerProducer = 5000;
+  {
+    lab::MpscQueue<Tracked, 4> q;
+    std::vector<std::thread> producers;
+    for (int p = 0; p < kProducers; ++p) {
+      producers.emplace_back([&, p] {
+        for (std::uint64_t i = 0; i < kPerProducer; ++i) {
+          q.push(Tracked(item(p, i)));
+        }
+      });
+    }
+    std::vector<std::uint64_t> next(kProducers, 0);
+    std::uint64_t received = 0, out_of_order = 0;
+    Tracked v;
+    // Leave some items queued for the destructor.
+    while (received < kProducers * kPerProducer - 10) {
+      if (!q.try_pop(v)) {
+        std::this_thread::yield();
+        continue;
+      }
+      std::uint64_t p = v.value >> 32, seq = v.value & 0xffffffff;
+      out_of_order += seq != next[p];
+      next[p] = seq + 1;
+      ++received;
+    }
+    for (auto& t : producers) t.join();
+    LAB_CHECK_EQ(out_of_order, 0u);
+    LAB_CHECK_EQ(Tracked::live.load(), 11);  // ten queued, plus v
+  }
+  LAB_CHECK_EQ(Tracked::live.load(), 0);
+
+  // Single-threaded: exactly one segment's worth, then one more.
+  lab::MpscQueue<int, 4> q;
+  int v = -1;
+  LAB_CHECK(!q.try_pop(v));
+  for (int i = 0; i < 4; ++i) q.push(i);
+  for (int i = 0; i < 4; ++i) LAB_CHECK(q.try_pop(v) && v == i);
+  LAB_CHECK(!q.try_pop(v));
+  q.push(4);
+  LAB_CHECK(q.try_pop(v) && v == 4);
+  LAB_CHECK(!q.try_pop(v));
+}
+
+}  // namespace
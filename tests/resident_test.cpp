@@ -0,0 +1,86 @@
+#include <cstdint>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "lab/bench.hpp"
+#include "lab/resident.hpp"
+#include "lab/test.hpp"
+
+namespace {
+
+LAB_TEST(resident_fills_once_per_key) {
+  lab::State state(1);
+  int fills = 0;
+  auto fill = [&](std::span<std::uint32_t> data) {
+    ++fills;
+    for (std::size_t i = 0; i < data.size(); ++i) {
+      data[i] = static_cast<std::uint32_t>(i * 3);
+    }
+  };
+  std::span<std::uint32_t> a =
+      state.resident<std::uint32_t>("resident_test/a", 1000, fill);
+  LAB_CHECK_EQ(a.size(), 1000u);
+  LAB_CHECK_EQ(a[999], 2997u);
+
+  // Another run sees the same block without filling it again.
+  lab::State later(1);
+  std::span<std::uint32_t> again =
+      later.resident<std::uint32_t>("resident_test/a", 1000, fill);
+  LAB_CHECK_EQ(fills, 1);
+  LAB_CHECK_EQ(again.data(), a.data());
+
+  // A new size replaces the block.
+  std::span<std::uint32_t> bigger =
+      later.resident<std::uint32_t>("resident_test/a", 2000, fill);
+  LAB_CHECK_EQ(fills, 2);
+  LAB_CHECK_EQ(bigger[1999], 5997u);
+  LAB_CHECK_EQ(reinterpret_cast<std::uintptr_t>(bigger.data()) % 4096, 0u);
+}
+
+LAB_TEST(resident_waits_for_concurrent_fill) {
+  int fills = 0;
+  std::vector<std::uint64_t> sums(4);
+  std::vector<std::thread> threads;
+  for (std::size_t t = 0; t < sums.size(); ++t) {
+    threads.emplace_back([&, t] {
+      lab::State state(1);
+      auto data = state.resident<std::uint64_t>(
+          "resident_test/shared", 1 << 16, [&](std::span<std::uint64_t> d) {
+            ++fills;
+            for (auto& v : d) v = 1;
+          });
+      for (auto v : data) sums[t] += v;
+    });
+  }
+  for (auto& t : threads) t.join();
+  LAB_CHECK_EQ(fills, 1);
+  for (auto s : sums) LAB_CHECK_EQ(s, std::uint64_t{1} << 16);
+}
+
+// Stands in for a plugin's store, which forwards to its host.
+class CountingStore : public lab::Resident {
+ public:
+  void* get(const std::string& key, std::size_t bytes, Init init,
+            void* ctx) override {
+    ++calls;
+    return lab::Resident::process().get("resident_test/counted/" + key,
+                                        bytes, init, ctx);
+  }
+  int calls = 0;
+};
+
+LAB_TEST(resident_uses_the_state_store) {
+  CountingStore store;
+  lab::State state(1);
+  state.set_resident_store(&store);
+  auto data = state.resident<char>("x", 3, [](std::span<char> d) {
+    d[0] = 'a';
+  });
+  LAB_CHECK_EQ(store.calls, 1);
+  LAB_CHECK_EQ(data[0], 'a');
+  LAB_CHECK_EQ(data[2], '\0');
+}
+
+}  // namespace
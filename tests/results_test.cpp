@@ -0,0 +1,93 @@
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "lab/histogram.hpp"
+#include "lab/results.hpp"
+#include "lab/test.hpp"
+
+namespace {
+
+LAB_TEST(results_round_trip) {
+  std::vector<lab::Result> written(2);
+  written[0].name = "a/size:4096";
+  written[0].iterations = 1000;
+  written[0].ns_per_op = 1.25;
+  written[0].p50_ns = 1.2;
+  written[0].p99_ns = 2.5;
+  written[0].bytes_per_op = 4096;
+  written[0].counters = {{"size", 4096}, {"ipc", 2.75}};
+  written[0].samples = {1.2, 1.3, 1.25};
+  written[0].latency = "hdr1:3:5:9:14:5*1,3*1";
+  written[1].name = "b";
+  written[1].counters = {{"speedup", 3}};
+
+  std::stringstream file;
+  lab::write_results(file, written);
+  std::vector<lab::Result> read;
+  std::string error;
+  LAB_REQUIRE(lab::read_results(file, read, &error));
+  LAB_REQUIRE(read.size() == 2);
+  LAB_CHECK_EQ(read[0].name, written[0].name);
+  LAB_CHECK_EQ(read[0].iterations, 1000u);
+  LAB_CHECK_EQ(read[0].ns_per_op, 1.25);
+  LAB_CHECK_EQ(read[0].bytes_per_op, 4096.0);
+  LAB_CHECK(read[0].samples == written[0].samples);
+  LAB_CHECK_EQ(read[0].latency, written[0].latency);
+  LAB_CHECK(read[1].latency.empty());
+  LAB_REQUIRE(read[0].counter("ipc") != nullptr);
+  LAB_CHECK_EQ(*read[0].counter("ipc"), 2.75);
+  // Cells a row does not have are written as "-" and read back as absent.
+  LAB_CHECK(read[0].counter("speedup") == nullptr);
+  LAB_CHECK(read[1].counter("ipc") == nullptr);
+  LAB_REQUIRE(read[1].counter("speedup") != nullptr);
+  LAB_CHECK_EQ(*read[1].counter("speedup"), 3.0);
+}
+
+LAB_TEST(results_reject_missing_header) {
+  std::stringstream file("a\t1\t2\n");
+  std::vector<lab::Result> read;
+  LAB_CHECK(!lab::read_results(file, read));
+}
+
+LAB_TEST(results_merge_pools_equal_names) {
+  lab::Histogram h1, h2;
+  h1.record(10);
+  h2.record(1000);
+  std::vector<lab::Result> rows(3);
+  rows[0].name = "a";
+  rows[0].iterations = 100;
+  rows[0].ns_per_op = 2;
+  rows[0].counters = {{"size", 8}, {"ipc", 1}};
+  rows[0].samples = {2, 2};
+  rows[0].latency = h1.serialize();
+  rows[1].name = "b";
+  rows[1].iterations = 5;
+  rows[1].ns_per_op = 7;
+  rows[2] = rows[0];
+  rows[2].iterations = 300;
+  rows[2].ns_per_op = 4;
+  rows[2].counters = {{"size", 8}, {"ipc", 3}};
+  rows[2].samples = {4, 4, 4};
+  rows[2].latency = h2.serialize();
+
+  std::vector<lab::Result> merged = lab::merge_results(rows);
+  LAB_REQUIRE(merged.size() == 2);
+  const lab::Result& a = merged[0];
+  LAB_CHECK_EQ(a.name, "a");
+  LAB_CHECK_EQ(a.iterations, 400u);
+  LAB_CHECK_EQ(a.ns_per_op, 3.5);
+  LAB_CHECK_EQ(*a.counter("size"), 8.0);
+  LAB_CHECK_EQ(*a.counter("ipc"), 2.5);
+  LAB_CHECK_EQ(a.samples.size(), 5u);
+  LAB_CHECK_EQ(a.p50_ns, 4.0);
+  lab::Histogram h;
+  LAB_REQUIRE(lab::Histogram::deserialize(a.latency, h));
+  LAB_CHECK_EQ(h.count(), 2u);
+  LAB_REQUIRE(a.counter("lat_max_ns") != nullptr);
+  LAB_CHECK_EQ(*a.counter("lat_max_ns"), 1000.0);
+  LAB_CHECK_EQ(merged[1].name, "b");
+  LAB_CHECK_EQ(merged[1].ns_per_op, 7.0);
+}
+
+}  // namespace
@@ -0,0 +1,175 @@
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "lab/bench.hpp"
+#include "lab/chase_lev_deque.hpp"
+#include "lab/scheduler.hpp"
+#include "lab/test.hpp"
+
+namespace {
+
+// Work that grows with the index, so that workers finish their first
+// chunks at different times and steal the rest.
+void uneven_work(std::size_t i) {
+  std::uint64_t x = i;
+  for (std::size_t k = 0; k < i % 64; ++k) lab::do_not_optimize(x += k);
+}
+
+LAB_TEST(scheduler_parallel_for_visits_each_index_once) {
+  constexpr std::size_t kN = 20011;
+  lab::Scheduler pool({.threads = 4, .pin = false});
+  for (std::size_t grain : {std::size_t{0}, std::size_t{1}, std::size_t{7},
+                            kN + 1}) {
+    std::vector<std::atomic<int>> hits(kN);
+    pool.parallel_for(
+        0, kN,
+        [&](std::size_t lo, std::size_t hi) {
+          for (std::size_t i = lo; i < hi; ++i) {
+            uneven_work(i);
+            hits[i].fetch_add(1, std::memory_order_relaxed);
+          }
+        },
+        grain);
+    std::size_t wrong = 0;
+    for (const auto& h : hits) wrong += h.load() != 1;
+    LAB_CHECK_EQ(wrong, 0u);
+  }
+  bool called = false;
+  pool.parallel_for(5, 5, [&](std::size_t, std::size_t) { called = true; });
+  LAB_CHECK(!called);
+}
+
+LAB_TEST(scheduler_parallel_reduce_is_deterministic) {
+  constexpr std::size_t kN = 10000, kGrain = 37;
+  lab::Scheduler pool({.threads = 4, .pin = false});
+
+  // Concatenation does not commute: any reordering changes the string.
+  auto name = [](std::size_t lo, std::size_t hi) {
+    uneven_work(lo);
+    return std::to_string(lo) + "-" + std::to_string(hi) + ",";
+  };
+  auto concat = [](std::string a, std::string b) { return a + b; };
+  std::string serial;
+  for (std::size_t lo = 0; lo < kN; lo += kGrain) {
+    serial += name(lo, lo + kGrain < kN ? lo + kGrain : kN);
+  }
+
+  // Floating-point sums depend on association; partial sums are combined
+  // in range order, so every run rounds identically.
+  auto sum = [](std::size_t lo, std::size_t hi) {
+    double s = 0;
+    for (std::size_t i = lo; i < hi; ++i) s += 1.0 / double(i + 1);
+    return s;
+  };
+  double expected = 0;
+  for (std::size_t lo = 0; lo < kN; lo += kGrain) {
+    expected += sum(lo, lo + kGrain < kN ? lo + kGrain : kN);
+  }
+
+  for (int run = 0; run < 20; ++run) {
+    LAB_CHECK_EQ(pool.parallel_reduce(0, kN, std::string(), name, concat,
+                                      kGrain),
+                 serial);
+    LAB_CHECK_EQ(pool.parallel_reduce(0, kN, 0.0, sum,
+                                      [](double a, double b) { return a + b; },
+                                      kGrain),
+                 expected);
+  }
+  LAB_CHECK_EQ(pool.parallel_reduce(3, 3, std::string("id"), name, concat),
+               "id");
+}
+
+LAB_TEST(scheduler_nested_parallel_for_completes) {
+  lab::Scheduler pool({.threads = 3, .pin = false});
+  std::atomic<std::size_t> total{0};
+  pool.parallel_for(
+      0, 16,
+      [&](std::size_t lo, std::size_t hi) {
+        for (std::size_t i = lo; i < hi; ++i) {
+          pool.parallel_for(0, 1000, [&](std::size_t a, std::size_t b) {
+            total.fetch_add(b - a, std::memory_order_relaxed);
+          });
+        }
+      },
+      1);
+  LAB_CHECK_EQ(total.load(), 16000u);
+
+  // And from a spawned task, which runs outside any parallel call.
+  std::atomic<bool> done{false};
+  std::atomic<std::size_t> inner{0};
+  pool.spawn([&] {
+    pool.parallel_for(0, 500, [&](std::size_t a, std::size_t b) {
+      inner.fetch_add(b - a, std::memory_order_relaxed);
+    });
+    done.store(true, std::memory_order_release);
+  });
+  while (!done.load(std::memory_order_acquire)) std::this_thread::yield();
+  LAB_CHECK_EQ(inner.load(), 500u);
+}
+
+LAB_TEST(scheduler_spawned_work_finishes_before_destruction) {
+  for (int threads : {1, 2, 4}) {
+    std::atomic<int> ran{0};
+    {
+      lab::Scheduler pool({.threads = threads, .pin = false});
+      // More than the injection queue holds, so some run inline.
+      for (int i = 0; i < 3000; ++i) {
+        pool.spawn([&] { ran.fetch_add(1, std::memory_order_relaxed); });
+      }
+    }
+    LAB_CHECK_EQ(ran.load(), 3000);
+  }
+}
+
+LAB_TEST(chase_lev_deque_owner_and_thieves) {
+  lab::ChaseLevDeque<std::uint32_t> single(4);
+  std::uint32_t v = 0;
+  LAB_CHECK(!single.pop(v));
+  LAB_CHECK(!single.steal(v));
+  for (std::uint32_t i = 0; i < 10; ++i) single.push(i);  // grows twice
+  LAB_CHECK(single.steal(v) && v == 0);                    // oldest
+  LAB_CHECK(single.pop(v) && v == 9);                      // newest
+  while (single.pop(v)) {
+  }
+  LAB_CHECK(single.empty());
+
+  // The owner pushes and pops while thieves steal; every item must come
+  // out exactly once.
+  constexpr std::uint32_t kItems = 200000;
+  constexpr int kThieves = 3;
+  lab::ChaseLevDeque<std::uint32_t> deque(4);
+  std::vector<std::atomic<int>> seen(kItems);
+  std::atomic<bool> pushing{true};
+  std::vector<std::thread> thieves;
+  for (int t = 0; t < kThieves; ++t) {
+    thieves.emplace_back([&] {
+      std::uint32_t item;
+      while (pushing.load(std::memory_order_acquire) || !deque.empty()) {
+        if (deque.steal(item)) {
+          seen[item].fetch_add(1, std::memory_order_relaxed);
+        } else {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  std::uint32_t item;
+  for (std::uint32_t i = 0; i < kItems; ++i) {
+    deque.push(i);
+    if (i % 3 == 0 && deque.pop(item)) {
+      seen[item].fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+  while (deque.pop(item)) seen[item].fetch_add(1, std::memory_order_relaxed);
+  pushing.store(false, std::memory_order_release);
+  for (auto& t : thieves) t.join();
+  std::size_t wrong = 0;
+  for (const auto& s : seen) wrong += s.load() != 1;
+  LAB_CHECK_EQ(wrong, 0u);
+}
+
+}  // namespace
@@ -0,0 +1,68 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "lab/search.hpp"
+#include "lab/test.hpp"
+
+namespace {
+
+namespace search = lab::search;
+
+// Every layout against std::lower_bound, for keys below, between, on and
+// above the stored ones, at sizes around full and partial tree levels.
+template <class T>
+void check_layouts(lab::TestContext& lab_test_context, std::size_t n,
+                   T step) {
+  std::vector<T> keys(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    keys[i] = static_cast<T>(1 + step * static_cast<T>(i / 2));
+  }
+  search::Eytzinger<T> eytzinger(keys);
+  search::BTree<T> btree(keys);
+  LAB_CHECK_EQ(eytzinger.size(), n);
+  LAB_CHECK_EQ(btree.size(), n);
+  T top = n == 0 ? T{2} : static_cast<T>(keys.back() + 2);
+  for (T key = 0; key <= top; ++key) {
+    auto want = std::lower_bound(keys.begin(), keys.end(), key);
+    std::size_t index = static_cast<std::size_t>(want - keys.begin());
+    LAB_CHECK_EQ(search::lower_bound(keys.data(), n, key), index);
+    const T* e = eytzinger.lower_bound(key);
+    const T* b = btree.lower_bound(key);
+    if (want == keys.end()) {
+      LAB_CHECK(e == nullptr);
+      LAB_CHECK(b == nullptr);
+    } else {
+      LAB_REQUIRE(e != nullptr);
+      LAB_REQUIRE(b != nullptr);
+      LAB_CHECK_EQ(*e, *want);
+      LAB_CHECK_EQ(*b, *want);
+    }
+  }
+}
+
+LAB_TEST(search_layouts_agree) {
+  for (std::size_t n : {0, 1, 2, 3, 7, 8, 9, 15, 16, 17, 72, 73, 100, 1000,
+                        4097}) {
+    check_layouts<std::uint64_t>(lab_test_context, n, 3);
+    check_layouts<std::uint32_t>(lab_test_context, n, 2);
+  }
+}
+
+// The B-tree pads with the largest key; a stored largest key must still be
+// found, and searching past padding must not return it.
+LAB_TEST(search_btree_largest_key) {
+  constexpr auto kMax = std::numeric_limits<std::uint64_t>::max();
+  std::vector<std::uint64_t> keys = {1, 5, kMax};
+  search::BTree<std::uint64_t> with_max(keys);
+  LAB_REQUIRE(with_max.lower_bound(6) != nullptr);
+  LAB_CHECK_EQ(*with_max.lower_bound(6), kMax);
+  keys.pop_back();
+  search::BTree<std::uint64_t> without_max(keys);
+  LAB_CHECK(without_max.lower_bound(6) == nullptr);
+  LAB_CHECK(without_max.lower_bound(kMax) == nullptr);
+}
+
+}  // namespace
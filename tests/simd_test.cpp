@@ -0,0 +1,46 @@
+// Every SIMD variant this CPU can run must agree with scalar; lab_bench
+// runs these before any benchmark, so a broken kernel is never timed.
+#include <string>
+
+#include "lab/simd.hpp"
+#include "lab/test.hpp"
+
+namespace {
+
+const bool registered = [] {
+  for (auto isa : lab::simd::kAllIsas) {
+    if (isa == lab::simd::Isa::scalar || !lab::simd::kernels(isa)) continue;
+    lab::TestRegistry::global().add(
+        std::string("simd_cross_check/") + lab::simd::isa_name(isa),
+        [isa](lab::TestContext& context) {
+          std::string error;
+          if (!lab::simd::cross_check(isa, &error)) {
+            context.fail(__FILE__, __LINE__, error);
+          }
+        });
+  }
+  return true;
+}();
+
+LAB_TEST(simd_scalar_encodings) {
+  const auto* in = reinterpret_cast<const std::uint8_t*>("foobar");
+  const lab::simd::Kernels& k = *lab::simd::kernels(lab::simd::Isa::scalar);
+  for (auto [n, want] : {std::pair<std::size_t, const char*>{0, ""},
+                         {1, "Zg=="},
+                         {2, "Zm8="},
+                         {3, "Zm9v"},
+                         {6, "Zm9vYmFy"}}) {
+    std::string out(lab::simd::base64_size(n), '\0');
+    LAB_CHECK_EQ(k.base64_encode(in, n, out.data()), out.size());
+    LAB_CHECK_EQ(out, want);
+  }
+  std::string hex(12, '\0');
+  k.hex_encode(in, 6, hex.data());
+  LAB_CHECK_EQ(hex, "666f6f626172");
+}
+
+LAB_TEST(simd_active_is_supported) {
+  LAB_CHECK(lab::simd::isa_supported(lab::simd::active().isa));
+}
+
+}  // namespace
@@ -0,0 +1,75 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "lab/scheduler.hpp"
+#include "lab/sort.hpp"
+#include "lab/test.hpp"
+
+namespace {
+
+namespace sort = lab::sort;
+
+// Inputs that take each sort down its special paths: random, few
+// distinct keys, sorted, reversed, sawtooth runs, and keys that differ
+// only in one byte (radix passes skipped).
+std::vector<std::vector<std::uint64_t>> inputs(std::size_t n) {
+  std::uint64_t rng = n + 1;
+  auto next = [&rng] {
+    rng = rng * 6364136223846793005ull + 1442695040888963407ull;
+    return rng ^ (rng >> 29);
+  };
+  std::vector<std::vector<std::uint64_t>> out(6,
+                                              std::vector<std::uint64_t>(n));
+  for (std::size_t i = 0; i < n; ++i) {
+    out[0][i] = next();
+    out[1][i] = next() % 5;
+    out[2][i] = i;
+    out[3][i] = n - i;
+    out[4][i] = i % 100;
+    out[5][i] = (next() & 0xff00) | 0x1234000000000000ull;
+  }
+  return out;
+}
+
+const std::size_t kSizes[] = {0, 1, 2, 23, 24, 63, 64, 65, 129, 1000,
+                              4099, 70000, 300000};
+
+LAB_TEST(sort_serial_sorts_agree) {
+  for (std::size_t n : kSizes) {
+    for (const auto& in : inputs(n)) {
+      std::vector<std::uint64_t> want = in;
+      std::sort(want.begin(), want.end());
+      std::vector<std::uint64_t> scratch(n);
+      std::vector<std::uint64_t> a = in, b = in, c = in, d = in;
+      sort::pdqsort(a.data(), n);
+      sort::radix_sort_lsd(b.data(), n, scratch.data());
+      sort::radix_sort_msd(c.data(), n);
+      sort::block_merge_sort(d.data(), n, scratch.data());
+      LAB_CHECK(a == want);
+      LAB_CHECK(b == want);
+      LAB_CHECK(c == want);
+      LAB_CHECK(d == want);
+    }
+  }
+}
+
+// One worker falls back to pdqsort; several split into buckets, including
+// the heavily duplicated inputs that leave some buckets empty.
+LAB_TEST(sort_sample_sort_agrees) {
+  for (int threads : {1, 3}) {
+    lab::Scheduler pool({.threads = threads, .pin = false});
+    for (std::size_t n : kSizes) {
+      for (const auto& in : inputs(n)) {
+        std::vector<std::uint64_t> want = in, got = in, scratch(n);
+        std::sort(want.begin(), want.end());
+        sort::sample_sort(pool, got.data(), n, scratch.data());
+        LAB_CHECK(got == want);
+      }
+    }
+  }
+}
+
+}  // namespace
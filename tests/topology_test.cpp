@@ -0,0 +1,32 @@
+#include <sched.h>
+
+#include <thread>
+
+#include "lab/test.hpp"
+#include "lab/topology.hpp"
+
+namespace {
+
+int allowed_cpus() {
+  cpu_set_t set;
+  if (sched_getaffinity(0, sizeof(set), &set) != 0) return -1;
+  return CPU_COUNT(&set);
+}
+
+LAB_TEST(topology_ignores_pinning_since_startup) {
+  int before = lab::Topology::detect().cpu_count();
+  LAB_REQUIRE(before > 0);
+  int pinned = -1, detected = 0, inside = 0, after = 0;
+  std::thread([&] {
+    pinned = lab::pin_thread(-1);
+    detected = lab::Topology::detect().cpu_count();
+    lab::with_startup_affinity([&] { inside = allowed_cpus(); });
+    after = allowed_cpus();
+  }).join();
+  LAB_REQUIRE(pinned >= 0);
+  LAB_CHECK_EQ(detected, before);
+  LAB_CHECK_EQ(inside, before);
+  LAB_CHECK_EQ(after, 1);
+}
+
+}  // namespace
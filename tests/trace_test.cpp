@@ -0,0 +1,182 @@
+#include <unistd.h>
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "lab/test.hpp"
+#include "lab/trace.hpp"
+
+namespace {
+
+std::size_t count(const std::string& text, const std::string& needle) {
+  std::size_t n = 0;
+  for (auto at = text.find(needle); at != std::string::npos;
+       at = text.find(needle, at + needle.size())) {
+    ++n;
+  }
+  return n;
+}
+
+// Writes the trace and returns it.
+std::string written_trace(lab::TestContext& context) {
+  auto path = std::filesystem::temp_directory_path() /
+              ("lab_trace_test_" + std::to_string(::getpid()) + ".json");
+  std::string error;
+  if (!lab::trace::write_json(path.string(), &error)) {
+    context.fail(__FILE__, __LINE__, error);
+    return {};
+  }
+  std::ifstream in(path);
+  std::stringstream text;
+  text << in.rdbuf();
+  std::filesystem::remove(path);
+  return text.str();
+}
+
+LAB_TEST(trace_records_nested_scopes_per_thread) {
+  lab::trace::start({.records_per_thread = 64});
+  std::thread([] {
+    LAB_TRACE_SCOPE("trace_test/outer");
+    for (int i = 0; i < 3; ++i) {
+      LAB_TRACE_SCOPE("trace_test/inner \"quoted\"");
+    }
+  }).join();
+  lab::trace::stop();
+  { LAB_TRACE_SCOPE("trace_test/after_stop"); }
+
+  std::string json = written_trace(lab_test_context);
+  LAB_REQUIRE(json.rfind("{\"traceEvents\":[", 0) == 0);
+  if (!LAB_TRACE_ENABLED) return;
+  LAB_CHECK_EQ(count(json, "\"trace_test/outer\""), 2u);
+  LAB_CHECK_EQ(count(json, "\"trace_test/inner \\\"quoted\\\"\""), 6u);
+  LAB_CHECK_EQ(count(json, "after_stop"), 0u);
+  LAB_CHECK_EQ(count(json, "\"ph\":\"B\""), count(json, "\"ph\":\"E\""));
+  LAB_CHECK(count(json, "\"thread_name\"") >= 1);
+}
+
+LAB_TEST(trace_ring_keeps_newest_records) {
+  // 202 records into 16 slots: the oldest kept is an orphaned leave, the
+  // newest the outer leave whose enter is gone.
+  lab::trace::start({.records_per_thread = 16});
+  std::thread([] {
+    LAB_TRACE_SCOPE("trace_test/wrap_outer");
+    for (int i = 0; i < 100; ++i) {
+      LAB_TRACE_SCOPE("trace_test/wrap_inner");
+    }
+  }).join();
+  lab::trace::stop();
+
+  std::string json = written_trace(lab_test_context);
+  if (!LAB_TRACE_ENABLED) return;
+  LAB_CHECK_EQ(count(json, "wrap_outer"), 0u);
+  LAB_CHECK_EQ(count(json, "wrap_inner"), 14u);
+  LAB_CHECK_EQ(count(json, "\"ph\":\"B\""), 7u);
+  LAB_CHECK_EQ(count(json, "\"ph\":\"E\""), 7u);
+}
+
+// Counts the scopes drain() visits by name.
+std::map<std::string, std::size_t> drained() {
+  std::map<std::uint32_t, std::size_t> counts;
+  lab::trace::drain([&](std::uint32_t name, std::uint64_t) {
+    ++counts[name];
+  });
+  std::map<std::string, std::size_t> named;
+  for (const auto& [id, n] : counts) named[lab::trace::name_of(id)] = n;
+  return named;
+}
+
+LAB_TEST(trace_drain_visits_each_finished_scope_once) {
+  lab::trace::start({.records_per_thread = 64});
+  std::thread([] {
+    LAB_TRACE_SCOPE("trace_test/drain_outer");
+    for (int i = 0; i < 3; ++i) {
+      LAB_TRACE_SCOPE("trace_test/drain_inner");
+    }
+  }).join();
+  auto first = drained();
+  // A scope open across a drain is visited by the one after it leaves.
+  std::map<std::string, std::size_t> open, closed;
+  {
+    LAB_TRACE_SCOPE("trace_test/drain_open");
+    open = drained();
+  }
+  closed = drained();
+  lab::trace::stop();
+  if (!LAB_TRACE_ENABLED) return;
+  LAB_CHECK_EQ(first["trace_test/drain_outer"], 1u);
+  LAB_CHECK_EQ(first["trace_test/drain_inner"], 3u);
+  LAB_CHECK(open.empty());
+  LAB_CHECK_EQ(closed.size(), 1u);
+  LAB_CHECK_EQ(closed["trace_test/drain_open"], 1u);
+  LAB_CHECK(drained().empty());
+}
+
+LAB_TEST(trace_drain_skips_overwritten_records) {
+  // As in trace_ring_keeps_newest_records, less the oldest kept record,
+  // which a live writer could be overwriting.
+  lab::trace::start({.records_per_thread = 16});
+  std::thread([] {
+    LAB_TRACE_SCOPE("trace_test/wrap_outer");
+    for (int i = 0; i < 100; ++i) {
+      LAB_TRACE_SCOPE("trace_test/wrap_inner");
+    }
+  }).join();
+  lab::trace::stop();
+  auto counts = drained();
+  if (!LAB_TRACE_ENABLED) return;
+  LAB_CHECK_EQ(counts.size(), 1u);
+  LAB_CHECK_EQ(counts["trace_test/wrap_inner"], 7u);
+}
+
+LAB_TEST(trace_drain_races_a_wrapping_writer) {
+  if (!LAB_TRACE_ENABLED) return;
+  // A 16-slot ring overwritten thousands of times while it is drained:
+  // torn or stale copies must be thrown away, never visited.
+  std::uint32_t outer = lab::trace::intern("trace_test/race_outer");
+  std::uint32_t inner = lab::trace::intern("trace_test/race_inner");
+  lab::trace::start({.records_per_thread = 16});
+  std::atomic<bool> running{true};
+  std::size_t scopes = 0;
+  std::thread writer([&] {
+    while (running.load(std::memory_order_relaxed)) {
+      lab::trace::Scope o(outer);
+      lab::trace::Scope a(inner);
+      // Lets the drains interleave even on a single CPU.
+      if (++scopes % 7 == 0) std::this_thread::yield();
+    }
+  });
+  std::size_t visits = 0, bad_names = 0, bad_times = 0;
+  auto visit = [&](std::uint32_t name, std::uint64_t ns) {
+    ++visits;
+    bad_names += name != outer && name != inner;
+    bad_times += ns > 1'000'000'000;
+  };
+  for (int i = 0; i < 2000; ++i) {
+    lab::trace::drain(visit);
+    std::this_thread::yield();
+  }
+  running.store(false, std::memory_order_relaxed);
+  writer.join();
+  lab::trace::drain(visit);
+  lab::trace::stop();
+  LAB_CHECK(scopes > 16);
+  LAB_CHECK(visits > 0);
+  LAB_CHECK_LE(visits, 2 * scopes);
+  LAB_CHECK_EQ(bad_names, 0u);
+  LAB_CHECK_EQ(bad_times, 0u);
+}
+
+LAB_TEST(trace_interns_stable_ids) {
+  std::uint32_t a = lab::trace::intern("trace_test/a");
+  LAB_CHECK_EQ(lab::trace::intern("trace_test/a"), a);
+  LAB_CHECK(lab::trace::intern("trace_test/b") != a);
+}
+
+}  // namespace
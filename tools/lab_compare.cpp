@@ -0,0 +1,200 @@
+// Compares two bench_output.txt files and fails only on slowdowns that are
+// both statistically significant and larger than a minimum effect size.
+//
+//   lab_compare [--alpha=P] [--min-effect=FRACTION] [--noise-factor=K]
+//               [--normalize=ROW] OLD NEW
+//
+// Each benchmark's per-sample ns/op are compared with a one-sided
+// Mann-Whitney U test. p-values are Holm-Bonferroni adjusted across all
+// benchmarks present in both files, so a suite of hundreds of benchmarks
+// does not produce chance failures. Rows repeated within a file (e.g.
+// several runs concatenated) have their samples pooled.
+//
+// Rows carrying the runner's `noise` column need a change larger than K
+// times the noisier side's noise as well, so a noisy host widens its own
+// threshold instead of failing the gate.
+//
+// --normalize=ROW divides every sample of each file by the median of that
+// file's ROW, typically a machine baseline such as
+// calibrate/stream/triad (lab_bench --calibrate), so runs from different
+// hosts compare in units of their own hardware.
+//
+// Exit status: 0 no significant slowdown, 1 slowdown, 2 usage/input error.
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "lab/results.hpp"
+#include "lab/stats.hpp"
+
+namespace {
+
+struct Series {
+  std::vector<double> samples;
+  double noise = 0;  // largest over the pooled rows
+};
+
+using Samples = std::map<std::string, Series>;
+
+bool load(const char* path, Samples& out) {
+  std::ifstream in(path);
+  if (!in) {
+    std::fprintf(stderr, "error: cannot open %s\n", path);
+    return false;
+  }
+  std::vector<lab::Result> results;
+  std::string error;
+  if (!lab::read_results(in, results, &error)) {
+    std::fprintf(stderr, "error: %s: %s\n", path, error.c_str());
+    return false;
+  }
+  for (const auto& r : results) {
+    auto& s = out[r.name];
+    s.samples.insert(s.samples.end(), r.samples.begin(), r.samples.end());
+    if (const double* noise = r.counter("noise")) {
+      s.noise = std::max(s.noise, *noise);
+    }
+  }
+  return true;
+}
+
+// Rescales `samples` to units of the median of its row `name`.
+bool normalize(Samples& samples, const std::string& name, const char* path) {
+  auto it = samples.find(name);
+  if (it == samples.end() || it->second.samples.empty()) {
+    std::fprintf(stderr, "error: %s: no %s row to normalize by\n", path,
+                 name.c_str());
+    return false;
+  }
+  double unit = lab::median(it->second.samples);
+  if (!(unit > 0)) {
+    std::fprintf(stderr, "error: %s: %s is not positive\n", path,
+                 name.c_str());
+    return false;
+  }
+  for (auto& [n, series] : samples) {
+    for (double& v : series.samples) v /= unit;
+  }
+  return true;
+}
+
+struct Row {
+  std::string name;
+  double old_median;
+  double new_median;
+  double p_slower;
+  double p_faster;
+  double min_effect;  // after widening for noise
+  bool slower = false;
+  bool faster = false;
+};
+
+// Holm-Bonferroni: marks rows whose p-value (selected by `p`) survives the
+// step-down procedure at level `alpha`.
+template <class P, class Mark>
+void holm(std::vector<Row>& rows, double alpha, P p, Mark mark) {
+  std::vector<Row*> order;
+  for (auto& row : rows) order.push_back(&row);
+  std::sort(order.begin(), order.end(),
+            [&](const Row* a, const Row* b) { return p(*a) < p(*b); });
+  double m = static_cast<double>(order.size());
+  for (std::size_t i = 0; i < order.size(); ++i) {
+    if (p(*order[i]) > alpha / (m - static_cast<double>(i))) break;
+    mark(*order[i]);
+  }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  double alpha = 0.01;
+  double min_effect = 0.02;
+  double noise_factor = 3;
+  std::string normalize_by;
+  std::vector<const char*> files;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg.rfind("--alpha=", 0) == 0) {
+      alpha = std::atof(arg.c_str() + 8);
+    } else if (arg.rfind("--min-effect=", 0) == 0) {
+      min_effect = std::atof(arg.c_str() + 13);
+    } else if (arg.rfind("--noise-factor=", 0) == 0) {
+      noise_factor = std::atof(arg.c_str() + 15);
+    } else if (arg.rfind("--normalize=", 0) == 0) {
+      normalize_by = arg.substr(12);
+    } else if (arg.rfind("--", 0) == 0) {
+      files.clear();
+      break;
+    } else {
+      files.push_back(argv[i]);
+    }
+  }
+  if (files.size() != 2) {
+    std::fprintf(stderr,
+                 "usage: %s [--alpha=P] [--min-effect=FRACTION] "
+                 "[--noise-factor=K] [--normalize=ROW] OLD NEW\n",
+                 argv[0]);
+    return 2;
+  }
+
+  Samples old_samples, new_samples;
+  if (!load(files[0], old_samples) || !load(files[1], new_samples)) return 2;
+  if (!normalize_by.empty() &&
+      (!normalize(old_samples, normalize_by, files[0]) ||
+       !normalize(new_samples, normalize_by, files[1]))) {
+    return 2;
+  }
+
+  std::vector<Row> rows;
+  for (auto& [name, old_series] : old_samples) {
+    auto it = new_samples.find(name);
+    if (it == new_samples.end()) continue;
+    auto& old_s = old_series.samples;
+    auto& new_s = it->second.samples;
+    if (old_s.empty() || new_s.empty()) {
+      std::fprintf(stderr, "warning: %s: no samples, skipped\n",
+                   name.c_str());
+      continue;
+    }
+    Row row{name, 0, 0, lab::mann_whitney_greater(old_s, new_s),
+            lab::mann_whitney_greater(new_s, old_s),
+            std::max(min_effect,
+                     noise_factor *
+                         std::max(old_series.noise, it->second.noise))};
+    row.old_median = lab::median(old_s);
+    row.new_median = lab::median(new_s);
+    rows.push_back(row);
+  }
+
+  auto change = [](const Row& r) { return r.new_median / r.old_median - 1; };
+  holm(rows, alpha, [](const Row& r) { return r.p_slower; },
+       [&](Row& r) { r.slower = change(r) > r.min_effect; });
+  holm(rows, alpha, [](const Row& r) { return r.p_faster; },
+       [&](Row& r) { r.faster = -change(r) > r.min_effect; });
+
+  int regressions = 0;
+  // Normalized medians are multiples of the baseline's.
+  bool plain = normalize_by.empty();
+  std::printf("%-40s %12s %12s %8s %10s %7s  %s\n", "name",
+              plain ? "old ns/op" : "old x base",
+              plain ? "new ns/op" : "new x base", "change", "p", "min",
+              "verdict");
+  for (const auto& r : rows) {
+    const char* verdict = r.slower ? "SLOWER" : r.faster ? "faster" : "~";
+    double p = r.new_median >= r.old_median ? r.p_slower : r.p_faster;
+    std::printf(plain ? "%-40s %12.2f %12.2f %+7.1f%% %10.2g %6.1f%%  %s\n"
+                      : "%-40s %12.4g %12.4g %+7.1f%% %10.2g %6.1f%%  %s\n",
+                r.name.c_str(), r.old_median, r.new_median, 100 * change(r),
+                p, 100 * r.min_effect, verdict);
+    regressions += r.slower;
+  }
+  if (regressions != 0) {
+    std::printf("%d significant slowdown(s)\n", regressions);
+    return 1;
+  }
+  return 0;
+}
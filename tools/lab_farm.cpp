@@ -0,0 +1,309 @@
+// Runs one benchmark suite across several hosts and merges the results.
+//
+//   lab_farm [--build=DIR] [--remote-dir=PATH] [--out=DIR] [--ssh=COMMAND]
+//            [--no-calibrate] [--tolerance=FRACTION]
+//            HOST... [-- LAB_BENCH_ARGS...]
+//
+// Each host gets a copy of lab_bench and plugins/ from the build
+// directory (default _gate_build) under PATH/<i> (default /tmp/lab_farm),
+// streamed through tar over ssh, and runs `lab_bench --shard=<i>/<N>`
+// with the given arguments, so that the N hosts split the suite between
+// them. Host "local" runs on this machine without ssh.
+//
+// Results land in DIR (default farm):
+//
+//   DIR/nodes/<i>-<host>/        bench_output.txt, fingerprint.txt, log.txt
+//   DIR/<fingerprint>/           bench_output.txt merged over the hosts
+//                                with that hardware, and hosts.txt
+//
+// Hosts are grouped by `lab_bench --fingerprint`, so timings from
+// different hardware never end up in one file. Latency histograms are
+// merged along with the rows.
+//
+// Every host also runs the machine baselines (`lab_bench --calibrate`).
+// A host whose baseline is more than FRACTION (default 0.2) slower than
+// the median of its group is reported as degraded, on stderr and in
+// DIR/<fingerprint>/degraded.txt: same hardware, so a bad DIMM, a
+// throttled CPU or a noisy neighbour. Its rows are still merged.
+//
+// Exit status: 0 every host finished, 1 some host failed (the others are
+// still merged), 2 usage error.
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "lab/results.hpp"
+
+namespace {
+
+namespace fs = std::filesystem;
+
+int usage(const char* argv0) {
+  std::fprintf(stderr,
+               "usage: %s [--build=DIR] [--remote-dir=PATH] [--out=DIR] "
+               "[--ssh=COMMAND]\n"
+               "          [--no-calibrate] [--tolerance=FRACTION]\n"
+               "          HOST... [-- LAB_BENCH_ARGS...]\n",
+               argv0);
+  return 2;
+}
+
+// Single-quotes `s` for a POSIX shell.
+std::string quote(const std::string& s) {
+  std::string out = "'";
+  for (char c : s) {
+    if (c == '\'') {
+      out += "'\\''";
+    } else {
+      out += c;
+    }
+  }
+  return out + "'";
+}
+
+struct Config {
+  std::string build = "_gate_build";
+  std::string remote_dir = "/tmp/lab_farm";
+  std::string out = "farm";
+  std::string ssh = "ssh -o BatchMode=yes";
+  bool calibrate = true;
+  double tolerance = 0.2;
+  std::vector<std::string> bench_args;
+};
+
+struct Node {
+  int index;
+  std::string host;
+  fs::path dir;  // local copy of its files
+  bool ok = false;
+};
+
+std::mutex print_mu;
+
+void report(const Node& node, const char* what) {
+  std::lock_guard lock(print_mu);
+  std::fprintf(stderr, "[%d %s] %s\n", node.index, node.host.c_str(), what);
+}
+
+// A local shell command that runs `command` on the node.
+std::string on_node(const Config& cfg, const Node& node,
+                    const std::string& command) {
+  if (node.host == "local") return "sh -c " + quote(command);
+  return cfg.ssh + " " + quote(node.host) + " " + quote(command);
+}
+
+bool run(const std::string& command) {
+  return std::system(command.c_str()) == 0;
+}
+
+void run_node(const Config& cfg, int shards, Node& node) {
+  std::string remote = cfg.remote_dir + "/" + std::to_string(node.index);
+  bool plugins = fs::is_directory(fs::path(cfg.build) / "plugins");
+
+  report(node, "shipping");
+  std::string files = plugins ? "lab_bench plugins" : "lab_bench";
+  if (!run("tar -C " + quote(cfg.build) + " -cf - " + files + " | " +
+           on_node(cfg, node,
+                   "rm -rf " + quote(remote) + " && mkdir -p " +
+                       quote(remote) + " && tar -C " + quote(remote) +
+                       " -xf -"))) {
+    report(node, "failed to ship the build");
+    return;
+  }
+
+  report(node, "running");
+  std::string bench = "./lab_bench --shard=" + std::to_string(node.index) +
+                      "/" + std::to_string(shards) +
+                      " --out=bench_output.txt";
+  if (plugins) bench += " --plugins=plugins";
+  if (cfg.calibrate) bench += " --calibrate";
+  for (const auto& arg : cfg.bench_args) {
+    bench += ' ';
+    bench += quote(arg);
+  }
+  bool finished = run(on_node(
+      cfg, node,
+      "cd " + quote(remote) + " && ./lab_bench --fingerprint >fingerprint.txt"
+          " && " + bench + " >log.txt 2>&1"));
+
+  std::error_code ec;
+  fs::create_directories(node.dir, ec);
+  for (const char* file : {"log.txt", "fingerprint.txt", "bench_output.txt"}) {
+    run(on_node(cfg, node, "cat " + quote(remote + "/" + file)) + " >" +
+        quote((node.dir / file).string()) + " 2>/dev/null");
+  }
+  if (!finished) {
+    report(node, ("lab_bench failed; see " + (node.dir / "log.txt").string())
+                     .c_str());
+    return;
+  }
+  report(node, "done");
+  node.ok = true;
+}
+
+// "hw-...\tdescription" from `lab_bench --fingerprint`.
+bool read_fingerprint(const fs::path& path, std::string& id,
+                      std::string& description) {
+  std::ifstream in(path);
+  std::string line;
+  if (!std::getline(in, line)) return false;
+  auto tab = line.find('\t');
+  if (tab == std::string::npos) return false;
+  id = line.substr(0, tab);
+  description = line.substr(tab + 1);
+  return !id.empty();
+}
+
+struct HostRows {
+  std::string host;
+  std::vector<lab::Result> rows;
+};
+
+// Hosts more than `tolerance` slower than the group median on some
+// calibrate/ row, one line each.
+std::vector<std::string> degraded(const std::vector<HostRows>& hosts,
+                                  double tolerance) {
+  std::map<std::string, std::vector<std::pair<double, std::string>>> rows;
+  for (const auto& h : hosts) {
+    for (const auto& r : h.rows) {
+      if (r.name.rfind("calibrate/", 0) == 0 && r.ns_per_op > 0) {
+        rows[r.name].emplace_back(r.ns_per_op, h.host);
+      }
+    }
+  }
+  std::vector<std::string> lines;
+  for (auto& [name, values] : rows) {
+    if (values.size() < 2) continue;
+    std::vector<double> ns;
+    for (const auto& v : values) ns.push_back(v.first);
+    // The lower median, so that of two hosts the slower one is flagged.
+    auto mid = ns.begin() + static_cast<std::ptrdiff_t>((ns.size() - 1) / 2);
+    std::nth_element(ns.begin(), mid, ns.end());
+    double median = *mid;
+    for (const auto& [value, host] : values) {
+      double slower = value / median - 1;
+      if (slower <= tolerance) continue;
+      char line[512];
+      std::snprintf(line, sizeof line, "%s: %s %.0f%% slower than the median "
+                    "of %zu hosts", host.c_str(), name.c_str(), 100 * slower,
+                    values.size());
+      lines.emplace_back(line);
+    }
+  }
+  return lines;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Config cfg;
+  std::vector<std::string> hosts;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--") {
+      cfg.bench_args.assign(argv + i + 1, argv + argc);
+      break;
+    } else if (arg.rfind("--build=", 0) == 0) {
+      cfg.build = arg.substr(8);
+    } else if (arg.rfind("--remote-dir=", 0) == 0) {
+      cfg.remote_dir = arg.substr(13);
+    } else if (arg.rfind("--out=", 0) == 0) {
+      cfg.out = arg.substr(6);
+    } else if (arg.rfind("--ssh=", 0) == 0) {
+      cfg.ssh = arg.substr(6);
+    } else if (arg == "--no-calibrate") {
+      cfg.calibrate = false;
+    } else if (arg.rfind("--tolerance=", 0) == 0) {
+      cfg.tolerance = std::atof(arg.c_str() + 12);
+    } else if (arg.rfind("--", 0) == 0) {
+      return usage(argv[0]);
+    } else {
+      hosts.push_back(arg);
+    }
+  }
+  if (hosts.empty()) return usage(argv[0]);
+  if (!fs::exists(fs::path(cfg.build) / "lab_bench")) {
+    std::fprintf(stderr, "error: no lab_bench in %s\n", cfg.build.c_str());
+    return 2;
+  }
+
+  std::vector<Node> nodes;
+  for (std::size_t i = 0; i < hosts.size(); ++i) {
+    int index = static_cast<int>(i);
+    nodes.push_back({index, hosts[i],
+                     fs::path(cfg.out) / "nodes" /
+                         (std::to_string(index) + "-" + hosts[i])});
+  }
+  std::vector<std::thread> threads;
+  for (auto& node : nodes) {
+    threads.emplace_back(run_node, std::cref(cfg),
+                         static_cast<int>(nodes.size()), std::ref(node));
+  }
+  for (auto& t : threads) t.join();
+
+  struct Group {
+    std::string description;
+    std::vector<HostRows> hosts;
+  };
+  std::map<std::string, Group> groups;
+  int failed = 0;
+  for (const auto& node : nodes) {
+    std::string id, description;
+    std::vector<lab::Result> rows;
+    std::ifstream in(node.dir / "bench_output.txt");
+    std::string error;
+    if (!node.ok ||
+        !read_fingerprint(node.dir / "fingerprint.txt", id, description) ||
+        !lab::read_results(in, rows, &error)) {
+      if (node.ok) {
+        std::fprintf(stderr, "error: %s: unreadable results %s\n",
+                     node.host.c_str(), error.c_str());
+      }
+      ++failed;
+      continue;
+    }
+    Group& g = groups[id];
+    g.description = description;
+    g.hosts.push_back({node.host, std::move(rows)});
+  }
+
+  for (auto& [id, g] : groups) {
+    fs::path dir = fs::path(cfg.out) / id;
+    std::error_code ec;
+    fs::create_directories(dir, ec);
+    std::vector<lab::Result> all;
+    for (const auto& h : g.hosts) {
+      all.insert(all.end(), h.rows.begin(), h.rows.end());
+    }
+    std::vector<lab::Result> merged = lab::merge_results(all);
+    std::ofstream out(dir / "bench_output.txt");
+    lab::write_results(out, merged);
+    std::ofstream list(dir / "hosts.txt");
+    list << g.description << '\n';
+    for (const auto& h : g.hosts) list << h.host << '\n';
+    std::ofstream bad(dir / "degraded.txt");
+    for (const auto& line : degraded(g.hosts, cfg.tolerance)) {
+      std::fprintf(stderr, "warning: degraded host %s\n", line.c_str());
+      bad << line << '\n';
+    }
+    if (!out || !list || !bad) {
+      std::fprintf(stderr, "error: cannot write %s\n", dir.c_str());
+      return 1;
+    }
+    std::printf("%s  %zu host(s)  %zu rows  %s\n", id.c_str(), g.hosts.size(),
+                merged.size(), g.description.c_str());
+  }
+  if (failed != 0) {
+    std::fprintf(stderr, "%d of %zu host(s) failed\n", failed, nodes.size());
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,113 @@
+// Maintains and queries a run archive (see lab/archive.hpp).
+//
+//   lab_history append ARCHIVE RESULTS [--commit=SHA] [--time=UNIX]
+//                                      [--host=NAME]
+//   lab_history runs ARCHIVE
+//   lab_history trend ARCHIVE BENCHMARK [METRIC]
+//
+// `append` imports a bench_output.txt; lab_bench --archive does the same
+// directly. `trend` prints one tab-separated "timestamp commit value" line
+// per run that has the benchmark, METRIC defaulting to ns_per_op.
+//
+// Exit status: 0 success, 1 nothing found, 2 usage/input error.
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "lab/archive.hpp"
+#include "lab/results.hpp"
+
+namespace {
+
+int usage(const char* argv0) {
+  std::fprintf(stderr,
+               "usage: %s append ARCHIVE RESULTS [--commit=SHA] "
+               "[--time=UNIX] [--host=NAME]\n"
+               "       %s runs ARCHIVE\n"
+               "       %s trend ARCHIVE BENCHMARK [METRIC]\n",
+               argv0, argv0, argv0);
+  return 2;
+}
+
+bool open_archive(const std::string& path, lab::Archive& archive) {
+  std::string error;
+  if (!archive.open(path, &error)) {
+    std::fprintf(stderr, "error: %s\n", error.c_str());
+    return false;
+  }
+  return true;
+}
+
+int append(const char* argv0, const std::vector<std::string>& args) {
+  lab::RunInfo info;
+  std::vector<std::string> files;
+  for (const auto& arg : args) {
+    if (arg.rfind("--commit=", 0) == 0) {
+      info.commit = arg.substr(9);
+    } else if (arg.rfind("--time=", 0) == 0) {
+      info.timestamp = std::atoll(arg.c_str() + 7);
+    } else if (arg.rfind("--host=", 0) == 0) {
+      info.host = arg.substr(7);
+    } else if (arg.rfind("--", 0) == 0) {
+      return usage(argv0);
+    } else {
+      files.push_back(arg);
+    }
+  }
+  if (files.size() != 2) return usage(argv0);
+
+  std::ifstream in(files[1]);
+  if (!in) {
+    std::fprintf(stderr, "error: cannot open %s\n", files[1].c_str());
+    return 2;
+  }
+  std::vector<lab::Result> results;
+  std::string error;
+  if (!lab::read_results(in, results, &error) ||
+      !lab::append_run(files[0], info, results, &error)) {
+    std::fprintf(stderr, "error: %s\n", error.c_str());
+    return 2;
+  }
+  return 0;
+}
+
+int runs(const std::string& path) {
+  lab::Archive archive;
+  if (!open_archive(path, archive)) return 2;
+  for (lab::Archive::Run run : archive) {
+    std::printf("%lld\t%.*s\t%.*s\t%zu rows\t%zu metrics\n",
+                static_cast<long long>(run.timestamp()),
+                static_cast<int>(run.commit().size()), run.commit().data(),
+                static_cast<int>(run.host().size()), run.host().data(),
+                run.rows(), run.metric_count());
+  }
+  return archive.size() == 0 ? 1 : 0;
+}
+
+int trend(const std::string& path, const std::string& benchmark,
+          const std::string& metric) {
+  lab::Archive archive;
+  if (!open_archive(path, archive)) return 2;
+  auto points = lab::trend(archive, benchmark, metric);
+  for (const auto& p : points) {
+    std::printf("%lld\t%.*s\t%.9g\n", static_cast<long long>(p.timestamp),
+                static_cast<int>(p.commit.size()), p.commit.data(), p.value);
+  }
+  return points.empty() ? 1 : 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc < 3) return usage(argv[0]);
+  std::string command = argv[1];
+  std::vector<std::string> args(argv + 2, argv + argc);
+  if (command == "append") return append(argv[0], args);
+  if (command == "runs" && args.size() == 1) return runs(args[0]);
+  if (command == "trend" && (args.size() == 2 || args.size() == 3)) {
+    return trend(args[0], args[1], args.size() == 3 ? args[2] : "ns_per_op");
+  }
+  return usage(argv[0]);
+}
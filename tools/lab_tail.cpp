@@ -0,0 +1,101 @@
+// Merges the latency histograms of any number of bench_output.txt files,
+// e.g. the same suite run on many machines, and prints fleet-wide tail
+// latency per benchmark.
+//
+//   lab_tail [--filter=SUBSTRING] RESULTS...
+//
+// Rows with the same name are merged across and within files; rows
+// without a latency histogram are ignored. Values are in ns.
+//
+// Exit status: 0 success, 1 no histograms found, 2 usage/input error.
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "lab/histogram.hpp"
+#include "lab/results.hpp"
+
+namespace {
+
+struct Merged {
+  lab::Histogram latency;
+  int rows = 0;
+};
+
+bool load(const char* path, const std::string& filter,
+          std::map<std::string, Merged>& out) {
+  std::ifstream in(path);
+  if (!in) {
+    std::fprintf(stderr, "error: cannot open %s\n", path);
+    return false;
+  }
+  std::vector<lab::Result> results;
+  std::string error;
+  if (!lab::read_results(in, results, &error)) {
+    std::fprintf(stderr, "error: %s: %s\n", path, error.c_str());
+    return false;
+  }
+  for (const auto& r : results) {
+    if (r.latency.empty()) continue;
+    if (r.name.find(filter) == std::string::npos) continue;
+    lab::Histogram h;
+    if (!lab::Histogram::deserialize(r.latency, h, &error)) {
+      std::fprintf(stderr, "error: %s: %s: %s\n", path, r.name.c_str(),
+                   error.c_str());
+      return false;
+    }
+    Merged& m = out[r.name];
+    m.latency.merge(h);
+    ++m.rows;
+  }
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  std::string filter;
+  std::vector<const char*> files;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg.rfind("--filter=", 0) == 0) {
+      filter = arg.substr(9);
+    } else if (arg.rfind("--", 0) == 0) {
+      files.clear();
+      break;
+    } else {
+      files.push_back(argv[i]);
+    }
+  }
+  if (files.empty()) {
+    std::fprintf(stderr, "usage: %s [--filter=SUBSTRING] RESULTS...\n",
+                 argv[0]);
+    return 2;
+  }
+
+  std::map<std::string, Merged> merged;
+  for (const char* path : files) {
+    if (!load(path, filter, merged)) return 2;
+  }
+  if (merged.empty()) {
+    std::fprintf(stderr, "no latency histograms found\n");
+    return 1;
+  }
+
+  std::printf("%-40s %5s %12s %10s %10s %10s %10s %12s\n", "name", "rows",
+              "count", "p50", "p90", "p99", "p99.9", "max");
+  for (const auto& [name, m] : merged) {
+    const lab::Histogram& h = m.latency;
+    std::printf("%-40s %5d %12llu %10llu %10llu %10llu %10llu %12llu\n",
+                name.c_str(), m.rows,
+                static_cast<unsigned long long>(h.count()),
+                static_cast<unsigned long long>(h.percentile(0.50)),
+                static_cast<unsigned long long>(h.percentile(0.90)),
+                static_cast<unsigned long long>(h.percentile(0.99)),
+                static_cast<unsigned long long>(h.percentile(0.999)),
+                static_cast<unsigned long long>(h.max()));
+  }
+  return 0;
+}